@@ -33,6 +33,8 @@
 
 #include <ortc/services/types.h>
 
+#include <iosfwd>
+
 namespace ortc
 {
   namespace services
@@ -48,6 +50,17 @@ namespace ortc
     interaction ICanonicalXML
     {
       static String convert(zsLib::XML::ElementPtr element);
+
+      // PURPOSE: Writes the same canonical form as "convert(element)" to a
+      //          stream as it is generated rather than into a string.
+      static void convert(
+                          zsLib::XML::ElementPtr element,
+                          std::ostream &output
+                          );
+
+      // PURPOSE: Returns the SHA1 digest of "convert(element)" without
+      //          holding the canonical form in memory.
+      static SecureByteBlockPtr hash(zsLib::XML::ElementPtr element);
     };
   }
 }
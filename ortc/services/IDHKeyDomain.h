@@ -61,7 +61,11 @@ namespace ortc
         KeyDomainPrecompiledType_6144 = 6144,
         KeyDomainPrecompiledType_8192 = 8192,
 
-        KeyDomainPrecompiledType_Last = KeyDomainPrecompiledType_8192,
+        // elliptic curve key agreement (RFC 7748); there is no p, q or g
+        // so the domain is only ever identified by its namespace
+        KeyDomainPrecompiledType_X25519 = 25519,
+
+        KeyDomainPrecompiledType_Last = KeyDomainPrecompiledType_X25519,
       };
 
       static const char *toNamespace(KeyDomainPrecompiledTypes length);
@@ -94,6 +98,9 @@ namespace ortc
 
       //-----------------------------------------------------------------------
       // NOTE: p, q and g integers are HEX encoded for compatibility
+      // NOTE: curve key domains (e.g. X25519) have no group parameters and
+      //       must be persisted by their namespace or precompiled type;
+      //       calling save on a curve key domain throws InvalidUsage
       virtual void save(
                         SecureByteBlock &p,
                         SecureByteBlock &q,
@@ -118,6 +118,12 @@ namespace ortc
                                            const SecureByteBlockPtr &part2
                                            );
 
+      // PURPOSE: Returns the SHA1 digest of the canonical JSON form of an
+      //          element, i.e. the same digest as hashing the JSON generated
+      //          from "cloneAsCanonicalJSON(el)" but computed by walking the
+      //          original element without cloning it or building the JSON.
+      static SecureByteBlockPtr hashCanonicalJSON(ElementPtr el);
+
       // RETURNS: returns the actual signed element, rather than the bundle element (if bundle was passed in) or NULL if no signature was found
       static ElementPtr getSignatureInfo(
                                          ElementPtr signedEl,
@@ -130,6 +136,63 @@ namespace ortc
       static String convertIDNToUTF8(const String &idnStr);
 
       static bool isValidDomain(const String &domain);
+
+      using zsLib::eventing::IHelper::convertToBase64;
+      using zsLib::eventing::IHelper::convertFromBase64;
+      using zsLib::eventing::IHelper::convertToHex;
+      using zsLib::eventing::IHelper::convertFromHex;
+
+      // PURPOSE: Base64 and hex conversions that write into a caller supplied
+      //          buffer instead of allocating a String or SecureByteBlock.
+      //          Vectorized (SSSE3/AVX2/NEON) kernels are used when the CPU
+      //          supports them. Encoded output is not NUL terminated.
+      static size_t getBase64EncodedLength(size_t bufferLengthInBytes);
+
+      // RETURNS: the decoded length or 0 if the length or padding of the
+      //          input cannot be valid base64
+      static size_t getBase64DecodedLength(
+                                           const char *encoded,
+                                           size_t encodedLength
+                                           );
+
+      // RETURNS: the number of characters written or 0 if the output is too
+      //          small
+      static size_t convertToBase64(
+                                    const BYTE *buffer,
+                                    size_t bufferLengthInBytes,
+                                    char *outEncoded,
+                                    size_t outEncodedLength
+                                    );
+
+      // RETURNS: false if the input is not valid (padded or unpadded) base64
+      //          or the output is too small
+      static bool convertFromBase64(
+                                    const char *encoded,
+                                    size_t encodedLength,
+                                    BYTE *outBuffer,
+                                    size_t outBufferLengthInBytes,
+                                    size_t &outDecodedLengthInBytes
+                                    );
+
+      // RETURNS: the number of characters written (twice the input length)
+      //          or 0 if the output is too small
+      static size_t convertToHex(
+                                 const BYTE *buffer,
+                                 size_t bufferLengthInBytes,
+                                 char *outEncoded,
+                                 size_t outEncodedLength,
+                                 bool outputUpperCase = false
+                                 );
+
+      // RETURNS: false if the input is not valid hex or the output is too
+      //          small
+      static bool convertFromHex(
+                                 const char *encoded,
+                                 size_t encodedLength,
+                                 BYTE *outBuffer,
+                                 size_t outBufferLengthInBytes,
+                                 size_t &outDecodedLengthInBytes
+                                 );
     };
 
   } // namespace services
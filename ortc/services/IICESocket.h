@@ -232,6 +232,13 @@ namespace ortc
                                            ICESocketStates state
                                            ) = 0;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Notifies as each local candidate is discovered (or lost)
+      //          so it can be trickled to the remote party immediately
+      //          rather than waiting for every candidate to be gathered.
+      // NOTE:    Use IICESocket::compare() against the previously signaled
+      //          list to find the new candidates. Gathering is complete once
+      //          the socket reaches ICESocketState_Ready.
       virtual void onICESocketCandidatesChanged(IICESocketPtr socket) = 0;
     };
 
@@ -96,6 +96,22 @@ namespace ortc
                                          IICESocketSessionPtr foundation = IICESocketSessionPtr()
                                          );
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Create an ICE-lite session (RFC 8445 section 2.5) for a
+      //          socket with public host candidates. The session only
+      //          answers connectivity checks and learns the remote address
+      //          from the checks it is nominated upon. It never sends checks,
+      //          keep alives or nominations and allocates no requesters or
+      //          timers so a single socket can serve many sessions.
+      // NOTE:    The session is always controlled. The ICE socket should be
+      //          created without STUN or TURN servers.
+      static IICESocketSessionPtr createLite(
+                                             IICESocketSessionDelegatePtr delegate,
+                                             IICESocketPtr socket,
+                                             const char *remoteUsernameFrag,
+                                             const char *remotePassword
+                                             );
+
       virtual PUID getID() const = 0;
 
       virtual IICESocketSessionSubscriptionPtr subscribe(IICESocketSessionDelegatePtr delegate) = 0;
@@ -117,6 +133,20 @@ namespace ortc
       virtual void getLocalCandidates(CandidateList &outCandidates) = 0;
       virtual void updateRemoteCandidates(const CandidateList &remoteCandidates) = 0;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Trickle a single remote candidate into the session as soon
+      //          as it is learned. Pairs for the candidate are formed and
+      //          checked without disturbing checks already in progress.
+      // NOTE:    Call endOfRemoteCandidates() once the remote party signals
+      //          it has no more candidates to offer.
+      virtual void addRemoteCandidate(const Candidate &remoteCandidate) = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Informs a full ICE session the remote party is ICE-lite.
+      //          A lite agent never sends checks so a successful check alone
+      //          is enough for a pair to be nominated.
+      virtual void setRemoteLite() = 0;
+
       //-----------------------------------------------------------------------
       // PURPOSE: Calling this method will cause the ICE connection to shutdown
       //          when all ICE candidate searches are exhausted.
@@ -134,6 +164,11 @@ namespace ortc
                               size_t packetLengthInBytes
                               ) = 0;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Sends a packet whose reserved headroom/tailroom can be used
+      //          to frame the packet for a TURN relay without a copy.
+      virtual bool sendPacket(PacketBufferPtr packet) = 0;
+
       //-----------------------------------------------------------------------
       // PURPOSE: Although each ICE session starts off as being in a particular
       //          controlling state, the state can change due to an unintended
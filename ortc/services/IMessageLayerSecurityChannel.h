@@ -330,6 +330,13 @@ namespace ortc
       //          true when this information is needed.
       virtual void setReceiveKeyingSigningPublicKey(IRSAPublicKeyPtr remotePublicKey) = 0;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Sets an Ed25519 public key to be used to validate the
+      //          signature of the received keying material.
+      // NOTE:    Use this instead of the RSA version when the remote party
+      //          signs its keying material using Ed25519.
+      virtual void setReceiveKeyingSigningPublicKey(IEd25519PublicKeyPtr remotePublicKey) = 0;
+
 
       //-----------------------------------------------------------------------
       // PURPOSE: Obtains the send keying material that needs to be signed.
@@ -361,6 +368,17 @@ namespace ortc
                                           IRSAPrivateKeyPtr signingKey,
                                           IRSAPublicKeyPtr signingPublicKey
                                           ) = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Notified the signture has been applied to the result of
+      //          "getSendKeyingNeedingToBeSigned" using an Ed25519 key.
+      // NOTE:    Future keying materials are automatically signed with the
+      //          Ed25519 key which is far cheaper to sign and verify than
+      //          an RSA key.
+      virtual void notifySendKeyingSigned(
+                                          IEd25519PrivateKeyPtr signingKey,
+                                          IEd25519PublicKeyPtr signingPublicKey
+                                          ) = 0;
     };
 
 
@@ -0,0 +1,148 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/types.h>
+
+namespace ortc
+{
+  namespace services
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRSABatch
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    // PURPOSE: Collects a set of independent RSA operations and performs
+    //          them in parallel across the service thread pool so the total
+    //          latency is roughly that of a single RSA operation rather than
+    //          the sum of all of them.
+    interaction IRSABatch
+    {
+      typedef size_t OperationIndex;
+
+      enum Operations
+      {
+        Operation_Sign,
+        Operation_Verify,
+        Operation_Encrypt,
+        Operation_Decrypt,
+      };
+
+      static const char *toString(Operations operation);
+
+      static ElementPtr toDebug(IRSABatchPtr batch);
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Create an empty batch of RSA operations
+      static IRSABatchPtr create();
+
+      virtual PUID getID() const = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Add an operation to the batch
+      // RETURNS: Index used to obtain the result once the batch completes
+      // NOTES:   Operations can only be added before "process" is called.
+      virtual OperationIndex sign(
+                                  IRSAPrivateKeyPtr key,
+                                  const SecureByteBlock &inBufferToSign
+                                  ) = 0;
+
+      virtual OperationIndex decrypt(
+                                     IRSAPrivateKeyPtr key,
+                                     const SecureByteBlock &buffer
+                                     ) = 0;
+
+      virtual OperationIndex verify(
+                                    IRSAPublicKeyPtr key,
+                                    const SecureByteBlock &inOriginalBufferSigned,
+                                    const SecureByteBlock &inSignature
+                                    ) = 0;
+
+      virtual OperationIndex encrypt(
+                                     IRSAPublicKeyPtr key,
+                                     const SecureByteBlock &buffer
+                                     ) = 0;
+
+      virtual size_t getTotalOperations() const = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Start performing the operations on the service thread pool
+      // NOTES:   The delegate (if any) is notified once every operation in
+      //          the batch has completed.
+      virtual void process(IRSABatchDelegatePtr delegate = IRSABatchDelegatePtr()) = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Block the calling thread until every operation completes
+      // NOTES:   The calling thread performs any operations not yet picked
+      //          up by the thread pool so waiting from a pool thread can
+      //          never stall the batch. Calls "process" if it has not been
+      //          called already.
+      virtual void wait() = 0;
+
+      virtual bool isComplete() const = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Obtain the output of a sign, encrypt or decrypt operation
+      // RETURNS: Result or SecureByteBlockPtr() if the operation failed or
+      //          has not yet completed
+      virtual SecureByteBlockPtr getResult(OperationIndex index) const = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Obtain the outcome of a verify operation
+      virtual bool getVerified(OperationIndex index) const = 0;
+    };
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRSABatchDelegate
+    #pragma mark
+
+    interaction IRSABatchDelegate
+    {
+      virtual void onRSABatchCompleted(IRSABatchPtr batch) = 0;
+    };
+
+  }
+}
+
+ZS_DECLARE_PROXY_BEGIN(ortc::services::IRSABatchDelegate)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::IRSABatchPtr, IRSABatchPtr)
+ZS_DECLARE_PROXY_METHOD_1(onRSABatchCompleted, IRSABatchPtr)
+ZS_DECLARE_PROXY_END()
@@ -59,17 +59,28 @@ namespace ortc
 
       virtual String getFingerprint() const = 0;
 
+      //-----------------------------------------------------------------------
+      // NOTE:    Verification results are remembered in a bounded cache
+      //          keyed by the key fingerprint, the signed data and the
+      //          signature so repeated checks of the same signed data skip
+      //          the RSA operation. Pass "useVerifyCache" as false to always
+      //          perform the full verification (and not record the result).
       virtual bool verify(
                           const SecureByteBlock &inOriginalBufferSigned,
-                          const SecureByteBlock &inSignature
+                          const SecureByteBlock &inSignature,
+                          bool useVerifyCache = true
                           ) const = 0;
 
       virtual bool verify(
                           const String &inOriginalStringSigned,
-                          const SecureByteBlock &inSignature
+                          const SecureByteBlock &inSignature,
+                          bool useVerifyCache = true
                           ) const = 0;
 
-      virtual bool verifySignature(ElementPtr signedEl) const = 0;
+      virtual bool verifySignature(
+                                   ElementPtr signedEl,
+                                   bool useVerifyCache = true
+                                   ) const = 0;
 
       virtual SecureByteBlockPtr encrypt(const SecureByteBlock &buffer) const = 0;
     };
@@ -33,6 +33,7 @@
 
 #include <ortc/services/types.h>
 #include <ortc/services/IHTTP.h>
+#include <ortc/services/ITransportStream.h>
 
 #include <zsLib/IPAddress.h>
 #include <zsLib/Proxy.h>
@@ -52,6 +53,8 @@ namespace ortc
 
     interaction IRUDPChannel
     {
+      ZS_DECLARE_STRUCT_PTR(ReliabilityHeader)
+
       enum RUDPChannelStates
       {
         RUDPChannelState_Connecting,
@@ -93,6 +96,46 @@ namespace ortc
 
       static const char *toString(CongestionAlgorithms value);
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Optional header attached to a buffer written to the send
+      //          stream to relax how reliably that buffer is delivered.
+      // NOTE:    Only a buffer small enough to fit inside a single packet
+      //          can be delivered unreliably, a larger buffer is always
+      //          delivered reliably and in order.
+      //
+      //          Expired data is never delivered to the remote party (the
+      //          remote party simply never sees the buffer).
+      //
+      //          An unordered buffer that arrives ahead of earlier data is
+      //          written to the remote party's receive stream as a buffer
+      //          of its own with a ReliabilityHeader attached (thus the
+      //          receiver must read the receive stream buffer by buffer to
+      //          tell the buffers apart).
+      //
+      //          The lifetime is counted from when the header was
+      //          constructed (not when the buffer is written) so create
+      //          the header right before writing the buffer, or reset
+      //          mCreated when re-using a header.
+      struct ReliabilityHeader : public ITransportStream::StreamHeader
+      {
+        ReliabilityHeader();
+        virtual ~ReliabilityHeader() {}
+
+        static ReliabilityHeaderPtr convert(ITransportStream::StreamHeaderPtr header);
+
+        bool isReliable() const;
+        bool hasExpired(
+                        ULONG totalRetransmits,
+                        Time now
+                        ) const;
+
+        bool mOrdered {true};               // if false, the buffer may be delivered ahead of data written before it
+        bool mLimitRetransmits {};          // if true, give up after mMaxRetransmits retransmissions
+        ULONG mMaxRetransmits {};           // 0 = send only once
+        Milliseconds mMaxLifetime {};       // give up once mCreated is older than this (0 = no limit)
+        Time mCreated;                      // when the header was constructed (the start of the lifetime)
+      };
+
       //-----------------------------------------------------------------------
       // PURPOSE: returns a debug object containing internal object state
       static ElementPtr toDebug(IRUDPChannelPtr channel);
@@ -120,6 +163,25 @@ namespace ortc
       // PURPOSE: Return connection information as reported by the remote party
       // NOTE:    Will return an empty string until connected.
       virtual String getRemoteConnectionInfo() = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Return how many independently ordered streams were
+      //          negotiated with the remote party for this channel.
+      // NOTE:    Will return 1 until connected or if the remote party does
+      //          not support multiple streams. Stream 0 is always the
+      //          channel's own receive/send stream.
+      virtual WORD getTotalStreams() const = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Obtain the receive/send stream for a negotiated stream other
+      //          than stream 0. Data lost on one stream does not delay the
+      //          delivery of data on the other streams.
+      // RETURNS: false if the stream does not exist (or not yet connected).
+      virtual bool getSubStream(
+                                WORD streamID,
+                                ITransportStreamPtr &outReceiveStream,
+                                ITransportStreamPtr &outSendStream
+                                ) = 0;
     };
 
     //-------------------------------------------------------------------------
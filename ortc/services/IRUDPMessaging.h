@@ -56,6 +56,18 @@ namespace ortc
     {
       typedef IRUDPChannel::Shutdown Shutdown;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Attach to a message written to the send stream to deliver
+      //          the message unordered, with a maximum number of
+      //          retransmits or with a maximum lifetime.
+      // NOTE:    Only a message which fits inside a single RUDP packet
+      //          (after adding a 4 byte size prefix) can be delivered
+      //          unreliably, larger messages are always delivered reliably.
+      //          An unordered message received ahead of earlier messages is
+      //          written to the receive stream with this header attached.
+      typedef IRUDPChannel::ReliabilityHeader MessageReliabilityHeader;
+      typedef IRUDPChannel::ReliabilityHeaderPtr MessageReliabilityHeaderPtr;
+
       enum RUDPMessagingStates
       {
         RUDPMessagingState_Connecting =   IRUDPChannel::RUDPChannelState_Connecting,
@@ -157,6 +169,30 @@ namespace ortc
       // PURPOSE: Return connection information as reported by the remote party
       // NOTE:    Will return an empty string until connected.
       virtual String getRemoteConnectionInfo() = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Return how many independently ordered streams the channel
+      //          negotiated with the remote party.
+      // NOTE:    Will return 1 until connected or if the remote party does
+      //          not support multiple streams.
+      virtual WORD getTotalStreams() = 0;
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Creates a messaging object on one of the channel's other
+      //          negotiated streams. Messages lost on one stream do not delay
+      //          the delivery of messages on any other stream.
+      // NOTE:    Both parties must open the same stream ID to exchange
+      //          messages. The stream lives only as long as the channel of
+      //          this messaging object. Will return NULL if the stream is
+      //          not available (i.e. not yet connected, stream ID is 0 or
+      //          beyond the negotiated total streams).
+      virtual IRUDPMessagingPtr openStream(
+                                           IRUDPMessagingDelegatePtr delegate,
+                                           WORD streamID,
+                                           ITransportStreamPtr receiveStream,
+                                           ITransportStreamPtr sendStream,
+                                           size_t maxMessageSizeInBytes = ORTC_SERVICES_IRDUPMESSAGING_MAX_MESSAGE_SIZE_IN_BYTES
+                                           ) = 0;
     };
 
     //-------------------------------------------------------------------------
@@ -118,6 +118,17 @@ namespace ortc
                               bool bindChannelIfPossible = false
                               ) = 0;
 
+      //-----------------------------------------------------------------------
+      // PURPOSE: Sends a packet via the TURN server. When the destination
+      //          has a bound channel the ChannelData header and padding are
+      //          written into the packet's reserved headroom and tailroom so
+      //          the packet is relayed without a copy.
+      virtual bool sendPacket(
+                              IPAddress destination,
+                              PacketBufferPtr packet,
+                              bool bindChannelIfPossible = false
+                              ) = 0;
+
       virtual IPAddress getActiveServerIP() const = 0;
       virtual IPAddress getRelayedIP() const = 0;
       virtual IPAddress getReflectedIP() const = 0;
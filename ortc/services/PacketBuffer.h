@@ -0,0 +1,105 @@
+/*
+
+ Copyright (c) 2014, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/types.h>
+
+// enough room in front of the data for a TURN ChannelData header
+#define ORTC_SERVICES_PACKET_BUFFER_DEFAULT_HEADROOM_IN_BYTES (sizeof(DWORD))
+// enough room after the data to pad the packet to a DWORD boundary
+#define ORTC_SERVICES_PACKET_BUFFER_DEFAULT_TAILROOM_IN_BYTES (sizeof(DWORD))
+
+namespace ortc
+{
+  namespace services
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketBuffer
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    // PURPOSE: A packet which reserves unused room before and after its data
+    //          so that lower layers (e.g. TURN ChannelData framing) can wrap
+    //          the packet in place without allocating and copying.
+    //
+    // NOTE:    The headroom and tailroom are scratch space belonging to
+    //          whoever is currently sending the packet. A sender may write
+    //          into them but must never alter the data itself since the same
+    //          packet can be sent again (e.g. a retransmission).
+    struct PacketBuffer
+    {
+      static PacketBufferPtr create(
+                                    size_t sizeInBytes,
+                                    size_t headroomInBytes = ORTC_SERVICES_PACKET_BUFFER_DEFAULT_HEADROOM_IN_BYTES,
+                                    size_t tailroomInBytes = ORTC_SERVICES_PACKET_BUFFER_DEFAULT_TAILROOM_IN_BYTES
+                                    );
+
+      static PacketBufferPtr create(
+                                    const BYTE *buffer,
+                                    size_t bufferLengthInBytes,
+                                    size_t headroomInBytes = ORTC_SERVICES_PACKET_BUFFER_DEFAULT_HEADROOM_IN_BYTES,
+                                    size_t tailroomInBytes = ORTC_SERVICES_PACKET_BUFFER_DEFAULT_TAILROOM_IN_BYTES
+                                    );
+
+      const BYTE *data() const              {return mBuffer.BytePtr() + mHeadroom;}
+      BYTE *data()                          {return mBuffer.BytePtr() + mHeadroom;}
+      size_t size() const                   {return mSize;}
+
+      size_t headroom() const               {return mHeadroom;}
+      size_t tailroom() const               {return mBuffer.SizeInBytes() - mHeadroom - mSize;}
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Returns a pointer to the start of the reserved bytes
+      //          immediately preceding the data.
+      // RETURNS: NULL if there is not enough headroom reserved.
+      BYTE *reserveHeadroom(size_t sizeInBytes);
+
+      //-----------------------------------------------------------------------
+      // PURPOSE: Returns a pointer to the reserved bytes immediately following
+      //          the data.
+      // RETURNS: NULL if there is not enough tailroom reserved.
+      BYTE *reserveTailroom(size_t sizeInBytes);
+
+    protected:
+      PacketBuffer() : mHeadroom(0), mSize(0) {}
+
+    protected:
+      SecureByteBlock mBuffer;
+      size_t mHeadroom;
+      size_t mSize;
+    };
+  }
+}
@@ -59,7 +59,8 @@ namespace ortc
         Flag_DP_DuplicatePacket =       (1 << 4),
         Flag_EC_ECNPacket =             (1 << 3),
         Flag_EQ_GSNREqualsGSNFR =       (1 << 2),
-        Flag_AR_ACKRequired =           (1 << 1)
+        Flag_AR_ACKRequired =           (1 << 1),
+        Flag_UO_Unordered =             (1 << 0)    // data may be delivered ahead of earlier data (ignored by receivers that do not understand it)
       };
 
       enum VectorFlags
@@ -113,6 +114,10 @@ namespace ortc
                                        );
 
       SecureByteBlockPtr packetize() const;
+      PacketBufferPtr packetize(                                  // reserves room around the packet for lower layers to frame it without a copy
+                                size_t headroomInBytes,
+                                size_t tailroomInBytes
+                                ) const;
 
       bool isFlagSet(Flags flag) const;
       bool isFlagSet(VectorFlags flag) const;
@@ -123,6 +128,13 @@ namespace ortc
       void clearFlag(Flags flag);
       void clearFlag(VectorFlags flag);
 
+      // sets a flag on an already packetized buffer (avoids re-packetizing)
+      static void setFlag(
+                          BYTE *packetizedBuffer,
+                          size_t packetizedLengthInBytes,
+                          Flags flag
+                          );
+
       QWORD getSequenceNumber(QWORD hintLastSequenceNumber) const;
       QWORD getGSNR(QWORD hintLastGSNR) const;
       QWORD getGSNFR(QWORD hintLastGSNFR) const;  // only can call if the Flag_EQ_GSNREqualsGSNFR is *NOT* set, otherwise an exception will be thrown
@@ -181,6 +193,10 @@ namespace ortc
                Log::Params inParams = Log::Params()
                ) const;
 
+    protected:
+      size_t getPacketizedLengthInBytes() const;
+      void packetizeInto(BYTE *packet) const;
+
     public:
       const char *mLogObject;            // when output to a log, which object was responsible for this packet (never packetized or parsed)
       PUID mLogObjectID;                 // when output to a log, which object ID was responsible for this packet (never packetized or parsed)
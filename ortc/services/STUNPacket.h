@@ -128,6 +128,7 @@ namespace ortc
         Attribute_GSNFR =                         0x1745,
         Attribute_RUDPFlags =                     0x1746,
         Attribute_ACKVector =                     0x1747,
+        Attribute_RUDPStreams =                   0x9748,   // comprehension optional so older RUDP implementations ignore it
 
         // obsolete attributes that should be ignored
         Attribute_ReservedResponseAddress =       0x0002,
@@ -290,6 +291,7 @@ namespace ortc
       RFCs guessRFC(RFCs allowedRFCs) const;
 
       SecureByteBlockPtr packetize(RFCs rfc);
+      bool repacketize(SecureByteBlock &packet);                 // stamps a buffer previously returned from packetize() with a new transaction ID (only MESSAGE-INTEGRITY and FINGERPRINT are recalculated); returns false and leaves the buffer untouched if it carries XOR'ed address attributes
 
       bool isValidResponseTo(
                              STUNPacketPtr stunRequest,
@@ -407,6 +409,8 @@ namespace ortc
 
       String mConnectionInfo;                                   // additional connection information in RUDP
 
+      WORD mRUDPStreams {};                                     // how many independently ordered sub-streams are supported within the channel (0 means this value is not set)
+
       QWORD mGSNR {};                                           // 0 means this value is not set
       QWORD mGSNFR {};                                          // 0 means this value is not set
 
@@ -29,10 +29,15 @@
 
  */
 
+
 #include <ortc/services/internal/services_CanonicalXML.h>
 #include <zsLib/XML.h>
 
-#include <list>
+#include <cryptopp/sha.h>
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
 
 namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
 
@@ -42,7 +47,7 @@ namespace ortc
   {
     namespace internal
     {
-      typedef std::map<String, String> XMLNamespaceMap;
+      typedef std::map<String, AttributePtr> XMLNamespaceMap;
 
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -52,276 +57,253 @@ namespace ortc
       #pragma mark (helpers)
       #pragma mark
 
+      //-----------------------------------------------------------------------
+      static bool isNamespace(const String &name)
+      {
+        return name.substr(0, 5) == "xmlns";
+      }
+
       //-----------------------------------------------------------------------
       static void calculateNamespaceTo(
                                        ElementPtr element,
                                        XMLNamespaceMap &outNamespaces
                                        )
       {
-        if (!element)
-          return;
+        typedef std::vector<ElementPtr> ElementVector;
 
-        ElementPtr current = element->getRootElement();
-        while (current)
-        {
-          // walk all the attributes in the namespace for overrides to the namespace map
-          {
-            AttributePtr attribute = current->getFirstAttribute();
-            AttributePtr next;
-            for (; attribute; attribute = next) {
-              NodePtr tmp = attribute->getNextSibling();
-              if (tmp) {
-                next = tmp->toAttribute();
-              } else {
-                next.reset();
-              }
-
-              String name = attribute->getName();
-              if (name.size() < 5)
-                continue;
-
-              if (name.substr(0, 5) == "xmlns") {
-                // this is a namespace, override the current namespace
-
-                String value = attribute->getValue();
-                if (value.isEmpty()) {
-                  XMLNamespaceMap::iterator found = outNamespaces.find(name);
-                  if (found != outNamespaces.end())
-                    outNamespaces.erase(found);
-                } else {
-                  outNamespaces[name] = value;
-                }
-              }
-            }
-          }
+        ElementVector path;
+        for (ElementPtr current = element; current; current = current->getParentElement()) {
+          path.push_back(current);
+        }
 
-          if (current == element)
-            break;  // we are now done
-
-          // calculate the new current root
-          ElementPtr found = element;
-          ElementPtr parent = found->getParentElement();
-          while (parent) {
-            if (parent == current)
-              break;  // do not redo the already processed parent
-            found = parent;
-            parent = parent->getParentElement();
-          }
+        // apply the namespaces from the outer most element inwards
+        for (auto iter = path.rbegin(); iter != path.rend(); ++iter) {
+          for (AttributePtr attribute = (*iter)->getFirstAttribute(); attribute; attribute = attribute->getNextAttribute()) {
+            String name = attribute->getName();
+            if (!isNamespace(name)) continue;
 
-          current = found;
+            if (attribute->getValue().isEmpty()) {
+              outNamespaces.erase(name);
+            } else {
+              outNamespaces[name] = attribute;
+            }
+          }
         }
       }
 
       //-----------------------------------------------------------------------
-      static void calculateOverrides(
-                                     ElementPtr element,
-                                     XMLNamespaceMap &namespaces,
-                                     XMLNamespaceMap &outOverrides
-                                     )
-      {
-        if (!element)
-          return;
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark CanonicalXMLWriter
+      #pragma mark
 
-        XMLNamespaceMap namespacesToParent = namespaces;
+      // Writes the canonical XML form of an element in a single pass over the
+      // original tree. Only the namespaces in scope and a small amount of
+      // scratch state per depth are kept while writing:
+      // - the root element declares every namespace in scope
+      // - other elements only declare namespaces that differ from their parent
+      // - namespaces are written first then attributes, each sorted by name
+      // - comments, declarations and DTDs are dropped
+      // - end tags are always written, CDATA is written as escaped text and
+      //   attribute values and text are re-escaped from their decoded values
+      class CanonicalXMLWriter
+      {
+      public:
+        typedef CanonicalXML::ISink ISink;
+        typedef std::vector<AttributePtr> AttributeVector;
 
-        ElementPtr parent = element->getParentElement();
-        if (parent) {
-          calculateNamespaceTo(parent, namespacesToParent);
-        }
+        struct ScopeChange
+        {
+          String mName;
+          AttributePtr mPrevious;
+        };
 
-        AttributePtr attribute = element->getFirstAttribute();
-        AttributePtr next;
-        for (; attribute; attribute = next) {
-          NodePtr tmp = attribute->getNextSibling();
-          if (tmp) {
-            next = tmp->toAttribute();
-          } else {
-            next.reset();
-          }
+        typedef std::vector<ScopeChange> ScopeChangeVector;
 
-          String name = attribute->getName();
-          if (name.size() < 5)
-            continue;
+        struct Level
+        {
+          XMLNamespaceMap mOverrides;
+          AttributeVector mAttributes;
+          ScopeChangeVector mRestore;
+        };
 
-          if (name.substr(0, 5) == "xmlns") {
+        typedef std::deque<Level> LevelDeque;   // references stay valid as deeper levels are added
 
-            // this is a namespace, override the parent namespace
-            String value = attribute->getValue();
+      public:
+        CanonicalXMLWriter(ISink &sink) : mSink(sink) {}
 
-            XMLNamespaceMap::iterator found = namespacesToParent.find(name);
-            if (found == namespacesToParent.end()) {
-              // this was not in the parent thus it is an override (if not set to empty)
-              if (!value.isEmpty())
-                outOverrides[name] = value;
-            } else {
-              // this was found in the parent, check to see if the value changed
-              String parentValue = (*found).second;
-              if (parentValue != value)
-                outOverrides[name] = value;
-            }
-          }
+        //---------------------------------------------------------------------
+        void writeRoot(ElementPtr element)
+        {
+          calculateNamespaceTo(element, mScope);
+          writeElement(element, 0);
         }
-      }
-
-      //-----------------------------------------------------------------------
-      static void changeAttribtues(
-                                   ElementPtr element,
-                                   XMLNamespaceMap &overrides
-                                   )
-      {
-        AttributePtr attribute = element->getFirstAttribute();
-        AttributePtr next;
-        for (; attribute; attribute = next) {
-          NodePtr tmp = attribute->getNextSibling();
-          if (tmp) {
-            next = tmp->toAttribute();
-          } else {
-            next.reset();
-          }
 
-          // first strip out any namespaces
+      protected:
+        //---------------------------------------------------------------------
+        void write(char value) {mSink.write(&value, sizeof(value));}
+        void write(const char *value) {mSink.write(value, strlen(value));}
+        void write(const String &value) {if (value.hasData()) mSink.write(value.c_str(), value.length());}
 
-          String name = attribute->getName();
-          if (name.size() < 5)
-            continue;
+        //---------------------------------------------------------------------
+        void writeEscaped(
+                          const String &value,
+                          bool isAttribute
+                          )
+        {
+          const char *start = value.c_str();
+          const char *pos = start;
+
+          for (; '\0' != *pos; ++pos) {
+            const char *replacement = NULL;
+            switch (*pos) {
+              case '&':   replacement = "&amp;"; break;
+              case '<':   replacement = "&lt;"; break;
+              case '>':   replacement = "&gt;"; break;
+              case '\r':  replacement = "&#xD;"; break;
+              case '\"':  if (isAttribute) replacement = "&quot;"; break;
+              case '\t':  if (isAttribute) replacement = "&#x9;"; break;
+              case '\n':  if (isAttribute) replacement = "&#xA;"; break;
+              default:    break;
+            }
+            if (!replacement) continue;
 
-          if (name.substr(0, 5) == "xmlns") {
-            attribute->orphan();
+            if (pos != start) mSink.write(start, pos - start);
+            write(replacement);
+            start = pos + 1;
           }
-        }
 
-        // now put back all the new XML element attrbutes namespaces
-        for (XMLNamespaceMap::iterator iter = overrides.begin(); iter != overrides.end(); ++iter)
-        {
-          element->setAttribute((*iter).first, (*iter).second);
+          if (pos != start) mSink.write(start, pos - start);
         }
-      }
-
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      #pragma mark
-      #pragma mark MyXMLNSWalkSink
-      #pragma mark
 
-      //-----------------------------------------------------------------------
-      class MyXMLNSWalkSink : public WalkSink
-      {
-      public:
         //---------------------------------------------------------------------
-        MyXMLNSWalkSink(
-                        XMLNamespaceMap &xmlns,
-                        ElementPtr &root
-                        ) : mRootXMLNS(xmlns), mRoot(root) {}
-
-        virtual bool onElementEnter(ElementPtr inNode) {
-          if (inNode == mRoot) return false;  // already processed the root element
-
-          XMLNamespaceMap xmlns;
-          calculateOverrides(inNode, mRootXMLNS, xmlns);
-          changeAttribtues(inNode, xmlns);
-          return false;
+        void writeAttribute(AttributePtr attribute)
+        {
+          write(' ');
+          write(attribute->getName());
+          write('=');
+          write('\"');
+          writeEscaped(attribute->getValueDecoded(), true);
+          write('\"');
         }
-      protected:
+
         //---------------------------------------------------------------------
-        #pragma mark
-        #pragma mark MyXMLNSWalkSink => (data)
-        #pragma mark
+        void writeElement(
+                          ElementPtr element,
+                          size_t depth
+                          )
+        {
+          if (mLevels.size() <= depth) mLevels.resize(depth + 1);
+
+          Level &level = mLevels[depth];
+          level.mOverrides.clear();
+          level.mAttributes.clear();
+          level.mRestore.clear();
+
+          for (AttributePtr attribute = element->getFirstAttribute(); attribute; attribute = attribute->getNextAttribute()) {
+            String name = attribute->getName();
+            if (!isNamespace(name)) {
+              level.mAttributes.push_back(attribute);
+              continue;
+            }
 
-        XMLNamespaceMap mRootXMLNS;
-        ElementPtr mRoot;
-      };
+            if (0 == depth) continue; // the root declares the entire scope instead
 
-      //---------------------------------------------------------------------
-      static bool normizeCompare(AttributePtr v1, AttributePtr v2)
-      {
-        if (v1->getName().substr(0, 5) == "xmlns") {
-          if (v2->getName().substr(0, 5) == "xmlns") {
-            return v1->getName() < v2->getName();
+            // only namespaces that differ from the parent's scope are declared
+            String value = attribute->getValue();
+            auto found = mScope.find(name);
+            if (found == mScope.end()) {
+              if (value.hasData()) level.mOverrides[name] = attribute;
+            } else if ((*found).second->getValue() != value) {
+              level.mOverrides[name] = attribute;
+            }
           }
-          return true;
-        } else if (v2->getName().substr(0, 5) == "xmlns") {
-          return false;
-        }
-        return v1->getName() < v2->getName();
-      }
 
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      //-----------------------------------------------------------------------
-      #pragma mark
-      #pragma mark MyOrphanerWalkSink
-      #pragma mark
+          if (0 == depth) level.mOverrides = mScope;
 
-      //---------------------------------------------------------------------
-      class MyOrphanerWalkSink : public WalkSink
-      {
-        typedef std::list<AttributePtr> AttributeValueList;
+          std::stable_sort(level.mAttributes.begin(), level.mAttributes.end(), [](const AttributePtr &first, const AttributePtr &second) -> bool {return first->getName() < second->getName();});
 
-      public:
-        virtual bool onElementEnter(ElementPtr inNode) {
-          // sort the attributes
-          AttributeValueList attributes;
-          AttributePtr attribute = inNode->getFirstAttribute();
-          while (attribute) {
-            NodePtr next = attribute->getNextSibling();
-            attributes.push_back(attribute);
-            attribute->orphan();
-            if (!next)
-              break;
-            attribute = next->toAttribute();
+          String name = element->getValue();
+
+          write('<');
+          write(name);
+          for (auto iter = level.mOverrides.begin(); iter != level.mOverrides.end(); ++iter) {
+            writeAttribute((*iter).second);
           }
+          for (auto iter = level.mAttributes.begin(); iter != level.mAttributes.end(); ++iter) {
+            writeAttribute(*iter);
+          }
+          write('>');
 
-          // The sort isn't proper because it doesn't take into account the
-          // primary key is the URI of the attribute not just the lexical name
-          // but will fix this one day... if we ever use name spaces in the
-          // attributes! (which we don't right now)
-
-          // sort them - namespaces go first, then other attributes
-          attributes.sort(normizeCompare);
-
-          // we orphaned all attributes - now going to put them back in order
-          AttributePtr last;
-          // now put them all back!
-          for (AttributeValueList::iterator iter = attributes.begin(); iter != attributes.end(); ++iter) {
-            if (!last) {
-              inNode->setAttribute(*iter);
-              last = (*iter);
-            } else {
-              last->adoptAsNextSibling(*iter);
-              last = (*iter);
+          pushScope(level);
+
+          for (NodePtr child = element->getFirstChild(); child; child = child->getNextSibling()) {
+            if (child->isElement()) {
+              writeElement(child->toElement(), depth + 1);
+              continue;
+            }
+            if (child->isText()) {
+              writeEscaped(child->toText()->getValueDecoded(), false);
+              continue;
+            }
+            if (child->isUnknown()) {
+              String value = child->toUnknown()->getValue();
+              if (value.substr(0, 1) == "!") continue;  // DTDs are dropped
+              write('<');
+              write(value);
+              write('>');
             }
           }
-          attributes.clear();
-          return false;
-        }
 
-        //---------------------------------------------------------------------
-        virtual bool onComment(CommentPtr inNode)
-        {
-          inNode->orphan();
-          return false;
+          popScope(mLevels[depth]);
+
+          write('<');
+          write('/');
+          write(name);
+          write('>');
         }
 
         //---------------------------------------------------------------------
-        virtual bool onDeclarationEnter(DeclarationPtr inNode)
+        void pushScope(Level &level)
         {
-          inNode->orphan();
-          return false;
+          for (auto iter = level.mOverrides.begin(); iter != level.mOverrides.end(); ++iter) {
+            const String &name = (*iter).first;
+
+            ScopeChange change;
+            change.mName = name;
+
+            auto found = mScope.find(name);
+            if (found != mScope.end()) {
+              change.mPrevious = (*found).second;
+            }
+            level.mRestore.push_back(change);
+
+            if ((*iter).second->getValue().isEmpty()) {
+              if (found != mScope.end()) mScope.erase(found);
+            } else {
+              mScope[name] = (*iter).second;
+            }
+          }
         }
 
         //---------------------------------------------------------------------
-        virtual bool onUnknown(UnknownPtr inNode)
+        void popScope(Level &level)
         {
-          String value = inNode->getValue();
-          if (value.substr(0, 1) == "!") {
-            // orphan DTDs
-            inNode->orphan();
+          for (auto iter = level.mRestore.rbegin(); iter != level.mRestore.rend(); ++iter) {
+            if ((*iter).mPrevious) {
+              mScope[(*iter).mName] = (*iter).mPrevious;
+            } else {
+              mScope.erase((*iter).mName);
+            }
           }
-          return false;
         }
+
+      protected:
+        ISink &mSink;
+        XMLNamespaceMap mScope;
+        LevelDeque mLevels;
       };
 
       //-----------------------------------------------------------------------
@@ -335,36 +317,78 @@ namespace ortc
       //-----------------------------------------------------------------------
       String CanonicalXML::convert(ElementPtr element)
       {
+        class StringSink : public ISink
+        {
+        public:
+          virtual void write(const char *value, size_t length) {mOutput.append(value, length);}
+
+          std::string mOutput;
+        };
+
         if (!element)
           return String();
 
-        XMLNamespaceMap xmlns;
-        calculateNamespaceTo(element, xmlns);
+        StringSink sink;
+        write(element, sink);
+        return String(sink.mOutput);
+      }
+
+      //-----------------------------------------------------------------------
+      void CanonicalXML::convert(
+                                 ElementPtr element,
+                                 std::ostream &output
+                                 )
+      {
+        class StreamSink : public ISink
+        {
+        public:
+          StreamSink(std::ostream &output) : mOutput(output) {}
+          virtual void write(const char *value, size_t length) {mOutput.write(value, length);}
+
+          std::ostream &mOutput;
+        };
+
+        if (!element)
+          return;
 
-        ElementPtr original = element;
-        ElementPtr newRoot = (original->clone())->toElementChecked();
+        StreamSink sink(output);
+        write(element, sink);
+      }
 
-        changeAttribtues(newRoot, xmlns);
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr CanonicalXML::hash(ElementPtr element)
+      {
+        class HashSink : public ISink
+        {
+        public:
+          HashSink(CryptoPP::HashTransformation &hasher) : mHasher(hasher) {}
+          virtual void write(const char *value, size_t length) {mHasher.Update((const BYTE *)value, length);}
 
-        MyXMLNSWalkSink nswalker(xmlns, newRoot);
-        newRoot->walk(nswalker, Node::NodeType::Element);
+          CryptoPP::HashTransformation &mHasher;
+        };
 
-        MyOrphanerWalkSink orphanWalker;
-        Node::FilterList filter;
-        filter.push_back(Node::NodeType::Element);
-        filter.push_back(Node::NodeType::Comment);
-        filter.push_back(Node::NodeType::Declaration);
-        filter.push_back(Node::NodeType::Unknown);
+        CryptoPP::SHA1 hasher;
 
-        newRoot->walk(orphanWalker,  &filter);
+        if (element) {
+          HashSink sink(hasher);
+          write(element, sink);
+        }
 
-        DocumentPtr doc = Document::create();
-        doc->adoptAsFirstChild(newRoot);
+        SecureByteBlockPtr result(make_shared<SecureByteBlock>(hasher.DigestSize()));
+        hasher.Final(result->BytePtr());
+        return result;
+      }
 
-        GeneratorPtr generator = Generator::createXMLGenerator(static_cast<Generator::XMLWriteFlags>(Generator::XMLWriteFlag_ForceElementEndTag | Generator::XMLWriteFlag_NormalizeCDATA | Generator::XMLWriteFlag_EntityEncode0xDInText | Generator::XMLWriteFlag_NormizeAttributeValue));
+      //-----------------------------------------------------------------------
+      void CanonicalXML::write(
+                               ElementPtr element,
+                               ISink &sink
+                               )
+      {
+        if (!element)
+          return;
 
-        std::unique_ptr<char[]> output = generator->write(doc);
-        return (CSTR)output.get();
+        CanonicalXMLWriter(sink).writeRoot(element);
       }
     }
 
@@ -381,5 +405,20 @@ namespace ortc
     {
       return internal::CanonicalXML::convert(element);
     }
+
+    //---------------------------------------------------------------------
+    void ICanonicalXML::convert(
+                                ElementPtr element,
+                                std::ostream &output
+                                )
+    {
+      internal::CanonicalXML::convert(element, output);
+    }
+
+    //---------------------------------------------------------------------
+    SecureByteBlockPtr ICanonicalXML::hash(ElementPtr element)
+    {
+      return internal::CanonicalXML::hash(element);
+    }
   }
 }
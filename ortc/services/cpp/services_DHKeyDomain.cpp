@@ -37,6 +37,9 @@
 #include <cryptopp/nbtheory.h>
 
 #include <zsLib/XML.h>
+#include <zsLib/helpers.h>
+
+#include <map>
 
 #define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_UNKNOWN "https://meta.ortclib.org/dh/modp/uknown"
 #define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_1024    "https://meta.ortclib.org/dh/modp/1024"
@@ -46,6 +49,7 @@
 #define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_4096    "https://meta.ortclib.org/dh/modp/4096"
 #define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_6144    "https://meta.ortclib.org/dh/modp/6144"
 #define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_8192    "https://meta.ortclib.org/dh/modp/8192"
+#define ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_X25519  "https://meta.ortclib.org/dh/curve/x25519"
 
 namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
 
@@ -62,6 +66,8 @@ namespace ortc
 
       using namespace zsLib::XML;
 
+      ZS_DECLARE_CLASS_PTR(DHKeyDomainPrecompiledCache);
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -405,7 +411,10 @@ namespace ortc
           "03"
         },
 
-        // 8 = end of list
+        // 8 = x25519 (curve domain, no modp group)
+        {NULL, NULL, NULL},
+
+        // 9 = end of list
         {NULL, NULL, NULL},
       };
 
@@ -421,6 +430,7 @@ namespace ortc
           case IDHKeyDomain::KeyDomainPrecompiledType_4096:     return 5;
           case IDHKeyDomain::KeyDomainPrecompiledType_6144:     return 6;
           case IDHKeyDomain::KeyDomainPrecompiledType_8192:     return 7;
+          case IDHKeyDomain::KeyDomainPrecompiledType_X25519:   return 8;
         }
         return 0;
       }
@@ -437,7 +447,54 @@ namespace ortc
           case 5: return IDHKeyDomain::KeyDomainPrecompiledType_4096;
           case 6: return IDHKeyDomain::KeyDomainPrecompiledType_6144;
           case 7: return IDHKeyDomain::KeyDomainPrecompiledType_8192;
+          case 8: return IDHKeyDomain::KeyDomainPrecompiledType_X25519;
+        }
+        return IDHKeyDomain::KeyDomainPrecompiledType_Unknown;
+      }
+
+      //-------------------------------------------------------------------------
+      static String toHex(const Integer &value)
+      {
+        SecureByteBlock buffer(value.MinEncodedSize());
+        value.Encode(buffer, buffer.SizeInBytes());
+        return IHelper::convertToHex(buffer, true);
+      }
+
+      //-------------------------------------------------------------------------
+      static IDHKeyDomain::KeyDomainPrecompiledTypes findPrecompiledType(
+                                                                         const Integer &p,
+                                                                         const Integer &q,
+                                                                         const Integer &g
+                                                                         )
+      {
+        String pStr = toHex(p);
+        String qStr = toHex(q);
+        String gStr = toHex(g);
+
+        for (size_t index = 0; true; ++index)
+        {
+          IDHKeyDomain::KeyDomainPrecompiledTypes type = fromIndex(index);
+
+          const char *pCompare = sDHPrecompiles[index].mP;
+          const char *qCompare = sDHPrecompiles[index].mQ;
+          const char *gCompare = sDHPrecompiles[index].mG;
+
+          if ((pCompare) &&
+              (qCompare) &&
+              (gCompare)) {
+
+            if ((pStr == pCompare) &&
+                (qStr == qCompare) &&
+                (gStr == gCompare)) {
+              return type;
+            }
+          }
+
+          if (IDHKeyDomain::KeyDomainPrecompiledType_Last == type) {
+            break;
+          }
         }
+
         return IDHKeyDomain::KeyDomainPrecompiledType_Unknown;
       }
 
@@ -447,6 +504,69 @@ namespace ortc
         return Log::Params(message, "stack::DHKeyDomain");
       }
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark DHKeyDomainPrecompiledCache
+      #pragma mark
+
+      // Each precompiled group is loaded (and validated when asked) once per
+      // process then shared since a key domain never changes once loaded.
+      class DHKeyDomainPrecompiledCache
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        struct Entry
+        {
+          DHKeyDomainPtr mKeyDomain;
+          bool mValidated {false};
+        };
+        typedef std::map<size_t, Entry> EntryMap;
+
+      public:
+        //---------------------------------------------------------------------
+        DHKeyDomainPrecompiledCache(const make_private &) {}
+
+        //---------------------------------------------------------------------
+        static DHKeyDomainPrecompiledCachePtr singleton()
+        {
+          static SingletonLazySharedPtr<DHKeyDomainPrecompiledCache> singleton(make_shared<DHKeyDomainPrecompiledCache>(make_private{}));
+          return singleton.singleton();
+        }
+
+        //---------------------------------------------------------------------
+        DHKeyDomainPtr get(
+                           IDHKeyDomain::KeyDomainPrecompiledTypes precompiledKey,
+                           bool validate
+                           )
+        {
+          AutoLock lock(mLock);
+
+          Entry &entry = mEntries[toIndex(precompiledKey)];
+
+          if (!entry.mKeyDomain) {
+            entry.mKeyDomain = DHKeyDomain::loadPrecompiledNow(precompiledKey);
+            if (!entry.mKeyDomain) return DHKeyDomainPtr();
+          }
+
+          if ((validate) &&
+              (!entry.mValidated)) {
+            ZS_THROW_BAD_STATE_IF(!entry.mKeyDomain->validate()) // this can't fail
+            entry.mValidated = true;
+          }
+
+          return entry.mKeyDomain;
+        }
+
+      protected:
+        Lock mLock;
+        EntryMap mEntries;
+      };
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -516,73 +636,27 @@ namespace ortc
                                                   bool validate
                                                   )
       {
-        size_t index = toIndex(precompiledKey);
-        const char *pStr = sDHPrecompiles[index].mP;
-        const char *qStr = sDHPrecompiles[index].mQ;
-        const char *gStr = sDHPrecompiles[index].mG;
-
-        if ((!pStr) || (!qStr) || (!gStr)) {
-          ZS_LOG_ERROR(Detail, slog("precompiled key is not valid") + ZS_PARAM("length", precompiledKey))
-          return DHKeyDomainPtr();
+        DHKeyDomainPrecompiledCachePtr cache = DHKeyDomainPrecompiledCache::singleton();
+        if (!cache) {
+          DHKeyDomainPtr pThis = loadPrecompiledNow(precompiledKey);
+          if ((pThis) && (validate)) {
+            ZS_THROW_BAD_STATE_IF(!pThis->validate()) // this can't fail
+          }
+          return pThis;
         }
 
-        Integer p((String("0x") + pStr).c_str());
-        Integer q((String("0x") + qStr).c_str());
-        Integer g((String("0x") + gStr).c_str());
-
-        SecureByteBlock resultP(p.MinEncodedSize());
-        SecureByteBlock resultQ(q.MinEncodedSize());
-        SecureByteBlock resultG(g.MinEncodedSize());
-
-        p.Encode(resultP, resultP.SizeInBytes());
-        q.Encode(resultQ, resultQ.SizeInBytes());
-        g.Encode(resultG, resultG.SizeInBytes());
-
-        DHKeyDomainPtr pThis = load(resultP, resultQ, resultG, validate);
-        ZS_THROW_BAD_STATE_IF(!pThis) // this can't fail
-
-        ZS_LOG_DEBUG(pThis->log("loading predefined key domain") + ZS_PARAM("length", precompiledKey) + ZS_PARAM("p", pStr) + ZS_PARAM("q", qStr) + ZS_PARAM("g", gStr))
-
-        return pThis;
+        return cache->get(precompiledKey, validate);
       }
 
       //-----------------------------------------------------------------------
       IDHKeyDomain::KeyDomainPrecompiledTypes DHKeyDomain::getPrecompiledType() const
       {
-        SecureByteBlock p;
-        SecureByteBlock q;
-        SecureByteBlock g;
-
-        save(p, q, g);
-
-        String pStr = IHelper::convertToHex(p, true);
-        String qStr = IHelper::convertToHex(q, true);
-        String gStr = IHelper::convertToHex(g, true);
-
-        for (size_t index = 0; true; ++index)
-        {
-          KeyDomainPrecompiledTypes type = fromIndex(index);
+        if (KeyDomainPrecompiledType_Unknown != mPrecompiledType) return mPrecompiledType;
 
-          const char *pCompare = sDHPrecompiles[index].mP;
-          const char *qCompare = sDHPrecompiles[index].mQ;
-          const char *gCompare = sDHPrecompiles[index].mG;
-
-          if ((pCompare) &&
-              (qCompare) &&
-              (gCompare)) {
-
-            if (pStr != pCompare) continue;
-            if (qStr != qCompare) continue;
-            if (gStr != gCompare) continue;
-
-            ZS_LOG_TRACE(log("found match to precompiled key") + ZS_PARAM("precompiled key", toNamespace(type)))
-
-            return type;
-          }
-
-          if (KeyDomainPrecompiledType_Last == type) {
-            break;
-          }
+        KeyDomainPrecompiledTypes type = findPrecompiledType(mDH.GetGroupParameters().GetModulus(), mDH.GetGroupParameters().GetSubgroupOrder(), mDH.GetGroupParameters().GetGenerator());
+        if (KeyDomainPrecompiledType_Unknown != type) {
+          ZS_LOG_TRACE(log("found match to precompiled key") + ZS_PARAM("precompiled key", toNamespace(type)))
+          return type;
         }
 
         ZS_LOG_TRACE(log("did not find match to any precompiled key"))
@@ -597,14 +671,19 @@ namespace ortc
                                        bool validate
                                        )
       {
-        DHKeyDomainPtr pThis(make_shared<DHKeyDomain>(make_private{}));
-
         try {
           Integer p(inP, inP.SizeInBytes());
           Integer q(inQ, inQ.SizeInBytes());
           Integer g(inG, inG.SizeInBytes());
 
-          pThis->mDH.AccessGroupParameters().Initialize(p, q, g);
+          // a well known group is shared (and only ever validated once)
+          KeyDomainPrecompiledTypes precompiledType = findPrecompiledType(p, q, g);
+          if (KeyDomainPrecompiledType_Unknown != precompiledType) {
+            ZS_LOG_TRACE(slog("key domain matches precompiled key domain") + ZS_PARAM("precompiled key", toNamespace(precompiledType)))
+            return loadPrecompiled(precompiledType, validate);
+          }
+
+          DHKeyDomainPtr pThis = loadNow(p, q, g);
 
           if (validate) {
             if (!pThis->validate()) {
@@ -612,14 +691,13 @@ namespace ortc
               return DHKeyDomainPtr();
             }
           }
+
+          ZS_LOG_DEBUG(pThis->debug("loaded key domain"))
+          return pThis;
         } catch (CryptoPP::Exception &e) {
-          ZS_LOG_ERROR(Basic, pThis->log("cryptography library threw an exception") + ZS_PARAM("what", e.what()))
-          return DHKeyDomainPtr();
+          ZS_LOG_ERROR(Basic, slog("cryptography library threw an exception") + ZS_PARAM("what", e.what()))
         }
-
-        ZS_LOG_DEBUG(pThis->debug("loaded key domain"))
-
-        return pThis;
+        return DHKeyDomainPtr();
       }
 
       //-----------------------------------------------------------------------
@@ -629,6 +707,8 @@ namespace ortc
                              SecureByteBlock &outG
                              ) const
       {
+        ZS_THROW_INVALID_USAGE_IF(isX25519())   // curve key domains are saved by namespace or precompiled type
+
         Integer p = mDH.GetGroupParameters().GetModulus();
         Integer q = mDH.GetGroupParameters().GetSubgroupOrder();
         Integer g = mDH.GetGroupParameters().GetGenerator();
@@ -653,8 +733,9 @@ namespace ortc
       #pragma mark
 
       //-----------------------------------------------------------------------
-      DHKeyDomain::DH &DHKeyDomain::getDH() const
+      DHKeyDomain::KeyAgreementDomain &DHKeyDomain::getKeyAgreementDomain() const
       {
+        if (isX25519()) return *mX25519;
         return mDH;
       }
 
@@ -685,6 +766,12 @@ namespace ortc
       {
         ElementPtr resultEl = Element::create("stack::DHKeyDomain");
 
+        if (isX25519()) {
+          IHelper::debugAppend(resultEl, "id", mID);
+          IHelper::debugAppend(resultEl, "curve", "x25519");
+          return resultEl;
+        }
+
         Integer p = mDH.GetGroupParameters().GetModulus();
         Integer q = mDH.GetGroupParameters().GetSubgroupOrder();
         Integer g = mDH.GetGroupParameters().GetGenerator();
@@ -709,11 +796,62 @@ namespace ortc
         return resultEl;
       }
 
+      //-----------------------------------------------------------------------
+      DHKeyDomainPtr DHKeyDomain::loadNow(
+                                          const Integer &p,
+                                          const Integer &q,
+                                          const Integer &g
+                                          )
+      {
+        DHKeyDomainPtr pThis(make_shared<DHKeyDomain>(make_private{}));
+        pThis->mDH.AccessGroupParameters().Initialize(p, q, g);
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      DHKeyDomainPtr DHKeyDomain::loadPrecompiledNow(KeyDomainPrecompiledTypes precompiledKey)
+      {
+        if (KeyDomainPrecompiledType_X25519 == precompiledKey) {
+          DHKeyDomainPtr pThis(make_shared<DHKeyDomain>(make_private{}));
+          pThis->mPrecompiledType = precompiledKey;
+          pThis->mX25519.reset(new X25519);
+          ZS_LOG_DEBUG(pThis->log("loading predefined curve key domain") + ZS_PARAM("curve", "x25519"))
+          return pThis;
+        }
+
+        size_t index = toIndex(precompiledKey);
+        const char *pStr = sDHPrecompiles[index].mP;
+        const char *qStr = sDHPrecompiles[index].mQ;
+        const char *gStr = sDHPrecompiles[index].mG;
+
+        if ((!pStr) || (!qStr) || (!gStr)) {
+          ZS_LOG_ERROR(Detail, slog("precompiled key is not valid") + ZS_PARAM("length", precompiledKey))
+          return DHKeyDomainPtr();
+        }
+
+        Integer p((String("0x") + pStr).c_str());
+        Integer q((String("0x") + qStr).c_str());
+        Integer g((String("0x") + gStr).c_str());
+
+        DHKeyDomainPtr pThis = loadNow(p, q, g);
+        pThis->mPrecompiledType = precompiledKey;
+
+        // the generator is fixed so build its exponentiation table once;
+        // every key pair generated in this domain then uses it
+        pThis->mDH.AccessGroupParameters().Precompute();
+
+        ZS_LOG_DEBUG(pThis->log("loading predefined key domain") + ZS_PARAM("length", precompiledKey) + ZS_PARAM("p", pStr) + ZS_PARAM("q", qStr) + ZS_PARAM("g", gStr))
+
+        return pThis;
+      }
+
       //-----------------------------------------------------------------------
       bool DHKeyDomain::validate() const
       {
         ZS_LOG_DEBUG(log("validating key domain"))
 
+        if (isX25519()) return true;  // fixed curve; public keys are checked during agreement
+
         try {
           AutoSeededRandomPool rnd;
 
@@ -803,6 +941,7 @@ namespace ortc
         case KeyDomainPrecompiledType_4096:     return ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_4096;
         case KeyDomainPrecompiledType_6144:     return ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_6144;
         case KeyDomainPrecompiledType_8192:     return ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_8192;
+        case KeyDomainPrecompiledType_X25519:   return ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_X25519;
       }
       return ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_UNKNOWN;
     }
@@ -834,6 +973,9 @@ namespace ortc
       if (0 == strcmp(inNamespace, ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_8192)) {
         return KeyDomainPrecompiledType_8192;
       }
+      if (0 == strcmp(inNamespace, ORTC_SERVICES_DH_KEY_DOMAIN_NAMESPACE_X25519)) {
+        return KeyDomainPrecompiledType_X25519;
+      }
 
       return KeyDomainPrecompiledType_Unknown;
     }
@@ -32,6 +32,7 @@
 #include <ortc/services/internal/services_DHPrivateKey.h>
 #include <ortc/services/internal/services_DHKeyDomain.h>
 #include <ortc/services/internal/services_DHPublicKey.h>
+#include <ortc/services/internal/services_KeyGenerationPool.h>
 
 #include <ortc/services/IDHPublicKey.h>
 #include <ortc/services/IHelper.h>
@@ -51,8 +52,8 @@ namespace ortc
     namespace internal
     {
       using CryptoPP::AutoSeededRandomPool;
-      using CryptoPP::DH;
       using CryptoPP::DH2;
+      using CryptoPP::SimpleKeyAgreementDomain;
 
       using namespace zsLib::XML;
 
@@ -118,20 +119,13 @@ namespace ortc
 
         DHPrivateKeyPtr pThis(make_shared<DHPrivateKey>(make_private{}, keyDomain));
 
-        AutoSeededRandomPool rnd;
-
-        DH &dh = pThis->mKeyDomain->getDH();
-
-        DH2 dh2(dh);
-
-        pThis->mStaticPrivateKey.CleanNew(dh2.StaticPrivateKeyLength());
-        pThis->mEphemeralPrivateKey.CleanNew(dh2.EphemeralPrivateKeyLength());
-
-        SecureByteBlock staticPublicKey(dh2.StaticPublicKeyLength());
-        SecureByteBlock ephemeralPublicKey(dh2.EphemeralPublicKeyLength());
+        SecureByteBlock staticPublicKey;
+        SecureByteBlock ephemeralPublicKey;
 
-        dh2.GenerateStaticKeyPair(rnd, pThis->mStaticPrivateKey, staticPublicKey);
-        dh2.GenerateEphemeralKeyPair(rnd, pThis->mEphemeralPrivateKey, ephemeralPublicKey);
+        // DH2 uses the same domain for both the static and ephemeral keys
+        // so either half can come from the pre-generated key pool
+        obtainKeyPair(inKeyDomain, pThis->mStaticPrivateKey, staticPublicKey);
+        obtainKeyPair(inKeyDomain, pThis->mEphemeralPrivateKey, ephemeralPublicKey);
 
         IDHPublicKeyPtr publicKey = IDHPublicKey::load(staticPublicKey, ephemeralPublicKey);
 
@@ -201,18 +195,10 @@ namespace ortc
 
         DHPrivateKeyPtr pThis(make_shared<DHPrivateKey>(make_private{}, keyDomain));
 
-        DH &dh = pThis->mKeyDomain->getDH();
-
-        AutoSeededRandomPool rnd;
-
-        DH2 dh2(dh);
-
         pThis->mStaticPrivateKey.Assign(staticPrivateKey);
 
-        pThis->mEphemeralPrivateKey.CleanNew(dh2.EphemeralPrivateKeyLength());
-        SecureByteBlock ephemeralPublicKey(dh2.EphemeralPublicKeyLength());
-
-        dh2.GenerateEphemeralKeyPair(rnd, pThis->mEphemeralPrivateKey, ephemeralPublicKey);
+        SecureByteBlock ephemeralPublicKey;
+        obtainKeyPair(inKeyDomain, pThis->mEphemeralPrivateKey, ephemeralPublicKey);
 
         IDHPublicKeyPtr publicKey = IDHPublicKey::load(staticPublicKey, ephemeralPublicKey);
         if (!publicKey) {
@@ -278,9 +264,9 @@ namespace ortc
 
         AutoSeededRandomPool rnd;
 
-        DH &dh = mKeyDomain->getDH();
+        SimpleKeyAgreementDomain &domain = mKeyDomain->getKeyAgreementDomain();
 
-        DH2 dh2(dh);
+        DH2 dh2(domain);
 
         SecureByteBlockPtr key(make_shared<SecureByteBlock>(dh2.AgreedValueLength()));
 
@@ -345,6 +331,41 @@ namespace ortc
         return resultEl;
       }
 
+      //-----------------------------------------------------------------------
+      void DHPrivateKey::obtainKeyPair(
+                                       IDHKeyDomainPtr keyDomain,
+                                       SecureByteBlock &outPrivateKey,
+                                       SecureByteBlock &outPublicKey
+                                       )
+      {
+        KeyGenerationPoolPtr pool = KeyGenerationPool::singleton();
+        if (pool) {
+          if (pool->takeDHKeyPair(keyDomain, outPrivateKey, outPublicKey)) return;
+        }
+
+        generateKeyPairNow(keyDomain, outPrivateKey, outPublicKey);
+      }
+
+      //-----------------------------------------------------------------------
+      void DHPrivateKey::generateKeyPairNow(
+                                            IDHKeyDomainPtr inKeyDomain,
+                                            SecureByteBlock &outPrivateKey,
+                                            SecureByteBlock &outPublicKey
+                                            )
+      {
+        UseDHKeyDomainPtr keyDomain = DHKeyDomain::convert(inKeyDomain);
+        ZS_THROW_INVALID_ARGUMENT_IF(!keyDomain)
+
+        AutoSeededRandomPool rnd;
+
+        SimpleKeyAgreementDomain &domain = keyDomain->getKeyAgreementDomain();
+
+        outPrivateKey.CleanNew(domain.PrivateKeyLength());
+        outPublicKey.CleanNew(domain.PublicKeyLength());
+
+        domain.GenerateKeyPair(rnd, outPrivateKey, outPublicKey);
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
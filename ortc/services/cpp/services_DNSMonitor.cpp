@@ -75,8 +75,11 @@ namespace ortc
       //-----------------------------------------------------------------------
       static String getGenericCookieName(const String &name, int flags, const char *type)
       {
-        String hash = IHelper::convertToHex(*IHasher::hash(name + ":" + string(flags)));
-        return String(ORTC_SERVICES_DNSMONITOR_CACHE_NAMESPACE) + type + "/" + hash;
+        SecureByteBlockPtr digest = IHasher::hash(name + ":" + string(flags));
+
+        std::string hash(digest->SizeInBytes() * 2, '\0');
+        IHelper::convertToHex(digest->BytePtr(), digest->SizeInBytes(), &(hash[0]), hash.size());
+        return String(ORTC_SERVICES_DNSMONITOR_CACHE_NAMESPACE) + type + "/" + String(hash);
       }
 
       //-----------------------------------------------------------------------
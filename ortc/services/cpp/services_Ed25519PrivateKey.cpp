@@ -0,0 +1,311 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_Ed25519PrivateKey.h>
+#include <ortc/services/internal/services_Ed25519PublicKey.h>
+#include <ortc/services/IHelper.h>
+
+#include <zsLib/Log.h>
+#include <zsLib/helpers.h>
+#include <zsLib/XML.h>
+
+#include <cryptopp/osrng.h>
+
+namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      using CryptoPP::AutoSeededRandomPool;
+
+      ZS_DECLARE_TYPEDEF_PTR(IEd25519PrivateKeyForEd25519PublicKey::ForPublicKey, ForPublicKey)
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PrivateKeyForEd25519PublicKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ForPublicKeyPtr IEd25519PrivateKeyForEd25519PublicKey::generate(Ed25519PublicKeyPtr &outPublicKey)
+      {
+        return IEd25519PrivateKeyFactory::singleton().generate(outPublicKey);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PrivateKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKey::Ed25519PrivateKey(const make_private &)
+      {
+        ZS_LOG_DEBUG(log("created"))
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKey::~Ed25519PrivateKey()
+      {
+        if(isNoop()) return;
+
+        ZS_LOG_DEBUG(log("destroyed"))
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr Ed25519PrivateKey::convert(IEd25519PrivateKeyPtr privateKey)
+      {
+        return ZS_DYNAMIC_PTR_CAST(Ed25519PrivateKey, privateKey);
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr Ed25519PrivateKey::convert(ForPublicKeyPtr privateKey)
+      {
+        return ZS_DYNAMIC_PTR_CAST(Ed25519PrivateKey, privateKey);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PrivateKey => IEd25519PrivateKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ElementPtr Ed25519PrivateKey::toDebug(IEd25519PrivateKeyPtr object)
+      {
+        if (!object) return ElementPtr();
+        return convert(object)->toDebug();
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr Ed25519PrivateKey::generate(Ed25519PublicKeyPtr &outPublicKey)
+      {
+        AutoSeededRandomPool rng;
+
+        Ed25519PrivateKeyPtr pThis(make_shared<Ed25519PrivateKey>(make_private{}));
+
+        try {
+          pThis->mSigner = Signer(rng);
+        } catch (CryptoPP::Exception &e) {
+          ZS_LOG_ERROR(Basic, pThis->log("cryptography library threw an exception") + ZS_PARAM("reason", e.what()))
+          return Ed25519PrivateKeyPtr();
+        }
+
+        // the public key is derived while generating the secret so no
+        // further curve operation is needed to hand it back
+        SecureByteBlock publicKeyBuffer(pThis->getPrivateKey().GetPublicKeyBytePtr(), PrivateKey::PUBLIC_KEYLENGTH);
+
+        outPublicKey = Ed25519PublicKey::convert(UsePublicKey::load(publicKeyBuffer));
+        if (!outPublicKey) {
+          ZS_LOG_ERROR(Basic, pThis->log("failed to load the public key for the new private key"))
+          return Ed25519PrivateKeyPtr();
+        }
+
+        ZS_LOG_DEBUG(pThis->log("generated private key") + IEd25519PublicKey::toDebug(outPublicKey))
+
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr Ed25519PrivateKey::load(const SecureByteBlock &buffer)
+      {
+        if (IHelper::isEmpty(buffer)) return Ed25519PrivateKeyPtr();
+
+        Ed25519PrivateKeyPtr pThis(make_shared<Ed25519PrivateKey>(make_private{}));
+
+        ZS_LOG_DEBUG(pThis->log("loading private key"))
+
+        if (PrivateKey::SECRET_KEYLENGTH != buffer.SizeInBytes()) {
+          ZS_LOG_ERROR(Basic, pThis->log("private key is not the expected length") + ZS_PARAM("length", buffer.SizeInBytes()) + ZS_PARAM("expecting", PrivateKey::SECRET_KEYLENGTH))
+          return Ed25519PrivateKeyPtr();
+        }
+
+        try {
+          pThis->mSigner = Signer(buffer.BytePtr());
+        } catch (CryptoPP::Exception &e) {
+          ZS_LOG_ERROR(Basic, pThis->log("cryptography library threw an exception") + ZS_PARAM("reason", e.what()))
+          return Ed25519PrivateKeyPtr();
+        }
+
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr Ed25519PrivateKey::save() const
+      {
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>(getPrivateKey().GetPrivateKeyBytePtr(), PrivateKey::SECRET_KEYLENGTH));
+
+        ZS_LOG_INSANE(log("saving private key") + ZS_PARAM("private key", IHelper::convertToBase64(*output)))
+
+        return output;
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr Ed25519PrivateKey::sign(const SecureByteBlock &inBufferToSign) const
+      {
+        return sign(inBufferToSign, inBufferToSign.size());
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr Ed25519PrivateKey::sign(const String &inStrDataToSign) const
+      {
+        return sign((const BYTE *)(inStrDataToSign.c_str()), inStrDataToSign.length());
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PrivateKey => (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Log::Params Ed25519PrivateKey::log(const char *message) const
+      {
+        ElementPtr objectEl = Element::create("Ed25519PrivateKey");
+        IHelper::debugAppend(objectEl, "id", mID);
+        return Log::Params(message, objectEl);
+      }
+
+      //-----------------------------------------------------------------------
+      Log::Params Ed25519PrivateKey::debug(const char *message) const
+      {
+        return Log::Params(message, toDebug());
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr Ed25519PrivateKey::toDebug() const
+      {
+        ElementPtr resultEl = Element::create("Ed25519PrivateKey");
+
+        SecureByteBlockPtr output = save();
+
+        IHelper::debugAppend(resultEl, "id", mID);
+
+        IHelper::debugAppend(resultEl, "private key", output ? IHelper::convertToHex(*output) : String());
+
+        return resultEl;
+      }
+
+      //-----------------------------------------------------------------------
+      const Ed25519PrivateKey::PrivateKey &Ed25519PrivateKey::getPrivateKey() const
+      {
+        return static_cast<const PrivateKey &>(mSigner.GetPrivateKey());
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr Ed25519PrivateKey::sign(
+                                                 const BYTE *inBuffer,
+                                                 size_t inBufferSizeInBytes
+                                                 ) const
+      {
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>());
+
+        AutoSeededRandomPool rng;   // Ed25519 signatures are deterministic but the interface requires one
+
+        output->CleanNew(mSigner.MaxSignatureLength());
+
+        size_t length = mSigner.SignMessage(rng, inBuffer, inBufferSizeInBytes, *output);
+        output->resize(length);
+
+        return output;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PrivateKeyFactory
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      IEd25519PrivateKeyFactory &IEd25519PrivateKeyFactory::singleton()
+      {
+        return Ed25519PrivateKeyFactory::singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr IEd25519PrivateKeyFactory::generate(Ed25519PublicKeyPtr &outPublicKey)
+      {
+        if (this) {}
+        return Ed25519PrivateKey::generate(outPublicKey);
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PrivateKeyPtr IEd25519PrivateKeyFactory::loadPrivateKey(const SecureByteBlock &buffer)
+      {
+        if (this) {}
+        return Ed25519PrivateKey::load(buffer);
+      }
+
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IEd25519PrivateKey
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr IEd25519PrivateKey::toDebug(IEd25519PrivateKeyPtr object)
+    {
+      return internal::Ed25519PrivateKey::toDebug(object);
+    }
+
+    //-------------------------------------------------------------------------
+    IEd25519PrivateKeyPtr IEd25519PrivateKey::generate(IEd25519PublicKeyPtr &outPublicKey)
+    {
+      internal::Ed25519PublicKeyPtr publicKey;
+      IEd25519PrivateKeyPtr result = internal::IEd25519PrivateKeyFactory::singleton().generate(publicKey);
+      outPublicKey = publicKey;
+      return result;
+    }
+
+    //-------------------------------------------------------------------------
+    IEd25519PrivateKeyPtr IEd25519PrivateKey::load(const SecureByteBlock &buffer)
+    {
+      return internal::IEd25519PrivateKeyFactory::singleton().loadPrivateKey(buffer);
+    }
+  }
+}
@@ -0,0 +1,342 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_Ed25519PublicKey.h>
+#include <ortc/services/internal/services_Ed25519PrivateKey.h>
+#include <ortc/services/IHelper.h>
+
+#include <zsLib/eventing/IHasher.h>
+#include <zsLib/XML.h>
+#include <zsLib/Log.h>
+#include <zsLib/helpers.h>
+
+#include <cryptopp/osrng.h>
+
+namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      typedef zsLib::XML::Exceptions::CheckFailed CheckFailed;
+
+      using CryptoPP::AutoSeededRandomPool;
+
+      ZS_DECLARE_TYPEDEF_PTR(IEd25519PublicKeyForEd25519PrivateKey::ForPrivateKey, ForPrivateKey)
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PublicKeyForEd25519PrivateKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ForPrivateKeyPtr IEd25519PublicKeyForEd25519PrivateKey::load(const SecureByteBlock &buffer)
+      {
+        return IEd25519PublicKeyFactory::singleton().loadPublicKey(buffer);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PublicKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKey::Ed25519PublicKey(const make_private &)
+      {
+        ZS_LOG_DEBUG(log("created"))
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKey::~Ed25519PublicKey()
+      {
+        if(isNoop()) return;
+
+        ZS_LOG_DEBUG(log("destroyed"))
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKeyPtr Ed25519PublicKey::convert(IEd25519PublicKeyPtr publicKey)
+      {
+        return ZS_DYNAMIC_PTR_CAST(Ed25519PublicKey, publicKey);
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKeyPtr Ed25519PublicKey::convert(ForPrivateKeyPtr publicKey)
+      {
+        return ZS_DYNAMIC_PTR_CAST(Ed25519PublicKey, publicKey);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PublicKey => IEd25519PublicKey
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ElementPtr Ed25519PublicKey::toDebug(IEd25519PublicKeyPtr object)
+      {
+        if (!object) return ElementPtr();
+        return convert(object)->toDebug();
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKeyPtr Ed25519PublicKey::generate(Ed25519PrivateKeyPtr &outPrivatekey)
+      {
+        Ed25519PublicKeyPtr result;
+        outPrivatekey = Ed25519PrivateKey::convert(UsePrivateKey::generate(result));
+        return result;
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKeyPtr Ed25519PublicKey::load(const SecureByteBlock &buffer)
+      {
+        if (IHelper::isEmpty(buffer)) return Ed25519PublicKeyPtr();
+
+        Ed25519PublicKeyPtr pThis(make_shared<Ed25519PublicKey>(make_private{}));
+
+        ZS_LOG_INSANE(pThis->log("loading public key") + ZS_PARAM("public key", IHelper::convertToBase64(buffer)))
+
+        if (CryptoPP::ed25519PublicKey::PUBLIC_KEYLENGTH != buffer.SizeInBytes()) {
+          ZS_LOG_WARNING(Detail, pThis->log("public key is not the expected length") + ZS_PARAM("length", buffer.SizeInBytes()) + ZS_PARAM("expecting", CryptoPP::ed25519PublicKey::PUBLIC_KEYLENGTH))
+          return Ed25519PublicKeyPtr();
+        }
+
+        try
+        {
+          AutoSeededRandomPool rng;
+
+          pThis->mVerifier = Verifier(buffer.BytePtr());
+          if (!pThis->mVerifier.GetPublicKey().Validate(rng, 3)) {
+            ZS_LOG_ERROR(Basic, pThis->log("failed to load an existing public key"))
+            return Ed25519PublicKeyPtr();
+          }
+        } catch (CryptoPP::Exception &e) {
+          ZS_LOG_WARNING(Detail, pThis->log("cryptography library threw an exception") + ZS_PARAM("reason", e.what()))
+          return Ed25519PublicKeyPtr();
+        }
+
+        pThis->mPublicKey.Assign(buffer);
+        pThis->mFingerprint = IHelper::convertToHex(*IHasher::hash(buffer));
+
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr Ed25519PublicKey::save() const
+      {
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>(mPublicKey));
+
+        ZS_LOG_INSANE(log("saving public key") + ZS_PARAM("public key", IHelper::convertToBase64(*output)))
+
+        return output;
+      }
+
+      //-----------------------------------------------------------------------
+      String Ed25519PublicKey::getFingerprint() const
+      {
+        return mFingerprint;
+      }
+
+      //-----------------------------------------------------------------------
+      bool Ed25519PublicKey::verify(
+                                    const SecureByteBlock &inOriginalBufferSigned,
+                                    const SecureByteBlock &inSignature
+                                    ) const
+      {
+        return verify(inOriginalBufferSigned, inOriginalBufferSigned.size(), inSignature);
+      }
+
+      //-----------------------------------------------------------------------
+      bool Ed25519PublicKey::verify(
+                                    const String &inOriginalStringSigned,
+                                    const SecureByteBlock &inSignature
+                                    ) const
+      {
+        return verify((const BYTE *)inOriginalStringSigned.c_str(), inOriginalStringSigned.length(), inSignature);
+      }
+
+      //-----------------------------------------------------------------------
+      bool Ed25519PublicKey::verifySignature(ElementPtr signedEl) const
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!signedEl)
+
+        ElementPtr signatureEl;
+        signedEl = IHelper::getSignatureInfo(signedEl, &signatureEl);
+
+        if (!signedEl) {
+          ZS_LOG_WARNING(Detail, log("signature validation failed because no signed element found"))
+          return false;
+        }
+
+        try {
+          String algorithm = signatureEl->findFirstChildElementChecked("algorithm")->getTextDecoded();
+          if (algorithm != ORTC_SERVICES_JSON_SIGNATURE_ALGORITHM_ED25519) {
+            ZS_LOG_WARNING(Detail, log("signature validation algorithm is not understood") + ZS_PARAM("algorithm", algorithm))
+            return false;
+          }
+
+          String signatureDigestAsString = signatureEl->findFirstChildElementChecked("digestValue")->getTextDecoded();
+
+          SecureByteBlockPtr actualDigest = IHelper::hashCanonicalJSON(signedEl);
+
+          if (0 != IHelper::compare(*actualDigest, *IHelper::convertFromBase64(signatureDigestAsString))) {
+            ZS_LOG_WARNING(Detail, log("digest values did not match") + ZS_PARAM("signature digest", signatureDigestAsString) + ZS_PARAM("actual digest", IHelper::convertToBase64(*actualDigest)))
+            return false;
+          }
+
+          SecureByteBlockPtr signatureDigestSigned = IHelper::convertFromBase64(signatureEl->findFirstChildElementChecked("digestSigned")->getTextDecoded());
+
+          if (!verify(*actualDigest, *signatureDigestSigned)) {
+            ZS_LOG_WARNING(Detail, log("signature failed to validate") + ZS_PARAM("fingerprint", mFingerprint))
+            return false;
+          }
+
+        } catch(CheckFailed &) {
+          ZS_LOG_WARNING(Detail, log("signature missing element"))
+          return false;
+        }
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PublicKey => (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Log::Params Ed25519PublicKey::log(const char *message) const
+      {
+        ElementPtr objectEl = Element::create("Ed25519PublicKey");
+        IHelper::debugAppend(objectEl, "id", mID);
+        return Log::Params(message, objectEl);
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr Ed25519PublicKey::toDebug() const
+      {
+        ElementPtr resultEl = Element::create("Ed25519PublicKey");
+
+        IHelper::debugAppend(resultEl, "id", mID);
+
+        IHelper::debugAppend(resultEl, "fingerprint", mFingerprint);
+        IHelper::debugAppend(resultEl, "public key", IHelper::convertToHex(mPublicKey));
+
+        return resultEl;
+      }
+
+      //-----------------------------------------------------------------------
+      bool Ed25519PublicKey::verify(
+                                    const BYTE *inBuffer,
+                                    size_t inBufferLengthInBytes,
+                                    const SecureByteBlock &inSignature
+                                    ) const
+      {
+        try
+        {
+          bool result = mVerifier.VerifyMessage(inBuffer, inBufferLengthInBytes, inSignature, inSignature.size());
+          if (!result) {
+            ZS_LOG_WARNING(Detail, log("signature verification did not pass"))
+            return false;
+          }
+        } catch (CryptoPP::Exception &e) {
+          ZS_LOG_WARNING(Detail, log("cryptography library threw an exception") + ZS_PARAM("reason", e.what()))
+          return false;
+        }
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PublicKeyFactory
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      IEd25519PublicKeyFactory &IEd25519PublicKeyFactory::singleton()
+      {
+        return Ed25519PublicKeyFactory::singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      Ed25519PublicKeyPtr IEd25519PublicKeyFactory::loadPublicKey(const SecureByteBlock &buffer)
+      {
+        if (this) {}
+        return Ed25519PublicKey::load(buffer);
+      }
+
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IEd25519PublicKey
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    ElementPtr IEd25519PublicKey::toDebug(IEd25519PublicKeyPtr object)
+    {
+      return internal::Ed25519PublicKey::toDebug(object);
+    }
+
+    //-------------------------------------------------------------------------
+    IEd25519PublicKeyPtr IEd25519PublicKey::generate(IEd25519PrivateKeyPtr &outPrivateKey)
+    {
+      internal::Ed25519PrivateKeyPtr privateKey;
+      IEd25519PublicKeyPtr publicKey = internal::Ed25519PublicKey::generate(privateKey);
+      outPrivateKey = privateKey;
+      return publicKey;
+    }
+
+    //-------------------------------------------------------------------------
+    IEd25519PublicKeyPtr IEd25519PublicKey::load(const SecureByteBlock &buffer)
+    {
+      return internal::IEd25519PublicKeyFactory::singleton().loadPublicKey(buffer);
+    }
+
+  }
+}
@@ -0,0 +1,663 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_Encoding.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ORTC_SERVICES_ENCODING_X86
+#endif //defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define ORTC_SERVICES_ENCODING_NEON
+#endif //defined(__aarch64__) || defined(_M_ARM64)
+
+#ifdef ORTC_SERVICES_ENCODING_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif //_MSC_VER
+#endif //ORTC_SERVICES_ENCODING_X86
+
+#ifdef ORTC_SERVICES_ENCODING_NEON
+#include <arm_neon.h>
+#endif //ORTC_SERVICES_ENCODING_NEON
+
+#if defined(ORTC_SERVICES_ENCODING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define ORTC_SERVICES_ENCODING_TARGET(xTarget) __attribute__((target(xTarget)))
+#else
+#define ORTC_SERVICES_ENCODING_TARGET(xTarget)
+#endif
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      static const char gBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      static const char gHexLower[] = "0123456789abcdef";
+      static const char gHexUpper[] = "0123456789ABCDEF";
+
+      static const BYTE gInvalid = 0xFF;
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark (helpers)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      struct DecodeTables
+      {
+        BYTE mBase64[256];
+        BYTE mHex[256];
+
+        DecodeTables()
+        {
+          for (size_t index = 0; index < 256; ++index) {
+            mBase64[index] = gInvalid;
+            mHex[index] = gInvalid;
+          }
+          for (size_t index = 0; index < 64; ++index) {
+            mBase64[static_cast<BYTE>(gBase64Alphabet[index])] = static_cast<BYTE>(index);
+          }
+          for (size_t index = 0; index < 16; ++index) {
+            mHex[static_cast<BYTE>(gHexLower[index])] = static_cast<BYTE>(index);
+            mHex[static_cast<BYTE>(gHexUpper[index])] = static_cast<BYTE>(index);
+          }
+        }
+      };
+
+      //-----------------------------------------------------------------------
+      static const DecodeTables &decodeTables()
+      {
+        static const DecodeTables tables;
+        return tables;
+      }
+
+      //-----------------------------------------------------------------------
+      static size_t stripBase64Padding(
+                                       const char *input,
+                                       size_t length
+                                       )
+      {
+        for (int loop = 0; (loop < 2) && (length > 0) && ('=' == input[length-1]); ++loop) {
+          --length;
+        }
+        return length;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark (scalar kernels)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      static void encodeBase64Scalar(
+                                     const BYTE *input,
+                                     size_t length,
+                                     char *output
+                                     )
+      {
+        for (; length >= 3; input += 3, length -= 3) {
+          *(output++) = gBase64Alphabet[input[0] >> 2];
+          *(output++) = gBase64Alphabet[((input[0] & 0x03) << 4) | (input[1] >> 4)];
+          *(output++) = gBase64Alphabet[((input[1] & 0x0F) << 2) | (input[2] >> 6)];
+          *(output++) = gBase64Alphabet[input[2] & 0x3F];
+        }
+
+        if (length < 1) return;
+
+        *(output++) = gBase64Alphabet[input[0] >> 2];
+        if (1 == length) {
+          *(output++) = gBase64Alphabet[(input[0] & 0x03) << 4];
+          *(output++) = '=';
+        } else {
+          *(output++) = gBase64Alphabet[((input[0] & 0x03) << 4) | (input[1] >> 4)];
+          *(output++) = gBase64Alphabet[(input[1] & 0x0F) << 2];
+        }
+        *(output++) = '=';
+      }
+
+      //-----------------------------------------------------------------------
+      static bool decodeBase64Scalar(
+                                     const char *input,
+                                     size_t length,
+                                     BYTE *output
+                                     )
+      {
+        const BYTE *table = decodeTables().mBase64;
+
+        length = stripBase64Padding(input, length);
+
+        for (; length >= 4; input += 4, length -= 4) {
+          BYTE a = table[static_cast<BYTE>(input[0])];
+          BYTE b = table[static_cast<BYTE>(input[1])];
+          BYTE c = table[static_cast<BYTE>(input[2])];
+          BYTE d = table[static_cast<BYTE>(input[3])];
+          if ((a | b | c | d) & 0xC0) return false;
+
+          *(output++) = static_cast<BYTE>((a << 2) | (b >> 4));
+          *(output++) = static_cast<BYTE>((b << 4) | (c >> 2));
+          *(output++) = static_cast<BYTE>((c << 6) | d);
+        }
+
+        if (length < 2) return (0 == length);
+
+        BYTE a = table[static_cast<BYTE>(input[0])];
+        BYTE b = table[static_cast<BYTE>(input[1])];
+        BYTE c = (length > 2 ? table[static_cast<BYTE>(input[2])] : 0);
+        if ((a | b | c) & 0xC0) return false;
+
+        *(output++) = static_cast<BYTE>((a << 2) | (b >> 4));
+        if (length > 2) *(output++) = static_cast<BYTE>((b << 4) | (c >> 2));
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      static void encodeHexScalar(
+                                  const BYTE *input,
+                                  size_t length,
+                                  char *output,
+                                  bool upperCase
+                                  )
+      {
+        const char *digits = (upperCase ? gHexUpper : gHexLower);
+        for (size_t index = 0; index < length; ++index) {
+          *(output++) = digits[input[index] >> 4];
+          *(output++) = digits[input[index] & 0x0F];
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      static bool decodeHexScalar(
+                                  const char *input,
+                                  size_t length,
+                                  BYTE *output
+                                  )
+      {
+        if (0 != (length % 2)) return false;
+
+        const BYTE *table = decodeTables().mHex;
+        for (; length > 0; input += 2, length -= 2) {
+          BYTE high = table[static_cast<BYTE>(input[0])];
+          BYTE low = table[static_cast<BYTE>(input[1])];
+          if ((high | low) & 0xF0) return false;
+          *(output++) = static_cast<BYTE>((high << 4) | low);
+        }
+        return true;
+      }
+
+#ifdef ORTC_SERVICES_ENCODING_X86
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark (SSSE3 kernels)
+      #pragma mark
+
+      // The base64 kernels follow Wojciech Mula's vectorized base64 encoding
+      // and decoding (http://0x80.pl/articles/index.html#base64-algorithm).
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static __m128i base64SplitSSSE3(__m128i input)
+      {
+        // spread 12 bytes into 16 lanes of 6 bits each
+        input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+        const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        return _mm_or_si128(t1, t3);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static __m128i base64LookupSSSE3(__m128i indices)
+      {
+        __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+        const __m128i shiftLUT = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                               '/' - 63, 'A', 0, 0);
+        result = _mm_shuffle_epi8(shiftLUT, result);
+        return _mm_add_epi8(result, indices);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static void encodeBase64SSSE3(
+                                    const BYTE *input,
+                                    size_t length,
+                                    char *output
+                                    )
+      {
+        // each step reads 16 bytes but only consumes 12
+        for (; length >= 16; input += 12, length -= 12, output += 16) {
+          __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(output), base64LookupSSSE3(base64SplitSSSE3(value)));
+        }
+        encodeBase64Scalar(input, length, output);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static bool base64TranslateSSSE3(
+                                       __m128i input,
+                                       __m128i &outValues
+                                       )
+      {
+        const __m128i higherNibble = _mm_and_si128(_mm_srli_epi32(input, 4), _mm_set1_epi8(0x0f));
+
+        const __m128i lowerBoundLUT = _mm_setr_epi8(1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1);
+        const __m128i upperBoundLUT = _mm_setr_epi8(0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i shiftLUT = _mm_setr_epi8(0, 0, 0x3e - 0x2b, 0x34 - 0x30, 0x00 - 0x41, 0x0f - 0x50, 0x1a - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0);
+
+        const __m128i upperBound = _mm_shuffle_epi8(upperBoundLUT, higherNibble);
+        const __m128i lowerBound = _mm_shuffle_epi8(lowerBoundLUT, higherNibble);
+
+        const __m128i below = _mm_cmplt_epi8(input, lowerBound);
+        const __m128i above = _mm_cmpgt_epi8(input, upperBound);
+        const __m128i isSlash = _mm_cmpeq_epi8(input, _mm_set1_epi8(0x2f));
+
+        // '/' shares its nibble range with '+' and is fixed up separately
+        const __m128i outside = _mm_andnot_si128(isSlash, _mm_or_si128(below, above));
+        if (0 != _mm_movemask_epi8(outside)) return false;
+
+        const __m128i shift = _mm_shuffle_epi8(shiftLUT, higherNibble);
+        outValues = _mm_add_epi8(_mm_add_epi8(input, shift), _mm_and_si128(isSlash, _mm_set1_epi8(-3)));
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static __m128i base64PackSSSE3(__m128i values)
+      {
+        // join 16 lanes of 6 bits each into 12 bytes
+        const __m128i mergeABandBC = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        const __m128i merged = _mm_madd_epi16(mergeABandBC, _mm_set1_epi32(0x00011000));
+        return _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static bool decodeBase64SSSE3(
+                                    const char *input,
+                                    size_t length,
+                                    BYTE *output
+                                    )
+      {
+        // each step writes 16 bytes but only produces 12, keeping at least 8
+        // characters (at least 4 bytes of output) behind keeps the extra
+        // writes within the output and any padding out of the vector steps
+        for (; length >= 24; input += 16, length -= 16, output += 12) {
+          __m128i values;
+          if (!base64TranslateSSSE3(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input)), values)) return false;
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(output), base64PackSSSE3(values));
+        }
+        return decodeBase64Scalar(input, length, output);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("ssse3")
+      static void encodeHexSSSE3(
+                                 const BYTE *input,
+                                 size_t length,
+                                 char *output,
+                                 bool upperCase
+                                 )
+      {
+        const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(upperCase ? gHexUpper : gHexLower));
+        const __m128i mask = _mm_set1_epi8(0x0f);
+
+        for (; length >= 16; input += 16, length -= 16, output += 32) {
+          __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+          __m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(value, 4), mask));
+          __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(value, mask));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm_unpacklo_epi8(high, low));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 16), _mm_unpackhi_epi8(high, low));
+        }
+        encodeHexScalar(input, length, output, upperCase);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark (AVX2 kernels)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("avx2")
+      static void encodeBase64AVX2(
+                                   const BYTE *input,
+                                   size_t length,
+                                   char *output
+                                   )
+      {
+        const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        const __m256i shiftLUT = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                  '/' - 63, 'A', 0, 0,
+                                                  'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                                  '/' - 63, 'A', 0, 0);
+
+        // each step reads 12 bytes into each 16 byte lane (28 bytes read in
+        // total) but only consumes 24
+        for (; length >= 28; input += 24, length -= 24, output += 32) {
+          __m256i value = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input))),
+                                                  _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 12)),
+                                                  1);
+          value = _mm256_shuffle_epi8(value, shuffle);
+
+          const __m256i t0 = _mm256_and_si256(value, _mm256_set1_epi32(0x0fc0fc00));
+          const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+          const __m256i t2 = _mm256_and_si256(value, _mm256_set1_epi32(0x003f03f0));
+          const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+          const __m256i indices = _mm256_or_si256(t1, t3);
+
+          __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+          const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+          result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+          result = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLUT, result), indices);
+
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(output), result);
+        }
+        encodeBase64SSSE3(input, length, output);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("avx2")
+      static bool decodeBase64AVX2(
+                                   const char *input,
+                                   size_t length,
+                                   BYTE *output
+                                   )
+      {
+        const __m256i lowerBoundLUT = _mm256_broadcastsi128_si256(_mm_setr_epi8(1, 1, 0x2b, 0x30, 0x41, 0x50, 0x61, 0x70, 1, 1, 1, 1, 1, 1, 1, 1));
+        const __m256i upperBoundLUT = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 0, 0x2b, 0x39, 0x4f, 0x5a, 0x6f, 0x7a, 0, 0, 0, 0, 0, 0, 0, 0));
+        const __m256i shiftLUT = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 0, 0x3e - 0x2b, 0x34 - 0x30, 0x00 - 0x41, 0x0f - 0x50, 0x1a - 0x61, 0x29 - 0x70, 0, 0, 0, 0, 0, 0, 0, 0));
+        const __m256i pack = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+        // each step writes 32 bytes but only produces 24, keeping at least 16
+        // characters (at least 10 bytes of output) behind keeps the extra
+        // writes within the output and any padding out of the vector steps
+        for (; length >= 48; input += 32, length -= 32, output += 24) {
+          const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input));
+          const __m256i higherNibble = _mm256_and_si256(_mm256_srli_epi32(value, 4), _mm256_set1_epi8(0x0f));
+
+          const __m256i upperBound = _mm256_shuffle_epi8(upperBoundLUT, higherNibble);
+          const __m256i lowerBound = _mm256_shuffle_epi8(lowerBoundLUT, higherNibble);
+
+          const __m256i below = _mm256_cmpgt_epi8(lowerBound, value);
+          const __m256i above = _mm256_cmpgt_epi8(value, upperBound);
+          const __m256i isSlash = _mm256_cmpeq_epi8(value, _mm256_set1_epi8(0x2f));
+
+          const __m256i outside = _mm256_andnot_si256(isSlash, _mm256_or_si256(below, above));
+          if (0 != _mm256_movemask_epi8(outside)) return false;
+
+          const __m256i shift = _mm256_shuffle_epi8(shiftLUT, higherNibble);
+          const __m256i values = _mm256_add_epi8(_mm256_add_epi8(value, shift), _mm256_and_si256(isSlash, _mm256_set1_epi8(-3)));
+
+          const __m256i mergeABandBC = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+          __m256i merged = _mm256_madd_epi16(mergeABandBC, _mm256_set1_epi32(0x00011000));
+          merged = _mm256_shuffle_epi8(merged, pack);
+
+          // move the 12 bytes of each lane next to each other
+          merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(output), merged);
+        }
+        return decodeBase64SSSE3(input, length, output);
+      }
+
+      //-----------------------------------------------------------------------
+      ORTC_SERVICES_ENCODING_TARGET("avx2")
+      static void encodeHexAVX2(
+                                const BYTE *input,
+                                size_t length,
+                                char *output,
+                                bool upperCase
+                                )
+      {
+        const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(upperCase ? gHexUpper : gHexLower)));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+
+        for (; length >= 32; input += 32, length -= 32, output += 64) {
+          __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input));
+          __m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(value, 4), mask));
+          __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(value, mask));
+
+          // unpacking works within each 16 byte lane so the lanes are
+          // swapped back into order afterwards
+          __m256i first = _mm256_unpacklo_epi8(high, low);
+          __m256i second = _mm256_unpackhi_epi8(high, low);
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(output), _mm256_permute2x128_si256(first, second, 0x20));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+        encodeHexSSSE3(input, length, output, upperCase);
+      }
+
+      //-----------------------------------------------------------------------
+      static bool supportsSSSE3()
+      {
+#ifdef _MSC_VER
+        int info[4] {};
+        __cpuid(info, 1);
+        return 0 != (info[2] & (1 << 9));
+#else
+        return 0 != __builtin_cpu_supports("ssse3");
+#endif //_MSC_VER
+      }
+
+      //-----------------------------------------------------------------------
+      static bool supportsAVX2()
+      {
+#ifdef _MSC_VER
+        int info[4] {};
+        __cpuid(info, 1);
+        bool osSavesYMM = (0 != (info[2] & (1 << 27))) && (0x6 == (_xgetbv(0) & 0x6));
+        if (!osSavesYMM) return false;
+        __cpuidex(info, 7, 0);
+        return 0 != (info[1] & (1 << 5));
+#else
+        return 0 != __builtin_cpu_supports("avx2");
+#endif //_MSC_VER
+      }
+
+#endif //ORTC_SERVICES_ENCODING_X86
+
+#ifdef ORTC_SERVICES_ENCODING_NEON
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark (NEON kernels)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      static void encodeBase64NEON(
+                                   const BYTE *input,
+                                   size_t length,
+                                   char *output
+                                   )
+      {
+        const BYTE *alphabet = reinterpret_cast<const BYTE *>(gBase64Alphabet);
+
+        uint8x16x4_t lookup;
+        lookup.val[0] = vld1q_u8(alphabet);
+        lookup.val[1] = vld1q_u8(alphabet + 16);
+        lookup.val[2] = vld1q_u8(alphabet + 32);
+        lookup.val[3] = vld1q_u8(alphabet + 48);
+
+        const uint8x16_t mask = vdupq_n_u8(0x3F);
+
+        for (; length >= 48; input += 48, length -= 48, output += 64) {
+          // de-interleaves every first, second and third byte
+          uint8x16x3_t value = vld3q_u8(input);
+
+          uint8x16x4_t indices;
+          indices.val[0] = vshrq_n_u8(value.val[0], 2);
+          indices.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(value.val[1], 4), vshlq_n_u8(value.val[0], 4)), mask);
+          indices.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(value.val[2], 6), vshlq_n_u8(value.val[1], 2)), mask);
+          indices.val[3] = vandq_u8(value.val[2], mask);
+
+          uint8x16x4_t result;
+          result.val[0] = vqtbl4q_u8(lookup, indices.val[0]);
+          result.val[1] = vqtbl4q_u8(lookup, indices.val[1]);
+          result.val[2] = vqtbl4q_u8(lookup, indices.val[2]);
+          result.val[3] = vqtbl4q_u8(lookup, indices.val[3]);
+
+          vst4q_u8(reinterpret_cast<BYTE *>(output), result);
+        }
+        encodeBase64Scalar(input, length, output);
+      }
+
+      //-----------------------------------------------------------------------
+      static void encodeHexNEON(
+                                const BYTE *input,
+                                size_t length,
+                                char *output,
+                                bool upperCase
+                                )
+      {
+        const uint8x16_t digits = vld1q_u8(reinterpret_cast<const BYTE *>(upperCase ? gHexUpper : gHexLower));
+        const uint8x16_t mask = vdupq_n_u8(0x0F);
+
+        for (; length >= 16; input += 16, length -= 16, output += 32) {
+          uint8x16_t value = vld1q_u8(input);
+
+          uint8x16x2_t result;
+          result.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(value, 4));
+          result.val[1] = vqtbl1q_u8(digits, vandq_u8(value, mask));
+
+          // interleaves the high and low digits
+          vst2q_u8(reinterpret_cast<BYTE *>(output), result);
+        }
+        encodeHexScalar(input, length, output, upperCase);
+      }
+
+#endif //ORTC_SERVICES_ENCODING_NEON
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Encoding
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      const Encoding::Kernels &Encoding::scalar()
+      {
+        static const Kernels kernels = {"scalar", encodeBase64Scalar, decodeBase64Scalar, encodeHexScalar, decodeHexScalar};
+        return kernels;
+      }
+
+      //-----------------------------------------------------------------------
+      const Encoding::Kernels &Encoding::best()
+      {
+        class Once
+        {
+        public:
+          Once() : mKernels(scalar())
+          {
+            decodeTables();
+
+#ifdef ORTC_SERVICES_ENCODING_X86
+            if (supportsAVX2()) {
+              Kernels kernels = {"avx2", encodeBase64AVX2, decodeBase64AVX2, encodeHexAVX2, decodeHexScalar};
+              mKernels = kernels;
+              return;
+            }
+            if (supportsSSSE3()) {
+              Kernels kernels = {"ssse3", encodeBase64SSSE3, decodeBase64SSSE3, encodeHexSSSE3, decodeHexScalar};
+              mKernels = kernels;
+              return;
+            }
+#endif //ORTC_SERVICES_ENCODING_X86
+
+#ifdef ORTC_SERVICES_ENCODING_NEON
+            Kernels kernels = {"neon", encodeBase64NEON, decodeBase64Scalar, encodeHexNEON, decodeHexScalar};
+            mKernels = kernels;
+#endif //ORTC_SERVICES_ENCODING_NEON
+          }
+
+          Kernels mKernels;
+        };
+
+        static const Once once;
+        return once.mKernels;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t Encoding::base64EncodedLength(size_t length)
+      {
+        return ((length + 2) / 3) * 4;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t Encoding::base64DecodedLength(
+                                           const char *input,
+                                           size_t length
+                                           )
+      {
+        if ((!input) || (length < 1)) return 0;
+
+        size_t unpadded = stripBase64Padding(input, length);
+        size_t remainder = unpadded % 4;
+
+        if (1 == remainder) return 0;
+
+        if (unpadded != length) {
+          // padding must complete the final group of four
+          if (0 != (length % 4)) return 0;
+        }
+
+        return ((unpadded / 4) * 3) + (remainder > 0 ? remainder - 1 : 0);
+      }
+    }
+  }
+}
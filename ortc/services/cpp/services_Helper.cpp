@@ -30,6 +30,7 @@
  */
 
 #include <ortc/services/internal/services_Helper.h>
+#include <ortc/services/internal/services_Encoding.h>
 #include <ortc/services/internal/services_HTTP.h>
 #include <ortc/services/internal/services.events.h>
 #include <ortc/services/IDNS.h>
@@ -48,7 +49,9 @@
 #include <zsLib/ITimer.h>
 #include <zsLib/IHelper.h>
 
-#include <regex>
+#include <algorithm>
+#include <deque>
+#include <list>
 #include <iostream>
 #include <fstream>
 #ifndef _WIN32
@@ -72,6 +75,9 @@
 
 #define ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO (6)
 
+#define ORTC_SERVICES_HELPER_JSON_ATTRIBUTE_PREFIX '$'
+#define ORTC_SERVICES_HELPER_JSON_FORCED_TEXT "#text"
+
 namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
 
 namespace ortc
@@ -105,6 +111,9 @@ namespace ortc
       void installLoggerSettingsDefaults();
       void installMessageLayerSecurityChannelSettingsDefaults();
       void installBackOffTimerSettingsDefaults();
+      void installRUDPChannelStreamSettingsDefaults();
+      void installRSAPublicKeySettingsDefaults();
+      void installKeyGenerationPoolSettingsDefaults();
 
 
       //-----------------------------------------------------------------------
@@ -163,6 +172,7 @@ namespace ortc
 #ifndef WINRT
           ISettings::setString(ORTC_SERVICES_SETTING_HELPER_HTTP_THREAD_PRIORITY, "normal");
 #endif //ndef WINRT
+          ISettings::setUInt(ORTC_SERVICES_SETTING_HELPER_IDN_CACHE_SIZE, 256);
         }
       };
 
@@ -180,6 +190,65 @@ namespace ortc
 
       class IDNHelper
       {
+      public:
+        //---------------------------------------------------------------------
+        // Least recently used cache of IDN conversions. DNS and HTTP
+        // lookups convert the same handful of names over and over.
+        class Cache
+        {
+        public:
+          typedef std::pair<String, String> Entry;
+          typedef std::list<Entry> EntryList;
+          typedef std::map<String, EntryList::iterator> EntryMap;
+
+        public:
+          //-------------------------------------------------------------------
+          bool find(
+                    const String &key,
+                    String &outValue
+                    )
+          {
+            AutoLock lock(mLock);
+
+            auto found = mEntries.find(key);
+            if (found == mEntries.end()) return false;
+
+            mOrder.splice(mOrder.begin(), mOrder, (*found).second);
+            outValue = (*(*found).second).second;
+            return true;
+          }
+
+          //-------------------------------------------------------------------
+          void insert(
+                      const String &key,
+                      const String &value
+                      )
+          {
+            size_t capacity = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_HELPER_IDN_CACHE_SIZE));
+
+            AutoLock lock(mLock);
+
+            auto found = mEntries.find(key);
+            if (found != mEntries.end()) {
+              (*(*found).second).second = value;
+              mOrder.splice(mOrder.begin(), mOrder, (*found).second);
+            } else if (capacity > 0) {
+              mOrder.push_front(Entry(key, value));
+              mEntries[key] = mOrder.begin();
+            }
+
+            while (mOrder.size() > capacity) {
+              mEntries.erase(mOrder.back().first);
+              mOrder.pop_back();
+            }
+          }
+
+        protected:
+          Lock mLock;
+          EntryList mOrder;   // most recently used first
+          EntryMap mEntries;
+        };
+
       public:
         //---------------------------------------------------------------------
         static IDNHelper &singleton()
@@ -204,8 +273,68 @@ namespace ortc
         {
           return Log::Params(message, "services::IDNHelper");
         }
+
+        //---------------------------------------------------------------------
+        Cache &toIDN() {return mToIDN;}
+        Cache &toUTF8() {return mToUTF8;}
+
+      protected:
+        Cache mToIDN;
+        Cache mToUTF8;
       };
 
+      //-----------------------------------------------------------------------
+      static bool isLowerAlpha(char value) {return (value >= 'a') && (value <= 'z');}
+      static bool isLowerAlphaNumeric(char value) {return isLowerAlpha(value) || ((value >= '0') && (value <= '9'));}
+
+      //-----------------------------------------------------------------------
+      // Same rules as the regular expression
+      // "((?=[a-z0-9-]{1,63}\\.)(xn--)?[a-z0-9]+(-[a-z0-9]+)*\\.)+[a-z]{2,63}$"
+      // i.e. one or more labels of up to 63 characters (an optional "xn--"
+      // prefix followed by alphanumerics separated by single dashes) then a
+      // top level domain of 2 to 63 letters.
+      static bool isValidDomainLabel(
+                                     const char *label,
+                                     size_t length
+                                     )
+      {
+        if ((length < 1) || (length > 63)) return false;
+
+        if ((length > 4) &&
+            ('x' == label[0]) &&
+            ('n' == label[1]) &&
+            ('-' == label[2]) &&
+            ('-' == label[3])) {
+          label += 4;
+          length -= 4;
+        }
+
+        if (!isLowerAlphaNumeric(label[0])) return false;
+        if (!isLowerAlphaNumeric(label[length-1])) return false;
+
+        for (size_t index = 1; index < length - 1; ++index) {
+          char value = label[index];
+          if (isLowerAlphaNumeric(value)) continue;
+          if ('-' != value) return false;
+          if ('-' == label[index+1]) return false;
+        }
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      static bool isValidTopLevelDomain(
+                                        const char *label,
+                                        size_t length
+                                        )
+      {
+        if ((length < 2) || (length > 63)) return false;
+
+        for (size_t index = 0; index < length; ++index) {
+          if (!isLowerAlpha(label[index])) return false;
+        }
+        return true;
+      }
+
 
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -234,6 +363,9 @@ namespace ortc
           installHelperSettingsDefaults();
           installMessageLayerSecurityChannelSettingsDefaults();
           installBackOffTimerSettingsDefaults();
+          installRUDPChannelStreamSettingsDefaults();
+          installRSAPublicKeySettingsDefaults();
+          installKeyGenerationPoolSettingsDefaults();
         }
 
         ~ServicesSetup()
@@ -242,6 +374,175 @@ namespace ortc
         }
       };
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark CanonicalJSONHasher
+      #pragma mark
+
+      // Hashes the JSON the JSON generator would write for
+      // "cloneAsCanonicalJSON(el)". Attributes and child elements are visited
+      // in canonical order (sorted by name, equal names keep their order) on
+      // the original tree and each JSON token is fed to the hash as it would
+      // have been written.
+      class CanonicalJSONHasher
+      {
+      public:
+        typedef std::vector<ElementPtr> ElementVector;
+        typedef std::vector<AttributePtr> AttributeVector;
+        typedef std::vector<TextPtr> TextVector;
+
+        struct Level
+        {
+          ElementVector mElements;
+          AttributeVector mAttributes;
+          TextVector mTexts;
+        };
+
+        typedef std::deque<Level> LevelDeque;   // references stay valid as deeper levels are added
+
+      public:
+        CanonicalJSONHasher(CryptoPP::HashTransformation &hasher) : mHasher(hasher) {}
+
+        //---------------------------------------------------------------------
+        void hashRoot(ElementPtr el)
+        {
+          write('{');
+          writeName(el->getValue());
+          hashValue(el, 0);
+          write('}');
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        void write(char value) {mHasher.Update((const BYTE *)(&value), sizeof(value));}
+        void write(const String &value) {if (value.hasData()) mHasher.Update((const BYTE *)(value.c_str()), value.length());}
+
+        //---------------------------------------------------------------------
+        void writeName(const String &name)
+        {
+          write('\"');
+          write(name);
+          write('\"');
+          write(':');
+        }
+
+        //---------------------------------------------------------------------
+        void writeText(const TextVector &texts)
+        {
+          if ((1 == texts.size()) &&
+              (Text::Format_JSONNumberEncoded == texts.front()->getFormat())) {
+            write(texts.front()->getValue());
+            return;
+          }
+
+          write('\"');
+          for (auto iter = texts.begin(); iter != texts.end(); ++iter) {
+            write((*iter)->getValueInFormat(Text::Format_JSONStringEncoded));
+          }
+          write('\"');
+        }
+
+        //---------------------------------------------------------------------
+        void hashValue(ElementPtr el, size_t depth)
+        {
+          if (mLevels.size() <= depth) mLevels.resize(depth + 1);
+
+          Level &level = mLevels[depth];
+          level.mElements.clear();
+          level.mAttributes.clear();
+          level.mTexts.clear();
+
+          for (AttributePtr attribute = el->getFirstAttribute(); attribute; attribute = attribute->getNextAttribute()) {
+            level.mAttributes.push_back(attribute);
+          }
+
+          for (NodePtr child = el->getFirstChild(); child; child = child->getNextSibling()) {
+            if (child->isElement()) {
+              level.mElements.push_back(child->toElement());
+              continue;
+            }
+            if (child->isText()) {
+              level.mTexts.push_back(child->toText());
+            }
+          }
+
+          if ((level.mAttributes.size() < 1) &&
+              (level.mElements.size() < 1)) {
+            if (level.mTexts.size() > 0) {
+              writeText(level.mTexts);
+            } else {
+              write('\"');
+              write('\"');
+            }
+            return;
+          }
+
+          std::stable_sort(level.mAttributes.begin(), level.mAttributes.end(), [](const AttributePtr &first, const AttributePtr &second) -> bool {return first->getName() < second->getName();});
+          std::stable_sort(level.mElements.begin(), level.mElements.end(), [](const ElementPtr &first, const ElementPtr &second) -> bool {return first->getValue() < second->getValue();});
+
+          bool first = true;
+
+          write('{');
+
+          for (auto iter = level.mAttributes.begin(); iter != level.mAttributes.end(); ++iter) {
+            if (!first) write(',');
+            first = false;
+
+            write('\"');
+            write(ORTC_SERVICES_HELPER_JSON_ATTRIBUTE_PREFIX);
+            write((*iter)->getName());
+            write('\"');
+            write(':');
+            write('\"');
+            write(zsLib::XML::Parser::convertToJSONEncoding((*iter)->getValueDecoded()));
+            write('\"');
+          }
+
+          if (level.mTexts.size() > 0) {
+            if (!first) write(',');
+            first = false;
+
+            writeName(ORTC_SERVICES_HELPER_JSON_FORCED_TEXT);
+            writeText(level.mTexts);
+          }
+
+          // children with the same name are adjacent once sorted and are written as an array
+          for (size_t index = 0; index < level.mElements.size(); ) {
+            const String &name = level.mElements[index]->getValue();
+
+            size_t end = index + 1;
+            while ((end < level.mElements.size()) &&
+                   (level.mElements[end]->getValue() == name)) {
+              ++end;
+            }
+
+            if (!first) write(',');
+            first = false;
+
+            writeName(name);
+
+            bool isArray = (end - index > 1);
+            if (isArray) write('[');
+            for (size_t pos = index; pos < end; ++pos) {
+              if (pos != index) write(',');
+              hashValue(level.mElements[pos], depth + 1);
+            }
+            if (isArray) write(']');
+
+            index = end;
+          }
+
+          write('}');
+        }
+
+      protected:
+        CryptoPP::HashTransformation &mHasher;
+        LevelDeque mLevels;
+      };
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -256,6 +557,92 @@ namespace ortc
         return Log::Params(message, "services::Helper");
       }
 
+      //-----------------------------------------------------------------------
+      String Helper::encodeIDN(const String &utf8Str)
+      {
+        IDNHelper::singleton();
+
+        if (utf8Str.isEmpty()) return String();
+
+        size_t length = utf8Str.length();
+
+        char outputBuffer[1024] {};
+        std::unique_ptr<char[]> overflowBuffer;
+
+        char *destStr = &(outputBuffer[0]);
+        size_t destLength = (sizeof(outputBuffer) / sizeof(char)) - 1;
+
+        if (length * ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO > destLength) {
+          overflowBuffer = std::unique_ptr<char[]>(new char[(length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO)+1] {});
+          destStr = overflowBuffer.get();
+          destLength = (length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO);
+        }
+
+        idn_result_t status = idn_encodename(IDN_ENCODE_LOOKUP & (~IDN_UNICODECONV), utf8Str.c_str(), destStr, destLength);
+
+        if (idn_success != status) {
+          ZS_LOG_ERROR(Detail, slog("utf 8 to idn convert failed") + ZS_PARAM("input utf8", utf8Str) + ZS_PARAM("status", status))
+          return String();
+        }
+
+        String result((const char *)destStr);
+        return result;
+      }
+
+      //-----------------------------------------------------------------------
+      String Helper::decodeIDN(const String &idnStr)
+      {
+        IDNHelper::singleton();
+
+        if (idnStr.isEmpty()) return String();
+
+        size_t length = idnStr.length();
+
+        char outputBuffer[1024] {};
+        std::unique_ptr<char[]> overflowBuffer;
+
+        char *destStr = &(outputBuffer[0]);
+        size_t destLength = (sizeof(outputBuffer) / sizeof(char)) - 1;
+
+        if (length * ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO > destLength) {
+          overflowBuffer = std::unique_ptr<char[]>(new char[(length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO)+1] {});
+          destStr = overflowBuffer.get();
+          destLength = (length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO);
+        }
+
+        idn_result_t status = idn_decodename(IDN_DECODE_LOOKUP & (~IDN_UNICODECONV), idnStr.c_str(), destStr, destLength);
+
+        if (idn_success != status) {
+          ZS_LOG_ERROR(Detail, slog("idn to utf8 convert failed") + ZS_PARAM("input idn", idnStr) + ZS_PARAM("status", status))
+          return String();
+        }
+
+        return String((const char *)destStr);
+      }
+
+      //-----------------------------------------------------------------------
+      bool Helper::isValidIDNDomain(
+                                    const char *domain,
+                                    size_t length
+                                    )
+      {
+        if (!domain) return false;
+
+        const char *end = domain + length;
+        const char *label = domain;
+        size_t totalLabels = 0;
+
+        for (const char *pos = domain; pos != end; ++pos) {
+          if ('.' != *pos) continue;
+          if (!isValidDomainLabel(label, pos - label)) return false;
+          ++totalLabels;
+          label = pos + 1;
+        }
+
+        if (totalLabels < 1) return false;
+        return isValidTopLevelDomain(label, end - label);
+      }
+
     } // namespace internal
 
     //-------------------------------------------------------------------------
@@ -459,6 +846,19 @@ namespace ortc
       return buffer;
     }
 
+    //-----------------------------------------------------------------------
+    SecureByteBlockPtr IHelper::hashCanonicalJSON(ElementPtr el)
+    {
+      ZS_THROW_INVALID_ARGUMENT_IF(!el)
+
+      CryptoPP::SHA1 hasher;
+      internal::CanonicalJSONHasher(hasher).hashRoot(el);
+
+      SecureByteBlockPtr result(make_shared<SecureByteBlock>(hasher.DigestSize()));
+      hasher.Final(result->BytePtr());
+      return result;
+    }
+
     //-----------------------------------------------------------------------
     ElementPtr IHelper::getSignatureInfo(
                                         ElementPtr signedEl,
@@ -555,63 +955,30 @@ namespace ortc
     //-----------------------------------------------------------------------
     String IHelper::convertIDNToUTF8(const String &idnStr)
     {
-      internal::IDNHelper::singleton();
+      internal::IDNHelper &helper = internal::IDNHelper::singleton();
 
       if (idnStr.isEmpty()) return String();
 
-      size_t length = idnStr.length();
-
-      char outputBuffer[1024] {};
-      std::unique_ptr<char[]> overflowBuffer;
-
-      char *destStr = &(outputBuffer[0]);
-      size_t destLength = (sizeof(outputBuffer) / sizeof(char)) - 1;
-
-      if (length * ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO > destLength) {
-        overflowBuffer = std::unique_ptr<char[]>(new char[(length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO)+1] {});
-        destStr = overflowBuffer.get();
-        destLength = (length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO);
-      }
-
-      idn_result_t status = idn_decodename(IDN_DECODE_LOOKUP & (~IDN_UNICODECONV), idnStr.c_str(), destStr, destLength);
-
-      if (idn_success != status) {
-        ZS_LOG_ERROR(Detail, internal::Helper::slog("idn to utf8 convert failed") + ZS_PARAM("input idn", idnStr) + ZS_PARAM("status", status))
-        return String();
-      }
+      String result;
+      if (helper.toUTF8().find(idnStr, result)) return result;
 
-      return String((const char *)destStr);
+      result = internal::Helper::decodeIDN(idnStr);
+      if (result.hasData()) helper.toUTF8().insert(idnStr, result);
+      return result;
     }
 
     //-----------------------------------------------------------------------
     String IHelper::convertUTF8ToIDN(const String &utf8Str)
     {
-      internal::IDNHelper::singleton();
+      internal::IDNHelper &helper = internal::IDNHelper::singleton();
 
       if (utf8Str.isEmpty()) return String();
 
-      size_t length = utf8Str.length();
-
-      char outputBuffer[1024] {};
-      std::unique_ptr<char[]> overflowBuffer;
-
-      char *destStr = &(outputBuffer[0]);
-      size_t destLength = (sizeof(outputBuffer) / sizeof(char)) - 1;
-
-      if (length * ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO > destLength) {
-        overflowBuffer = std::unique_ptr<char[]>(new char[(length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO)+1] {});
-        destStr = overflowBuffer.get();
-        destLength = (length*ORTC_SERVICES_HELPER_UNICODE_CHAR_TO_PUNY_CODE_CHARACTOR_RATIO);
-      }
-
-      idn_result_t status = idn_encodename(IDN_ENCODE_LOOKUP & (~IDN_UNICODECONV), utf8Str.c_str(), destStr, destLength);
-
-      if (idn_success != status) {
-        ZS_LOG_ERROR(Detail, internal::Helper::slog("utf 8 to idn convert failed") + ZS_PARAM("input utf8", utf8Str) + ZS_PARAM("status", status))
-        return String();
-      }
+      String result;
+      if (helper.toIDN().find(utf8Str, result)) return result;
 
-      String result((const char *)destStr);
+      result = internal::Helper::encodeIDN(utf8Str);
+      if (result.hasData()) helper.toIDN().insert(utf8Str, result);
       return result;
     }
 
@@ -630,9 +997,7 @@ namespace ortc
       }
 
       String domain(inDomain ? convertUTF8ToIDN(inDomain) : String());
-//        std::regex exp("^([a-zA-Z0-9]([a-zA-Z0-9\\-]{0,61}[a-zA-Z0-9])?\\.)+[a-zA-Z]{2,6}$");
-      std::regex exp("((?=[a-z0-9-]{1,63}\\.)(xn--)?[a-z0-9]+(-[a-z0-9]+)*\\.)+[a-z]{2,63}$");
-      if (! std::regex_match(domain, exp)) {
+      if (!internal::Helper::isValidIDNDomain(domain.c_str(), domain.length())) {
         ZS_LOG_WARNING(Detail, internal::Helper::slog("domain name is not valid") + ZS_PARAM("domain", domain))
         return false;
       }
@@ -640,5 +1005,97 @@ namespace ortc
       return true;
     }
 
+    //-----------------------------------------------------------------------
+    size_t IHelper::getBase64EncodedLength(size_t bufferLengthInBytes)
+    {
+      return internal::Encoding::base64EncodedLength(bufferLengthInBytes);
+    }
+
+    //-----------------------------------------------------------------------
+    size_t IHelper::getBase64DecodedLength(
+                                           const char *encoded,
+                                           size_t encodedLength
+                                           )
+    {
+      return internal::Encoding::base64DecodedLength(encoded, encodedLength);
+    }
+
+    //-----------------------------------------------------------------------
+    size_t IHelper::convertToBase64(
+                                    const BYTE *buffer,
+                                    size_t bufferLengthInBytes,
+                                    char *outEncoded,
+                                    size_t outEncodedLength
+                                    )
+    {
+      size_t length = internal::Encoding::base64EncodedLength(bufferLengthInBytes);
+      if ((length < 1) || (!buffer) || (!outEncoded) || (outEncodedLength < length)) return 0;
+
+      internal::Encoding::best().mEncodeBase64(buffer, bufferLengthInBytes, outEncoded);
+      return length;
+    }
+
+    //-----------------------------------------------------------------------
+    bool IHelper::convertFromBase64(
+                                    const char *encoded,
+                                    size_t encodedLength,
+                                    BYTE *outBuffer,
+                                    size_t outBufferLengthInBytes,
+                                    size_t &outDecodedLengthInBytes
+                                    )
+    {
+      outDecodedLengthInBytes = 0;
+
+      if ((!encoded) || (encodedLength < 1)) return true;
+
+      size_t length = internal::Encoding::base64DecodedLength(encoded, encodedLength);
+      if (length < 1) return false;
+      if ((!outBuffer) || (outBufferLengthInBytes < length)) return false;
+
+      if (!internal::Encoding::best().mDecodeBase64(encoded, encodedLength, outBuffer)) return false;
+
+      outDecodedLengthInBytes = length;
+      return true;
+    }
+
+    //-----------------------------------------------------------------------
+    size_t IHelper::convertToHex(
+                                 const BYTE *buffer,
+                                 size_t bufferLengthInBytes,
+                                 char *outEncoded,
+                                 size_t outEncodedLength,
+                                 bool outputUpperCase
+                                 )
+    {
+      size_t length = bufferLengthInBytes * 2;
+      if ((length < 1) || (!buffer) || (!outEncoded) || (outEncodedLength < length)) return 0;
+
+      internal::Encoding::best().mEncodeHex(buffer, bufferLengthInBytes, outEncoded, outputUpperCase);
+      return length;
+    }
+
+    //-----------------------------------------------------------------------
+    bool IHelper::convertFromHex(
+                                 const char *encoded,
+                                 size_t encodedLength,
+                                 BYTE *outBuffer,
+                                 size_t outBufferLengthInBytes,
+                                 size_t &outDecodedLengthInBytes
+                                 )
+    {
+      outDecodedLengthInBytes = 0;
+
+      if ((!encoded) || (encodedLength < 1)) return true;
+      if (0 != (encodedLength % 2)) return false;
+
+      size_t length = encodedLength / 2;
+      if ((!outBuffer) || (outBufferLengthInBytes < length)) return false;
+
+      if (!internal::Encoding::best().mDecodeHex(encoded, encodedLength, outBuffer)) return false;
+
+      outDecodedLengthInBytes = length;
+      return true;
+    }
+
   }
 }
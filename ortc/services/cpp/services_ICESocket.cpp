@@ -36,6 +36,7 @@
 #include <ortc/services/internal/services_wire.h>
 
 #include <ortc/services/ISTUNRequesterManager.h>
+#include <ortc/services/PacketBuffer.h>
 #include <ortc/services/IHTTP.h>
 
 #include <ortc/services/IHTTP.h>
@@ -76,6 +77,8 @@ using namespace Windows::Networking::Connectivity;
 
 #define ORTC_SERVICES_ICESOCKET_BUFFER_SIZE  (1 << (sizeof(WORD)*8))
 
+#define ORTC_SERVICES_ICESOCKET_WIRE_DUMP_STACK_BUFFER_SIZE (1500)
+
 #define ORTC_SERVICES_ICESOCKET_MINIMUM_TURN_KEEP_ALIVE_TIME_IN_SECONDS  ORTC_SERVICES_IICESOCKET_DEFAULT_HOW_LONG_CANDIDATES_MUST_REMAIN_VALID_IN_SECONDS
 
 #define ORTC_SERVICES_TURN_DEFAULT_RETRY_AFTER_DURATION_IN_MILLISECONDS (500)
@@ -86,6 +89,8 @@ using namespace Windows::Networking::Connectivity;
 
 #define ORTC_SERVICES_ICESOCKET_LOCAL_PREFERENCE_MAX (0xFFFF)
 
+#define ORTC_SERVICES_ICESOCKET_MIN_KEEP_ALIVE_BUCKET_IN_MILLISECONDS (10)
+
 
 namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services_ice) } }
 
@@ -143,6 +148,38 @@ namespace ortc
         return (candidate.mRelatedIP.isEmpty() ? candidate.mIPAddress : candidate.mRelatedIP);
       }
 
+      //-----------------------------------------------------------------------
+      // base64 of a packet logged on the wire, encoded on the stack for any
+      // packet fitting an MTU and on the heap for larger packets
+      class WireDump
+      {
+      public:
+        WireDump(
+                 const BYTE *buffer,
+                 size_t bufferLengthInBytes
+                 )
+        {
+          size_t length = IHelper::getBase64EncodedLength(bufferLengthInBytes);
+
+          char *output = &(mStackBuffer[0]);
+          if (length >= sizeof(mStackBuffer)) {
+            mHeapBuffer.resize(length + 1);
+            output = &(mHeapBuffer[0]);
+          }
+
+          length = IHelper::convertToBase64(buffer, bufferLengthInBytes, output, length);
+          output[length] = '\0';
+          mEncoded = output;
+        }
+
+        const char *c_str() const {return mEncoded;}
+
+      private:
+        char mStackBuffer[(((ORTC_SERVICES_ICESOCKET_WIRE_DUMP_STACK_BUFFER_SIZE + 2) / 3) * 4) + 1];
+        std::vector<char> mHeapBuffer;
+        const char *mEncoded {};
+      };
+
       
       //-------------------------------------------------------------------------
       //-------------------------------------------------------------------------
@@ -186,6 +223,9 @@ namespace ortc
           ISettings::setString(ORTC_SERVICES_SETTING_ICE_SOCKET_ONLY_ALLOW_DATA_SENT_TO_SPECIFIC_IPS, "");
           ISettings::setString(ORTC_SERVICES_SETTING_ICE_SOCKET_INTERFACE_NAME_ORDER, "lo;en;pdp_ip;stf;gif;bbptp;p2p");
           ISettings::setUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_TURN_CANDIDATES_MUST_REMAIN_ALIVE_AFTER_ICE_WAKE_UP_IN_SECONDS, 60 * 5);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_BUCKET_IN_MILLISECONDS, 250);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_SPREAD_IN_MILLISECONDS, 2000);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_MAX_PER_BUCKET, 250);
         }
       };
 
@@ -239,7 +279,11 @@ namespace ortc
         mForceUseTURN(ISettings::getBool(ORTC_SERVICES_SETTING_ICE_SOCKET_FORCE_USE_TURN)),
         mSupportIPv6(ISettings::getBool(ORTC_SERVICES_SETTING_ICE_SOCKET_INTERFACE_SUPPORT_IPV6)),
 
-        mMaxRebindAttemptDuration(Seconds(ISettings::getUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_MAX_REBIND_ATTEMPT_DURATION_IN_SECONDS)))
+        mMaxRebindAttemptDuration(Seconds(ISettings::getUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_MAX_REBIND_ATTEMPT_DURATION_IN_SECONDS))),
+
+        mKeepAliveBucketDuration(Milliseconds(ISettings::getUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_BUCKET_IN_MILLISECONDS))),
+        mKeepAliveSpreadDuration(Milliseconds(ISettings::getUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_SPREAD_IN_MILLISECONDS))),
+        mKeepAliveMaxPerBucket(ISettings::getUInt(ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_MAX_PER_BUCKET))
       {
         ZS_LOG_BASIC(log("created"))
 
@@ -261,6 +305,10 @@ namespace ortc
           mComponentID = 1;
         }
 
+        if (mKeepAliveBucketDuration < Milliseconds(ORTC_SERVICES_ICESOCKET_MIN_KEEP_ALIVE_BUCKET_IN_MILLISECONDS)) {
+          mKeepAliveBucketDuration = Milliseconds(ORTC_SERVICES_ICESOCKET_MIN_KEEP_ALIVE_BUCKET_IN_MILLISECONDS);
+        }
+
         // calculate the empty list CRC value
         CRC32 crc;
         crc.Final((BYTE *)(&mLastCandidateCRC));
@@ -510,6 +558,13 @@ namespace ortc
 
         // remember the session for later
         mSessions[session->getID()] = session;
+
+        String remoteUsernameFrag = session->getRemoteUsernameFrag();
+        if (remoteUsernameFrag.hasData()) {
+          if (mSessionsByUsername.end() == mSessionsByUsername.find(remoteUsernameFrag)) {
+            mSessionsByUsername[remoteUsernameFrag] = session;
+          }
+        }
         return true;
       }
       
@@ -522,75 +577,19 @@ namespace ortc
                              bool isUserData
                              )
       {
-        if (isShutdown()) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet via ICE socket as it is already shutdown") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) << ZS_PARAM("user data", isUserData))
-          return false;
-        }
-
-        SocketPtr socket;
-        ITURNSocketPtr turnSocket;
-
-        // get socket or turn socket value
-        {
-          AutoRecursiveLock lock(*this);
-
-          LocalSocketIPAddressMap::iterator found = mSocketLocalIPs.find(getViaLocalIP(viaLocalCandidate));
-          if (found == mSocketLocalIPs.end()) {
-            ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("did not find local IP to use"))
-            return false;
-          }
-
-          LocalSocketPtr &localSocket = (*found).second;
-          if (viaLocalCandidate.mType == Type_Relayed) {
-            TURNInfoRelatedIPMap::iterator foundRelated = localSocket->mTURNRelayIPs.find(viaLocalCandidate.mIPAddress);
-            if (foundRelated != localSocket->mTURNRelayIPs.end()) {
-              turnSocket = (*foundRelated).second->mTURNSocket;
-            }
-          } else {
-            socket = localSocket->mSocket;
-          }
-        }
-
-        if (viaLocalCandidate.mType == Type_Relayed) {
-          if (!turnSocket) {
-            ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet via TURN socket as it is not connected") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData))
-            return false;
-          }
-
-          mTURNLastUsed = zsLib::now();
-          return turnSocket->sendPacket(destination, buffer, bufferLengthInBytes, isUserData);
-        }
-
-        if (!socket) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as UDP socket is not set") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData))
-          return false;
-        }
-
-        // attempt to send the packet over the UDP buffer
-        try {
-          bool wouldBlock = false;
-
-          if (mForceUseTURN) {
-            ZS_LOG_WARNING(Trace, log("preventing data packet from going to destination due to TURN restriction") + ZS_PARAM("destination", destination.string()))
-            return true;     // simulates forcing via TURN by refusing to send out any packets over local UDP (does not block STUN discovery)
-          }
-
-          if (!Helper::containsIP(mRestrictedIPs, destination)) {
-            ZS_LOG_WARNING(Trace, log("preventing data packet from going to destination as destination is not in restricted IP list") + ZS_PARAM("destination", destination.string()))
-            return true;
-          }
+        return sendToHelper(viaLocalCandidate, destination, buffer, bufferLengthInBytes, isUserData, PacketBufferPtr());
+      }
 
-          size_t bytesSent = socket->sendTo(destination, buffer, bufferLengthInBytes, &wouldBlock);
-          ORTC_SERVICES_WIRE_LOG_TRACE(log("sending packet") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData) + ZS_PARAM("bytes sent", bytesSent) + ZS_PARAM("would block", wouldBlock))
-          if (ZS_IS_LOGGING(Insane)) {
-            String base64 = IHelper::convertToBase64(buffer, bytesSent);
-            ORTC_SERVICES_WIRE_LOG_INSANE(log("SEND PACKET ON WIRE") + ZS_PARAM("destination", destination.string()) + ZS_PARAM("wire out", base64))
-          }
-          return ((!wouldBlock) && (bufferLengthInBytes == bytesSent));
-        } catch(Socket::Exceptions::Unspecified &error) {
-          ZS_LOG_ERROR(Detail, log("sendTo error") + ZS_PARAM("error", error.errorCode()))
-        }
-        return false;
+      //-----------------------------------------------------------------------
+      bool ICESocket::sendTo(
+                             const Candidate &viaLocalCandidate,
+                             const IPAddress &destination,
+                             PacketBufferPtr packet,
+                             bool isUserData
+                             )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!packet)
+        return sendToHelper(viaLocalCandidate, destination, packet->data(), packet->size(), isUserData, packet);
       }
 
       //-----------------------------------------------------------------------
@@ -619,6 +618,51 @@ namespace ortc
         }
       }
 
+      //-----------------------------------------------------------------------
+      void ICESocket::monitorKeepAlive(ICESocketSessionPtr inSession)
+      {
+        UseICESocketSessionPtr session = inSession;
+
+        ZS_THROW_INVALID_ARGUMENT_IF(!session)
+
+        AutoRecursiveLock lock(*this);
+
+        if ((isShuttingDown()) ||
+            (isShutdown())) {
+          ZS_LOG_WARNING(Detail, log("cannot monitor keep alives after socket is being shutdown"))
+          return;
+        }
+
+        PUID sessionID = session->getID();
+        if (mKeepAliveSchedule.end() != mKeepAliveSchedule.find(sessionID)) {
+          ZS_LOG_TRACE(log("already monitoring keep alives for session") + ZS_PARAM("session id", sessionID))
+          return;
+        }
+
+        // phase each session to a fixed offset within the spread window so
+        // sessions nominated at the same moment do not all fire at once
+        Milliseconds offset;
+        if (Milliseconds() != mKeepAliveSpreadDuration) {
+          offset = Milliseconds((static_cast<QWORD>(sessionID) * 2654435761ULL) % static_cast<QWORD>(mKeepAliveSpreadDuration.count()));
+        }
+
+        ZS_LOG_DEBUG(log("monitoring keep alives for session") + ZS_PARAM("session id", sessionID) + ZS_PARAM("offset (ms)", offset))
+
+        scheduleKeepAlive(session, zsLib::now() + offset);
+        stepKeepAliveTimer();
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocket::cancelKeepAlive(PUID sessionID)
+      {
+        AutoRecursiveLock lock(*this);
+
+        ZS_LOG_DEBUG(log("cancel monitoring keep alives for session") + ZS_PARAM("session id", sessionID))
+
+        unscheduleKeepAlive(sessionID);
+        stepKeepAliveTimer();
+      }
+
       //-----------------------------------------------------------------------
       void ICESocket::onICESocketSessionClosed(PUID sessionID)
       {
@@ -631,8 +675,20 @@ namespace ortc
           return;
         }
 
-        removeRoute(ICESocketSession::convert((*found).second));
+        UseICESocketSessionPtr session = (*found).second;
+
+        removeRoute(ICESocketSession::convert(session));
         mSessions.erase(found);
+
+        unscheduleKeepAlive(sessionID);
+        stepKeepAliveTimer();
+
+        ICESocketSessionUsernameMap::iterator foundUsername = mSessionsByUsername.find(session->getRemoteUsernameFrag());
+        if (foundUsername != mSessionsByUsername.end()) {
+          if ((*foundUsername).second == session) {
+            mSessionsByUsername.erase(foundUsername);
+          }
+        }
         
         step();
       }
@@ -694,9 +750,9 @@ namespace ortc
 
             ORTC_SERVICES_WIRE_LOG_TRACE(log("packet received") + ZS_PARAM("ip", + source.string()) + ZS_PARAM("handle", socket->getSocket()))
 
-            if (ZS_IS_LOGGING(Insane)) {
-              String base64 = Helper::convertToBase64(buffer.get(), bytesRead);
-              ORTC_SERVICES_WIRE_LOG_INSANE(log("RECEIVE PACKET ON WIRE") + ZS_PARAM("source", source.string()) + ZS_PARAM("wire in", base64))
+            if (ORTC_SERVICES_WIRE_IS_LOGGING(Insane)) {
+              WireDump base64(buffer.get(), bytesRead);
+              ORTC_SERVICES_WIRE_LOG_INSANE(log("RECEIVE PACKET ON WIRE") + ZS_PARAM("source", source.string()) + ZS_PARAM("wire in", base64.c_str()))
             }
 
           } catch(Socket::Exceptions::Unspecified &error) {
@@ -1008,6 +1064,18 @@ namespace ortc
       {
         ZS_LOG_DEBUG(log("on timer") + ZS_PARAM("timer ID", timer->getID()))
 
+        bool isKeepAlive = false;
+
+        {
+          AutoRecursiveLock lock(*this);
+          isKeepAlive = ((mKeepAliveTimer) && (timer == mKeepAliveTimer));
+        }
+
+        if (isKeepAlive) {
+          serviceKeepAlives();
+          return;
+        }
+
         AutoRecursiveLock lock(*this);
 
         if (timer == mRebindTimer) {
@@ -1125,6 +1193,13 @@ namespace ortc
 
         IHelper::debugAppend(resultEl, "routes", mRoutes.size());
 
+        IHelper::debugAppend(resultEl, "keep alive timer", (bool)mKeepAliveTimer);
+        IHelper::debugAppend(resultEl, "keep alive bucket (ms)", mKeepAliveBucketDuration);
+        IHelper::debugAppend(resultEl, "keep alive spread (ms)", mKeepAliveSpreadDuration);
+        IHelper::debugAppend(resultEl, "keep alive max per bucket", mKeepAliveMaxPerBucket);
+        IHelper::debugAppend(resultEl, "keep alive buckets", mKeepAliveBuckets.size());
+        IHelper::debugAppend(resultEl, "keep alive sessions", mKeepAliveSchedule.size());
+
         IHelper::debugAppend(resultEl, "notified candidates changed", mNotifiedCandidateChanged);
         IHelper::debugAppend(resultEl, "candidate crc", mLastCandidateCRC);
 
@@ -1154,6 +1229,10 @@ namespace ortc
 
         clearRebindTimer();
 
+        mKeepAliveBuckets.clear();
+        mKeepAliveSchedule.clear();
+        stepKeepAliveTimer();
+
         for (LocalSocketMap::iterator iter_DoNotUse = mSockets.begin(); iter_DoNotUse != mSockets.end(); )
         {
           LocalSocketMap::iterator current = iter_DoNotUse; ++iter_DoNotUse;
@@ -1202,6 +1281,7 @@ namespace ortc
         if (mSessions.size() > 0) {
           ICESocketSessionMap temp = mSessions;
           mSessions.clear();
+          mSessionsByUsername.clear();
 
           // close down all the ICE sessions immediately
           for(ICESocketSessionMap::iterator iter = temp.begin(); iter != temp.end(); ++iter) {
@@ -1255,6 +1335,90 @@ namespace ortc
         ZS_LOG_WARNING(Detail, debug("error set") + ZS_PARAM("code", mLastError) + ZS_PARAM("reason", mLastErrorReason))
       }
 
+      //-----------------------------------------------------------------------
+      bool ICESocket::sendToHelper(
+                                   const Candidate &viaLocalCandidate,
+                                   const IPAddress &destination,
+                                   const BYTE *buffer,
+                                   size_t bufferLengthInBytes,
+                                   bool isUserData,
+                                   PacketBufferPtr framingPacket
+                                   )
+      {
+        if (isShutdown()) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet via ICE socket as it is already shutdown") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) << ZS_PARAM("user data", isUserData))
+          return false;
+        }
+
+        SocketPtr socket;
+        ITURNSocketPtr turnSocket;
+
+        // get socket or turn socket value
+        {
+          AutoRecursiveLock lock(*this);
+
+          LocalSocketIPAddressMap::iterator found = mSocketLocalIPs.find(getViaLocalIP(viaLocalCandidate));
+          if (found == mSocketLocalIPs.end()) {
+            ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("did not find local IP to use"))
+            return false;
+          }
+
+          LocalSocketPtr &localSocket = (*found).second;
+          if (viaLocalCandidate.mType == Type_Relayed) {
+            TURNInfoRelatedIPMap::iterator foundRelated = localSocket->mTURNRelayIPs.find(viaLocalCandidate.mIPAddress);
+            if (foundRelated != localSocket->mTURNRelayIPs.end()) {
+              turnSocket = (*foundRelated).second->mTURNSocket;
+            }
+          } else {
+            socket = localSocket->mSocket;
+          }
+        }
+
+        if (viaLocalCandidate.mType == Type_Relayed) {
+          if (!turnSocket) {
+            ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet via TURN socket as it is not connected") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData))
+            return false;
+          }
+
+          mTURNLastUsed = zsLib::now();
+          if (framingPacket) {
+            return turnSocket->sendPacket(destination, framingPacket, isUserData);
+          }
+          return turnSocket->sendPacket(destination, buffer, bufferLengthInBytes, isUserData);
+        }
+
+        if (!socket) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as UDP socket is not set") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData))
+          return false;
+        }
+
+        // attempt to send the packet over the UDP buffer
+        try {
+          bool wouldBlock = false;
+
+          if (mForceUseTURN) {
+            ZS_LOG_WARNING(Trace, log("preventing data packet from going to destination due to TURN restriction") + ZS_PARAM("destination", destination.string()))
+            return true;     // simulates forcing via TURN by refusing to send out any packets over local UDP (does not block STUN discovery)
+          }
+
+          if (!Helper::containsIP(mRestrictedIPs, destination)) {
+            ZS_LOG_WARNING(Trace, log("preventing data packet from going to destination as destination is not in restricted IP list") + ZS_PARAM("destination", destination.string()))
+            return true;
+          }
+
+          size_t bytesSent = socket->sendTo(destination, buffer, bufferLengthInBytes, &wouldBlock);
+          ORTC_SERVICES_WIRE_LOG_TRACE(log("sending packet") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData) + ZS_PARAM("bytes sent", bytesSent) + ZS_PARAM("would block", wouldBlock))
+          if (ORTC_SERVICES_WIRE_IS_LOGGING(Insane)) {
+            WireDump base64(buffer, bytesSent);
+            ORTC_SERVICES_WIRE_LOG_INSANE(log("SEND PACKET ON WIRE") + ZS_PARAM("destination", destination.string()) + ZS_PARAM("wire out", base64.c_str()))
+          }
+          return ((!wouldBlock) && (bufferLengthInBytes == bytesSent));
+        } catch(Socket::Exceptions::Unspecified &error) {
+          ZS_LOG_ERROR(Detail, log("sendTo error") + ZS_PARAM("error", error.errorCode()))
+        }
+        return false;
+      }
+
       //-----------------------------------------------------------------------
       void ICESocket::step()
       {
@@ -2602,6 +2766,138 @@ namespace ortc
         mSocketSTUNs.erase(found);
       }
 
+      //-----------------------------------------------------------------------
+      ICESocket::KeepAliveBucket ICESocket::toKeepAliveBucket(Time when) const
+      {
+        // round up to the next bucket boundary so a session is never serviced early
+        auto since = zsLib::toMilliseconds(when.time_since_epoch()).count();
+        auto bucket = mKeepAliveBucketDuration.count();
+        auto rounded = ((since + bucket - 1) / bucket) * bucket;
+        return Time() + Milliseconds(rounded);
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocket::scheduleKeepAlive(
+                                        UseICESocketSessionPtr session,
+                                        Time when
+                                        )
+      {
+        PUID sessionID = session->getID();
+
+        unscheduleKeepAlive(sessionID);
+
+        KeepAliveBucket bucket = toKeepAliveBucket(when);
+        mKeepAliveBuckets[bucket][sessionID] = session;
+        mKeepAliveSchedule[sessionID] = bucket;
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocket::unscheduleKeepAlive(PUID sessionID)
+      {
+        KeepAliveScheduleMap::iterator found = mKeepAliveSchedule.find(sessionID);
+        if (found == mKeepAliveSchedule.end()) return;
+
+        KeepAliveBucketMap::iterator foundBucket = mKeepAliveBuckets.find((*found).second);
+        if (foundBucket != mKeepAliveBuckets.end()) {
+          ICESocketSessionMap &sessions = (*foundBucket).second;
+          sessions.erase(sessionID);
+          if (sessions.size() < 1) {
+            mKeepAliveBuckets.erase(foundBucket);
+          }
+        }
+
+        mKeepAliveSchedule.erase(found);
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocket::stepKeepAliveTimer()
+      {
+        if (mKeepAliveBuckets.size() > 0) {
+          if (mKeepAliveTimer) return;
+
+          ZS_LOG_DEBUG(log("starting shared keep alive timer") + ZS_PARAM("bucket (ms)", mKeepAliveBucketDuration))
+          mKeepAliveTimer = ITimer::create(mThisWeak.lock(), mKeepAliveBucketDuration);
+          return;
+        }
+
+        if (!mKeepAliveTimer) return;
+
+        ZS_LOG_DEBUG(log("stopping shared keep alive timer"))
+        mKeepAliveTimer->cancel();
+        mKeepAliveTimer.reset();
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocket::serviceKeepAlives()
+      {
+        // WARNING: DO NOT CALL THIS METHOD WHILE INSIDE A LOCK AS IT COULD
+        //          ** DEADLOCK **. Sessions send through the socket while
+        //          holding their own lock.
+        Time tick = zsLib::now();
+
+        ICESocketSessionMap due;
+
+        // scope: pull every session from the expired buckets
+        {
+          AutoRecursiveLock lock(*this);
+          if ((isShuttingDown()) ||
+              (isShutdown())) return;
+
+          KeepAliveBucket overflowBucket = toKeepAliveBucket(tick + mKeepAliveBucketDuration);
+
+          while (mKeepAliveBuckets.size() > 0) {
+            KeepAliveBucketMap::iterator first = mKeepAliveBuckets.begin();
+            if ((*first).first > tick) break;
+
+            ICESocketSessionMap sessions;
+            sessions.swap((*first).second);
+            mKeepAliveBuckets.erase(first);
+
+            for (ICESocketSessionMap::iterator iter = sessions.begin(); iter != sessions.end(); ++iter) {
+              PUID sessionID = (*iter).first;
+
+              if ((0 != mKeepAliveMaxPerBucket) &&
+                  (due.size() >= mKeepAliveMaxPerBucket)) {
+                // too many sessions came due at once, slide the rest to the
+                // next bucket rather than bursting them all out together
+                mKeepAliveBuckets[overflowBucket][sessionID] = (*iter).second;
+                mKeepAliveSchedule[sessionID] = overflowBucket;
+                continue;
+              }
+
+              due[sessionID] = (*iter).second;
+              mKeepAliveSchedule.erase(sessionID);
+            }
+          }
+        }
+
+        if (due.size() > 0) {
+          ZS_LOG_TRACE(log("servicing keep alives") + ZS_PARAM("total", due.size()))
+        }
+
+        for (ICESocketSessionMap::iterator iter = due.begin(); iter != due.end(); ++iter) {
+          PUID sessionID = (*iter).first;
+          UseICESocketSessionPtr &session = (*iter).second;
+
+          Time next = session->notifyKeepAliveDue(tick);
+          if (Time() == next) continue;
+
+          if (next < tick + mKeepAliveBucketDuration) next = tick + mKeepAliveBucketDuration;
+
+          AutoRecursiveLock lock(*this);
+          if ((isShuttingDown()) ||
+              (isShutdown())) break;
+
+          if (mSessions.end() == mSessions.find(sessionID)) continue;                   // session closed while outside the lock
+          if (mKeepAliveSchedule.end() != mKeepAliveSchedule.find(sessionID)) continue; // session was rescheduled while outside the lock
+
+          scheduleKeepAlive(session, next);
+        }
+
+        AutoRecursiveLock lock(*this);
+        stepKeepAliveTimer();
+      }
+
       //-----------------------------------------------------------------------
       void ICESocket::internalReceivedData(
                                            const Candidate &viaCandidate,
@@ -2675,6 +2971,21 @@ namespace ortc
           String localUsernameFrag = stun->mUsername.substr(0, pos); // this would be our local username
           String remoteUsernameFrag = stun->mUsername.substr(pos+1);  // this would be the remote username
 
+          // scope: try the session registered for the remote username first
+          {
+            UseICESocketSessionPtr direct;
+            {
+              AutoRecursiveLock lock(*this);
+              ICESocketSessionUsernameMap::iterator found = mSessionsByUsername.find(remoteUsernameFrag);
+              if (found != mSessionsByUsername.end()) {
+                direct = (*found).second;
+              }
+            }
+            if (direct) {
+              if (direct->handleSTUNPacket(viaCandidate, source, stun, localUsernameFrag, remoteUsernameFrag)) return;
+            }
+          }
+
           while (true)
           {
             // scope: find the next socket session to test in the list while in a lock
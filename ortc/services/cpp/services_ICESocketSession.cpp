@@ -40,6 +40,7 @@
 
 #include <ortc/services/IICESocket.h>
 #include <ortc/services/ISTUNRequester.h>
+#include <ortc/services/PacketBuffer.h>
 
 #include <zsLib/ISettings.h>
 #include <zsLib/Exception.h>
@@ -49,12 +50,16 @@
 
 #include <cryptopp/osrng.h>
 
+#include <algorithm>
+#include <set>
+
 #define ORTC_SERVICES_ICESOCKETSESSION_MAX_WAIT_TIME_FOR_CANDIDATE_TO_ACTIVATE_IF_ALL_DONE (60)
 #define ORTC_SERVICES_ICESOCKETSESSION_DEFAULT_KEEPALIVE_INDICATION_TIME_IN_SECONDS (15)
 
 #define ORTC_SERVICES_ICESOCKETSESSION_MAX_REASONABLE_CANDIDATE_PAIR_SEARCHES (100)
 
 #define ORTC_SERVICES_ICESOCKETSESSION_ACTIVATE_TIMER_IN_MS (20)
+#define ORTC_SERVICES_ICESOCKETSESSION_MIN_CHECK_PACING_IN_MS (5)
 #define ORTC_SERVICES_ICESOCKETSESSION_STEP_TIMER_IN_SECONDS (2)
 
 #define ORTC_SERVICES_ICESOCKETSESSION_BACKGROUNDING_TIMER_SECONDS (10)
@@ -100,19 +105,33 @@ namespace ortc
       }
 
       //-----------------------------------------------------------------------
-      static bool comparePairControlling(const ICESocketSession::CandidatePairPtr pair1, const ICESocketSession::CandidatePairPtr pair2) {
-        QWORD priorityPair1 = calculatePriority(pair1->mLocal, pair1->mRemote);
-        QWORD priorityPair2 = calculatePriority(pair2->mLocal, pair2->mRemote);
+      static QWORD calculatePriority(const ICESocketSession::CandidatePairPtr &pair, IICESocket::ICEControls control) {
+        if (IICESocket::ICEControl_Controlling == control)
+          return calculatePriority(pair->mLocal, pair->mRemote);
+        return calculatePriority(pair->mRemote, pair->mLocal);
+      }
 
-        return priorityPair1 > priorityPair2; // pair1 comes before pair2 if pair1 priority is greater
+      //-----------------------------------------------------------------------
+      static bool comparePairPriority(const ICESocketSession::CandidatePairPtr &pair1, const ICESocketSession::CandidatePairPtr &pair2) {
+        return pair1->mPriority > pair2->mPriority; // pair1 comes before pair2 if pair1 priority is greater
       }
 
       //-----------------------------------------------------------------------
-      static bool comparePairControlled(const ICESocketSession::CandidatePairPtr pair1, const ICESocketSession::CandidatePairPtr pair2) {
-        QWORD priorityPair1 = calculatePriority(pair1->mRemote, pair1->mLocal);
-        QWORD priorityPair2 = calculatePriority(pair2->mRemote, pair2->mLocal);
+      static bool isSameCandidate(const IICESocket::Candidate &candidate1, const IICESocket::Candidate &candidate2)
+      {
+        if (candidate1.mType != candidate2.mType) return false;
+        if (candidate1.mPriority != candidate2.mPriority) return false;
+        if (candidate1.mIPAddress != candidate2.mIPAddress) return false;
+        if (candidate1.mFoundation != candidate2.mFoundation) return false;
+        if (candidate1.mComponentID != candidate2.mComponentID) return false;
 
-        return priorityPair1 > priorityPair2; // pair1 comes before pair2 if pair1 priority is greater
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      static String getPairFoundation(const IICESocket::Candidate &local, const IICESocket::Candidate &remote)
+      {
+        return local.mFoundation + ":" + remote.mFoundation;
       }
 
       //-----------------------------------------------------------------------
@@ -189,6 +208,8 @@ namespace ortc
         virtual void notifySettingsApplyDefaults() override
         {
           ISettings::setUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_BACKGROUNDING_PHASE, 4);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_CHECK_PACING_IN_MILLISECONDS, ORTC_SERVICES_ICESOCKETSESSION_ACTIVATE_TIMER_IN_MS);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_MAX_CHECKS_IN_FLIGHT, 0);
         }
       };
 
@@ -214,6 +235,19 @@ namespace ortc
       #pragma mark ICESocketSession::CandidatePair
       #pragma mark
 
+      //-----------------------------------------------------------------------
+      const char *ICESocketSession::CandidatePair::toString(CheckStates state)
+      {
+        switch (state) {
+          case CheckState_Frozen:     return "Frozen";
+          case CheckState_Waiting:    return "Waiting";
+          case CheckState_InProgress: return "In progress";
+          case CheckState_Succeeded:  return "Succeeded";
+          case CheckState_Failed:     return "Failed";
+        }
+        return "UNDEFINED";
+      }
+
       //-----------------------------------------------------------------------
       ICESocketSession::CandidatePairPtr ICESocketSession::CandidatePair::create()
       {
@@ -221,9 +255,21 @@ namespace ortc
         pThis->mReceivedRequest = false;
         pThis->mReceivedResponse = false;
         pThis->mFailed = false;
+        pThis->mUnfrozen = false;
+        pThis->mPriority = 0;
         return pThis;
       }
 
+      //-----------------------------------------------------------------------
+      ICESocketSession::CandidatePair::CheckStates ICESocketSession::CandidatePair::getCheckState() const
+      {
+        if (mFailed) return CheckState_Failed;
+        if (mReceivedResponse) return CheckState_Succeeded;
+        if (mRequester) return CheckState_InProgress;
+        if (mUnfrozen) return CheckState_Waiting;
+        return CheckState_Frozen;
+      }
+
       //-----------------------------------------------------------------------
       ElementPtr ICESocketSession::CandidatePair::toDebug() const
       {
@@ -232,6 +278,9 @@ namespace ortc
         IHelper::debugAppend(resultEl, "id", mID);
         IHelper::debugAppend(resultEl, "local candidate", mLocal.toDebug());
         IHelper::debugAppend(resultEl, "remote candidate", mRemote.toDebug());
+        IHelper::debugAppend(resultEl, "priority", mPriority);
+        IHelper::debugAppend(resultEl, "pair foundation", mPairFoundation);
+        IHelper::debugAppend(resultEl, "check state", toString(getCheckState()));
         IHelper::debugAppend(resultEl, "received request", mReceivedRequest);
         IHelper::debugAppend(resultEl, "received response", mReceivedResponse);
         IHelper::debugAppend(resultEl, "failed", mFailed);
@@ -286,6 +335,13 @@ namespace ortc
       {
         AutoRecursiveLock lock(*this);
 
+        if (mLite) {
+          // an ICE-lite session is driven entirely by the checks it answers
+          // (the socket closes its sessions directly upon shutdown)
+          step();
+          return;
+        }
+
         mSocketSubscription = getSocket()->subscribe(mThisWeak.lock());
 
         mBackgroundingSubscription = IBackgrounding::subscribe(
@@ -293,6 +349,13 @@ namespace ortc
                                                                ISettings::getUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_BACKGROUNDING_PHASE)
                                                                );
 
+        mCheckPacing = Milliseconds(ISettings::getUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_CHECK_PACING_IN_MILLISECONDS));
+        if (mCheckPacing < Milliseconds(ORTC_SERVICES_ICESOCKETSESSION_MIN_CHECK_PACING_IN_MS)) {
+          // RFC 8445 section 14.2 - Ta must not be less than 5ms
+          mCheckPacing = Milliseconds(ORTC_SERVICES_ICESOCKETSESSION_MIN_CHECK_PACING_IN_MS);
+        }
+        mMaxChecksInFlight = ISettings::getUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_MAX_CHECKS_IN_FLIGHT);
+
         step();
       }
 
@@ -362,6 +425,29 @@ namespace ortc
         return pThis;
       }
 
+      //-----------------------------------------------------------------------
+      ICESocketSessionPtr ICESocketSession::createLite(
+                                                       IICESocketSessionDelegatePtr delegate,
+                                                       IICESocketPtr inSocket,
+                                                       const char *remoteUsernameFrag,
+                                                       const char *remotePassword
+                                                       )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!inSocket)
+
+        UseICESocketPtr socket = ICESocket::convert(inSocket);
+
+        ICESocketSessionPtr pThis(make_shared<ICESocketSession>(make_private{}, socket->getMessageQueue(), delegate, ICESocket::convert(socket), remoteUsernameFrag, remotePassword, IICESocket::ICEControl_Controlled));
+        pThis->mThisWeak = pThis;
+        pThis->mLite = true;
+
+        AutoRecursiveLock lock(*pThis);
+        pThis->init();
+
+        socket->attach(pThis);
+        return pThis;
+      }
+
       //-----------------------------------------------------------------------
       IICESocketPtr ICESocketSession::getSocket()
       {
@@ -465,6 +551,29 @@ namespace ortc
         step();
       }
 
+      //-----------------------------------------------------------------------
+      void ICESocketSession::addRemoteCandidate(const Candidate &remoteCandidate)
+      {
+        ZS_LOG_DEBUG(log("adding remote candidate") + ZS_PARAM("candidate", remoteCandidate.toDebug()))
+        AutoRecursiveLock lock(*this);
+
+        if (mUpdatedRemoteCandidates.size() < 1) {
+          mUpdatedRemoteCandidates = mRemoteCandidates;
+        }
+        mUpdatedRemoteCandidates.push_back(remoteCandidate);
+        step();
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::setRemoteLite()
+      {
+        ZS_LOG_DEBUG(log("remote party is ICE-lite"))
+
+        AutoRecursiveLock lock(*this);
+        mRemoteLite = true;
+        step();
+      }
+
       //-----------------------------------------------------------------------
       void ICESocketSession::endOfRemoteCandidates()
       {
@@ -489,10 +598,9 @@ namespace ortc
                      ZS_PARAM("send keep alive (ms)", sendKeepAliveIndications) +
                      ZS_PARAM("expecting data within (ms)", expectSTUNOrDataWithinWithinOrSendAliveCheck))
 
-        if (mKeepAliveTimer) {
-          ZS_LOG_DEBUG(log("cancelling current keep alive timer"))
-          mKeepAliveTimer->cancel();
-          mKeepAliveTimer.reset();
+        if (mKeepAliveMonitored) {
+          ZS_LOG_DEBUG(log("cancelling current keep alive monitoring"))
+          cancelKeepAlive();
         }
 
         if (mAliveCheckRequester) {
@@ -500,12 +608,6 @@ namespace ortc
           clearAliveCheckRequester();
         }
 
-        if (mExpectingDataTimer) {
-          ZS_LOG_DEBUG(log("cancelling current expecting data timer"))
-          mExpectingDataTimer->cancel();
-          mExpectingDataTimer.reset();
-        }
-
         clearBackgroundingNotifierIfPossible();
 
         mKeepAliveDuration = sendKeepAliveIndications;
@@ -527,21 +629,14 @@ namespace ortc
                                         size_t packetLengthInBytes
                                         )
       {
-        AutoRecursiveLock lock(*this);
-        if (isShutdown()) {
-          ZS_LOG_WARNING(Detail, log("unable to send packet as socket is already shutdown"))
-          return false;
-        }
-
-        mInformedWriteReady = false;  // if this method was called in response to a write-ready event, be sure to clear the write-ready informed flag so future events will fire
-
-        if (!mNominated) {
-          ZS_LOG_WARNING(Detail, log("not allowed to send data as ICE nomination process is not complete"))
-          return false;  // do not allow sending when no candidate has been nominated
-        }
+        return sendPacketHelper(packet, packetLengthInBytes, PacketBufferPtr());
+      }
 
-        mLastSentData = zsLib::now();
-        return sendTo(mNominated->mLocal, mNominated->mRemote.mIPAddress, packet, packetLengthInBytes, true);
+      //-----------------------------------------------------------------------
+      bool ICESocketSession::sendPacket(PacketBufferPtr packet)
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!packet)
+        return sendPacketHelper(packet->data(), packet->size(), packet);
       }
 
       //-----------------------------------------------------------------------
@@ -644,6 +739,24 @@ namespace ortc
           ZS_LOG_DEBUG(log("found pairing") + ZS_PARAM("is nominated", (mNominated == found)) + found->toDebug())
         }
 
+        if ((!found) &&
+            (mLite)) {
+          // an ICE-lite session learns the remote address from the checks
+          // it receives and only keeps the pairs it has been checked upon
+          CandidatePairPtr newPair = CandidatePair::create();
+          newPair->mLocal = viaLocalCandidate;
+          newPair->mRemote.mIPAddress = source;
+          newPair->mRemote.mType = IICESocket::Type_PeerReflexive;
+          newPair->mReceivedRequest = true;
+          newPair->mReceivedResponse = true;  // no checks are sent thus the pair is considered valid upon request
+
+          ZS_LOG_DEBUG(log("new lite candidate pair discovered"))
+
+          insertCandidatePair(newPair);
+          found = newPair;
+          goto send_response;
+        }
+
         if (!found) {
 
           CandidateList::iterator foundLocalCandidate = mLocalCandidates.end();
@@ -670,11 +783,13 @@ namespace ortc
             CandidatePairPtr newPair = CandidatePair::create();
             newPair->mLocal = (*foundLocalCandidate);
             newPair->mRemote = remote;
+            newPair->mPairFoundation = getPairFoundation(newPair->mLocal, newPair->mRemote);
             newPair->mReceivedRequest = true;
+            newPair->mUnfrozen = true;              // triggered check
 
             ZS_LOG_DEBUG(log("new candidate pair discovered") + newPair->toDebug())
 
-            mCandidatePairs.push_back(newPair);
+            insertCandidatePair(newPair);
 
             found = newPair;
           }
@@ -695,6 +810,7 @@ namespace ortc
         {
           found->mReceivedRequest = true;
           found->mFailed = false;                   // even if this previously failed, we are now going to try this request to see if it works
+          found->mUnfrozen = true;                  // triggered check (RFC 8445 section 7.3.1.4)
 
           if (found->mRequester) {
             found->mRequester->retryRequestNow();   // retry the request immediately
@@ -710,8 +826,9 @@ namespace ortc
           bool wonConflict = false;
 
           if (STUNPacket::Class_Indication != stun->mClass) {
-            if (!failedIntegrity) {
-              // check to see if the request is in the correct role...
+            if ((!failedIntegrity) &&
+                (!mLite)) {
+              // check to see if the request is in the correct role (an ICE-lite session is always controlled)...
               if ((ICESocket::ICEControl_Controlling == mControl) &&
                   (stun->mIceControllingIncluded)) {
                 correctRole = false;
@@ -806,7 +923,8 @@ namespace ortc
         //.....................................................................
         // scope: create new requester
         {
-          if (found) {
+          if ((found) &&
+              (!mLite)) {
             if (!found->mRequester) {
               if (!found->mReceivedResponse) {
                 ZS_LOG_DETAIL(log("candidate search started on reaction to a request") + found->toDebug())
@@ -953,6 +1071,54 @@ namespace ortc
         mInformedWriteReady = true;
       }
 
+      //-----------------------------------------------------------------------
+      Time ICESocketSession::notifyKeepAliveDue(Time tick)
+      {
+        AutoRecursiveLock lock(*this);
+        if (isShutdown()) return Time();
+        if (!mKeepAliveMonitored) return Time();
+
+        Time next;
+
+        if (!mNominated) goto not_needed;
+
+        if (Milliseconds() != mKeepAliveDuration) {
+          Time due = mLastSentData + mKeepAliveDuration;
+          if (due > tick) {
+            ORTC_SERVICES_WIRE_LOG_TRACE(log("no need to send keep alive as data was sent within keep alive window"))
+          } else {
+            sendKeepAliveNow();
+            due = tick + mKeepAliveDuration;
+          }
+          next = due;
+        }
+
+        if (Milliseconds() != mExpectSTUNOrDataWithinDuration) {
+          Time due = mLastReceivedDataOrSTUN + mExpectSTUNOrDataWithinDuration;
+          if (due > tick) {
+            ORTC_SERVICES_WIRE_LOG_TRACE(log("received STUN request or indication or data within the expected window so no need to test if remote party is alive"))
+          } else {
+            if (!mAliveCheckRequester) {
+              sendAliveCheckRequest();
+            }
+            due = tick + mExpectSTUNOrDataWithinDuration;
+          }
+          if ((Time() == next) ||
+              (due < next)) {
+            next = due;
+          }
+        }
+
+        if (Time() != next) return next;
+
+      not_needed:
+        // the socket stops monitoring once told nothing is needed, the next
+        // step will ask to be monitored again if that changes
+        ZS_LOG_DEBUG(log("keep alives are no longer needed"))
+        mKeepAliveMonitored = false;
+        return Time();
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -1185,6 +1351,8 @@ namespace ortc
             pairing->mReceivedRequest = true;
           }
           ZS_LOG_DEBUG(log("pairing response received") + pairing->toDebug())
+
+          unfreezeFoundation(pairing->mPairFoundation);
           step();
           return true;
         }
@@ -1319,29 +1487,45 @@ namespace ortc
       //-----------------------------------------------------------------------
       void ICESocketSession::sendKeepAliveNow()
       {
-        if (!mKeepAliveTimer) return;     // not legal to send keep alives right now
+        if (!mKeepAliveMonitored) return; // not legal to send keep alives right now
         if (mNominateRequester) return;   // can't do keep alives during a nomination process
         if (!mNominated) return;          // can't do keep alives if not connected
 
         ZS_LOG_DETAIL(log("keep alive") + mNominated->toDebug())
 
-        STUNPacketPtr indication = STUNPacket::createIndication(STUNPacket::Method_Binding);
-        fix(indication);
+        // the same indication is sent on every interval thus it is only
+        // packetized once per nominated pair, after which only the
+        // transaction ID (and the attributes depending upon it) change
+        bool reuse = ((mKeepAliveIndication) &&
+                      (mKeepAliveIndicationPacket) &&
+                      (mKeepAliveIndicationPair == mNominated));
 
-        if (mRemotePassword.hasData()) {
-          indication->mUsername = mRemoteUsernameFrag + ":" + mLocalUsernameFrag;
-          indication->mPassword = mRemotePassword;
-          indication->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+        if (reuse) {
+          reuse = mKeepAliveIndication->repacketize(*mKeepAliveIndicationPacket);
+        }
+
+        if (!reuse) {
+          STUNPacketPtr indication = STUNPacket::createIndication(STUNPacket::Method_Binding);
+          fix(indication);
+
+          if (mRemotePassword.hasData()) {
+            indication->mUsername = mRemoteUsernameFrag + ":" + mLocalUsernameFrag;
+            indication->mPassword = mRemotePassword;
+            indication->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+          }
+
+          mKeepAliveIndication = indication;
+          mKeepAliveIndicationPacket = indication->packetize(STUNPacket::RFC_5245_ICE);
+          mKeepAliveIndicationPair = mNominated;
         }
 
-        SecureByteBlockPtr buffer = indication->packetize(STUNPacket::RFC_5245_ICE);
-        sendTo(mNominated->mLocal, mNominated->mRemote.mIPAddress, *buffer, buffer->SizeInBytes(), true);
+        sendTo(mNominated->mLocal, mNominated->mRemote.mIPAddress, *mKeepAliveIndicationPacket, mKeepAliveIndicationPacket->SizeInBytes(), true);
       }
 
       //-----------------------------------------------------------------------
       void ICESocketSession::sendAliveCheckRequest()
       {
-        if (!mExpectingDataTimer) return; // not legel to send alive check request right now
+        if (!mKeepAliveMonitored) return; // not legal to send alive check request right now
         if (mNominateRequester) return;   // can't do keep alives during a nomination process
         if (!mNominated) return;          // can't do keep alives if not connected
 
@@ -1382,14 +1566,27 @@ namespace ortc
         mAliveCheckRequester = ISTUNRequester::create(getAssociatedMessageQueue(), mThisWeak.lock(), mNominated->mRemote.mIPAddress, request, (isICE ? STUNPacket::RFC_5245_ICE : STUNPacket::RFC_5389_STUN));
       }
 
+      //-----------------------------------------------------------------------
+      void ICESocketSession::cancelKeepAlive()
+      {
+        mKeepAliveMonitored = false;
+
+        mKeepAliveIndication.reset();
+        mKeepAliveIndicationPacket.reset();
+        mKeepAliveIndicationPair.reset();
+
+        UseICESocketPtr socket = mICESocket.lock();
+        if (!socket) return;
+
+        socket->cancelKeepAlive(mID);
+      }
+
       //-----------------------------------------------------------------------
       void ICESocketSession::onTimer(ITimerPtr timer)
       {
         AutoRecursiveLock lock(*this);
         if (isShutdown()) return;
 
-        Time tick = zsLib::now();
-
         if (timer == mActivateTimer)
         {
           if (mCandidatePairs.size() < 1) {
@@ -1397,63 +1594,7 @@ namespace ortc
             return;
           }
 
-          bool foundPending = false;
-
-          // we are going to activate the next candidate pair now...
-          for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
-          {
-            CandidatePairPtr pairing = (*iter);
-            if (pairing == mNominated) {
-              ZS_LOG_DEBUG(log("cannot activate beyond the point of nomination"))
-              break;
-            }
-            if (pairing->mReceivedResponse) continue; // no need to activate a second time if a response has been received
-            if (pairing->mRequester) continue;        // already have an outstanding requester
-            if (pairing->mFailed) continue;           // do not activate a pair that has already failed
-
-            foundPending = true;
-
-            if (mFoundation) {
-              if (!mFoundation->canUnfreeze(pairing)) {
-                if (pairing->mFailed) {
-                  ZS_LOG_TRACE(log("candidate now marked as failed (as foundation candidate pairing failed)") + pairing->toDebug())
-                  // need to perform step after failure
-                  IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
-                  break;
-                }
-                ZS_LOG_TRACE(log("candidate still frozen") + pairing->toDebug())
-                continue;
-              }
-            }
-
-            ZS_LOG_DETAIL(log("activating search on candidate") + pairing->toDebug())
-
-            // activate this pair right now... if there is no remote username then treat this as a regular STUN request/response situation (plus will automatically nominate if successful)
-            STUNPacketPtr request = STUNPacket::createRequest(STUNPacket::Method_Binding);
-            fix(request);
-            bool isICE = false;
-
-            if (mRemotePassword.hasData()) {
-              isICE = true;
-              request->mUsername = mRemoteUsernameFrag + ":" + mLocalUsernameFrag;
-              request->mPassword = mRemotePassword;
-              request->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
-              request->mPriorityIncluded = true;
-              request->mPriority = pairing->mLocal.mPriority;
-              if (IICESocket::ICEControl_Controlling == mControl) {
-                request->mIceControllingIncluded = true;
-                request->mIceControlling = mConflictResolver;
-              } else {
-                request->mIceControlledIncluded = true;
-                request->mIceControlled = mConflictResolver;
-              }
-              request->mFingerprintIncluded = true;
-            }
-
-            // activate the pair search now...
-            pairing->mRequester = ISTUNRequester::create(getAssociatedMessageQueue(), mThisWeak.lock(), pairing->mRemote.mIPAddress, request, (isICE ? STUNPacket::RFC_5245_ICE : STUNPacket::RFC_5389_STUN));
-            break;  // only activate one pair at this time
-          }
+          bool foundPending = activateNextCheck();
 
           if (!foundPending) {
             // the activation timer seems to no longer be needed, shut it down...
@@ -1471,29 +1612,6 @@ namespace ortc
           step();
           return;
         }
-
-        if (timer == mKeepAliveTimer)
-        {
-          // we are going to check the ICE socket to see if it can shutdown TURN at this time...
-          if (mLastSentData + mKeepAliveDuration > tick) {
-            ZS_LOG_TRACE(log("no need to fire keep alive timer as data was sent within keep alive window"))
-            return;  // not enough time has passed since sending data to send more...
-          }
-
-          sendKeepAliveNow();
-          return;
-        }
-
-        if (timer == mExpectingDataTimer)
-        {
-          if (mLastReceivedDataOrSTUN + mExpectSTUNOrDataWithinDuration > tick) {
-            ZS_LOG_TRACE(log("received STUN request or indication or data within the expected window so no need to test if remote party is alive"))
-            return;
-          }
-
-          sendAliveCheckRequest();
-          return;
-        }
       }
 
       //-----------------------------------------------------------------------
@@ -1621,9 +1739,12 @@ namespace ortc
         IHelper::debugAppend(resultEl, "remote username frag", mRemoteUsernameFrag);
         IHelper::debugAppend(resultEl, "remote password", mRemotePassword);
 
+        IHelper::debugAppend(resultEl, "lite", mLite);
+        IHelper::debugAppend(resultEl, "remote lite", mRemoteLite);
         IHelper::debugAppend(resultEl, "activate timer", (bool)mActivateTimer);
-        IHelper::debugAppend(resultEl, "keep-alive timer", (bool)mKeepAliveTimer);
-        IHelper::debugAppend(resultEl, "expecting data timer", (bool)mExpectingDataTimer);
+        IHelper::debugAppend(resultEl, "check pacing (ms)", mCheckPacing);
+        IHelper::debugAppend(resultEl, "max checks in flight", mMaxChecksInFlight);
+        IHelper::debugAppend(resultEl, "keep-alive monitored", mKeepAliveMonitored);
         IHelper::debugAppend(resultEl, "step timer", (bool)mStepTimer);
 
         IHelper::debugAppend(resultEl, "control", IICESocket::toString(mControl));
@@ -1704,15 +1825,10 @@ namespace ortc
           mActivateTimer.reset();
         }
 
-        if (mKeepAliveTimer) {
-          mKeepAliveTimer->cancel();
-          mKeepAliveTimer.reset();
-        }
-
-        if (mExpectingDataTimer) {
-          mExpectingDataTimer->cancel();
-          mExpectingDataTimer.reset();
-        }
+        mKeepAliveMonitored = false;  // the ICE socket stops monitoring when notified of the session closing
+        mKeepAliveIndication.reset();
+        mKeepAliveIndicationPacket.reset();
+        mKeepAliveIndicationPair.reset();
 
         if (mStepTimer) {
           mStepTimer->cancel();
@@ -1796,16 +1912,21 @@ namespace ortc
 
         ZS_LOG_DEBUG(debug("step"))
 
+        if (mLite) {
+          if (!stepLite()) goto notify_nominated;
+          goto completed;
+        }
+
         if (!stepSocket()) goto notify_nominated;
         if (!stepCandidates()) goto notify_nominated;
         if (!stepActivateTimer()) goto notify_nominated;
         if (!stepEndSearch()) goto notify_nominated;
         if (!stepTimer()) goto notify_nominated;
-        if (!stepExpectingDataTimer()) goto notify_nominated;
-        if (!stepKeepAliveTimer()) goto notify_nominated;
+        if (!stepKeepAlive()) goto notify_nominated;
         if (!stepCancelLowerPriority()) goto notify_nominated;
         if (!stepNominate()) goto notify_nominated;
 
+      completed:
         setState(ICESocketSessionState_Completed);
 
       notify_nominated:
@@ -1814,6 +1935,26 @@ namespace ortc
         }
       }
 
+      //-----------------------------------------------------------------------
+      bool ICESocketSession::stepLite()
+      {
+        ZS_LOG_TRACE(log("step lite") + ZS_PARAM("nominated", (bool)mNominated))
+
+        if (!mICESocket.lock()) {
+          setError(IHTTP::HTTPStatusCode_PreconditionFailed, "underlying socket gone");
+          cancel();
+          return false;
+        }
+
+        // no checks, timers or nomination logic are needed as the remote
+        // (controlling) party drives everything through its own checks
+        if (!mNominated) {
+          setState(ICESocketSessionState_Searching);
+          return false;
+        }
+        return true;
+      }
+
       //-----------------------------------------------------------------------
       bool ICESocketSession::stepSocket()
       {
@@ -1868,45 +2009,50 @@ namespace ortc
         CandidateList newLocalCandidates;
         CandidateList newRemoteCandidates;
 
-        CandidateList removedCandidates;
+        CandidateList removedLocalCandidates;
+        CandidateList removedRemoteCandidates;
 
         if (mUpdatedLocalCandidates.size() > 0) {
-          IICESocket::compare(mLocalCandidates, mUpdatedLocalCandidates, newLocalCandidates, removedCandidates);
+          IICESocket::compare(mLocalCandidates, mUpdatedLocalCandidates, newLocalCandidates, removedLocalCandidates);
 
           if ((newLocalCandidates.size() > 0) ||
-              (removedCandidates.size() > 0)) {
+              (removedLocalCandidates.size() > 0)) {
             mLocalCandidates = mUpdatedLocalCandidates;
             mUpdatedLocalCandidates.clear();
           }
         }
 
         if (mUpdatedRemoteCandidates.size() > 0) {
-          removedCandidates.clear();
-          IICESocket::compare(mRemoteCandidates, mUpdatedRemoteCandidates, newRemoteCandidates, removedCandidates);
+          IICESocket::compare(mRemoteCandidates, mUpdatedRemoteCandidates, newRemoteCandidates, removedRemoteCandidates);
 
           if ((newRemoteCandidates.size() > 0) ||
-              (removedCandidates.size() > 0)) {
+              (removedRemoteCandidates.size() > 0)) {
             mRemoteCandidates = mUpdatedRemoteCandidates;
             mUpdatedRemoteCandidates.clear();
           }
         }
 
         if ((newLocalCandidates.size() < 1) &&
-            (newRemoteCandidates.size() < 1)) {
+            (newRemoteCandidates.size() < 1) &&
+            (removedLocalCandidates.size() < 1) &&
+            (removedRemoteCandidates.size() < 1)) {
           ZS_LOG_TRACE(log("candidates have not changed since last time"))
           return true;
         }
 
+        // only pairs referencing a removed candidate are dropped (every
+        // other pair keeps its check state)
+        removeCandidatePairs(removedLocalCandidates, removedRemoteCandidates);
+
+        // pairs are formed only for the newly introduced candidates and are
+        // inserted into the already prioritized list (so checks on existing
+        // pairs continue undisturbed as candidates trickle in)
+
         // scope: assemble the local/remote pairs together (remote to new local candidates)
         {
           for (CandidateList::iterator outer = mRemoteCandidates.begin(); outer != mRemoteCandidates.end(); ++outer) {
             for (CandidateList::const_iterator inner = newLocalCandidates.begin(); inner != newLocalCandidates.end(); ++inner) {
-              CandidatePairPtr pairing = CandidatePair::create();
-
-              pairing->mLocal = (*inner);
-              pairing->mRemote = (*outer);
-
-              mCandidatePairs.push_back(pairing);
+              addCandidatePair(*inner, *outer);
             }
           }
         }
@@ -1915,114 +2061,7 @@ namespace ortc
         {
           for (CandidateList::iterator outer = mLocalCandidates.begin(); outer != mLocalCandidates.end(); ++outer) {
             for (CandidateList::const_iterator inner = newRemoteCandidates.begin(); inner != newRemoteCandidates.end(); ++inner) {
-              CandidatePairPtr pairing = CandidatePair::create();
-
-              pairing->mLocal = (*outer);
-              pairing->mRemote = (*inner);
-
-              mCandidatePairs.push_back(pairing);
-            }
-          }
-        }
-
-        // sort the list based on priority of the pairs
-        if (mControl == IICESocket::ICEControl_Controlling)
-          mCandidatePairs.sort(comparePairControlling);
-        else
-          mCandidatePairs.sort(comparePairControlled);
-
-        // scope: prune the list of non-searchable/redundent candidates
-        {
-          static const IICESocket::Types searchArray[] = {
-            ICESocket::Type_Local,
-            ICESocket::Type_ServerReflexive,
-            ICESocket::Type_Relayed,
-            ICESocket::Type_Unknown
-          };
-
-          ULONG totalAdded = 0;
-
-          for (int loop = 0; searchArray[loop] != ICESocket::Type_Unknown; ++loop)
-          {
-            typedef std::map<IPAddress, CandidateList> ViaLocalIPCandidateList;
-            ViaLocalIPCandidateList foundRemotes;
-
-            for (CandidatePairList::iterator canIter = mCandidatePairs.begin(); canIter != mCandidatePairs.end();)
-            {
-              CandidatePairList::iterator current = canIter;
-              ++canIter;
-
-              CandidatePairPtr &pairing = (*current);
-              const char *reason = "UNSPECIFIED";
-
-              // only going through one type at a time
-              if (pairing->mLocal.mType != searchArray[loop])
-                continue;
-
-              // scope: check if candidate should be remoted
-              {
-                if (totalAdded >= ORTC_SERVICES_ICESOCKETSESSION_MAX_REASONABLE_CANDIDATE_PAIR_SEARCHES) {
-                  // truncate the list at 100 pairs maximum - RFC says that anything above 100 is unreasonable
-                  ZS_LOG_WARNING(Detail, log("too many candidates"))
-                  reason = "too many candidates";
-                  goto remove_candidate;
-                }
-
-                if (ICESocket::Type_ServerReflexive == pairing->mLocal.mType) {
-                  // this is server reflixive which can never be sent "from" so elimate it
-                  reason = "cannot send from server reflexive";
-                  goto remove_candidate;
-                }
-
-                IPAddress viaLocalIP = getViaLocalIP(pairing->mLocal);
-
-                ViaLocalIPCandidateList::iterator found = foundRemotes.find(viaLocalIP);
-                if (found == foundRemotes.end()) {
-                  foundRemotes[viaLocalIP] = CandidateList();
-                  found = foundRemotes.find(viaLocalIP);
-                }
-
-                CandidateList &useList = (*found).second;
-
-                bool foundType = false;
-                for (CandidateList::iterator candIter = useList.begin(); candIter != useList.end(); ++candIter) {
-                  Candidate &foundRemoteCandidate = (*candIter);
-                  if (foundRemoteCandidate.mIPAddress.isEqualIgnoringIPv4Format(pairing->mRemote.mIPAddress)) {
-                    // this is a redundant remote candidate so we will need to eliminate it
-                    foundType = true;
-                    break;
-                  }
-                }
-
-                if (foundType) {
-                  reason = "remote IP candidate already being searched remotely";
-                  goto remove_candidate;
-                }
-
-                ++totalAdded;
-                useList.push_back(pairing->mRemote);
-                continue;
-              }
-
-            remove_candidate:
-              // scoope: remove candidate
-              {
-                if ((mNominated == pairing) ||
-                    (mPendingNominatation == pairing)) {
-                  ZS_LOG_WARNING(Detail, log("cannot remove candidate pair that is nominating/nominated") + pairing->toDebug())
-                  continue;
-                }
-
-                // cancel requester
-                if (pairing->mRequester) {
-                  pairing->mRequester->cancel();
-                  pairing->mRequester.reset();
-                }
-
-                ZS_LOG_DEBUG(log("removing candidate pair") + ZS_PARAM("reason", reason) + pairing->toDebug())
-
-                mCandidatePairs.erase(current);
-              }
+              addCandidatePair(*outer, *inner);
             }
           }
         }
@@ -2059,17 +2098,15 @@ namespace ortc
           }
 
           // is there any need for an activation timer?
-          if (pairing->mReceivedResponse) {
-            ZS_LOG_INSANE(log("activate timer - pairing received response") + pairing->toDebug())
-            continue;
-          }
-          if (pairing->mRequester) {
-            ZS_LOG_INSANE(log("activate timer - pairing requester is already active") + pairing->toDebug())
-            continue;
-          }
-          if (pairing->mFailed) {
-            ZS_LOG_INSANE(log("activate timer - pairing failed") + pairing->toDebug())
-            continue;
+          switch (pairing->getCheckState()) {
+            case CandidatePair::CheckState_Frozen:
+            case CandidatePair::CheckState_Waiting:     break;
+            case CandidatePair::CheckState_InProgress:
+            case CandidatePair::CheckState_Succeeded:
+            case CandidatePair::CheckState_Failed:      {
+              ZS_LOG_INSANE(log("activate timer - pairing does not need activation") + pairing->toDebug())
+              continue;
+            }
           }
 
           ZS_LOG_INSANE(log("activate timer - found unsearched") + pairing->toDebug())
@@ -2085,7 +2122,10 @@ namespace ortc
 
           ZS_LOG_DEBUG(log("creating activate timer"))
 
-          mActivateTimer = ITimer::create(mThisWeak.lock(), Milliseconds(ORTC_SERVICES_ICESOCKETSESSION_ACTIVATE_TIMER_IN_MS)); // this will cause candidates to start searching right away
+          mActivateTimer = ITimer::create(mThisWeak.lock(), mCheckPacing);
+
+          // the first check does not need to wait for the pacing interval
+          activateNextCheck();
           return true;
         }
 
@@ -2150,44 +2190,32 @@ namespace ortc
       }
 
       //-----------------------------------------------------------------------
-      bool ICESocketSession::stepExpectingDataTimer()
-      {
-        bool needed =  ((mNominated) && (Milliseconds() != mExpectSTUNOrDataWithinDuration));
-        ZS_LOG_TRACE(log("expecting data timer") + ZS_PARAM("needs timer", needed))
-
-        if (needed) {
-          if (mExpectingDataTimer) return true;
-
-          mExpectingDataTimer = ITimer::create(mThisWeak.lock(), mExpectSTUNOrDataWithinDuration); // this will cause candidates to start searching right away
-
-          return true;
-        }
-
-        if (!mExpectingDataTimer) return true;
-
-        mExpectingDataTimer->cancel();
-        mExpectingDataTimer.reset();
-        return true;
-      }
-
-      //-----------------------------------------------------------------------
-      bool ICESocketSession::stepKeepAliveTimer()
+      bool ICESocketSession::stepKeepAlive()
       {
-        bool needed =  ((mNominated) && (Milliseconds() != mKeepAliveDuration));
-        ZS_LOG_TRACE(log("keep alive timer") + ZS_PARAM("needs timer", needed))
+        bool needed = ((mNominated) &&
+                       ((Milliseconds() != mKeepAliveDuration) ||
+                        (Milliseconds() != mExpectSTUNOrDataWithinDuration)));
+        ZS_LOG_TRACE(log("keep alive") + ZS_PARAM("needs monitoring", needed))
 
         if (needed) {
-          if (mKeepAliveTimer) return true;
+          if (mKeepAliveMonitored) return true;
 
-          mKeepAliveTimer = ITimer::create(mThisWeak.lock(), mKeepAliveDuration); // this will cause candidates to start searching right away
+          UseICESocketPtr socket = mICESocket.lock();
+          if (!socket) {
+            ZS_LOG_WARNING(Detail, log("cannot monitor keep alives as ICE socket is gone"))
+            return true;
+          }
 
+          // the socket groups all of its sessions into shared time buckets
+          // rather than each session owning its own keep alive timers
+          socket->monitorKeepAlive(mThisWeak.lock());
+          mKeepAliveMonitored = true;
           return true;
         }
 
-        if (!mKeepAliveTimer) return true;
+        if (!mKeepAliveMonitored) return true;
 
-        mKeepAliveTimer->cancel();
-        mKeepAliveTimer.reset();
+        cancelKeepAlive();
         return true;
       }
       
@@ -2263,7 +2291,8 @@ namespace ortc
             ZS_LOG_INSANE(log("nominate - pairing is failed") + pairing->toDebug())
             continue;
           }
-          if (!pairing->mReceivedRequest) {
+          if ((!pairing->mReceivedRequest) &&
+              (!mRemoteLite)) {
             ZS_LOG_INSANE(log("nominate - pairing did not receive request") + pairing->toDebug())
             continue;
           }
@@ -2399,22 +2428,56 @@ namespace ortc
           pairing->mFailed = false;
           pairing->mReceivedRequest = false;
           pairing->mReceivedResponse = false;
+          pairing->mUnfrozen = false;
           if (pairing->mRequester) {
             pairing->mRequester->cancel();
             pairing->mRequester.reset();
           }
         }
 
+        // pair priorities depend on the role
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+        {
+          CandidatePairPtr &pairing = (*iter);
+          pairing->mPriority = calculatePriority(pairing, mControl);
+        }
+        std::stable_sort(mCandidatePairs.begin(), mCandidatePairs.end(), comparePairPriority);
+
         (IWakeDelegateProxy::create(mThisWeak.lock()))->onWake();
       }
 
+      //-----------------------------------------------------------------------
+      bool ICESocketSession::sendPacketHelper(
+                                              const BYTE *packet,
+                                              size_t packetLengthInBytes,
+                                              PacketBufferPtr framingPacket
+                                              )
+      {
+        AutoRecursiveLock lock(*this);
+        if (isShutdown()) {
+          ZS_LOG_WARNING(Detail, log("unable to send packet as socket is already shutdown"))
+          return false;
+        }
+
+        mInformedWriteReady = false;  // if this method was called in response to a write-ready event, be sure to clear the write-ready informed flag so future events will fire
+
+        if (!mNominated) {
+          ZS_LOG_WARNING(Detail, log("not allowed to send data as ICE nomination process is not complete"))
+          return false;  // do not allow sending when no candidate has been nominated
+        }
+
+        mLastSentData = zsLib::now();
+        return sendTo(mNominated->mLocal, mNominated->mRemote.mIPAddress, packet, packetLengthInBytes, true, framingPacket);
+      }
+
       //-----------------------------------------------------------------------
       bool ICESocketSession::sendTo(
                                     const IICESocket::Candidate &viaLocalCandidate,
                                     const IPAddress &destination,
                                     const BYTE *buffer,
                                     size_t bufferLengthInBytes,
-                                    bool isUserData
+                                    bool isUserData,
+                                    PacketBufferPtr framingPacket
                                     )
       {
         if (isShutdown()) {
@@ -2428,9 +2491,293 @@ namespace ortc
         }
 
         ORTC_SERVICES_WIRE_LOG_TRACE((log("sending packet") + ZS_PARAM("candidate", viaLocalCandidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer", buffer ? true : false) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("user data", isUserData)))
+        if (framingPacket) {
+          return socket->sendTo(viaLocalCandidate, destination, framingPacket, isUserData);
+        }
         return socket->sendTo(viaLocalCandidate, destination, buffer, bufferLengthInBytes, isUserData);
       }
 
+      //-----------------------------------------------------------------------
+      bool ICESocketSession::activateNextCheck()
+      {
+        // RFC 8445 section 6.1.4.2 - every Ta one ordinary check is sent
+        // for the highest priority waiting pair; checks already in progress
+        // continue to run in parallel
+        unfreezeChecks();
+
+        bool foundPending = false;
+        ULONG totalInFlight = 0;
+        CandidatePairPtr pairing;
+
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+        {
+          CandidatePairPtr &check = (*iter);
+          if (check == mNominated) {
+            ZS_LOG_DEBUG(log("cannot activate beyond the point of nomination"))
+            break;
+          }
+
+          switch (check->getCheckState()) {
+            case CandidatePair::CheckState_Frozen:      foundPending = true; break;
+            case CandidatePair::CheckState_Waiting:     {
+              foundPending = true;
+              if (!pairing) pairing = check;
+              break;
+            }
+            case CandidatePair::CheckState_InProgress:  ++totalInFlight; break;
+            case CandidatePair::CheckState_Succeeded:
+            case CandidatePair::CheckState_Failed:      break;
+          }
+        }
+
+        if (!pairing) {
+          ZS_LOG_TRACE(log("no waiting candidate pair to activate") + ZS_PARAM("pending", foundPending) + ZS_PARAM("in flight", totalInFlight))
+          return foundPending;
+        }
+
+        if ((0 != mMaxChecksInFlight) &&
+            (totalInFlight >= mMaxChecksInFlight)) {
+          ZS_LOG_TRACE(log("too many checks in flight to activate another") + ZS_PARAM("in flight", totalInFlight) + ZS_PARAM("max", mMaxChecksInFlight))
+          return true;
+        }
+
+        ZS_LOG_DETAIL(log("activating search on candidate") + ZS_PARAM("in flight", totalInFlight) + pairing->toDebug())
+
+        // activate this pair right now... if there is no remote username then treat this as a regular STUN request/response situation (plus will automatically nominate if successful)
+        STUNPacketPtr request = STUNPacket::createRequest(STUNPacket::Method_Binding);
+        fix(request);
+        bool isICE = false;
+
+        if (mRemotePassword.hasData()) {
+          isICE = true;
+          request->mUsername = mRemoteUsernameFrag + ":" + mLocalUsernameFrag;
+          request->mPassword = mRemotePassword;
+          request->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+          request->mPriorityIncluded = true;
+          request->mPriority = pairing->mLocal.mPriority;
+          if (IICESocket::ICEControl_Controlling == mControl) {
+            request->mIceControllingIncluded = true;
+            request->mIceControlling = mConflictResolver;
+          } else {
+            request->mIceControlledIncluded = true;
+            request->mIceControlled = mConflictResolver;
+          }
+          request->mFingerprintIncluded = true;
+        }
+
+        // activate the pair search now...
+        pairing->mRequester = ISTUNRequester::create(getAssociatedMessageQueue(), mThisWeak.lock(), pairing->mRemote.mIPAddress, request, (isICE ? STUNPacket::RFC_5245_ICE : STUNPacket::RFC_5389_STUN));
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::unfreezeChecks()
+      {
+        typedef std::set<String> FoundationSet;
+
+        // any foundation with a waiting or in progress check stays as is;
+        // every other foundation has its highest priority frozen pair moved
+        // to waiting (RFC 8445 sections 6.1.2.6 and 6.1.4.2)
+        FoundationSet activeFoundations;
+        bool needsStep = false;
+
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+        {
+          CandidatePairPtr &pairing = (*iter);
+          switch (pairing->getCheckState()) {
+            case CandidatePair::CheckState_Waiting:
+            case CandidatePair::CheckState_InProgress:  activeFoundations.insert(pairing->mPairFoundation); break;
+            case CandidatePair::CheckState_Frozen:
+            case CandidatePair::CheckState_Succeeded:
+            case CandidatePair::CheckState_Failed:      break;
+          }
+        }
+
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+        {
+          CandidatePairPtr &pairing = (*iter);
+          if (pairing == mNominated) break;
+
+          if (CandidatePair::CheckState_Frozen != pairing->getCheckState()) continue;
+          if (activeFoundations.end() != activeFoundations.find(pairing->mPairFoundation)) continue;
+
+          if (mFoundation) {
+            if (!mFoundation->canUnfreeze(pairing)) {
+              if (pairing->mFailed) {
+                ZS_LOG_TRACE(log("candidate now marked as failed (as foundation candidate pairing failed)") + pairing->toDebug())
+                // need to perform step after failure
+                needsStep = true;
+                continue;
+              }
+              ZS_LOG_TRACE(log("candidate still frozen") + pairing->toDebug())
+              continue;
+            }
+          }
+
+          ZS_LOG_TRACE(log("unfreezing candidate") + pairing->toDebug())
+
+          pairing->mUnfrozen = true;
+          activeFoundations.insert(pairing->mPairFoundation);
+        }
+
+        if (needsStep) {
+          // a single step handles every pair that failed along with its foundation
+          IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::unfreezeFoundation(const String &pairFoundation)
+      {
+        // a successful check unfreezes every pair sharing its foundation (RFC 8445 section 7.2.5.3.3)
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+        {
+          CandidatePairPtr &pairing = (*iter);
+          if (pairing->mPairFoundation != pairFoundation) continue;
+          if (CandidatePair::CheckState_Frozen != pairing->getCheckState()) continue;
+
+          ZS_LOG_TRACE(log("unfreezing candidate (foundation succeeded)") + pairing->toDebug())
+          pairing->mUnfrozen = true;
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::addCandidatePair(
+                                              const Candidate &local,
+                                              const Candidate &remote
+                                              )
+      {
+        if (ICESocket::Type_ServerReflexive == local.mType) {
+          // this is server reflixive which can never be sent "from" so elimate it
+          ZS_LOG_TRACE(log("cannot send from server reflexive") + ZS_PARAM("local", local.toDebug()) + ZS_PARAM("remote", remote.toDebug()))
+          return;
+        }
+
+        CandidatePairPtr pairing = CandidatePair::create();
+        pairing->mLocal = local;
+        pairing->mRemote = remote;
+        pairing->mPairFoundation = getPairFoundation(local, remote);
+        pairing->mPriority = calculatePriority(pairing, mControl);
+
+        IPAddress viaLocalIP = getViaLocalIP(local);
+
+        // scope: check if pairing is redundant
+        {
+          for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+          {
+            CandidatePairPtr &existing = (*iter);
+            if (existing->mLocal.mType != local.mType) continue;
+            if (!existing->mRemote.mIPAddress.isEqualIgnoringIPv4Format(remote.mIPAddress)) continue;
+            if (!getViaLocalIP(existing->mLocal).isEqualIgnoringIPv4Format(viaLocalIP)) continue;
+
+            // the higher priority pair wins unless the lower priority pair's check has already started
+            if ((pairing->mPriority <= existing->mPriority) ||
+                (!isRemovable(existing))) {
+              ZS_LOG_TRACE(log("remote IP candidate already being searched remotely") + pairing->toDebug())
+              return;
+            }
+
+            ZS_LOG_DEBUG(log("replacing redundant candidate pair") + ZS_PARAM("replacement", pairing->mID) + existing->toDebug())
+            mCandidatePairs.erase(iter);
+            break;
+          }
+        }
+
+        if (mCandidatePairs.size() >= ORTC_SERVICES_ICESOCKETSESSION_MAX_REASONABLE_CANDIDATE_PAIR_SEARCHES) {
+          // truncate the list at 100 pairs maximum - RFC says that anything above 100 is unreasonable
+          CandidatePairList::iterator lowest = mCandidatePairs.end();
+          for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); ++iter)
+          {
+            if (isRemovable(*iter)) lowest = iter;
+          }
+
+          if ((lowest == mCandidatePairs.end()) ||
+              (pairing->mPriority <= (*lowest)->mPriority)) {
+            ZS_LOG_WARNING(Detail, log("too many candidates") + pairing->toDebug())
+            return;
+          }
+
+          ZS_LOG_DEBUG(log("removing candidate pair") + ZS_PARAM("reason", "too many candidates") + (*lowest)->toDebug())
+          mCandidatePairs.erase(lowest);
+        }
+
+        insertCandidatePair(pairing);
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::insertCandidatePair(CandidatePairPtr pairing)
+      {
+        pairing->mPriority = calculatePriority(pairing, mControl);
+
+        // equal priority pairs keep their arrival order
+        CandidatePairList::iterator iter = std::upper_bound(mCandidatePairs.begin(), mCandidatePairs.end(), pairing, comparePairPriority);
+
+        ZS_LOG_DEBUG(log("new candidate pair") + pairing->toDebug())
+
+        mCandidatePairs.insert(iter, pairing);
+      }
+
+      //-----------------------------------------------------------------------
+      void ICESocketSession::removeCandidatePairs(
+                                                  const CandidateList &removedLocalCandidates,
+                                                  const CandidateList &removedRemoteCandidates
+                                                  )
+      {
+        for (CandidatePairList::iterator iter = mCandidatePairs.begin(); iter != mCandidatePairs.end(); )
+        {
+          CandidatePairPtr pairing = (*iter);
+
+          bool removed = false;
+
+          for (CandidateList::const_iterator candIter = removedLocalCandidates.begin(); (!removed) && (candIter != removedLocalCandidates.end()); ++candIter) {
+            removed = isSameCandidate(pairing->mLocal, *candIter);
+          }
+          // peer reflexive remotes are learned locally and never signalled thus are never removed by the remote party
+          if (IICESocket::Type_PeerReflexive != pairing->mRemote.mType) {
+            for (CandidateList::const_iterator candIter = removedRemoteCandidates.begin(); (!removed) && (candIter != removedRemoteCandidates.end()); ++candIter) {
+              removed = isSameCandidate(pairing->mRemote, *candIter);
+            }
+          }
+
+          if (!removed) {
+            ++iter;
+            continue;
+          }
+
+          if ((mNominated == pairing) ||
+              (mPendingNominatation == pairing)) {
+            ZS_LOG_WARNING(Detail, log("cannot remove candidate pair that is nominating/nominated") + pairing->toDebug())
+            ++iter;
+            continue;
+          }
+
+          if (pairing->mRequester) {
+            pairing->mRequester->cancel();
+            pairing->mRequester.reset();
+          }
+
+          ZS_LOG_DEBUG(log("removing candidate pair") + ZS_PARAM("reason", "candidate removed") + pairing->toDebug())
+
+          iter = mCandidatePairs.erase(iter);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      bool ICESocketSession::isRemovable(const CandidatePairPtr &pairing) const
+      {
+        if ((mNominated == pairing) ||
+            (mPendingNominatation == pairing)) return false;
+
+        switch (pairing->getCheckState()) {
+          case CandidatePair::CheckState_Frozen:
+          case CandidatePair::CheckState_Waiting:
+          case CandidatePair::CheckState_Failed:      return true;
+          case CandidatePair::CheckState_InProgress:
+          case CandidatePair::CheckState_Succeeded:   break;
+        }
+        return false;
+      }
+
       //-----------------------------------------------------------------------
       bool ICESocketSession::canUnfreeze(CandidatePairPtr derivedPairing)
       {
@@ -2502,6 +2849,18 @@ namespace ortc
         return internal::ICESocketSession::create(delegate, socket, remoteUsernameFrag, remotePassword, remoteCandidates, control, foundation);
       }
 
+      //-----------------------------------------------------------------------
+      ICESocketSessionPtr IICESocketSessionFactory::createLite(
+                                                               IICESocketSessionDelegatePtr delegate,
+                                                               IICESocketPtr socket,
+                                                               const char *remoteUsernameFrag,
+                                                               const char *remotePassword
+                                                               )
+      {
+        if (this) {}
+        return internal::ICESocketSession::createLite(delegate, socket, remoteUsernameFrag, remotePassword);
+      }
+
     }
 
     //-------------------------------------------------------------------------
@@ -2557,5 +2916,16 @@ namespace ortc
     {
       return internal::IICESocketSessionFactory::singleton().create(delegate, socket, remoteUsernameFrag, remotePassword, remoteCandidates, control, foundation);
     }
+
+    //-------------------------------------------------------------------------
+    IICESocketSessionPtr IICESocketSession::createLite(
+                                                       IICESocketSessionDelegatePtr delegate,
+                                                       IICESocketPtr socket,
+                                                       const char *remoteUsernameFrag,
+                                                       const char *remotePassword
+                                                       )
+    {
+      return internal::IICESocketSessionFactory::singleton().createLite(delegate, socket, remoteUsernameFrag, remotePassword);
+    }
   }
 }
@@ -0,0 +1,342 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_KeyGenerationPool.h>
+#include <ortc/services/internal/services_DHPrivateKey.h>
+#include <ortc/services/internal/services_RSAPrivateKey.h>
+#include <ortc/services/internal/services_RSAPublicKey.h>
+#include <ortc/services/internal/services_Helper.h>
+
+#include <ortc/services/IRSAPrivateKey.h>
+
+#include <zsLib/ISettings.h>
+#include <zsLib/XML.h>
+#include <zsLib/Log.h>
+#include <zsLib/Stringize.h>
+#include <zsLib/helpers.h>
+
+namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      ZS_DECLARE_CLASS_PTR(KeyGenerationPoolSettingsDefaults);
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark KeyGenerationPoolSettingsDefaults
+      #pragma mark
+
+      class KeyGenerationPoolSettingsDefaults : public ISettingsApplyDefaultsDelegate
+      {
+      public:
+        //-----------------------------------------------------------------------
+        ~KeyGenerationPoolSettingsDefaults()
+        {
+          ISettings::removeDefaults(*this);
+        }
+
+        //-----------------------------------------------------------------------
+        static KeyGenerationPoolSettingsDefaultsPtr singleton()
+        {
+          static SingletonLazySharedPtr<KeyGenerationPoolSettingsDefaults> singleton(create());
+          return singleton.singleton();
+        }
+
+        //-----------------------------------------------------------------------
+        static KeyGenerationPoolSettingsDefaultsPtr create()
+        {
+          auto pThis(make_shared<KeyGenerationPoolSettingsDefaults>());
+          ISettings::installDefaults(pThis);
+          return pThis;
+        }
+
+        //-----------------------------------------------------------------------
+        virtual void notifySettingsApplyDefaults() override
+        {
+          ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_RSA_KEYS, 2);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS, 4);
+        }
+      };
+
+      //-------------------------------------------------------------------------
+      void installKeyGenerationPoolSettingsDefaults()
+      {
+        KeyGenerationPoolSettingsDefaults::singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark KeyGenerationPool
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      KeyGenerationPool::KeyGenerationPool(const make_private &)
+      {
+        ZS_LOG_DEBUG(log("created"))
+      }
+
+      //-----------------------------------------------------------------------
+      KeyGenerationPoolPtr KeyGenerationPool::create()
+      {
+        KeyGenerationPoolPtr pThis(make_shared<KeyGenerationPool>(make_private{}));
+        pThis->mThisWeak = pThis;
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      KeyGenerationPoolPtr KeyGenerationPool::singleton()
+      {
+        static SingletonLazySharedPtr<KeyGenerationPool> singleton(KeyGenerationPool::create());
+        return singleton.singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      RSAPrivateKeyPtr KeyGenerationPool::takeRSAKeyPair(RSAPublicKeyPtr &outPublicKey)
+      {
+        size_t total = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_RSA_KEYS));
+        if (0 == total) return RSAPrivateKeyPtr();
+
+        AutoLock lock(mLock);
+
+        RSAPrivateKeyPtr result;
+
+        if (mRSAKeys.size() > 0) {
+          RSAKeyPair &keyPair = mRSAKeys.front();
+          result = keyPair.mPrivateKey;
+          outPublicKey = keyPair.mPublicKey;
+          mRSAKeys.pop_front();
+          ++mHits;
+        } else {
+          ++mMisses;
+        }
+
+        refillRSA(total);
+        return result;
+      }
+
+      //-----------------------------------------------------------------------
+      bool KeyGenerationPool::takeDHKeyPair(
+                                            IDHKeyDomainPtr keyDomain,
+                                            SecureByteBlock &outPrivateKey,
+                                            SecureByteBlock &outPublicKey
+                                            )
+      {
+        if (!keyDomain) return false;
+
+        KeyDomainPrecompiledTypes precompiledType = keyDomain->getPrecompiledType();
+        if (IDHKeyDomain::KeyDomainPrecompiledType_Unknown == precompiledType) return false;
+
+        size_t total = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS));
+        if (0 == total) return false;
+
+        AutoLock lock(mLock);
+
+        DHKeyPairPool &pool = mDHKeys[precompiledType];
+        if (!pool.mKeyDomain) pool.mKeyDomain = keyDomain;
+
+        bool found = false;
+
+        if (pool.mKeys.size() > 0) {
+          DHKeyPair &keyPair = pool.mKeys.front();
+          outPrivateKey.Assign(*keyPair.mPrivateKey);
+          outPublicKey.Assign(*keyPair.mPublicKey);
+          pool.mKeys.pop_front();
+          ++mHits;
+          found = true;
+        } else {
+          ++mMisses;
+        }
+
+        refillDH(precompiledType, pool, total);
+        return found;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t KeyGenerationPool::getHits() const
+      {
+        AutoLock lock(mLock);
+        return mHits;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t KeyGenerationPool::getMisses() const
+      {
+        AutoLock lock(mLock);
+        return mMisses;
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr KeyGenerationPool::toDebug() const
+      {
+        AutoLock lock(mLock);
+
+        ElementPtr resultEl = Element::create("KeyGenerationPool");
+
+        IHelper::debugAppend(resultEl, "id", mID);
+        IHelper::debugAppend(resultEl, "rsa keys", mRSAKeys.size());
+        IHelper::debugAppend(resultEl, "rsa pending", mRSAPending);
+
+        for (auto iter = mDHKeys.begin(); iter != mDHKeys.end(); ++iter) {
+          auto precompiledType = (*iter).first;
+          auto &pool = (*iter).second;
+
+          ElementPtr poolEl = Element::create("dh keys");
+          IHelper::debugAppend(poolEl, "type", static_cast<size_t>(precompiledType));
+          IHelper::debugAppend(poolEl, "keys", pool.mKeys.size());
+          IHelper::debugAppend(poolEl, "pending", pool.mPending);
+          IHelper::debugAppend(resultEl, poolEl);
+        }
+
+        IHelper::debugAppend(resultEl, "hits", mHits);
+        IHelper::debugAppend(resultEl, "misses", mMisses);
+
+        return resultEl;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark KeyGenerationPool => IKeyGenerationPoolAsync
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      void KeyGenerationPool::onGenerateRSAKeyPair()
+      {
+        RSAPublicKeyPtr publicKey;
+        RSAPrivateKeyPtr privateKey = RSAPrivateKey::generateNow(publicKey, ORTC_SERVICES_RSA_PRIVATE_KEY_GENERATION_SIZE);
+
+        size_t total = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_RSA_KEYS));
+
+        AutoLock lock(mLock);
+
+        if (mRSAPending > 0) --mRSAPending;
+
+        if ((!privateKey) ||
+            (!publicKey)) {
+          ZS_LOG_WARNING(Detail, log("failed to pre-generate RSA key pair"))
+          return;
+        }
+
+        if (mRSAKeys.size() >= total) return;
+
+        RSAKeyPair keyPair;
+        keyPair.mPrivateKey = privateKey;
+        keyPair.mPublicKey = publicKey;
+        mRSAKeys.push_back(keyPair);
+
+        ZS_LOG_TRACE(log("pre-generated RSA key pair") + ZS_PARAM("total", mRSAKeys.size()))
+      }
+
+      //-----------------------------------------------------------------------
+      void KeyGenerationPool::onGenerateDHKeyPair(KeyDomainPrecompiledTypes precompiledType)
+      {
+        IDHKeyDomainPtr keyDomain;
+
+        {
+          AutoLock lock(mLock);
+          auto found = mDHKeys.find(precompiledType);
+          if (found == mDHKeys.end()) return;
+          keyDomain = (*found).second.mKeyDomain;
+        }
+
+        DHKeyPair keyPair;
+        keyPair.mPrivateKey = make_shared<SecureByteBlock>();
+        keyPair.mPublicKey = make_shared<SecureByteBlock>();
+
+        DHPrivateKey::generateKeyPairNow(keyDomain, *keyPair.mPrivateKey, *keyPair.mPublicKey);
+
+        size_t total = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS));
+
+        AutoLock lock(mLock);
+
+        DHKeyPairPool &pool = mDHKeys[precompiledType];
+        if (pool.mPending > 0) --pool.mPending;
+
+        if (pool.mKeys.size() >= total) return;
+
+        pool.mKeys.push_back(keyPair);
+
+        ZS_LOG_TRACE(log("pre-generated DH key pair") + ZS_PARAM("type", static_cast<size_t>(precompiledType)) + ZS_PARAM("total", pool.mKeys.size()))
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark KeyGenerationPool => (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Log::Params KeyGenerationPool::log(const char *message) const
+      {
+        ElementPtr objectEl = Element::create("KeyGenerationPool");
+        IHelper::debugAppend(objectEl, "id", mID);
+        return Log::Params(message, objectEl);
+      }
+
+      //-----------------------------------------------------------------------
+      void KeyGenerationPool::refillRSA(size_t total)
+      {
+        while (mRSAKeys.size() + mRSAPending < total) {
+          ++mRSAPending;
+          IKeyGenerationPoolAsyncProxy::create(IHelper::getServicePoolQueue(), mThisWeak.lock())->onGenerateRSAKeyPair();
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void KeyGenerationPool::refillDH(
+                                       KeyDomainPrecompiledTypes precompiledType,
+                                       DHKeyPairPool &pool,
+                                       size_t total
+                                       )
+      {
+        while (pool.mKeys.size() + pool.mPending < total) {
+          ++pool.mPending;
+          IKeyGenerationPoolAsyncProxy::create(IHelper::getServicePoolQueue(), mThisWeak.lock())->onGenerateDHKeyPair(precompiledType);
+        }
+      }
+
+    }
+  }
+}
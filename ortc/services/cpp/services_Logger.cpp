@@ -51,6 +51,7 @@
 #include <zsLib/Numeric.h>
 #include <zsLib/Singleton.h>
 
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <ctime>
@@ -1590,6 +1591,10 @@ namespace ortc
             return;
           }
 
+          // quick exit without taking the lock or formatting while there is
+          // nobody connected and the backlog window has closed
+          if (mDiscarding) return;
+
           // scope: quick exit is not logging
           {
             AutoRecursiveLock lock(*this);
@@ -1600,6 +1605,7 @@ namespace ortc
               if (tick > mBacklogDataUntil) {
                 // clear out any pending data since we can't backlog any longer
                 mBufferedList.clear();
+                mDiscarding = true;
                 return;
               }
             }
@@ -1689,6 +1695,7 @@ namespace ortc
               mTelnetSocket->setOptionFlag(Socket::SetOptionFlag::NonBlocking, true);
               mTelnetSocket->setDelegate(mThisWeak.lock());
               activate = mConnected = true;
+              mDiscarding = false;
             }
 
             if (inSocket == mTelnetSocket) {
@@ -1757,6 +1764,7 @@ namespace ortc
             if (isOutgoing()) {
               if (!mConnected) {
                 activate = mConnected = true;
+                mDiscarding = false;
                 IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
               }
             }
@@ -2184,6 +2192,7 @@ namespace ortc
           if (!mRetryTimer) {
             // offer a bit of buffering
             mBacklogDataUntil = zsLib::now() + Seconds(ORTC_SERVICES_MAX_TELNET_LOGGER_PENDING_CONNECTIONBACKLOG_TIME_SECONDS);
+            mDiscarding = false;
 
             mRetryWaitTime = Seconds(1);
             mNextRetryTime = zsLib::now();
@@ -2384,6 +2393,7 @@ namespace ortc
         SocketPtr mTelnetSocket;
 
         Time mBacklogDataUntil;
+        std::atomic<bool> mDiscarding {};
 
         bool mClosed {};
 
@@ -31,12 +31,15 @@
 
 #include <ortc/services/internal/services_MessageLayerSecurityChannel.h>
 #include <ortc/services/internal/services_Helper.h>
+#include <ortc/services/IRSABatch.h>
 #include <ortc/services/IRSAPrivateKey.h>
 #include <ortc/services/IRSAPublicKey.h>
 #include <ortc/services/IHTTP.h>
 #include <ortc/services/IDHKeyDomain.h>
 #include <ortc/services/IDHPrivateKey.h>
 #include <ortc/services/IDHPublicKey.h>
+#include <ortc/services/IEd25519PrivateKey.h>
+#include <ortc/services/IEd25519PublicKey.h>
 #include <ortc/services/ICache.h>
 
 #include <zsLib/eventing/IHasher.h>
@@ -116,7 +119,17 @@ namespace ortc
 
         return tmp;
       }
-      
+
+      //-----------------------------------------------------------------------
+      static void toLowerHex(
+                             const BYTE *buffer,
+                             size_t bufferSizeInBytes,
+                             BYTE *outHex                 // must be 2*bufferSizeInBytes in size
+                             )
+      {
+        IHelper::convertToHex(buffer, bufferSizeInBytes, reinterpret_cast<char *>(outHex), bufferSizeInBytes * 2);
+      }
+
       //-----------------------------------------------------------------------
       static SecureByteBlockPtr decryptUsingPassphraseEncoding(
                                                                const String &passphrase,
@@ -140,7 +153,7 @@ namespace ortc
         String base64Value = values[1];
 
         SecureByteBlockPtr iv = IHelper::convertFromHex(hexSalt);
-        SecureByteBlockPtr input = IHelper::convertFromBase64(base64Value);
+        SecureByteBlockPtr input = MessageLayerSecurityChannel::fromBase64(base64Value);
 
         SecureByteBlockPtr key = IHasher::hash("keying:" + nonce, IHasher::hmacSHA256(*IHasher::hmacKeyFromPassphrase(passphrase)));
 
@@ -210,6 +223,8 @@ namespace ortc
         virtual void notifySettingsApplyDefaults() override
         {
           ISettings::setUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_CHANGE_SENDING_KEY_AFTER, 60 * 60);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_CHAINS, 0);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_MAX_PENDING, 256);
         }
       };
 
@@ -271,6 +286,10 @@ namespace ortc
         mSendStreamDecodedSubscription = mSendStreamDecoded->subscribe(mThisWeak.lock());
         mSendStreamEncodedSubscription = mSendStreamEncoded->subscribe(mThisWeak.lock());
 
+        mPipelineChains = ISettings::getUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_CHAINS);
+        mPipelineMaxPending = ISettings::getUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_MAX_PENDING);
+        if (mPipelineMaxPending < 1) mPipelineMaxPending = 1;
+
         IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
       }
 
@@ -288,6 +307,21 @@ namespace ortc
         return ZS_DYNAMIC_PTR_CAST(MessageLayerSecurityChannel, channel);
       }
 
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr MessageLayerSecurityChannel::fromBase64(const String &value)
+      {
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>(IHelper::getBase64DecodedLength(value.c_str(), value.length())));
+        size_t decodedLength = 0;
+        if (IHelper::convertFromBase64(value.c_str(), value.length(), output->BytePtr(), output->SizeInBytes(), decodedLength)) return output;
+
+        // keying values may be wrapped or padded with whitespace which the
+        // fast decoder rejects but the lenient decoder skips
+        ZS_LOG_TRACE(Log::Params("base64 value is not strict (thus decoding leniently)") + ZS_PARAM("length", value.length()))
+        output = IHelper::convertFromBase64(value);
+        if (!output) return make_shared<SecureByteBlock>();
+        return output;
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -381,11 +415,13 @@ namespace ortc
         mSendRemotePublicKey.reset();
 
         mReceiveSigningPublicKey.reset();
+        mReceiveSigningEd25519PublicKey.reset();
         mReceiveKeyingSignedDoc.reset();
         mReceiveKeyingSignedEl.reset();
 
 
         mSendSigningPrivateKey.reset();
+        mSendSigningEd25519PrivateKey.reset();
         mSendKeyingNeedingToSignDoc.reset();
         mSendKeyingNeedToSignEl.reset();
 
@@ -405,6 +441,9 @@ namespace ortc
         mReceiveKeys.clear();
         mSendKeys.clear();
 
+        mPendingEncodes.clear();
+        mEncodeChains.clear();    // any pool thread still encoding discards its result
+
         if (mChangeSendingKeyTimer) {
           mChangeSendingKeyTimer->cancel();
           mChangeSendingKeyTimer.reset();
@@ -520,8 +559,8 @@ namespace ortc
           return false;
         }
 
-        ZS_LOG_TRACE(log("needs receive keying signing public key") + IRSAPublicKey::toDebug(mReceiveSigningPublicKey))
-        return (!((bool)mReceiveSigningPublicKey));
+        ZS_LOG_TRACE(log("needs receive keying signing public key") + IRSAPublicKey::toDebug(mReceiveSigningPublicKey) + IEd25519PublicKey::toDebug(mReceiveSigningEd25519PublicKey))
+        return !hasReceiveSigningPublicKey();
       }
 
       //-----------------------------------------------------------------------
@@ -803,6 +842,7 @@ namespace ortc
         if (mReceiveSigningPublicKey) {
           ZS_THROW_INVALID_ARGUMENT_IF(remotePublicKey != mReceiveSigningPublicKey)
         }
+        ZS_THROW_INVALID_ARGUMENT_IF(mReceiveSigningEd25519PublicKey)
 
         mReceiveSigningPublicKey = remotePublicKey;
 
@@ -811,6 +851,30 @@ namespace ortc
         IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
       }
 
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::setReceiveKeyingSigningPublicKey(IEd25519PublicKeyPtr remotePublicKey)
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (isShutdown()) {
+          ZS_LOG_WARNING(Detail, log("already shutdown"))
+          return;
+        }
+
+        ZS_LOG_TRACE(log("set receive keying signing public key") + IEd25519PublicKey::toDebug(remotePublicKey))
+
+        if (mReceiveSigningEd25519PublicKey) {
+          ZS_THROW_INVALID_ARGUMENT_IF(remotePublicKey != mReceiveSigningEd25519PublicKey)
+        }
+        ZS_THROW_INVALID_ARGUMENT_IF(mReceiveSigningPublicKey)
+
+        mReceiveSigningEd25519PublicKey = remotePublicKey;
+
+        setState(SessionState_Pending);
+
+        IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
+      }
+
       //-----------------------------------------------------------------------
       void MessageLayerSecurityChannel::getSendKeyingNeedingToBeSigned(
                                                                        DocumentPtr &outDocumentContainedElementToSign,
@@ -855,6 +919,7 @@ namespace ortc
         if (mSendSigningPublicKey) {
           ZS_THROW_INVALID_ARGUMENT_IF(signingPublicKey != mSendSigningPublicKey)
         }
+        ZS_THROW_INVALID_ARGUMENT_IF(mSendSigningEd25519PrivateKey)
 
         mSendSigningPrivateKey = signingPrivateKey;
         mSendSigningPublicKey = signingPublicKey;
@@ -865,6 +930,36 @@ namespace ortc
         IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
       }
 
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::notifySendKeyingSigned(
+                                                               IEd25519PrivateKeyPtr signingPrivateKey,
+                                                               IEd25519PublicKeyPtr signingPublicKey
+                                                               )
+      {
+        AutoRecursiveLock lock(*this);
+
+        if (isShutdown()) {
+          ZS_LOG_WARNING(Detail, log("already shutdown"))
+          return;
+        }
+
+        if (mSendSigningEd25519PrivateKey) {
+          ZS_THROW_INVALID_ARGUMENT_IF(signingPrivateKey != mSendSigningEd25519PrivateKey)
+        }
+        if (mSendSigningEd25519PublicKey) {
+          ZS_THROW_INVALID_ARGUMENT_IF(signingPublicKey != mSendSigningEd25519PublicKey)
+        }
+        ZS_THROW_INVALID_ARGUMENT_IF(mSendSigningPrivateKey)
+
+        mSendSigningEd25519PrivateKey = signingPrivateKey;
+        mSendSigningEd25519PublicKey = signingPublicKey;
+        mSendKeyingNeedToSignEl.reset();
+
+        setState(SessionState_Pending);
+
+        IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
+      }
+
 
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -908,6 +1003,61 @@ namespace ortc
         step();
       }
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark MessageLayerSecurityChannel => IMessageLayerSecurityChannelAsync
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::onEncodeChain(AlgorithmIndex index)
+      {
+        // NOTE: called on the services thread pool; only one pool thread owns
+        //       a chain at a time so its key context is used without the lock
+        PendingEncodePtr pending;
+
+        {
+          AutoRecursiveLock lock(*this);
+
+          EncodeChainMap::iterator found = mEncodeChains.find(index);
+          if (found == mEncodeChains.end()) {
+            ZS_LOG_TRACE(log("encode chain is gone (probably cancelled)") + ZS_PARAM("keying index", index))
+            return;
+          }
+
+          EncodeChain &chain = (*found).second;
+          ZS_THROW_BAD_STATE_IF(chain.mQueued.size() < 1)
+
+          pending = chain.mQueued.front();
+        }
+
+        SecureByteBlockPtr output = pending->mContext->encode(pending->mIndex, pending->mBuffer->BytePtr(), pending->mBuffer->SizeInBytes());
+
+        AutoRecursiveLock lock(*this);
+
+        EncodeChainMap::iterator found = mEncodeChains.find(index);
+        if (found == mEncodeChains.end()) {
+          ZS_LOG_TRACE(log("encode chain is gone (probably cancelled)") + ZS_PARAM("keying index", index))
+          return;
+        }
+
+        EncodeChain &chain = (*found).second;
+        chain.mQueued.pop_front();
+
+        pending->mOutput = output;
+        pending->mBuffer.reset();
+
+        if (chain.mQueued.size() > 0) {
+          IMessageLayerSecurityChannelAsyncProxy::create(IHelper::getServicePoolQueue(), mThisWeak.lock())->onEncodeChain(index);
+        } else {
+          chain.mBusy = false;
+        }
+
+        flushPipelinedEncodes();
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -1019,11 +1169,14 @@ namespace ortc
 
 
         IHelper::debugAppend(resultEl, "receive signing public key", IRSAPublicKey::toDebug(mReceiveSigningPublicKey));
+        IHelper::debugAppend(resultEl, "receive signing ed25519 public key", IEd25519PublicKey::toDebug(mReceiveSigningEd25519PublicKey));
         IHelper::debugAppend(resultEl, "receive signing doc", (bool)mReceiveKeyingSignedDoc);
         IHelper::debugAppend(resultEl, "receive signing element", (bool)mReceiveKeyingSignedEl);
 
         IHelper::debugAppend(resultEl, "send signing private key", IRSAPrivateKey::toDebug(mSendSigningPrivateKey));
         IHelper::debugAppend(resultEl, "send signing public key", IRSAPublicKey::toDebug(mSendSigningPublicKey));
+        IHelper::debugAppend(resultEl, "send signing ed25519 private key", IEd25519PrivateKey::toDebug(mSendSigningEd25519PrivateKey));
+        IHelper::debugAppend(resultEl, "send signing ed25519 public key", IEd25519PublicKey::toDebug(mSendSigningEd25519PublicKey));
         IHelper::debugAppend(resultEl, "send signing doc", (bool)mSendKeyingNeedingToSignDoc);
         IHelper::debugAppend(resultEl, "send signing element", (bool)mSendKeyingNeedToSignEl);
 
@@ -1051,6 +1204,12 @@ namespace ortc
         IHelper::debugAppend(resultEl, "change key", mChangeKey);
         IHelper::debugAppend(resultEl, "change send key timer", mChangeSendingKeyTimer ? mChangeSendingKeyTimer->getID() : 0);
 
+        IHelper::debugAppend(resultEl, "pipeline chains", mPipelineChains);
+        IHelper::debugAppend(resultEl, "pipeline max pending", mPipelineMaxPending);
+        IHelper::debugAppend(resultEl, "pipeline last index", mPipelineLastIndex);
+        IHelper::debugAppend(resultEl, "pending encodes", mPendingEncodes.size());
+        IHelper::debugAppend(resultEl, "encode chains", mEncodeChains.size());
+
         return resultEl;
       }
 
@@ -1118,7 +1277,7 @@ namespace ortc
         if ((mReceiveKeyingSignedDoc) &&
             (mReceiveKeyingSignedEl)) {
 
-          if (!mReceiveSigningPublicKey) {
+          if (!hasReceiveSigningPublicKey()) {
             ZS_LOG_TRACE(log("waiting for receive keying materials"))
             setState(SessionState_WaitingForNeededInformation);
             return true;
@@ -1150,7 +1309,7 @@ namespace ortc
               case KeyingType_KeyAgreement: hasReceiveInformation = hasReceiveInformation && ((bool)mDHLocalPrivateKey) && ((bool)mDHLocalPublicKey) && ((bool)mDHRemotePublicKey); break;
             }
 
-            hasReceiveInformation = hasReceiveInformation && (mReceiveSigningPublicKey);
+            hasReceiveInformation = hasReceiveInformation && hasReceiveSigningPublicKey();
 
             if (!hasReceiveInformation) {
               ZS_LOG_TRACE(log("waiting for receive keying materials"))
@@ -1217,50 +1376,35 @@ namespace ortc
             }
 
 
-            SecureByteBlockPtr integrity(make_shared<SecureByteBlock>(integritySize));
-            memcpy(integrity->BytePtr(), source, integritySize);
+            const BYTE *integrity = source;
 
             source += integritySize;
             remaining -= integritySize;
 
-            SecureByteBlock input(remaining);
-            memcpy(input.BytePtr(), source, remaining);
-
-            SecureByteBlockPtr output = IHelper::decrypt(*(keyInfo.mSendKey), *(keyInfo.mNextIV), input);
+            KeyContextPtr context = keyInfo.context();
 
-            String hashDecryptedBuffer = IHelper::convertToHex(*IHasher::hash(*output));
-
-            if (!output) {
-              ZS_LOG_ERROR(Detail, log("unable to decrypte buffer"))
-              setError(IHTTP::HTTPStatusCode_Unauthorized, "unable to decrypt buffer");
-              cancel();
-              return false;
-            }
-
-            if (ZS_IS_LOGGING(Insane)) {
-              String str = IHelper::convertToBase64(*output);
-              ZS_LOG_INSANE(log("stream buffer decrypted") + ZS_PARAM("wire in", str))
+            String debugIV;
+            if (ZS_IS_LOGGING(Debug)) {
+              debugIV = context->getNextIV();
             }
 
-            String hexIV = IHelper::convertToHex(*keyInfo.mNextIV);
-
-            SecureByteBlockPtr calculatedIntegrity = IHasher::hash(("integrity:" + IHelper::convertToHex(*IHasher::hash(*output)) + ":" + hexIV).c_str(), IHasher::hmacSHA1(*(IHelper::convertToBuffer(keyInfo.mIntegrityPassphrase))));
+            SecureByteBlockPtr output = context->decode(integrity, source, remaining);
 
             if (ZS_IS_LOGGING(Debug)) {
-              String hashEncryptedBuffer = IHelper::convertToHex(*IHasher::hash(input));
-              ZS_LOG_DEBUG(log("received data from wire") + ZS_PARAM("keying index", algorithm) + ZS_PARAM("buffer size", streamBuffer->SizeInBytes()) + ZS_PARAM("encrypted size", input.SizeInBytes()) + ZS_PARAM("decrypted size", output->SizeInBytes()) + ZS_PARAM("key", IHelper::convertToHex(*(keyInfo.mSendKey))) + ZS_PARAM("iv", hexIV) + ZS_PARAM("calculated integrity", IHelper::convertToHex(*calculatedIntegrity)) + ZS_PARAM("received integrity", IHelper::convertToHex(*integrity)) + ZS_PARAM("integrity passphrase", keyInfo.mIntegrityPassphrase) + ZS_PARAM("decrypted data hash", hashDecryptedBuffer) + ZS_PARAM("encrypted data hash", hashEncryptedBuffer))
+              ZS_LOG_DEBUG(log("received data from wire") + ZS_PARAM("keying index", algorithm) + ZS_PARAM("buffer size", streamBuffer->SizeInBytes()) + ZS_PARAM("encrypted size", remaining) + ZS_PARAM("key", IHelper::convertToHex(*(keyInfo.mSendKey))) + ZS_PARAM("iv", debugIV) + ZS_PARAM("received integrity", IHelper::convertToHex(*IHelper::convertToBuffer(integrity, integritySize))) + ZS_PARAM("integrity passphrase", keyInfo.mIntegrityPassphrase) + ZS_PARAM("valid", (bool)output))
             }
 
-            if (0 != IHelper::compare(*calculatedIntegrity, *integrity)) {
+            if (!output) {
               ZS_LOG_ERROR(Debug,log("integrity failed on packet"))
               setError(IHTTP::HTTPStatusCode_Unauthorized, "buffer is not decodable");
               cancel();
               return false;
             }
 
-            // calculate the next IV and remember the integrity field
-            keyInfo.mNextIV = IHasher::hash(hexIV + ":" + IHelper::convertToHex(*calculatedIntegrity));
-            keyInfo.mLastIntegrity = calculatedIntegrity;
+            if (ZS_IS_LOGGING(Insane)) {
+              String str = IHelper::convertToBase64(*output);
+              ZS_LOG_INSANE(log("stream buffer decrypted") + ZS_PARAM("wire in", str))
+            }
 
             mReceiveStreamDecoded->write(output, streamHeader);
 
@@ -1335,12 +1479,13 @@ namespace ortc
               mRemoteContextID = getElementTextAndDecode(keyingEl->findFirstChildElement("context"));
             }
 
-            if (!mReceiveSigningPublicKey) {
+            if (!hasReceiveSigningPublicKey()) {
               ZS_LOG_TRACE(log("waiting for receive material signing public key"))
               goto receive_waiting_for_information;
             }
 
-            if (!mReceiveSigningPublicKey->verifySignature(keyingEl)) {
+            bool verified = (mReceiveSigningEd25519PublicKey ? mReceiveSigningEd25519PublicKey->verifySignature(keyingEl) : mReceiveSigningPublicKey->verifySignature(keyingEl));
+            if (!verified) {
               ZS_LOG_ERROR(Detail, log("failed to validate receiving stream signature"))
               setError(IHTTP::HTTPStatusCode_Forbidden, "keying encoding not using expecting passphrase");
               goto receive_error_out;
@@ -1426,7 +1571,7 @@ namespace ortc
 
                 IHelper::split(remoteKey, splits, ':');
                 if (splits.size() >= 1) {
-                  namespaceStr = IHelper::convertToString(*IHelper::convertFromBase64((*(splits.find(0))).second));
+                  namespaceStr = IHelper::convertToString(*fromBase64((*(splits.find(0))).second));
 
                   IDHKeyDomainPtr keyDomain = IDHKeyDomain::loadPrecompiled(IDHKeyDomain::fromNamespace(namespaceStr));
                   if (!keyDomain) {
@@ -1450,8 +1595,8 @@ namespace ortc
                   String staticPublicKeyStr = (*(splits.find(1))).second;
                   String ephemeralPublicKeyStr = (*(splits.find(2))).second;
 
-                  SecureByteBlockPtr staticPublicKey = IHelper::convertFromBase64(staticPublicKeyStr);
-                  SecureByteBlockPtr ephemeralPublicKey = IHelper::convertFromBase64(ephemeralPublicKeyStr);
+                  SecureByteBlockPtr staticPublicKey = fromBase64(staticPublicKeyStr);
+                  SecureByteBlockPtr ephemeralPublicKey = fromBase64(ephemeralPublicKeyStr);
 
                   if ((IHelper::hasData(staticPublicKey)) &&
                       (IHelper::hasData(ephemeralPublicKey))) {
@@ -1591,6 +1736,21 @@ namespace ortc
 
             // scope: extract out latest keying material
             {
+              struct ReceivedKey
+              {
+                AlgorithmIndex mIndex {};
+                KeyInfo mKey;
+                SecureByteBlockPtr mIntegrityPassphrase;
+
+                IRSABatch::OperationIndex mSecretOperation {};
+                IRSABatch::OperationIndex mIVOperation {};
+                IRSABatch::OperationIndex mIntegrityOperation {};
+              };
+              typedef std::list<ReceivedKey> ReceivedKeyList;
+
+              ReceivedKeyList receivedKeys;
+              IRSABatchPtr batch;   // private key decrypts for every key are performed in parallel
+
               ElementPtr keysEl = keyingEl->findFirstChildElement("keys");
               ElementPtr keyEl = ((bool)keysEl) ? keysEl->findFirstChildElementChecked("key") : ElementPtr();
               while (keyEl) {
@@ -1616,35 +1776,56 @@ namespace ortc
 
                   ElementPtr inputs = keyEl->findFirstChildElementChecked("inputs");
 
-                  KeyInfo key;
-                  SecureByteBlockPtr integrityPassphrase;
+                  ReceivedKey received;
+                  received.mIndex = index;
                   if (KeyingType_PublicKey == mReceiveKeyingType) {
                     // base64(rsa_encrypt(`<remote-public-key>`, `<value>`))
-                    key.mSendKey = mReceiveLocalPrivateKey->decrypt(*IHelper::convertFromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("secret"))));
-                    key.mNextIV = mReceiveLocalPrivateKey->decrypt(*IHelper::convertFromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("iv"))));
-                    integrityPassphrase = mReceiveLocalPrivateKey->decrypt(*IHelper::convertFromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("hmacIntegrityKey"))));
+                    if (!batch) batch = IRSABatch::create();
+                    received.mSecretOperation = batch->decrypt(mReceiveLocalPrivateKey, *fromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("secret"))));
+                    received.mIVOperation = batch->decrypt(mReceiveLocalPrivateKey, *fromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("iv"))));
+                    received.mIntegrityOperation = batch->decrypt(mReceiveLocalPrivateKey, *fromBase64(getElementTextAndDecode(inputs->findFirstChildElementChecked("hmacIntegrityKey"))));
                   } else {
-                    key.mSendKey = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("secret")));
-                    key.mNextIV = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("iv")));
-                    integrityPassphrase = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("hmacIntegrityKey")));
-                  }
-                  if (integrityPassphrase) {
-                    key.mIntegrityPassphrase = IHelper::convertToString(*integrityPassphrase);
+                    received.mKey.mSendKey = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("secret")));
+                    received.mKey.mNextIV = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("iv")));
+                    received.mIntegrityPassphrase = decryptUsingPassphraseEncoding(decodingPassphrase, nonce, getElementTextAndDecode(inputs->findFirstChildElementChecked("hmacIntegrityKey")));
                   }
-                  if ((IHelper::isEmpty(key.mSendKey)) ||
-                      (IHelper::isEmpty(key.mNextIV)) ||
-                      (key.mIntegrityPassphrase.isEmpty())) {
-                    ZS_LOG_WARNING(Detail, log("algorithm missing vital secret, iv or integrity information") + ZS_PARAM("index", index))
-                    goto next_key;
-                  }
-
-                  ZS_LOG_DEBUG(log("receive algorithm keying information") + key.toDebug(index))
-                  mReceiveKeys[index] = key;
+                  receivedKeys.push_back(received);
                 }
 
               next_key:
                 keyEl = keyEl->findNextSiblingElement("key");
               }
+
+              if (batch) {
+                ZS_LOG_TRACE(log("waiting for keying decrypts to complete") + ZS_PARAM("operations", batch->getTotalOperations()))
+                batch->wait();
+
+                for (auto iter = receivedKeys.begin(); iter != receivedKeys.end(); ++iter) {
+                  auto &received = (*iter);
+                  received.mKey.mSendKey = batch->getResult(received.mSecretOperation);
+                  received.mKey.mNextIV = batch->getResult(received.mIVOperation);
+                  received.mIntegrityPassphrase = batch->getResult(received.mIntegrityOperation);
+                }
+              }
+
+              for (auto iter = receivedKeys.begin(); iter != receivedKeys.end(); ++iter) {
+                auto &received = (*iter);
+                KeyInfo &key = received.mKey;
+
+                if (received.mIntegrityPassphrase) {
+                  key.mIntegrityPassphrase = IHelper::convertToString(*received.mIntegrityPassphrase);
+                }
+                if ((IHelper::isEmpty(key.mSendKey)) ||
+                    (IHelper::isEmpty(key.mNextIV)) ||
+                    (key.mNextIV->SizeInBytes() < KeyContext::MinIVSize) ||
+                    (key.mIntegrityPassphrase.isEmpty())) {
+                  ZS_LOG_WARNING(Detail, log("algorithm missing vital secret, iv or integrity information") + ZS_PARAM("index", received.mIndex))
+                  continue;
+                }
+
+                ZS_LOG_DEBUG(log("receive algorithm keying information") + key.toDebug(received.mIndex))
+                mReceiveKeys[received.mIndex] = key;
+              }
             }
 
           } catch(CheckFailed &) {
@@ -1753,6 +1934,12 @@ namespace ortc
           return true;
         }
 
+        if (mPendingEncodes.size() > 0) {
+          // new keying must not overtake messages encoded with the previous keys
+          ZS_LOG_TRACE(log("waiting for pipelined messages to flush before sending new keying") + ZS_PARAM("pending", mPendingEncodes.size()))
+          return false;
+        }
+
         if ((!mChangeSendingKeyTimer) &&
             (KeyingType_KeyAgreement == mSendKeyingType)) {
           mChangeSendingKeyTimer = ITimer::create(mThisWeak.lock(), Seconds(ISettings::getUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_CHANGE_SENDING_KEY_AFTER)));
@@ -1885,7 +2072,10 @@ namespace ortc
         if (createKeys) {
           ElementPtr keysEl = Element::create("keys");
 
-          for (AlgorithmIndex index = 1; index <= ORTC_SERVICES_MESSAGE_LAYER_SECURITY_DEFAULT_TOTAL_SEND_KEYS; ++index) {
+          AlgorithmIndex totalKeys = ORTC_SERVICES_MESSAGE_LAYER_SECURITY_DEFAULT_TOTAL_SEND_KEYS;
+          if (mPipelineChains > totalKeys) totalKeys = mPipelineChains;
+
+          for (AlgorithmIndex index = 1; index <= totalKeys; ++index) {
             KeyInfo key;
 
             key.mIntegrityPassphrase = IHelper::randomString((20*8/5));
@@ -1908,7 +2098,7 @@ namespace ortc
               inputsEl->adoptAsLastChild(createElementWithText("hmacIntegrityKey", IHelper::convertToBase64(*mSendRemotePublicKey->encrypt(*IHelper::convertToBuffer(key.mIntegrityPassphrase)))));
             }
 
-            ZS_LOG_DEBUG(log("send algorithm keying information") + key.toDebug(index))
+            ZS_LOG_DEBUG(log("send algorithm keying information") + key.toDebug(index, isEncoding(index)))
 
             keyEl->adoptAsLastChild(inputsEl);
 
@@ -1926,8 +2116,11 @@ namespace ortc
         mSendKeyingNeedingToSignDoc->adoptAsLastChild(keyingBundleEl);
         mSendKeyingNeedToSignEl = keyingEl;
 
-        if ((mSendSigningPrivateKey) &&
-            (mSendSigningPublicKey)) {
+        bool hasRSASigningKey = (mSendSigningPrivateKey) && (mSendSigningPublicKey);
+        bool hasEd25519SigningKey = (mSendSigningEd25519PrivateKey) && (mSendSigningEd25519PublicKey);
+
+        if ((hasRSASigningKey) ||
+            (hasEd25519SigningKey)) {
 
           ZS_LOG_DEBUG(log("auto-signing sending keying material (via fingerprint)"))
 
@@ -1938,24 +2131,28 @@ namespace ortc
 
           String referenceID = "#" + id;
 
-          GeneratorPtr generator = Generator::createJSONGenerator();
-
-          ElementPtr canonicalJSONEl = IHelper::cloneAsCanonicalJSON(elementToSign);
-          std::unique_ptr<char[]> elementAsJSON = generator->write(canonicalJSONEl);
-
-          SecureByteBlockPtr elementHash = IHasher::hash(elementAsJSON.get(), IHasher::sha1());
+          SecureByteBlockPtr elementHash = IHelper::hashCanonicalJSON(elementToSign);
 
           ElementPtr signatureEl = Element::create("signature");
 
           signatureEl->adoptAsLastChild(createElementWithText("reference", referenceID));
-          signatureEl->adoptAsLastChild(createElementWithText("algorithm", ORTC_SERVICES_MESSAGE_LAYER_SECURITY_SIGNATURE_ALGORITHM));
-          signatureEl->adoptAsLastChild(createElementWithText("digestValue", IHelper::convertToBase64(*elementHash)));
-          signatureEl->adoptAsLastChild(createElementWithText("digestSigned", IHelper::convertToBase64(*mSendSigningPrivateKey->sign(*elementHash))));
+          if (hasEd25519SigningKey) {
+            signatureEl->adoptAsLastChild(createElementWithText("algorithm", ORTC_SERVICES_MESSAGE_LAYER_SECURITY_SIGNATURE_ALGORITHM_ED25519));
+            signatureEl->adoptAsLastChild(createElementWithText("digestValue", IHelper::convertToBase64(*elementHash)));
+            signatureEl->adoptAsLastChild(createElementWithText("digestSigned", IHelper::convertToBase64(*mSendSigningEd25519PrivateKey->sign(*elementHash))));
+          } else {
+            signatureEl->adoptAsLastChild(createElementWithText("algorithm", ORTC_SERVICES_MESSAGE_LAYER_SECURITY_SIGNATURE_ALGORITHM));
+            signatureEl->adoptAsLastChild(createElementWithText("digestValue", IHelper::convertToBase64(*elementHash)));
+            signatureEl->adoptAsLastChild(createElementWithText("digestSigned", IHelper::convertToBase64(*mSendSigningPrivateKey->sign(*elementHash))));
+          }
 
           ElementPtr keyEl = Element::create("key");
 
-          ElementPtr fingerprintEl = createElementWithText("fingerprint", mSendSigningPublicKey->getFingerprint());
+          ElementPtr fingerprintEl = createElementWithText("fingerprint", hasEd25519SigningKey ? mSendSigningEd25519PublicKey->getFingerprint() : mSendSigningPublicKey->getFingerprint());
           keyEl->adoptAsLastChild(fingerprintEl);
+          signatureEl->adoptAsLastChild(keyEl);
+
+          elementToSign->adoptAsNextSibling(signatureEl);
 
           mSendKeyingNeedToSignEl.reset();
           IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
@@ -1981,6 +2178,8 @@ namespace ortc
           return true;
         }
 
+        if (isPipelining()) return stepSendPipelined();
+
         while (mSendStreamDecoded->getTotalReadBuffersAvailable() > 0) {
           StreamHeaderPtr header;
           SecureByteBlockPtr buffer = mSendStreamDecoded->read(&header);
@@ -2000,29 +2199,16 @@ namespace ortc
 
           KeyInfo &keyInfo = (*found).second;
 
-          ZS_LOG_INSANE(log("encrypting key to use") + keyInfo.toDebug(index))
-
-          SecureByteBlockPtr encrypted = IHelper::encrypt(*(keyInfo.mSendKey), *(keyInfo.mNextIV), *buffer);
-
-          String hexIV = IHelper::convertToHex(*keyInfo.mNextIV);
+          ZS_LOG_INSANE(log("encrypting key to use") + keyInfo.toDebug(index, isEncoding(index)))
 
-          String hashDecryptedBuffer = IHelper::convertToHex(*IHasher::hash(*buffer));
+          KeyContextPtr context = keyInfo.context();
 
-          SecureByteBlockPtr calculatedIntegrity = IHasher::hash(("integrity:" + hashDecryptedBuffer + ":" + hexIV).c_str(), IHasher::hmacSHA1(*(IHelper::convertToBuffer(keyInfo.mIntegrityPassphrase))));
-
-          // calculate the next IV and remember the integrity field
-          keyInfo.mNextIV = IHasher::hash(hexIV + ":" + IHelper::convertToHex(*calculatedIntegrity));
-          keyInfo.mLastIntegrity = calculatedIntegrity;
-
-          SecureByteBlockPtr output(make_shared<SecureByteBlock>(sizeof(DWORD) + calculatedIntegrity->SizeInBytes() + encrypted->SizeInBytes()));
-
-          IHelper::setBE32(output->BytePtr(), static_cast<DWORD>(index));
-
-          BYTE *integrityPos = (output->BytePtr() + sizeof(DWORD));
-          BYTE *outputPos = (integrityPos + calculatedIntegrity->SizeInBytes());
+          String debugIV;
+          if (ZS_IS_LOGGING(Debug)) {
+            debugIV = context->getNextIV();
+          }
 
-          memcpy(integrityPos, calculatedIntegrity->BytePtr(), calculatedIntegrity->SizeInBytes());
-          memcpy(outputPos, encrypted->BytePtr(), encrypted->SizeInBytes());
+          SecureByteBlockPtr output = context->encode(index, buffer->BytePtr(), buffer->SizeInBytes());
 
           if (ZS_IS_LOGGING(Insane)) {
             String str = IHelper::convertToBase64(*output);
@@ -2030,8 +2216,7 @@ namespace ortc
           }
 
           if (ZS_IS_LOGGING(Debug)) {
-            String hashEncryptedBuffer = IHelper::convertToHex(*IHasher::hash(*encrypted));
-            ZS_LOG_DEBUG(log("sending data on wire") + ZS_PARAM("keying index", index) + ZS_PARAM("buffer size", output->SizeInBytes()) + ZS_PARAM("decrypted size", buffer->SizeInBytes()) + ZS_PARAM("encrypted size", encrypted->SizeInBytes()) + ZS_PARAM("key", IHelper::convertToHex(*(keyInfo.mSendKey))) + ZS_PARAM("iv", hexIV) + ZS_PARAM("integrity", IHelper::convertToHex(*calculatedIntegrity)) + ZS_PARAM("integrity passphrase", keyInfo.mIntegrityPassphrase) + ZS_PARAM("decrypted data hash", hashDecryptedBuffer) + ZS_PARAM("encrypted data hash", hashEncryptedBuffer));
+            ZS_LOG_DEBUG(log("sending data on wire") + ZS_PARAM("keying index", index) + ZS_PARAM("buffer size", output->SizeInBytes()) + ZS_PARAM("decrypted size", buffer->SizeInBytes()) + ZS_PARAM("key", IHelper::convertToHex(*(keyInfo.mSendKey))) + ZS_PARAM("iv", debugIV) + ZS_PARAM("integrity", context->getLastIntegrity()) + ZS_PARAM("integrity passphrase", keyInfo.mIntegrityPassphrase));
           }
           mSendStreamEncoded->write(output, header);
         }
@@ -2039,6 +2224,85 @@ namespace ortc
         return true;
       }
 
+      //-----------------------------------------------------------------------
+      bool MessageLayerSecurityChannel::stepSendPipelined()
+      {
+        while (mSendStreamDecoded->getTotalReadBuffersAvailable() > 0) {
+          if (mPendingEncodes.size() >= mPipelineMaxPending) {
+            ZS_LOG_TRACE(log("pipeline is full (will resume as encoded messages flush)") + ZS_PARAM("pending", mPendingEncodes.size()))
+            return true;
+          }
+
+          StreamHeaderPtr header;
+          SecureByteBlockPtr buffer = mSendStreamDecoded->read(&header);
+
+          ZS_THROW_BAD_STATE_IF(!buffer)
+
+          // key chains are assigned round-robin so every chain stays busy
+          mPipelineLastIndex = (mPipelineLastIndex % static_cast<AlgorithmIndex>(mSendKeys.size())) + 1;
+
+          KeyMap::iterator found = mSendKeys.find(mPipelineLastIndex);
+          ZS_THROW_BAD_STATE_IF(found == mSendKeys.end())
+
+          PendingEncodePtr pending(make_shared<PendingEncode>());
+          pending->mIndex = mPipelineLastIndex;
+          pending->mContext = (*found).second.context();
+          pending->mBuffer = buffer;
+          pending->mHeader = header;
+
+          mPendingEncodes.push_back(pending);
+
+          EncodeChain &chain = mEncodeChains[pending->mIndex];
+          chain.mQueued.push_back(pending);
+
+          ZS_LOG_INSANE(log("queued message for pipelined encoding") + ZS_PARAM("keying index", pending->mIndex) + ZS_PARAM("size", buffer->SizeInBytes()) + ZS_PARAM("chain queued", chain.mQueued.size()) + ZS_PARAM("pending", mPendingEncodes.size()))
+
+          if (!chain.mBusy) {
+            chain.mBusy = true;
+            IMessageLayerSecurityChannelAsyncProxy::create(IHelper::getServicePoolQueue(), mThisWeak.lock())->onEncodeChain(pending->mIndex);
+          }
+        }
+
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      bool MessageLayerSecurityChannel::isEncoding(AlgorithmIndex index) const
+      {
+        EncodeChainMap::const_iterator found = mEncodeChains.find(index);
+        if (found == mEncodeChains.end()) return false;
+        return (*found).second.mBusy;
+      }
+
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::flushPipelinedEncodes()
+      {
+        bool wasFull = (mPendingEncodes.size() >= mPipelineMaxPending);
+        bool flushed = false;
+
+        while (mPendingEncodes.size() > 0) {
+          PendingEncodePtr pending = mPendingEncodes.front();
+          if (!pending->mOutput) break;
+
+          if (ZS_IS_LOGGING(Insane)) {
+            String str = IHelper::convertToBase64(*(pending->mOutput));
+            ZS_LOG_INSANE(log("stream buffer write") + ZS_PARAM("keying index", pending->mIndex) + ZS_PARAM("wire out", str))
+          }
+
+          mSendStreamEncoded->write(pending->mOutput, pending->mHeader);
+          mPendingEncodes.pop_front();
+          flushed = true;
+        }
+
+        if (!flushed) return;
+
+        if ((wasFull) ||
+            (mPendingEncodes.size() < 1)) {
+          // resume reading the decoded stream or continue a waiting key change
+          IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
+        }
+      }
+
       //-----------------------------------------------------------------------
       bool MessageLayerSecurityChannel::stepCheckConnected()
       {
@@ -2106,18 +2370,186 @@ namespace ortc
       #pragma mark
 
       //-----------------------------------------------------------------------
-      ElementPtr MessageLayerSecurityChannel::KeyInfo::toDebug(AlgorithmIndex index) const
+      MessageLayerSecurityChannel::KeyContextPtr MessageLayerSecurityChannel::KeyInfo::context()
+      {
+        if (mContext) return mContext;
+
+        ZS_THROW_BAD_STATE_IF(!mSendKey)
+        ZS_THROW_BAD_STATE_IF(!mNextIV)
+
+        mContext = make_shared<KeyContext>(*mSendKey, *mNextIV, mIntegrityPassphrase);
+        return mContext;
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr MessageLayerSecurityChannel::KeyInfo::toDebug(
+                                                               AlgorithmIndex index,
+                                                               bool encoding
+                                                               ) const
       {
         ElementPtr resultEl = Element::create("MessageLayerSecurityChannel");
 
         IHelper::debugAppend(resultEl, "key index", index);
         IHelper::debugAppend(resultEl, "integrity passphrase", mIntegrityPassphrase);
         IHelper::debugAppend(resultEl, "send key", mSendKey ? IHelper::convertToHex(*mSendKey) : String());
-        IHelper::debugAppend(resultEl, "next iv", mNextIV ? IHelper::convertToHex(*mNextIV) : String());
-        IHelper::debugAppend(resultEl, "last integrity", mLastIntegrity ? IHelper::convertToHex(*mLastIntegrity) : String());
+        if (encoding) {
+          // the IV and integrity are being advanced by a pool thread
+          IHelper::debugAppend(resultEl, "encoding", true);
+        } else if (mContext) {
+          IHelper::debugAppend(resultEl, "next iv", mContext->getNextIV());
+          IHelper::debugAppend(resultEl, "last integrity", mContext->getLastIntegrity());
+        } else {
+          IHelper::debugAppend(resultEl, "next iv", mNextIV ? IHelper::convertToHex(*mNextIV) : String());
+          IHelper::debugAppend(resultEl, "last integrity", mLastIntegrity ? IHelper::convertToHex(*mLastIntegrity) : String());
+        }
         return resultEl;
       }
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark MessageLayerSecurityChannel::KeyContext
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      MessageLayerSecurityChannel::KeyContext::KeyContext(
+                                                          const SecureByteBlock &key,
+                                                          const SecureByteBlock &iv,
+                                                          const String &integrityPassphrase
+                                                          ) :
+        mIV(iv),
+        mHexIV(iv.SizeInBytes()*2)
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(iv.SizeInBytes() < MinIVSize)
+
+        mEncryption.SetKeyWithIV(key, key.SizeInBytes(), mIV);
+        mDecryption.SetKeyWithIV(key, key.SizeInBytes(), mIV);
+        mIntegrity.SetKey(reinterpret_cast<const BYTE *>(integrityPassphrase.c_str()), integrityPassphrase.length());
+
+        toLowerHex(mIV.BytePtr(), mIV.SizeInBytes(), mHexIV.BytePtr());
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr MessageLayerSecurityChannel::KeyContext::encode(
+                                                                         AlgorithmIndex index,
+                                                                         const BYTE *buffer,
+                                                                         size_t bufferSizeInBytes
+                                                                         )
+      {
+        // wire format: index + hmac("integrity:" + hex(sha1(data)) + ":" + hex(iv)) + encrypt(data)
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>(headerSize() + bufferSizeInBytes));
+
+        BYTE *indexPos = output->BytePtr();
+        BYTE *integrityPos = indexPos + sizeof(DWORD);
+        BYTE *encryptedPos = integrityPos + IntegritySize;
+
+        IHelper::setBE32(indexPos, static_cast<DWORD>(index));
+
+        mEncryption.Resynchronize(mIV);
+        if (bufferSizeInBytes > 0) {
+          mEncryption.ProcessData(encryptedPos, buffer, bufferSizeInBytes);
+        }
+
+        calculateIntegrity(buffer, bufferSizeInBytes, integrityPos);
+        advanceIV(integrityPos);
+
+        return output;
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr MessageLayerSecurityChannel::KeyContext::decode(
+                                                                         const BYTE *integrity,
+                                                                         const BYTE *buffer,
+                                                                         size_t bufferSizeInBytes
+                                                                         )
+      {
+        SecureByteBlockPtr output(make_shared<SecureByteBlock>(bufferSizeInBytes));
+
+        mDecryption.Resynchronize(mIV);
+        if (bufferSizeInBytes > 0) {
+          mDecryption.ProcessData(output->BytePtr(), buffer, bufferSizeInBytes);
+        }
+
+        BYTE calculated[IntegritySize] {};
+        calculateIntegrity(output->BytePtr(), bufferSizeInBytes, &(calculated[0]));
+
+        if (!CryptoPP::VerifyBufsEqual(&(calculated[0]), integrity, IntegritySize)) return SecureByteBlockPtr();
+
+        advanceIV(&(calculated[0]));
+        return output;
+      }
+
+      //-----------------------------------------------------------------------
+      String MessageLayerSecurityChannel::KeyContext::getNextIV() const
+      {
+        return String(std::string(reinterpret_cast<const char *>(mHexIV.BytePtr()), mHexIV.SizeInBytes()));
+      }
+
+      //-----------------------------------------------------------------------
+      String MessageLayerSecurityChannel::KeyContext::getLastIntegrity() const
+      {
+        if (!mHasLastIntegrity) return String();
+
+        char hex[sizeof(mLastIntegrity) * 2] {};
+        size_t length = IHelper::convertToHex(&(mLastIntegrity[0]), sizeof(mLastIntegrity), &(hex[0]), sizeof(hex));
+        return String(std::string(&(hex[0]), length));
+      }
+
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::KeyContext::calculateIntegrity(
+                                                                       const BYTE *decrypted,
+                                                                       size_t decryptedSizeInBytes,
+                                                                       BYTE *outIntegrity
+                                                                       )
+      {
+        static const char *prefix = "integrity:";
+        static const char *separator = ":";
+
+        BYTE digest[Hasher::DIGESTSIZE] {};
+        BYTE hexDigest[Hasher::DIGESTSIZE*2] {};
+
+        mHasher.CalculateDigest(&(digest[0]), decrypted, decryptedSizeInBytes);
+        toLowerHex(&(digest[0]), sizeof(digest), &(hexDigest[0]));
+
+        // the HMAC restarts with the same key after every Final() so the
+        // key schedule is only ever computed once per key
+        mIntegrity.Update(reinterpret_cast<const BYTE *>(prefix), strlen(prefix));
+        mIntegrity.Update(&(hexDigest[0]), sizeof(hexDigest));
+        mIntegrity.Update(reinterpret_cast<const BYTE *>(separator), strlen(separator));
+        mIntegrity.Update(mHexIV.BytePtr(), mHexIV.SizeInBytes());
+        mIntegrity.Final(outIntegrity);
+      }
+
+      //-----------------------------------------------------------------------
+      void MessageLayerSecurityChannel::KeyContext::advanceIV(const BYTE *integrity)
+      {
+        static const char *separator = ":";
+
+        BYTE hexIntegrity[IntegritySize*2] {};
+        toLowerHex(integrity, IntegritySize, &(hexIntegrity[0]));
+
+        // next iv = sha1(hex(iv) + ":" + hex(integrity))
+        BYTE nextIV[Hasher::DIGESTSIZE] {};
+        mHasher.Update(mHexIV.BytePtr(), mHexIV.SizeInBytes());
+        mHasher.Update(reinterpret_cast<const BYTE *>(separator), strlen(separator));
+        mHasher.Update(&(hexIntegrity[0]), sizeof(hexIntegrity));
+        mHasher.Final(&(nextIV[0]));
+
+        if (mIV.SizeInBytes() != sizeof(nextIV)) {
+          // only the initial IV can differ in size (after which the IV is always a SHA1 digest)
+          mIV.CleanNew(sizeof(nextIV));
+          mHexIV.CleanNew(sizeof(nextIV)*2);
+        }
+
+        memcpy(mIV.BytePtr(), &(nextIV[0]), sizeof(nextIV));
+        toLowerHex(mIV.BytePtr(), mIV.SizeInBytes(), mHexIV.BytePtr());
+
+        memcpy(&(mLastIntegrity[0]), integrity, IntegritySize);
+        mHasLastIntegrity = true;
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
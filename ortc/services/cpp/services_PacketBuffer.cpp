@@ -0,0 +1,93 @@
+/*
+
+ Copyright (c) 2014, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/PacketBuffer.h>
+
+#include <zsLib/Exception.h>
+
+namespace ortc
+{
+  namespace services
+  {
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark PacketBuffer
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    PacketBufferPtr PacketBuffer::create(
+                                         size_t sizeInBytes,
+                                         size_t headroomInBytes,
+                                         size_t tailroomInBytes
+                                         )
+    {
+      PacketBufferPtr pThis(new PacketBuffer);
+      pThis->mBuffer.CleanNew(headroomInBytes + sizeInBytes + tailroomInBytes);
+      pThis->mHeadroom = headroomInBytes;
+      pThis->mSize = sizeInBytes;
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    PacketBufferPtr PacketBuffer::create(
+                                         const BYTE *buffer,
+                                         size_t bufferLengthInBytes,
+                                         size_t headroomInBytes,
+                                         size_t tailroomInBytes
+                                         )
+    {
+      ZS_THROW_INVALID_ARGUMENT_IF((NULL == buffer) && (0 != bufferLengthInBytes))
+
+      PacketBufferPtr pThis = create(bufferLengthInBytes, headroomInBytes, tailroomInBytes);
+      if (0 != bufferLengthInBytes) {
+        memcpy(pThis->data(), buffer, bufferLengthInBytes);
+      }
+      return pThis;
+    }
+
+    //-------------------------------------------------------------------------
+    BYTE *PacketBuffer::reserveHeadroom(size_t sizeInBytes)
+    {
+      if (sizeInBytes > mHeadroom) return NULL;
+      return data() - sizeInBytes;
+    }
+
+    //-------------------------------------------------------------------------
+    BYTE *PacketBuffer::reserveTailroom(size_t sizeInBytes)
+    {
+      if (sizeInBytes > tailroom()) return NULL;
+      return data() + mSize;
+    }
+  }
+}
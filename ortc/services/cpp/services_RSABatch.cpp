@@ -0,0 +1,429 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_RSABatch.h>
+#include <ortc/services/internal/services_Helper.h>
+#include <ortc/services/IRSAPrivateKey.h>
+#include <ortc/services/IRSAPublicKey.h>
+
+#include <zsLib/Event.h>
+#include <zsLib/XML.h>
+#include <zsLib/Log.h>
+#include <zsLib/Stringize.h>
+#include <zsLib/helpers.h>
+
+namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      //-----------------------------------------------------------------------
+      static SecureByteBlockPtr copyBuffer(const SecureByteBlock &buffer)
+      {
+        return make_shared<SecureByteBlock>(buffer.BytePtr(), buffer.SizeInBytes());
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSABatch
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      RSABatch::RSABatch(const make_private &) :
+        mCompletedEvent(Event::create())
+      {
+        ZS_LOG_DEBUG(log("created"))
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::~RSABatch()
+      {
+        if(isNoop()) return;
+
+        mThisWeak.reset();
+        ZS_LOG_DEBUG(log("destroyed"))
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatchPtr RSABatch::convert(IRSABatchPtr batch)
+      {
+        return ZS_DYNAMIC_PTR_CAST(RSABatch, batch);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSABatch => IRSABatch
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      ElementPtr RSABatch::toDebug(IRSABatchPtr batch)
+      {
+        if (!batch) return ElementPtr();
+        return convert(batch)->toDebug();
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatchPtr RSABatch::create()
+      {
+        RSABatchPtr pThis(make_shared<RSABatch>(make_private{}));
+        pThis->mThisWeak = pThis;
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::OperationIndex RSABatch::sign(
+                                              IRSAPrivateKeyPtr key,
+                                              const SecureByteBlock &inBufferToSign
+                                              )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!key)
+
+        OperationPtr operation(make_shared<Operation>());
+        operation->mOperation = Operation_Sign;
+        operation->mPrivateKey = key;
+        operation->mInput = copyBuffer(inBufferToSign);
+        return add(operation);
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::OperationIndex RSABatch::decrypt(
+                                                 IRSAPrivateKeyPtr key,
+                                                 const SecureByteBlock &buffer
+                                                 )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!key)
+
+        OperationPtr operation(make_shared<Operation>());
+        operation->mOperation = Operation_Decrypt;
+        operation->mPrivateKey = key;
+        operation->mInput = copyBuffer(buffer);
+        return add(operation);
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::OperationIndex RSABatch::verify(
+                                                IRSAPublicKeyPtr key,
+                                                const SecureByteBlock &inOriginalBufferSigned,
+                                                const SecureByteBlock &inSignature
+                                                )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!key)
+
+        OperationPtr operation(make_shared<Operation>());
+        operation->mOperation = Operation_Verify;
+        operation->mPublicKey = key;
+        operation->mInput = copyBuffer(inOriginalBufferSigned);
+        operation->mSignature = copyBuffer(inSignature);
+        return add(operation);
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::OperationIndex RSABatch::encrypt(
+                                                 IRSAPublicKeyPtr key,
+                                                 const SecureByteBlock &buffer
+                                                 )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!key)
+
+        OperationPtr operation(make_shared<Operation>());
+        operation->mOperation = Operation_Encrypt;
+        operation->mPublicKey = key;
+        operation->mInput = copyBuffer(buffer);
+        return add(operation);
+      }
+
+      //-----------------------------------------------------------------------
+      size_t RSABatch::getTotalOperations() const
+      {
+        AutoLock lock(mLock);
+        return mOperations.size();
+      }
+
+      //-----------------------------------------------------------------------
+      void RSABatch::process(IRSABatchDelegatePtr delegate)
+      {
+        size_t total = 0;
+
+        {
+          AutoLock lock(mLock);
+
+          if (mProcessing) {
+            ZS_LOG_WARNING(Detail, log("batch is already being processed"))
+            return;
+          }
+
+          mProcessing = true;
+          total = mOperations.size();
+
+          if (delegate) {
+            mDelegate = IRSABatchDelegateProxy::create(delegate);
+          }
+
+          ZS_LOG_DEBUG(log("processing batch") + ZS_PARAM("operations", total))
+
+          if (0 == total) {
+            delegate = mDelegate;
+            mDelegate.reset();
+          }
+        }
+
+        if (0 == total) {
+          mCompletedEvent->notify();
+          if (delegate) {
+            delegate->onRSABatchCompleted(mThisWeak.lock());
+          }
+          return;
+        }
+
+        for (OperationIndex index = 0; index < total; ++index) {
+          IRSABatchAsyncProxy::create(IHelper::getServicePoolQueue(), mThisWeak.lock())->onPerformOperation(index);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void RSABatch::wait()
+      {
+        size_t total = 0;
+        bool needsProcessing = false;
+
+        {
+          AutoLock lock(mLock);
+          needsProcessing = !mProcessing;
+          total = mOperations.size();
+        }
+
+        if (needsProcessing) process(IRSABatchDelegatePtr());
+
+        // pool workers pick up operations from the front so the waiting
+        // thread works from the back to avoid contending for the same ones
+        for (OperationIndex index = total; index > 0; --index) {
+          perform(index - 1);
+        }
+
+        mCompletedEvent->wait();
+      }
+
+      //-----------------------------------------------------------------------
+      bool RSABatch::isComplete() const
+      {
+        AutoLock lock(mLock);
+        return ((mProcessing) &&
+                (mCompleted == mOperations.size()));
+      }
+
+      //-----------------------------------------------------------------------
+      SecureByteBlockPtr RSABatch::getResult(OperationIndex index) const
+      {
+        AutoLock lock(mLock);
+        if (index >= mOperations.size()) return SecureByteBlockPtr();
+        return mOperations[index]->mResult;
+      }
+
+      //-----------------------------------------------------------------------
+      bool RSABatch::getVerified(OperationIndex index) const
+      {
+        AutoLock lock(mLock);
+        if (index >= mOperations.size()) return false;
+        return mOperations[index]->mVerified;
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSABatch => IRSABatchAsync
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      void RSABatch::onPerformOperation(OperationIndex index)
+      {
+        perform(index);
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSABatch => (internal)
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      Log::Params RSABatch::log(const char *message) const
+      {
+        ElementPtr objectEl = Element::create("RSABatch");
+        IHelper::debugAppend(objectEl, "id", mID);
+        return Log::Params(message, objectEl);
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr RSABatch::toDebug() const
+      {
+        AutoLock lock(mLock);
+
+        ElementPtr resultEl = Element::create("RSABatch");
+
+        IHelper::debugAppend(resultEl, "id", mID);
+        IHelper::debugAppend(resultEl, "operations", mOperations.size());
+        IHelper::debugAppend(resultEl, "processing", mProcessing);
+        IHelper::debugAppend(resultEl, "completed", mCompleted);
+        IHelper::debugAppend(resultEl, "delegate", (bool)mDelegate);
+
+        return resultEl;
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatch::OperationIndex RSABatch::add(OperationPtr operation)
+      {
+        AutoLock lock(mLock);
+        ZS_THROW_INVALID_USAGE_IF(mProcessing)
+
+        mOperations.push_back(operation);
+        return mOperations.size() - 1;
+      }
+
+      //-----------------------------------------------------------------------
+      void RSABatch::perform(OperationIndex index)
+      {
+        OperationPtr operation;
+
+        {
+          AutoLock lock(mLock);
+          if (index >= mOperations.size()) return;
+          operation = mOperations[index];
+        }
+
+        // whichever thread claims the operation first performs it
+        if (operation->mClaimed.exchange(true)) return;
+
+        SecureByteBlockPtr result;
+        bool verified = false;
+
+        switch (operation->mOperation) {
+          case Operation_Sign:    result = operation->mPrivateKey->sign(*operation->mInput); break;
+          case Operation_Decrypt: result = operation->mPrivateKey->decrypt(*operation->mInput); break;
+          case Operation_Encrypt: result = operation->mPublicKey->encrypt(*operation->mInput); break;
+          case Operation_Verify:  verified = operation->mPublicKey->verify(*operation->mInput, *operation->mSignature); break;
+        }
+
+        IRSABatchDelegatePtr delegate;
+        bool completed = false;
+
+        {
+          AutoLock lock(mLock);
+
+          operation->mResult = result;
+          operation->mVerified = verified;
+
+          ++mCompleted;
+          if (mCompleted == mOperations.size()) {
+            ZS_LOG_TRACE(log("batch completed") + ZS_PARAM("operations", mCompleted))
+            completed = true;
+            delegate = mDelegate;
+            mDelegate.reset();
+          }
+        }
+
+        if (!completed) return;
+
+        mCompletedEvent->notify();
+        if (delegate) {
+          delegate->onRSABatchCompleted(mThisWeak.lock());
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IRSABatchFactory
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      IRSABatchFactory &IRSABatchFactory::singleton()
+      {
+        return RSABatchFactory::singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      RSABatchPtr IRSABatchFactory::create()
+      {
+        if (this) {}
+        return RSABatch::create();
+      }
+
+    }
+
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRSABatch
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    const char *IRSABatch::toString(Operations operation)
+    {
+      switch (operation) {
+        case Operation_Sign:    return "Sign";
+        case Operation_Verify:  return "Verify";
+        case Operation_Encrypt: return "Encrypt";
+        case Operation_Decrypt: return "Decrypt";
+      }
+      return "Unknown";
+    }
+
+    //-------------------------------------------------------------------------
+    ElementPtr IRSABatch::toDebug(IRSABatchPtr batch)
+    {
+      return internal::RSABatch::toDebug(batch);
+    }
+
+    //-------------------------------------------------------------------------
+    IRSABatchPtr IRSABatch::create()
+    {
+      return internal::IRSABatchFactory::singleton().create();
+    }
+
+  }
+}
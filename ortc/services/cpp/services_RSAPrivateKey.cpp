@@ -31,6 +31,7 @@
 
 #include <ortc/services/internal/services_RSAPrivateKey.h>
 #include <ortc/services/internal/services_RSAPublicKey.h>
+#include <ortc/services/internal/services_KeyGenerationPool.h>
 #include <ortc/services/ICache.h>
 #include <ortc/services/IHelper.h>
 
@@ -154,40 +155,18 @@ namespace ortc
                                                size_t keySizeInBits
                                                )
       {
-        AutoSeededRandomPool rng;
-        SecureByteBlock publicKeyBuffer;
-
-        RSAPrivateKeyPtr pThis(make_shared<RSAPrivateKey>(make_private{}));
-
-        ZS_LOG_DEBUG(pThis->log("generating private key"))
-
-        pThis->mPrivateKey.GenerateRandomWithKeySize(rng, static_cast<unsigned int>(keySizeInBits));
-        if (!pThis->mPrivateKey.Validate(rng, 3)) {
-          ZS_LOG_ERROR(Basic, pThis->log("failed to generate a new private key"))
-          return RSAPrivateKeyPtr();
-        }
-
-        PublicKey rsaPublic(pThis->mPrivateKey);
-        if (!rsaPublic.Validate(rng, 3)) {
-          ZS_LOG_ERROR(Basic, pThis->log("Failed to generate a public key for the new private key"))
-          return RSAPrivateKeyPtr();
+        if (ORTC_SERVICES_RSA_PRIVATE_KEY_GENERATION_SIZE == keySizeInBits) {
+          KeyGenerationPoolPtr pool = KeyGenerationPool::singleton();
+          if (pool) {
+            RSAPrivateKeyPtr pThis = pool->takeRSAKeyPair(outPublicKey);
+            if (pThis) {
+              ZS_LOG_DEBUG(pThis->log("using pre-generated private key") + IRSAPublicKey::toDebug(outPublicKey))
+              return pThis;
+            }
+          }
         }
 
-        ByteQueue byteQueue;
-        rsaPublic.Save(byteQueue);
-
-        size_t outputLengthInBytes = (size_t)byteQueue.CurrentSize();
-        publicKeyBuffer.CleanNew(outputLengthInBytes);
-
-        byteQueue.Get(publicKeyBuffer, outputLengthInBytes);
-
-        outPublicKey = RSAPublicKey::convert(UsePublicKey::load(publicKeyBuffer));
-
-        ZS_LOG_DEBUG(pThis->debug("generated private key") + IRSAPublicKey::toDebug(outPublicKey))
-
-        pThis->mDidGenerate = true;
-
-        return pThis;
+        return generateNow(outPublicKey, keySizeInBits);
       }
 
       //-----------------------------------------------------------------------
@@ -334,6 +313,48 @@ namespace ortc
         return resultEl;
       }
       
+      //-----------------------------------------------------------------------
+      RSAPrivateKeyPtr RSAPrivateKey::generateNow(
+                                                  RSAPublicKeyPtr &outPublicKey,
+                                                  size_t keySizeInBits
+                                                  )
+      {
+        AutoSeededRandomPool rng;
+        SecureByteBlock publicKeyBuffer;
+
+        RSAPrivateKeyPtr pThis(make_shared<RSAPrivateKey>(make_private{}));
+
+        ZS_LOG_DEBUG(pThis->log("generating private key"))
+
+        pThis->mPrivateKey.GenerateRandomWithKeySize(rng, static_cast<unsigned int>(keySizeInBits));
+        if (!pThis->mPrivateKey.Validate(rng, 3)) {
+          ZS_LOG_ERROR(Basic, pThis->log("failed to generate a new private key"))
+          return RSAPrivateKeyPtr();
+        }
+
+        PublicKey rsaPublic(pThis->mPrivateKey);
+        if (!rsaPublic.Validate(rng, 3)) {
+          ZS_LOG_ERROR(Basic, pThis->log("Failed to generate a public key for the new private key"))
+          return RSAPrivateKeyPtr();
+        }
+
+        ByteQueue byteQueue;
+        rsaPublic.Save(byteQueue);
+
+        size_t outputLengthInBytes = (size_t)byteQueue.CurrentSize();
+        publicKeyBuffer.CleanNew(outputLengthInBytes);
+
+        byteQueue.Get(publicKeyBuffer, outputLengthInBytes);
+
+        outPublicKey = RSAPublicKey::convert(UsePublicKey::load(publicKeyBuffer));
+
+        ZS_LOG_DEBUG(pThis->debug("generated private key") + IRSAPublicKey::toDebug(outPublicKey))
+
+        pThis->mDidGenerate = true;
+
+        return pThis;
+      }
+
       //-----------------------------------------------------------------------
       SecureByteBlockPtr RSAPrivateKey::sign(
                                              const BYTE *inBuffer,
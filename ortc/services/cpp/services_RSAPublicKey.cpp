@@ -34,6 +34,7 @@
 #include <ortc/services/internal/services_Helper.h>
 
 #include <zsLib/eventing/IHasher.h>
+#include <zsLib/ISettings.h>
 #include <zsLib/XML.h>
 #include <zsLib/Log.h>
 #include <zsLib/Stringize.h>
@@ -42,6 +43,7 @@
 
 #include <cryptopp/osrng.h>
 #include <cryptopp/rsa.h>
+#include <cryptopp/sha.h>
 
 
 namespace ortc { namespace services { ZS_DECLARE_SUBSYSTEM(ortc_services) } }
@@ -65,6 +67,53 @@ namespace ortc
 
       ZS_DECLARE_TYPEDEF_PTR(IRSAPublicKeyForRSAPrivateKey::ForPrivateKey, ForPrivateKey)
 
+      ZS_DECLARE_CLASS_PTR(RSAPublicKeySettingsDefaults);
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSAPublicKeySettingsDefaults
+      #pragma mark
+
+      class RSAPublicKeySettingsDefaults : public ISettingsApplyDefaultsDelegate
+      {
+      public:
+        //-----------------------------------------------------------------------
+        ~RSAPublicKeySettingsDefaults()
+        {
+          ISettings::removeDefaults(*this);
+        }
+
+        //-----------------------------------------------------------------------
+        static RSAPublicKeySettingsDefaultsPtr singleton()
+        {
+          static SingletonLazySharedPtr<RSAPublicKeySettingsDefaults> singleton(create());
+          return singleton.singleton();
+        }
+
+        //-----------------------------------------------------------------------
+        static RSAPublicKeySettingsDefaultsPtr create()
+        {
+          auto pThis(make_shared<RSAPublicKeySettingsDefaults>());
+          ISettings::installDefaults(pThis);
+          return pThis;
+        }
+
+        //-----------------------------------------------------------------------
+        virtual void notifySettingsApplyDefaults() override
+        {
+          ISettings::setUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE, 1024);
+        }
+      };
+
+      //-------------------------------------------------------------------------
+      void installRSAPublicKeySettingsDefaults()
+      {
+        RSAPublicKeySettingsDefaults::singleton();
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -194,23 +243,28 @@ namespace ortc
       //-----------------------------------------------------------------------
       bool RSAPublicKey::verify(
                                 const SecureByteBlock &inOriginalBufferSigned,
-                                const SecureByteBlock &inSignature
+                                const SecureByteBlock &inSignature,
+                                bool useVerifyCache
                                 ) const
       {
-        return verify(inOriginalBufferSigned, inOriginalBufferSigned.size(), inSignature);
+        return verify(inOriginalBufferSigned, inOriginalBufferSigned.size(), inSignature, useVerifyCache);
       }
 
       //-----------------------------------------------------------------------
       bool RSAPublicKey::verify(
                                 const String &inOriginalStringSigned,
-                                const SecureByteBlock &inSignature
+                                const SecureByteBlock &inSignature,
+                                bool useVerifyCache
                                 ) const
       {
-        return verify((const BYTE *)inOriginalStringSigned.c_str(), inOriginalStringSigned.length(), inSignature);
+        return verify((const BYTE *)inOriginalStringSigned.c_str(), inOriginalStringSigned.length(), inSignature, useVerifyCache);
       }
 
       //-----------------------------------------------------------------------
-      bool RSAPublicKey::verifySignature(ElementPtr signedEl) const
+      bool RSAPublicKey::verifySignature(
+                                         ElementPtr signedEl,
+                                         bool useVerifyCache
+                                         ) const
       {
         ZS_THROW_INVALID_ARGUMENT_IF(!signedEl)
 
@@ -232,12 +286,7 @@ namespace ortc
 
           String signatureDigestAsString = signatureEl->findFirstChildElementChecked("digestValue")->getTextDecoded();
 
-          ElementPtr canonicalSigned = Helper::cloneAsCanonicalJSON(signedEl);
-
-          GeneratorPtr generator = Generator::createJSONGenerator();
-          std::unique_ptr<char[]> signedElAsJSON = generator->write(canonicalSigned);
-
-          SecureByteBlockPtr actualDigest = IHasher::hash((const char *)(signedElAsJSON.get()), IHasher::sha1());
+          SecureByteBlockPtr actualDigest = IHelper::hashCanonicalJSON(signedEl);
 
           if (0 != IHelper::compare(*actualDigest, *IHelper::convertFromBase64(signatureDigestAsString))) {
             ZS_LOG_WARNING(Detail, log("digest values did not match") + ZS_PARAM("signature digest", signatureDigestAsString) + ZS_PARAM("actual digest", IHelper::convertToBase64(*actualDigest)))
@@ -246,7 +295,7 @@ namespace ortc
 
           SecureByteBlockPtr signatureDigestSigned = IHelper::convertFromBase64(signatureEl->findFirstChildElementChecked("digestSigned")->getTextDecoded());
 
-          if (!verify(*actualDigest, *signatureDigestSigned)) {
+          if (!verify(*actualDigest, *signatureDigestSigned, useVerifyCache)) {
             ZS_LOG_WARNING(Detail, log("signature failed to validate") + ZS_PARAM("fingerprint", mFingerprint))
             return false;
           }
@@ -318,6 +367,11 @@ namespace ortc
         IHelper::debugAppend(resultEl, "fingerprint", mFingerprint);
         IHelper::debugAppend(resultEl, "public key", output ? IHelper::convertToHex(*output) : String());
 
+        RSAPublicKeyVerifyCachePtr cache = RSAPublicKeyVerifyCache::singleton();
+        if (cache) {
+          IHelper::debugAppend(resultEl, "verify cache", cache->toDebug());
+        }
+
         return resultEl;
       }
 
@@ -325,8 +379,33 @@ namespace ortc
       bool RSAPublicKey::verify(
                                 const BYTE *inBuffer,
                                 size_t inBufferLengthInBytes,
-                                const SecureByteBlock &inSignature
+                                const SecureByteBlock &inSignature,
+                                bool useVerifyCache
                                 ) const
+      {
+        // a disabled cache is skipped entirely (no key hashing nor miss counting)
+        RSAPublicKeyVerifyCachePtr cache = ((useVerifyCache) && (RSAPublicKeyVerifyCache::isEnabled()) ? RSAPublicKeyVerifyCache::singleton() : RSAPublicKeyVerifyCachePtr());
+        if (!cache) return verifyNow(inBuffer, inBufferLengthInBytes, inSignature);
+
+        RSAPublicKeyVerifyCache::CacheKey key = RSAPublicKeyVerifyCache::toKey(mFingerprint, inBuffer, inBufferLengthInBytes, inSignature);
+
+        bool verified = false;
+        if (cache->find(key, verified)) {
+          ZS_LOG_TRACE(log("using cached verification result") + ZS_PARAM("verified", verified))
+          return verified;
+        }
+
+        verified = verifyNow(inBuffer, inBufferLengthInBytes, inSignature);
+        cache->store(key, verified);
+        return verified;
+      }
+
+      //-----------------------------------------------------------------------
+      bool RSAPublicKey::verifyNow(
+                                   const BYTE *inBuffer,
+                                   size_t inBufferLengthInBytes,
+                                   const SecureByteBlock &inSignature
+                                   ) const
       {
         Verifier verifier(mPublicKey);
 
@@ -344,6 +423,152 @@ namespace ortc
         return true;
       }
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSAPublicKeyVerifyCache
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      RSAPublicKeyVerifyCache::RSAPublicKeyVerifyCache(const make_private &)
+      {
+      }
+
+      //-----------------------------------------------------------------------
+      RSAPublicKeyVerifyCachePtr RSAPublicKeyVerifyCache::singleton()
+      {
+        static SingletonLazySharedPtr<RSAPublicKeyVerifyCache> singleton(make_shared<RSAPublicKeyVerifyCache>(make_private{}));
+        return singleton.singleton();
+      }
+
+      //-----------------------------------------------------------------------
+      bool RSAPublicKeyVerifyCache::isEnabled()
+      {
+        return 0 != ISettings::getUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE);
+      }
+
+      //-----------------------------------------------------------------------
+      RSAPublicKeyVerifyCache::CacheKey RSAPublicKeyVerifyCache::toKey(
+                                                                       const String &fingerprint,
+                                                                       const BYTE *inBuffer,
+                                                                       size_t inBufferLengthInBytes,
+                                                                       const SecureByteBlock &inSignature
+                                                                       )
+      {
+        BYTE lengths[sizeof(DWORD) * 2] {};
+        IHelper::setBE32(&(lengths[0]), static_cast<DWORD>(inBufferLengthInBytes));
+        IHelper::setBE32(&(lengths[sizeof(DWORD)]), static_cast<DWORD>(inSignature.SizeInBytes()));
+
+        CryptoPP::SHA256 hasher;
+        hasher.Update((const BYTE *)fingerprint.c_str(), fingerprint.length() + 1);   // includes the NUL as a separator
+        hasher.Update(lengths, sizeof(lengths));
+        if (inBufferLengthInBytes > 0) hasher.Update(inBuffer, inBufferLengthInBytes);
+        if (inSignature.SizeInBytes() > 0) hasher.Update(inSignature.BytePtr(), inSignature.SizeInBytes());
+
+        BYTE digest[CryptoPP::SHA256::DIGESTSIZE] {};
+        hasher.Final(digest);
+
+        return CacheKey((const char *)(&(digest[0])), sizeof(digest));
+      }
+
+      //-----------------------------------------------------------------------
+      bool RSAPublicKeyVerifyCache::find(
+                                         const CacheKey &key,
+                                         bool &outVerified
+                                         )
+      {
+        AutoLock lock(mLock);
+
+        CacheMap::iterator found = mLookup.find(key);
+        if (found == mLookup.end()) {
+          ++mMisses;
+          return false;
+        }
+
+        CacheList::iterator entry = (*found).second;
+        mEntries.splice(mEntries.begin(), mEntries, entry);
+
+        outVerified = (*entry).second;
+        ++mHits;
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      void RSAPublicKeyVerifyCache::store(
+                                          const CacheKey &key,
+                                          bool verified
+                                          )
+      {
+        size_t maxSize = static_cast<size_t>(ISettings::getUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE));
+
+        AutoLock lock(mLock);
+
+        CacheMap::iterator found = mLookup.find(key);
+        if (found != mLookup.end()) {
+          CacheList::iterator entry = (*found).second;
+          (*entry).second = verified;
+          mEntries.splice(mEntries.begin(), mEntries, entry);
+          return;
+        }
+
+        if (maxSize > 0) {
+          mEntries.push_front(CacheEntry(key, verified));
+          mLookup[key] = mEntries.begin();
+        }
+
+        while (mEntries.size() > maxSize) {
+          mLookup.erase(mEntries.back().first);
+          mEntries.pop_back();
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void RSAPublicKeyVerifyCache::clear()
+      {
+        AutoLock lock(mLock);
+        mEntries.clear();
+        mLookup.clear();
+        mHits = 0;
+        mMisses = 0;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t RSAPublicKeyVerifyCache::getHits() const
+      {
+        AutoLock lock(mLock);
+        return mHits;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t RSAPublicKeyVerifyCache::getMisses() const
+      {
+        AutoLock lock(mLock);
+        return mMisses;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t RSAPublicKeyVerifyCache::getSize() const
+      {
+        AutoLock lock(mLock);
+        return mEntries.size();
+      }
+
+      //-----------------------------------------------------------------------
+      ElementPtr RSAPublicKeyVerifyCache::toDebug() const
+      {
+        AutoLock lock(mLock);
+
+        ElementPtr resultEl = Element::create("RSAPublicKeyVerifyCache");
+
+        IHelper::debugAppend(resultEl, "size", mEntries.size());
+        IHelper::debugAppend(resultEl, "hits", mHits);
+        IHelper::debugAppend(resultEl, "misses", mMisses);
+
+        return resultEl;
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -32,11 +32,14 @@
 #include <ortc/services/internal/services_RUDPChannel.h>
 #include <ortc/services/internal/services_ICESocket.h>
 #include <ortc/services/internal/services_IRUDPChannelStream.h>
+#include <ortc/services/internal/services_RUDPChannelStream.h>
 #include <ortc/services/internal/services_Helper.h>
 
 #include <ortc/services/RUDPPacket.h>
+#include <ortc/services/PacketBuffer.h>
 
 #include <zsLib/Exception.h>
+#include <zsLib/ISettings.h>
 #include <zsLib/helpers.h>
 #include <zsLib/Stringize.h>
 
@@ -71,6 +74,23 @@ namespace ortc
         return string(value) + " (" + string(value & 0xFFFFFF) + ")";
       }
 
+      //-----------------------------------------------------------------------
+      static WORD getMaxSubStreamsSetting()
+      {
+        auto value = ISettings::getUInt(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_MAX_SUB_STREAMS);
+
+        // the total streams are negotiated as a WORD and at least the main
+        // stream must always exist
+        auto clamped = value;
+        if (clamped < 1) clamped = 1;
+        if (clamped > 0xFFFF) clamped = 0xFFFF;
+
+        if (clamped != value) {
+          ZS_LOG_WARNING(Detail, Log::Params("max sub streams setting is out of range (thus adjusting)", "RUDPChannel") + ZS_PARAM("setting", value) + ZS_PARAM("using", clamped))
+        }
+        return static_cast<WORD>(clamped);
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -281,6 +301,37 @@ namespace ortc
         return mRemoteChannelInfo;
       }
 
+      //-----------------------------------------------------------------------
+      WORD RUDPChannel::getTotalStreams() const
+      {
+        AutoRecursiveLock lock(mLock);
+        return mTotalStreams;
+      }
+
+      //-----------------------------------------------------------------------
+      bool RUDPChannel::getSubStream(
+                                     WORD streamID,
+                                     ITransportStreamPtr &outReceiveStream,
+                                     ITransportStreamPtr &outSendStream
+                                     )
+      {
+        AutoRecursiveLock lock(mLock);
+
+        outReceiveStream.reset();
+        outSendStream.reset();
+
+        if ((0 == streamID) ||
+            (streamID >= mSubStreams.size())) {
+          ZS_LOG_WARNING(Debug, log("sub stream is not available") + ZS_PARAM("stream", streamID) + ZS_PARAM("total streams", mTotalStreams))
+          return false;
+        }
+
+        SubStream &subStream = mSubStreams[streamID];
+        outReceiveStream = subStream.mReceiveStream;
+        outSendStream = subStream.mSendStream;
+        return true;
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -343,9 +394,11 @@ namespace ortc
 
         AutoRecursiveLock lock(pThis->mLock);
         pThis->mIncoming = true;
+        pThis->mTotalStreams = getNegotiatedTotalStreams(stun);
         pThis->init();
         // do not allow sending to the remote party until we receive an ACK or data
         pThis->mStream = IRUDPChannelStream::create(queue, pThis, pThis->mLocalSequenceNumber, pThis->mRemoteSequenceNumber, pThis->mOutgoingChannelNumber, pThis->mIncomingChannelNumber, pThis->mMinimumRTT);
+        pThis->setupSubStreams();
         pThis->mStream->holdSendingUntilReceiveSequenceNumber(stun->mNextSequenceNumber);
         pThis->handleSTUN(stun, outResponse, localUsernameFrag, remoteUsernameFrag);
         if (!outResponse) {
@@ -576,6 +629,7 @@ namespace ortc
               (minimumRTT != mMinimumRTT) ||
               (stun->mConnectionInfo != mRemoteChannelInfo) ||
               (lifetime != mLifetime) ||
+              (getNegotiatedTotalStreams(stun) != mTotalStreams) ||
               (stun->mLocalCongestionControl.size() < 1) ||
               (stun->mRemoteCongestionControl.size() < 1)) {
             ZS_LOG_WARNING(Detail, log("received open channel with non supported renegociation"))
@@ -612,6 +666,9 @@ namespace ortc
           outResponse->mMinimumRTT = minimumRTT;
           outResponse->mLifetime = lifetime;
           outResponse->mChannelNumber = mIncomingChannelNumber;
+          if (stun->hasAttribute(STUNPacket::Attribute_RUDPStreams)) {
+            outResponse->mRUDPStreams = mTotalStreams;
+          }
 
           IRUDPChannelStream::getResponseToOfferedAlgorithms(
                                                              stun->mRemoteCongestionControl,        // the remote applies to us
@@ -776,6 +833,10 @@ namespace ortc
         stun->mMinimumRTTIncluded = true;
         stun->mMinimumRTT = mMinimumRTT;
         stun->mConnectionInfo = mLocalChannelInfo;
+        WORD maxStreams = getMaxSubStreamsSetting();
+        if (maxStreams > 1) {
+          stun->mRUDPStreams = maxStreams;
+        }
         stun->mLocalCongestionControl = local;
         stun->mRemoteCongestionControl = remote;
         if (mRemotePassword.isEmpty()) {
@@ -879,9 +940,11 @@ namespace ortc
         pThis->mIncoming = true;
         pThis->mRealm = stun->mRealm;
         pThis->mNonce = stun->mNonce;
+        pThis->mTotalStreams = getNegotiatedTotalStreams(stun);
         pThis->init();
         // do not allow sending to the remote party until we receive an ACK or data
         pThis->mStream = IRUDPChannelStream::create(queue, pThis, pThis->mLocalSequenceNumber, pThis->mRemoteSequenceNumber, pThis->mOutgoingChannelNumber, pThis->mIncomingChannelNumber, pThis->mMinimumRTT);
+        pThis->setupSubStreams();
         pThis->mStream->holdSendingUntilReceiveSequenceNumber(stun->mNextSequenceNumber);
         pThis->handleSTUN(stun, outResponse, localUsernameFrag, remoteUsernameFrag);
         if (!outResponse) {
@@ -953,11 +1016,10 @@ namespace ortc
       //-----------------------------------------------------------------------
       bool RUDPChannel::notifyRUDPChannelStreamSendPacket(
                                                           IRUDPChannelStreamPtr stream,
-                                                          const BYTE *packet,
-                                                          size_t packetLengthInBytes
+                                                          PacketBufferPtr packet
                                                           )
       {
-        ZS_LOG_TRACE(log("notify channel stream send packet") + ZS_PARAM("stream ID", stream->getID()) + ZS_PARAM("length", packetLengthInBytes))
+        ZS_LOG_TRACE(log("notify channel stream send packet") + ZS_PARAM("stream ID", stream->getID()) + ZS_PARAM("length", packet->size()))
         IRUDPChannelDelegateForSessionAndListenerPtr master;
         IPAddress remoteIP;
 
@@ -970,7 +1032,7 @@ namespace ortc
         }
 
         try {
-          return master->notifyRUDPChannelSendPacket(mThisWeak.lock(), remoteIP, packet, packetLengthInBytes);
+          return master->notifyRUDPChannelSendPacket(mThisWeak.lock(), remoteIP, packet);
         } catch(IRUDPChannelDelegateForSessionAndListenerProxy::Exceptions::DelegateGone &) {
           ZS_LOG_WARNING(Detail, log("master delegate gone for sent packet"))
           setError(RUDPChannelShutdownReason_DelegateGone, "delegate gone");
@@ -1202,6 +1264,8 @@ namespace ortc
             return false;
           }
 
+          mTotalStreams = getNegotiatedTotalStreams(response);
+
           mRemoteSequenceNumber = response->mNextSequenceNumber;
           mOutgoingChannelNumber = response->mChannelNumber;
 
@@ -1218,6 +1282,8 @@ namespace ortc
                                                mMinimumRTT
                                                );
 
+          setupSubStreams();
+
           if ((mReceiveStream) &&
               (mSendStream)) {
             mStream->setStreams(mReceiveStream, mSendStream);
@@ -1401,6 +1467,7 @@ namespace ortc
         IHelper::debugAppend(resultEl, "remote sequence number", mRemoteSequenceNumber);
 
         IHelper::debugAppend(resultEl, "minimum RTT", mMinimumRTT);
+        IHelper::debugAppend(resultEl, "total streams", mTotalStreams);
         IHelper::debugAppend(resultEl, "lifetime", mLifetime);
 
         IHelper::debugAppend(resultEl, "local channel info", mLocalChannelInfo);
@@ -1723,6 +1790,37 @@ namespace ortc
         return true;
       }
 
+      //-----------------------------------------------------------------------
+      WORD RUDPChannel::getNegotiatedTotalStreams(STUNPacketPtr stun)
+      {
+        if (!stun->hasAttribute(STUNPacket::Attribute_RUDPStreams)) return 1;
+
+        WORD maxStreams = getMaxSubStreamsSetting();
+
+        // never negotiate more than what both parties are willing to support
+        return (stun->mRUDPStreams < maxStreams ? stun->mRUDPStreams : maxStreams);
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannel::setupSubStreams()
+      {
+        if (!mStream) return;
+        if (mTotalStreams < 2) return;
+
+        ZS_LOG_DETAIL(log("setting up sub streams") + ZS_PARAM("total streams", mTotalStreams))
+
+        mStream->setTotalSubStreams(mTotalStreams);
+
+        mSubStreams.resize(mTotalStreams);
+        for (WORD index = 1; index < mTotalStreams; ++index) {
+          SubStream &subStream = mSubStreams[index];
+          subStream.mReceiveStream = ITransportStream::create();
+          subStream.mSendStream = ITransportStream::create();
+
+          mStream->setSubStreamStreams(index, subStream.mReceiveStream, subStream.mSendStream);
+        }
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -1863,5 +1961,46 @@ namespace ortc
       return internal::RUDPChannel::toDebug(channel);
     }
 
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    //-------------------------------------------------------------------------
+    #pragma mark
+    #pragma mark IRUDPChannel::ReliabilityHeader
+    #pragma mark
+
+    //-------------------------------------------------------------------------
+    IRUDPChannel::ReliabilityHeader::ReliabilityHeader() :
+      mCreated(zsLib::now())
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    IRUDPChannel::ReliabilityHeaderPtr IRUDPChannel::ReliabilityHeader::convert(ITransportStream::StreamHeaderPtr header)
+    {
+      return ZS_DYNAMIC_PTR_CAST(ReliabilityHeader, header);
+    }
+
+    //-------------------------------------------------------------------------
+    bool IRUDPChannel::ReliabilityHeader::isReliable() const
+    {
+      return (mOrdered) &&
+             (!mLimitRetransmits) &&
+             (Milliseconds() == mMaxLifetime);
+    }
+
+    //-------------------------------------------------------------------------
+    bool IRUDPChannel::ReliabilityHeader::hasExpired(
+                                                     ULONG totalRetransmits,
+                                                     Time now
+                                                     ) const
+    {
+      if ((mLimitRetransmits) &&
+          (totalRetransmits > mMaxRetransmits)) return true;
+
+      if (Milliseconds() == mMaxLifetime) return false;
+      return (mCreated + mMaxLifetime < now);
+    }
+
   }
 }
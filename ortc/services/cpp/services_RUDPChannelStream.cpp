@@ -33,8 +33,10 @@
 #include <ortc/services/internal/services_Helper.h>
 
 #include <ortc/services/RUDPPacket.h>
+#include <ortc/services/PacketBuffer.h>
 
 #include <zsLib/Exception.h>
+#include <zsLib/ISettings.h>
 #include <zsLib/helpers.h>
 #include <zsLib/Stringize.h>
 #include <zsLib/XML.h>
@@ -58,6 +60,15 @@
 #define ORTC_SERVICES_UNFREEZE_AFTER_SECONDS_OF_GOOD_TRANSMISSION (10)
 #define ORTC_SERVICES_DEFAULT_PACKETS_PER_BURST (3)
 
+#define ORTC_SERVICES_RUDP_MINIMUM_PACING_INTERVAL_IN_MICROSECONDS (50)
+#define ORTC_SERVICES_RUDP_MINIMUM_PACING_TIMER_IN_MILLISECONDS (1)
+
+#define ORTC_SERVICES_RUDP_MINIMUM_REORDERING_WINDOW_IN_MILLISECONDS (1)
+#define ORTC_SERVICES_RUDP_MAX_TAIL_LOSS_PROBES_BEFORE_FORCING_ACK (2)
+#define ORTC_SERVICES_RUDP_MAX_TAIL_LOSS_PROBE_TIMEOUT_IN_SECONDS (10)
+
+#define ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE (sizeof(WORD)+sizeof(DWORD))
+
 //#define ORTC_INDUCE_FAKE_PACKET_LOSS
 #define ORTC_INDUCE_FAKE_PACKET_LOSS_PERCENTAGE (10)
 
@@ -78,6 +89,8 @@ namespace ortc
     {
       using services::internal::IRUDPChannelStreamPtr;
 
+      ZS_DECLARE_CLASS_PTR(RUDPChannelStreamSettingsDefaults);
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -96,7 +109,61 @@ namespace ortc
       {
         return string(value) + " (" + string(value & 0xFFFFFF) + ")";
       }
+
+      //-----------------------------------------------------------------------
+      static IRUDPChannel::ReliabilityHeaderPtr createUnorderedHeader()
+      {
+        IRUDPChannel::ReliabilityHeaderPtr header(make_shared<IRUDPChannel::ReliabilityHeader>());
+        header->mOrdered = false;
+        return header;
+      }
       
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RUDPChannelStreamSettingsDefaults
+      #pragma mark
+
+      class RUDPChannelStreamSettingsDefaults : public ISettingsApplyDefaultsDelegate
+      {
+      public:
+        //-----------------------------------------------------------------------
+        ~RUDPChannelStreamSettingsDefaults()
+        {
+          ISettings::removeDefaults(*this);
+        }
+
+        //-----------------------------------------------------------------------
+        static RUDPChannelStreamSettingsDefaultsPtr singleton()
+        {
+          static SingletonLazySharedPtr<RUDPChannelStreamSettingsDefaults> singleton(create());
+          return singleton.singleton();
+        }
+
+        //-----------------------------------------------------------------------
+        static RUDPChannelStreamSettingsDefaultsPtr create()
+        {
+          auto pThis(make_shared<RUDPChannelStreamSettingsDefaults>());
+          ISettings::installDefaults(pThis);
+          return pThis;
+        }
+
+        //-----------------------------------------------------------------------
+        virtual void notifySettingsApplyDefaults() override
+        {
+          ISettings::setBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING, true);
+          ISettings::setUInt(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_MAX_SUB_STREAMS, 1);
+        }
+      };
+
+      //-------------------------------------------------------------------------
+      void installRUDPChannelStreamSettingsDefaults()
+      {
+        RUDPChannelStreamSettingsDefaults::singleton();
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -246,6 +313,7 @@ namespace ortc
         mLastDeliveredReadData(zsLib::now()),
         mAddToAvailableBurstBatonsDuation(Milliseconds(ORTC_SERVICES_RUDP_DEFAULT_CALCULATE_RTT_IN_MILLISECONDS)),
         mPacketsPerBurst(ORTC_SERVICES_DEFAULT_PACKETS_PER_BURST),
+        mPaceSending(ISettings::getBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING)),
         mStartedSendingAtTime(zsLib::now())
       {
         ZS_LOG_DETAIL(log("created"))
@@ -371,6 +439,53 @@ namespace ortc
         mPendingReceiveData.reset();
       }
 
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::setTotalSubStreams(WORD totalSubStreams)
+      {
+        ZS_LOG_DEBUG(log("set total sub streams called") + ZS_PARAM("total", totalSubStreams))
+
+        ZS_THROW_INVALID_ARGUMENT_IF(totalSubStreams < 1)
+
+        AutoRecursiveLock lock(mLock);
+
+        ZS_THROW_INVALID_USAGE_IF(mSubStreams.size() > 0)
+
+        mTotalSubStreams = totalSubStreams;
+        if (mTotalSubStreams < 2) return;
+
+        mSubStreams.resize(mTotalSubStreams);
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::setSubStreamStreams(
+                                                  WORD subStreamID,
+                                                  ITransportStreamPtr receiveStream,
+                                                  ITransportStreamPtr sendStream
+                                                  )
+      {
+        ZS_LOG_DEBUG(log("set sub stream streams called") + ZS_PARAM("sub stream", subStreamID))
+
+        ZS_THROW_INVALID_ARGUMENT_IF(!receiveStream)
+        ZS_THROW_INVALID_ARGUMENT_IF(!sendStream)
+
+        AutoRecursiveLock lock(mLock);
+
+        ZS_THROW_INVALID_ARGUMENT_IF((0 == subStreamID) || (subStreamID >= mSubStreams.size()))
+
+        SubStream &subStream = mSubStreams[subStreamID];
+
+        subStream.mReceiveStream = receiveStream->getWriter();
+        subStream.mSendStream = sendStream->getReader();
+        subStream.mSendStream->notifyReaderReadyToRead();
+
+        subStream.mSendStreamSubscription = subStream.mSendStream->subscribe(mThisWeak.lock());
+
+        if (0 != (IRUDPChannel::Shutdown_Receive & mShutdownState)) {
+          ZS_LOG_DEBUG(log("cancelling sub stream receive stream since that direction is shutdown") + ZS_PARAM("sub stream", subStreamID))
+          subStream.mReceiveStream->cancel();
+        }
+      }
+
       //-----------------------------------------------------------------------
       void RUDPChannelStream::shutdown(bool shutdownOnlyOnceAllDataSent)
       {
@@ -406,6 +521,11 @@ namespace ortc
             ZS_LOG_DEBUG(log("cancelling receive stream since that direction is shutdown"))
             mReceiveStream->cancel();
           }
+          for (auto iter = mSubStreams.begin(); iter != mSubStreams.end(); ++iter) {
+            SubStream &subStream = (*iter);
+            if (subStream.mReceiveStream) subStream.mReceiveStream->cancel();
+            subStream.mPendingReceiveData.clear();
+          }
         }
         if (isShutdown()) return;
         if (isShuttingDown()) return;
@@ -458,6 +578,12 @@ namespace ortc
           if (sequenceNumber <= mGSNFR) {
             ZS_LOG_WARNING(Debug, log("received duplicate packet") + ZS_PARAM("GSNFR", sequenceToString(mGSNFR)) + ZS_PARAM("packet sequence number", sequenceToString(sequenceNumber)))
             mDuplicateReceived = true;
+            if (packet->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)) {
+              // the remote party is probing for lost packets so it must be
+              // told what has arrived even though this packet is a duplicate
+              fireExternalACKIfNotSent = true;
+              goto handlePacketSendNow;
+            }
             return true;
           }
 
@@ -494,6 +620,10 @@ namespace ortc
             ZS_LOG_WARNING(Debug, log("received packet is duplicated and already exist in pending buffers thus dropping packet") + ZS_PARAM("packet sequence number", sequenceToString(sequenceNumber)))
             // we have already received and processed this packet
             mDuplicateReceived = true;
+            if (packet->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)) {
+              fireExternalACKIfNotSent = true;
+              goto handlePacketSendNow;
+            }
             return true;
           }
 
@@ -527,9 +657,25 @@ namespace ortc
           BufferedPacketPtr bufferedPacket = BufferedPacket::create();
           bufferedPacket->mSequenceNumber = sequenceNumber;
           bufferedPacket->mRUDPPacket = packet;
-          bufferedPacket->mPacket = originalBuffer;
+          bufferedPacket->mOriginalBuffer = originalBuffer;
 
           mReceivedPackets[sequenceNumber] = bufferedPacket;
+
+          // sub-stream data does not need to wait for the gaps in the
+          // channel's sequence to be filled (only for gaps on its own
+          // sub-stream)
+          if (mTotalSubStreams > 1) {
+            deliverSubStreamData(bufferedPacket);
+          } else if ((packet->isFlagSet(RUDPPacket::Flag_UO_Unordered)) &&
+                     (sequenceNumber != mGSNFR+1) &&
+                     (mReceiveStream)) {
+            // unordered data does not need to wait for the gaps before it
+            if (packet->mDataLengthInBytes > 0) {
+              writeReceivedData(0, packet->mData, packet->mDataLengthInBytes, createUnorderedHeader());
+            }
+            bufferedPacket->mDataDelivered = true;
+          }
+
           if (sequenceNumber > mGSNR) {
             mGSNR = sequenceNumber;
             mGSNRParity = packet->isFlagSet(RUDPPacket::Flag_PS_ParitySending);
@@ -545,6 +691,8 @@ namespace ortc
 
         } // scope
 
+      handlePacketSendNow:
+
         // because we have possible new ACKs the window might have progressed, attempt to send more data now
         bool sent = sendNow();  // WARNING: this method cannot be called from within a lock
         if (sent) {
@@ -788,18 +936,22 @@ namespace ortc
       {
         ZS_LOG_TRACE(log("tick") + ZS_PARAM("timer ID", timer->getID()))
 
+        bool sendProbe = false;
+
         {
           AutoRecursiveLock lock(mLock);
 
           PUID burstID = (mBurstTimer ? mBurstTimer->getID() : 0);
           PUID ensureID = (mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer ? mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->getID() : 0);
           PUID addID = (mAddToAvailableBurstBatonsTimer ? mAddToAvailableBurstBatonsTimer->getID() : 0);
+          PUID lossID = (mLossDetectionTimer ? mLossDetectionTimer->getID() : 0);
 
           ZS_LOG_TRACE(log("tick") +
                        ZS_PARAM("comparing timer ID", timer->getID()) +
                        ZS_PARAM("burst ID", burstID) +
                        ZS_PARAM("ensure ID", ensureID) +
-                       ZS_PARAM("addID ID", addID))
+                       ZS_PARAM("addID ID", addID) +
+                       ZS_PARAM("loss ID", lossID))
 
           if (timer == mBurstTimer) {
             ZS_LOG_TRACE(log("burst timer is firing") + ZS_PARAM("timer ID", timer->getID()))
@@ -807,13 +959,32 @@ namespace ortc
           }
 
           if (timer == mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer) {
-            ZS_LOG_TRACE(log("ensuring data has arrived by causing an external ACK") + ZS_PARAM("timer ID", timer->getID()))
             // this is only fired once if there is data that we want to force an ACK from the remote party
             mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->cancel();
             mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer.reset();
 
-            // we will use the "force" ACK mechanism to ensure that data has arrived
-            mForceACKNextTimePossible = true;
+            if (mTailLossProbesSent >= ORTC_SERVICES_RUDP_MAX_TAIL_LOSS_PROBES_BEFORE_FORCING_ACK) {
+              ZS_LOG_TRACE(log("ensuring data has arrived by causing an external ACK as tail loss probes were not answered") + ZS_PARAM("timer ID", timer->getID()) + ZS_PARAM("probes sent", mTailLossProbesSent))
+
+              // we will use the "force" ACK mechanism to ensure that data has arrived
+              mForceACKNextTimePossible = true;
+              goto quickExitToSendNow;
+            }
+
+            ZS_LOG_TRACE(log("ensuring data has arrived by sending a tail loss probe") + ZS_PARAM("timer ID", timer->getID()) + ZS_PARAM("probes sent", mTailLossProbesSent))
+            sendProbe = true;
+            goto quickExitToSendNow;
+          }
+
+          if (timer == mLossDetectionTimer) {
+            ZS_LOG_TRACE(log("loss detection timer fired") + ZS_PARAM("timer ID", timer->getID()))
+
+            mLossDetectionTimer->cancel();
+            mLossDetectionTimer.reset();
+
+            if (detectLossByTime(zsLib::now())) {
+              handlePacketLoss();
+            }
             goto quickExitToSendNow;
           }
 
@@ -834,6 +1005,9 @@ namespace ortc
         }
 
       quickExitToSendNow:
+        if (sendProbe) {
+          sendTailLossProbe();  // do NOT call from within a lock
+        }
         sendNow();
       }
 
@@ -909,6 +1083,10 @@ namespace ortc
 
         IHelper::debugAppend(resultEl, "send stream subscription", (bool)mSendStreamSubscription);
 
+        IHelper::debugAppend(resultEl, "partially reliable data sent", mPartiallyReliableDataSent);
+
+        IHelper::debugAppend(resultEl, "total sub streams", mTotalSubStreams);
+
         IHelper::debugAppend(resultEl, "pending receive data", (bool)mPendingReceiveData);
 
         IHelper::debugAppend(resultEl, "did receive write ready", (bool)mDidReceiveWriteReady);
@@ -952,12 +1130,25 @@ namespace ortc
         IHelper::debugAppend(resultEl, "burst timer", (bool)mBurstTimer);
 
         IHelper::debugAppend(resultEl, "ensure data has arrived when no more burst batons available timer", (bool)mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer);
+        IHelper::debugAppend(resultEl, "tail loss probes sent", mTailLossProbesSent);
+        IHelper::debugAppend(resultEl, "total tail loss probes", mTotalTailLossProbes);
+
+        IHelper::debugAppend(resultEl, "most recent delivered sent time", mMostRecentDeliveredSentTime);
+        IHelper::debugAppend(resultEl, "most recent delivered RTT (ms)", mMostRecentDeliveredRTT);
+        IHelper::debugAppend(resultEl, "minimum observed RTT (ms)", mMinimumObservedRTT);
+        IHelper::debugAppend(resultEl, "loss detection timer", (bool)mLossDetectionTimer);
+        IHelper::debugAppend(resultEl, "fast retransmit now", mFastRetransmitNow);
 
         IHelper::debugAppend(resultEl, "add to available burst batons timer", (bool)mAddToAvailableBurstBatonsTimer);
         IHelper::debugAppend(resultEl, "add to available burst batons duration (ms)", mAddToAvailableBurstBatonsDuation);
 
         IHelper::debugAppend(resultEl, "total packets per burst", mPacketsPerBurst);
 
+        IHelper::debugAppend(resultEl, "pace sending", mPaceSending);
+        IHelper::debugAppend(resultEl, "burst timer duration (ms)", mBurstTimerDuration);
+        IHelper::debugAppend(resultEl, "paced burst packets remaining", mPacedBurstPacketsRemaining);
+        IHelper::debugAppend(resultEl, "next paced send time", mNextPacedSendTime);
+
         IHelper::debugAppend(resultEl, "bandwidth increase frozen", mBandwidthIncreaseFrozen);
         IHelper::debugAppend(resultEl, "started sending time", mStartedSendingAtTime);
         IHelper::debugAppend(resultEl, "total sending period without issues (ms)", mTotalSendingPeriodWithoutIssues);
@@ -996,11 +1187,23 @@ namespace ortc
           mSendStream->cancel();
         }
 
+        for (auto iter = mSubStreams.begin(); iter != mSubStreams.end(); ++iter) {
+          SubStream &subStream = (*iter);
+          if (subStream.mReceiveStream) subStream.mReceiveStream->cancel();
+          if (subStream.mSendStream) subStream.mSendStream->cancel();
+          subStream.mPendingReceiveData.clear();
+        }
+
         if (mBurstTimer) {
           mBurstTimer->cancel();
           mBurstTimer.reset();
         }
 
+        if (mLossDetectionTimer) {
+          mLossDetectionTimer->cancel();
+          mLossDetectionTimer.reset();
+        }
+
         if (mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer) {
           mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->cancel();
           mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer.reset();
@@ -1060,8 +1263,7 @@ namespace ortc
       //-----------------------------------------------------------------------
       bool RUDPChannelStream::sendNowHelper(
                                             IRUDPChannelStreamDelegatePtr &delegate,
-                                            const BYTE *buffer,
-                                            size_t packetLengthInBytes
+                                            PacketBufferPtr packet
                                             )
       {
 #ifdef ORTC_INDUCE_FAKE_PACKET_LOSS
@@ -1069,9 +1271,9 @@ namespace ortc
         if (forcePacketLoss) {
           ZS_LOG_WARNING(Trace, log("faking packet loss in deliver attempt"))
         }
-        return = (forcePacketLoss ? true : (delegate->notifyRUDPChannelStreamSendPacket(mThisWeak.lock(), buffer, packetLengthInBytes)));
+        return = (forcePacketLoss ? true : (delegate->notifyRUDPChannelStreamSendPacket(mThisWeak.lock(), packet)));
 #else
-        return delegate->notifyRUDPChannelStreamSendPacket(mThisWeak.lock(), buffer, packetLengthInBytes);
+        return delegate->notifyRUDPChannelStreamSendPacket(mThisWeak.lock(), packet);
 #endif //ORTC_INDUCE_FAKE_PACKET_LOSS
       }
 
@@ -1118,7 +1320,7 @@ namespace ortc
                        ZS_PARAM("packets per burst", mPacketsPerBurst) +
                        ZS_PARAM("resend", mTotalPacketsToResend) +
                        ZS_PARAM("send size", mSendingPackets.size()) +
-                       ZS_PARAM("write data", (mSendStream ? mSendStream->getTotalReadBuffersAvailable() : 0)))
+                       ZS_PARAM("write data", getTotalWriteBuffers()))
 
           if (isShutdown()) {
             ZS_LOG_TRACE(log("already shutdown thus aborting send now"))
@@ -1143,6 +1345,9 @@ namespace ortc
             return false; // already in the middle of an attempt at sending so cannot create or send more packets now
           }
 
+          // free the memory of sent data nobody cares about anymore
+          abandonExpiredPackets(zsLib::now());
+
           protect.set();
         }
 
@@ -1156,18 +1361,42 @@ namespace ortc
           // scope: check out if we can send now
           {
             AutoRecursiveLock lock(mLock);
-            if (0 == mAvailableBurstBatons) {
+
+            // a newly detected loss is resent right away even if there are no
+            // batons available or the pacing would otherwise delay it
+            bool fastRetransmit = (mFastRetransmitNow) && (0 != mTotalPacketsToResend);
+            mFastRetransmitNow = false;
+
+            if ((0 == mAvailableBurstBatons) &&
+                (!fastRetransmit)) {
               ZS_LOG_TRACE(log("no batons for bursting available for sending data thus aborting send routine"))
               goto sendNowQuickExit;
             }
 
-            packetsToSend = mPacketsPerBurst;
+            if (mPaceSending) {
+              packetsToSend = getPacedPacketsToSend(zsLib::now());
+              if ((0 == packetsToSend) &&
+                  (fastRetransmit)) {
+                packetsToSend = 1;
+              }
+              if (0 == packetsToSend) {
+                ZS_LOG_TRACE(log("paced sending is not allowing another packet onto the wire yet") + ZS_PARAM("next paced send time", mNextPacedSendTime))
+                goto sendNowQuickExit;
+              }
+            } else {
+              packetsToSend = mPacketsPerBurst;
+            }
+
+            if (0 == mAvailableBurstBatons) {
+              ZS_LOG_TRACE(log("fast retransmitting lost packet without a baton") + ZS_PARAM("resend", mTotalPacketsToResend))
+              packetsToSend = 1;
+            }
           }
 
           while (0 != packetsToSend)
           {
             BufferedPacketPtr attemptToDeliver;
-            SecureByteBlockPtr attemptToDeliverBuffer;
+            PacketBufferPtr attemptToDeliverBuffer;
 
             // scope: grab the next buffer to be resent over the wire
             {
@@ -1185,8 +1414,25 @@ namespace ortc
                 for (; iter != mSendingPackets.end(); ++iter) {
                   BufferedPacketPtr &packet = (*iter).second;
                   if (packet->mFlagForResendingInNextBurst) {
+                    ++(packet->mTotalRetransmits);
+                    if ((packet->mReliability) &&
+                        (packet->mReliability->hasExpired(packet->mTotalRetransmits, zsLib::now()))) {
+                      abandonPacket(packet);
+                    }
+
                     attemptToDeliver = packet;
                     attemptToDeliverBuffer = packet->mPacket;
+
+                    // a resent packet's ACK cannot be used to measure the RTT
+                    packet->mFlaggedAsFailedToReceive = true;
+
+                    if (!packet->mRUDPPacket->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)) {
+                      // ask the remote party to ACK the resent packet right
+                      // away instead of having to force an external ACK
+                      packet->mRUDPPacket->setFlag(RUDPPacket::Flag_AR_ACKRequired);
+                      RUDPPacket::setFlag(packet->mPacket->data(), packet->mPacket->size(), RUDPPacket::Flag_AR_ACKRequired);
+                    }
+                    break;  // resend the oldest lost packet first
                   }
                 }
               }
@@ -1197,8 +1443,7 @@ namespace ortc
 
               // there are no packets to be resent so attempt to create a new packet to send...
 
-              if (!mSendStream) goto sendNowQuickExit;
-              if (mSendStream->getTotalReadBuffersAvailable() < 1) goto sendNowQuickExit;
+              if (getTotalWriteBuffers() < 1) goto sendNowQuickExit;
 
               // we need to start breaking up new packets immediately that will be sent over the wire
               RUDPPacketPtr newPacket = RUDPPacket::create();
@@ -1278,15 +1523,26 @@ namespace ortc
 
               size_t availableBytes = newPacket->getRoomAvailableForData(ORTC_SERVICES_RUDP_MAX_PACKET_SIZE_WHEN_PMTU_IS_NOT_KNOWN);
 
-              size_t bytesRead = getFromWriteBuffer(&(temp[0]), availableBytes);
+              ReliabilityHeaderPtr reliability;
+              size_t bytesRead = getFromWriteBuffer(&(temp[0]), availableBytes, reliability);
+              if ((0 == bytesRead) &&
+                  (getTotalWriteBuffers() < 1)) {
+                ZS_LOG_TRACE(log("all remaining write data expired before it could be sent"))
+                goto sendNowQuickExit;
+              }
+              if ((reliability) &&
+                  (!reliability->mOrdered)) {
+                newPacket->setFlag(RUDPPacket::Flag_UO_Unordered);
+              }
               newPacket->mData = &(temp[0]);
 #ifdef _ANDROID
 			  newPacket->mDataLengthInBytes = bytesRead;
 #else
               newPacket->mDataLengthInBytes = static_cast<decltype(newPacket->mDataLengthInBytes)>(bytesRead);
 #endif
-              if ((mSendStream->getTotalReadBuffersAvailable() < 1) ||
-                  (1 == packetsToSend)) {
+              bool lastPacketInBurst = (mPaceSending ? (1 == mPacedBurstPacketsRemaining) : (1 == packetsToSend));
+              if ((getTotalWriteBuffers() < 1) ||
+                  (lastPacketInBurst)) {
                 newPacket->setFlag(RUDPPacket::Flag_AR_ACKRequired);
                 if (mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer) {
                   ZS_LOG_TRACE(log("since a newly created packet has an ACK we will cancel the current ensure timer") + ZS_PARAM("timer ID", mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->getID()))
@@ -1296,7 +1552,8 @@ namespace ortc
                 }
               }
 
-              SecureByteBlockPtr packetizedBuffer = newPacket->packetize();
+              // reserve room so a TURN relay can frame the packet without a copy
+              PacketBufferPtr packetizedBuffer = newPacket->packetize(ORTC_SERVICES_PACKET_BUFFER_DEFAULT_HEADROOM_IN_BYTES, ORTC_SERVICES_PACKET_BUFFER_DEFAULT_TAILROOM_IN_BYTES);
               ZS_THROW_BAD_STATE_IF(!packetizedBuffer)
 
               BufferedPacketPtr bufferedPacket = BufferedPacket::create();
@@ -1305,11 +1562,13 @@ namespace ortc
               bufferedPacket->mXORedParityToNow = mXORedParityToNow;          // when the remore party reports their GSNFR parity in an ACK, this value is required to verify it is accurate
               bufferedPacket->mRUDPPacket = newPacket;
               bufferedPacket->mPacket = packetizedBuffer;
+              bufferedPacket->mReliability = reliability;
+              if (reliability) mPartiallyReliableDataSent = true;
 
               ZS_LOG_TRACE(
                            log("adding buffer to pending list")
                            + ZS_PARAM("sequence number", sequenceToString(mNextSequenceNumber))
-                           + ZS_PARAM("packet size", packetizedBuffer->SizeInBytes())
+                           + ZS_PARAM("packet size", packetizedBuffer->size())
                            + ZS_PARAM("GSNR", sequenceToString(mGSNR))
                            + ZS_PARAM("GSNFR", sequenceToString(mGSNFR))
                            + ZS_PARAM("vector size", newPacket->mVectorLengthInBytes)
@@ -1345,7 +1604,7 @@ namespace ortc
             }
 
             ZS_LOG_TRACE(log("attempting to (re)send packet") + ZS_PARAM("sequence number", sequenceToString(attemptToDeliver->mSequenceNumber)) + ZS_PARAM("packets to send", packetsToSend))
-            bool sent = sendNowHelper(delegate, *attemptToDeliverBuffer, attemptToDeliverBuffer->SizeInBytes());
+            bool sent = sendNowHelper(delegate, attemptToDeliverBuffer);
             if (!sent) {
               ZS_LOG_WARNING(Trace, log("unable to send data onto wire as data failed to send") + ZS_PARAM("sequence number", sequenceToString(attemptToDeliver->mSequenceNumber)))
               if (firstPacketCreated == attemptToDeliver) {
@@ -1361,10 +1620,15 @@ namespace ortc
             --packetsToSend;  // total packets to send in the burst is now decreased
 
             AutoRecursiveLock lock(mLock);
-            if (attemptToDeliver->mFlagForResendingInNextBurst) {
-              ZS_LOG_TRACE(log("flag for resending in next burst is set this will force an ACK next time possible"))
+            Time tick = zsLib::now();
 
-              mForceACKNextTimePossible = true;                     // we need to force an ACK when there is resent data to ensure it has arrived
+            attemptToDeliver->mTimeSent = tick;
+
+            if (mPaceSending) {
+              notifyPacedPacketSent(tick);
+            }
+            if (attemptToDeliver->mFlagForResendingInNextBurst) {
+              ZS_LOG_TRACE(log("packet flagged for resending was resent") + ZS_PARAM("sequence number", sequenceToString(attemptToDeliver->mSequenceNumber)))
               attemptToDeliver->doNotResend(mTotalPacketsToResend); // if this was marked for resending, then clear it now since it is resent
             }
           }
@@ -1383,7 +1647,17 @@ namespace ortc
       sendNowQuickExit:
         AutoRecursiveLock lock(mLock);
         if (lastPacketSent) {
-          if (lastPacketSent->mPacket) {  // make sure the packet hasn't already been released
+          bool burstComplete = true;
+          if (mPaceSending) {
+            // a paced burst is spread across many calls to send now and is
+            // only complete once all its packets are sent or an ACK was
+            // requested because there was no more data to send
+            burstComplete = (0 == mPacedBurstPacketsRemaining) ||
+                            ((lastPacketSent->mRUDPPacket) && (lastPacketSent->mRUDPPacket->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)));
+            if (burstComplete) mPacedBurstPacketsRemaining = 0;
+          }
+          if ((burstComplete) &&
+              (lastPacketSent->mPacket)) {  // make sure the packet hasn't already been released
             // the last packet sent over the wire will hold the baton
             lastPacketSent->consumeBaton(mAvailableBurstBatons);
           }
@@ -1396,7 +1670,7 @@ namespace ortc
       //-----------------------------------------------------------------------
       void RUDPChannelStream::sendNowCleanup()
       {
-        ULONG writeBuffers = static_cast<ULONG>(mSendStream ? mSendStream->getTotalReadBuffersAvailable() : 0);
+        ULONG writeBuffers = getTotalWriteBuffers();
 
         ZS_LOG_TRACE(log("starting send now cleanup routine") +
                      ZS_PARAM("packets to resend", mTotalPacketsToResend) +
@@ -1429,47 +1703,27 @@ namespace ortc
         if (mSendingPackets.size() > 0) {
           // there is unacked sent packets in the buffer waiting for an ACK...
 
-          // because there is unacked send data we should make sure a timer is setup to eventually ACK this data
+          // because there is unacked send data we should make sure a timer
+          // is setup to eventually probe for the ACK of this data
           ensureDataHasArrivedTimer = true;
 
-          // also we should force a new ACK if none of the
-          forceACKOfSentPacketsRequired = true;
+          // an external ACK is only forced when tail loss probes have failed
+          // to cause the remote party to ACK the data
+          forceACKOfSentPacketsRequired = mForceACKNextTimePossible;
 
           if ((0 != mAvailableBurstBatons) &&
               (writeBuffers > 0)) {
 
             // but if there is available batons and write data outstanding then
             // there's no need to setup a timer to ensure the data to be acked
-            // or force the data to be acked right away
+            // as the new data will carry the ACK request
             ensureDataHasArrivedTimer = false;
-            forceACKOfSentPacketsRequired = mForceACKNextTimePossible;  // only required in this case if there was  request to force the ACK next time possible
           }
 
           if (0 != mForceACKOfSentPacketsRequestID) {
             forceACKOfSentPacketsRequired = false;  // cannot force again since there is already an outstanding request
           }
 
-          if ((forceACKOfSentPacketsRequired) &&
-              (!mForceACKNextTimePossible)) {
-            // if we are forcing a packet now but not because we are required
-            // to do it next time possible then we should see if there is
-            // already an outstanding ACK require packet holding a baton
-            // in which case we don't need to force an ACK immediately
-            for (BufferedPacketMap::iterator iter = mSendingPackets.begin(); iter != mSendingPackets.end(); ++iter) {
-              BufferedPacketPtr &packet = (*iter).second;
-
-              if ((packet->mHoldsBaton) &&
-                  (packet->mRUDPPacket->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)) &&
-                  (!packet->mFlagForResendingInNextBurst)) {
-                // this packet holds a baton and is required to ACK so it's
-                // possible that the ACK will eventually arrive so no need for
-                // force an ACK just yet...
-                forceACKOfSentPacketsRequired = false;
-                break;
-              }
-            }
-          }
-
           if (forceACKOfSentPacketsRequired) {
             // if an ACK is being forced to send right away then no need
             // to start a timer to eventually force an ACK since it is already
@@ -1494,11 +1748,39 @@ namespace ortc
           ensureDataHasArrivedTimer = false;
         }
 
-        if (burstTimerRequired) {
+        if ((burstTimerRequired) &&
+            (mPaceSending)) {
+          // when pacing the burst timer ticks when the next paced packet is
+          // due (but no faster than the timer granularity) and is only
+          // re-created when that delay changes; see getPacedPacketsToSend
+          Milliseconds pacedDuration(ORTC_SERVICES_RUDP_MINIMUM_PACING_TIMER_IN_MILLISECONDS);
+
+          Time tick = zsLib::now();
+          if (mNextPacedSendTime > tick) {
+            // round up so the timer never fires before the packet is due
+            Milliseconds untilDue = std::chrono::duration_cast<Milliseconds>(std::chrono::duration_cast<Microseconds>(mNextPacedSendTime - tick) + Microseconds(999));
+            if (untilDue > pacedDuration) pacedDuration = untilDue;
+          }
+
+          if ((mBurstTimer) &&
+              (pacedDuration != mBurstTimerDuration)) {
+            ZS_LOG_TRACE(log("re-creating the paced burst timer as the delay until the next paced send changed") + ZS_PARAM("timer ID", mBurstTimer->getID()) + ZS_PARAM("was duration (ms)", mBurstTimerDuration) + ZS_PARAM("duration (ms)", pacedDuration))
+            mBurstTimer->cancel();
+            mBurstTimer.reset();
+          }
+
+          if (!mBurstTimer) {
+            mBurstTimerDuration = pacedDuration;
+            mBurstTimer = ITimer::create(mThisWeak.lock(), mBurstTimerDuration);
+
+            ZS_LOG_TRACE(log("creating a paced burst timer since there is data to send and available batons to send it") + ZS_PARAM("timer ID", mBurstTimer->getID()) + ZS_PARAM("available batons", mAvailableBurstBatons) + ZS_PARAM("packets per burst", mPacketsPerBurst) + ZS_PARAM("write size", writeBuffers) + ZS_PARAM("sending size", mSendingPackets.size()) + ZS_PARAM("timer duration (ms)", mBurstTimerDuration) + ZS_PARAM("pacing interval (us)", getPacingInterval().count()) + ZS_PARAM("calculated RTT (ms)", mCalculatedRTT))
+          }
+        } else if (burstTimerRequired) {
           if (!mBurstTimer) {
             Milliseconds burstDuration = mCalculatedRTT / ((int)mAvailableBurstBatons);
 
             // all available bursts should happen in one RTT
+            mBurstTimerDuration = burstDuration;
             mBurstTimer = ITimer::create(mThisWeak.lock(), burstDuration);
             if (burstDuration < Milliseconds(ORTC_SERVICES_RUDP_MINIMUM_BURST_TIMER_IN_MILLISECONDS)) {
               burstDuration = Milliseconds(ORTC_SERVICES_RUDP_MINIMUM_BURST_TIMER_IN_MILLISECONDS);
@@ -1517,9 +1799,12 @@ namespace ortc
 
         if (ensureDataHasArrivedTimer) {
           if (!mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer) {
-            Milliseconds ensureDuration = (mCalculatedRTT*3)/2;
+            // The timer is set to fire at 2 x calculated RTT (doubling for every unanswered probe)
+            Milliseconds ensureDuration = (mCalculatedRTT*2) * (1 << (mTailLossProbesSent > 5 ? 5 : mTailLossProbesSent));
+            if (ensureDuration > Seconds(ORTC_SERVICES_RUDP_MAX_TAIL_LOSS_PROBE_TIMEOUT_IN_SECONDS)) {
+              ensureDuration = Seconds(ORTC_SERVICES_RUDP_MAX_TAIL_LOSS_PROBE_TIMEOUT_IN_SECONDS);
+            }
 
-            // The timer is set to fire at 1.5 x calculated RTT
             mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer = ITimer::create(mThisWeak.lock(), ensureDuration, false);
 
             ZS_LOG_TRACE(log("starting ensure timer to make sure packets get acked") + ZS_PARAM("timer ID", mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->getID()) + ZS_PARAM("available batons", mAvailableBurstBatons) + ZS_PARAM("write size", writeBuffers) + ZS_PARAM("sending size", mSendingPackets.size()) + ZS_PARAM("ensure duration (ms)", ensureDuration) + ZS_PARAM("calculated RTT (ms)", mCalculatedRTT))
@@ -1573,6 +1858,142 @@ namespace ortc
                      ZS_PARAM("forced sequence number", sequenceToString(mForceACKOfSentPacketsAtSendingSequnceNumber)))
       }
 
+      //-----------------------------------------------------------------------
+      Microseconds RUDPChannelStream::getPacingInterval() const
+      {
+        // the congestion window allows for "batons x packets per burst"
+        // packets every RTT, pacing spreads those packets evenly across the
+        // RTT instead of releasing each burst back to back
+        ULONG packetsPerRTT = mAvailableBurstBatons * mPacketsPerBurst;
+        if (packetsPerRTT < 1) packetsPerRTT = 1;
+
+        Microseconds interval = std::chrono::duration_cast<Microseconds>(mCalculatedRTT) / packetsPerRTT;
+        if (interval < Microseconds(ORTC_SERVICES_RUDP_MINIMUM_PACING_INTERVAL_IN_MICROSECONDS)) {
+          interval = Microseconds(ORTC_SERVICES_RUDP_MINIMUM_PACING_INTERVAL_IN_MICROSECONDS);
+        }
+        return interval;
+      }
+
+      //-----------------------------------------------------------------------
+      ULONG RUDPChannelStream::getPacedPacketsToSend(Time tick)
+      {
+        if (0 == mPacedBurstPacketsRemaining) {
+          // start a new burst
+          mPacedBurstPacketsRemaining = mPacketsPerBurst;
+        }
+
+        Microseconds interval = getPacingInterval();
+
+        if ((Time() == mNextPacedSendTime) ||
+            (tick > mNextPacedSendTime + (interval * mPacketsPerBurst))) {
+          // the pacer was idle so restart the pacing from now rather than
+          // catching up with a burst of packets
+          mNextPacedSendTime = tick;
+        }
+
+        if (tick < mNextPacedSendTime) return 0;
+
+        // the timer has a millisecond resolution so when the pacing interval
+        // is smaller than the timer resolution more than one packet is owed
+        Microseconds behind = std::chrono::duration_cast<Microseconds>(tick - mNextPacedSendTime);
+        ULONG allowed = 1 + static_cast<ULONG>(behind.count() / interval.count());
+
+        if (allowed > mPacedBurstPacketsRemaining) allowed = mPacedBurstPacketsRemaining;
+        return allowed;
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::notifyPacedPacketSent(Time tick)
+      {
+        if (mPacedBurstPacketsRemaining > 0) --mPacedBurstPacketsRemaining;
+
+        if (Time() == mNextPacedSendTime) mNextPacedSendTime = tick;
+        mNextPacedSendTime += getPacingInterval();
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::sendTailLossProbe()
+      {
+        //*********************************************************************
+        //*********************************************************************
+        //                              WARNING
+        //*********************************************************************
+        // This method calls a delegate synchronously thus cannot be called
+        // from within a lock.
+        //*********************************************************************
+
+        IRUDPChannelStreamDelegatePtr delegate;
+        BufferedPacketPtr probe;
+        PacketBufferPtr probeBuffer;
+
+        // scope: pick the packet to probe with
+        {
+          AutoRecursiveLock lock(mLock);
+          if (isShutdown()) return;
+          if (!mDelegate) return;
+          if (!mDidReceiveWriteReady) return;
+
+          delegate = mDelegate;
+
+          // the most recently sent unacked packet is resent as the probe so
+          // the ACK it solicits reveals every packet missing before it
+          for (BufferedPacketMap::reverse_iterator iter = mSendingPackets.rbegin(); iter != mSendingPackets.rend(); ++iter) {
+            BufferedPacketPtr &packet = (*iter).second;
+            if (!packet->mPacket) continue;
+            probe = packet;
+            break;
+          }
+
+          if (!probe) {
+            ZS_LOG_TRACE(log("no unacked packet available to send as a tail loss probe"))
+            return;
+          }
+
+          probeBuffer = probe->mPacket;
+
+          if (!probe->mRUDPPacket->isFlagSet(RUDPPacket::Flag_AR_ACKRequired)) {
+            probe->mRUDPPacket->setFlag(RUDPPacket::Flag_AR_ACKRequired);
+            RUDPPacket::setFlag(probeBuffer->data(), probeBuffer->size(), RUDPPacket::Flag_AR_ACKRequired);
+          }
+
+          probe->mFlaggedAsFailedToReceive = true;  // the ACK might be for the original or the probe so no RTT can be measured
+          ++mTailLossProbesSent;
+          ++mTotalTailLossProbes;
+
+          ZS_LOG_TRACE(log("sending tail loss probe") + ZS_PARAM("sequence number", sequenceToString(probe->mSequenceNumber)) + ZS_PARAM("probes sent", mTailLossProbesSent) + ZS_PARAM("total probes", mTotalTailLossProbes))
+        }
+
+        try {
+          bool sent = sendNowHelper(delegate, probeBuffer);
+          if (!sent) {
+            ZS_LOG_WARNING(Trace, log("unable to send tail loss probe onto wire") + ZS_PARAM("sequence number", sequenceToString(probe->mSequenceNumber)))
+            return;
+          }
+
+          AutoRecursiveLock lock(mLock);
+          probe->mTimeSent = zsLib::now();
+        } catch(IRUDPChannelStreamDelegateProxy::Exceptions::DelegateGone &) {
+          AutoRecursiveLock lock(mLock);
+          setError(RUDPChannelStreamShutdownReason_DelegateGone, "delegate gone");
+          cancel();
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::resetTailLossProbes()
+      {
+        if (0 == mTailLossProbesSent) return;
+
+        ZS_LOG_TRACE(log("ACK progress made thus resetting tail loss probe backoff") + ZS_PARAM("probes sent", mTailLossProbesSent))
+        mTailLossProbesSent = 0;
+
+        if (mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer) {
+          // the timer will be recreated without the backoff
+          mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer->cancel();
+          mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer.reset();
+        }
+      }
+
       //-----------------------------------------------------------------------
       void RUDPChannelStream::handleAck(
                                         QWORD nextSequenceNumber,
@@ -1587,6 +2008,8 @@ namespace ortc
                                         bool ecFlag
                                         ) throw(Exceptions::IllegalACK)
       {
+        Time tick = zsLib::now();
+
         // scope: handle the ACK
         {
           if (ecFlag) {
@@ -1642,7 +2065,7 @@ namespace ortc
               if (!(gsnrPacket->mFlaggedAsFailedToReceive)) {
                 Milliseconds oldRTT = mCalculatedRTT;
 
-                mCalculatedRTT = zsLib::toMilliseconds(zsLib::now() - gsnrPacket->mTimeSentOrReceived);
+                mCalculatedRTT = zsLib::toMilliseconds(tick - gsnrPacket->mTimeSent);
 
                 // we have the new calculated time but we will only move halfway between the old calculation and the new one
                 if (mCalculatedRTT > oldRTT) {
@@ -1676,6 +2099,7 @@ namespace ortc
           }
 
           bool hadPackets = (mSendingPackets.size() > 0);
+          bool ackProgress = false;
 
           // we can now acknowledge and clean out all packets up-to and including the gsnfr packet
           while (0 != mSendingPackets.size()) {
@@ -1688,6 +2112,7 @@ namespace ortc
 
             ZS_LOG_TRACE(log("cleaning ACKed packet") + ZS_PARAM("sequence number", sequenceToString(current->mSequenceNumber)) + ZS_PARAM("GSNFR", sequenceToString(gsnfr)))
 
+            if (handleDeliveredForLossDetection(current, tick)) ackProgress = true;
             current->flagAsReceivedByRemoteParty(mTotalPacketsToResend, mAvailableBurstBatons);
             mSendingPackets.erase(mSendingPackets.begin());
           }
@@ -1699,6 +2124,8 @@ namespace ortc
             hadPackets = false;
           }
 
+          if (ackProgress) resetTailLossProbes();
+
           // there will be no vector if these are equal
           if (gsnr == gsnfr) {
             ZS_LOG_TRACE(log("ACK packet GSNR == GSNFR thus no vector will be present") + ZS_PARAM("gsnr/gsnfr", sequenceToString(gsnr)))
@@ -1712,7 +2139,6 @@ namespace ortc
 
           bool xoredParity = xpFlag;
           bool foundECN = false;
-          bool foundLoss = false;
 
           String vectorParityField;
           bool couldNotCalculateVectorParity = false;
@@ -1754,16 +2180,13 @@ namespace ortc
 
               // mark the current packet as being received by cleaning out the original packet data (but not the packet information)
               ZS_LOG_TRACE(log("marking packet as received because of vector ACK") + ZS_PARAM("sequence number", sequenceToString(bufferedPacket->mSequenceNumber)))
+              if (handleDeliveredForLossDetection(bufferedPacket, tick)) ackProgress = true;
               bufferedPacket->flagAsReceivedByRemoteParty(mTotalPacketsToResend, mAvailableBurstBatons);
             } else {
               // this packet was not received, do not remove the packet data
+              // (a hole in the vector is not declared lost until packets sent
+              // after it are ACKed beyond the reordering window)
               if (ZS_IS_LOGGING(Trace)) { vectorParityField += "."; }
-
-              if (!bufferedPacket->mFlaggedAsFailedToReceive) {
-                bufferedPacket->mFlaggedAsFailedToReceive = true;
-                bufferedPacket->flagForResending(mTotalPacketsToResend);  // since this is the first report of this packet being lost we can be sure it needs to be resent immediately
-                foundLoss = true;
-              }
             }
 
             if (RUDPPacket::VectorState_ReceivedECNMarked == state)
@@ -1777,6 +2200,7 @@ namespace ortc
             // now it is time to mark the gsnr as received
             BufferedPacketPtr gsnrPacket = (*gsnrIter).second;
             ZS_LOG_TRACE(log("marking GSNR as received in vector case") + ZS_PARAM("sequence number", sequenceToString(gsnrPacket->mSequenceNumber)))
+            if (handleDeliveredForLossDetection(gsnrPacket, tick)) ackProgress = true;
             gsnrPacket->flagAsReceivedByRemoteParty(mTotalPacketsToResend, mAvailableBurstBatons);
           }
 
@@ -1793,8 +2217,7 @@ namespace ortc
           if (dpFlag)
             handleDuplicate();
 
-          if (foundLoss)
-            handlePacketLoss();
+          if (ackProgress) resetTailLossProbes();
 
           ZS_LOG_TRACE(
                        log("handling ACK with values")
@@ -1819,6 +2242,9 @@ namespace ortc
 
       handleAckQuickExit:
 
+        if (detectLossByTime(tick))
+          handlePacketLoss();
+
         handleUnfreezing();
 
         if (mSendingPackets.size() < 1) {
@@ -1900,6 +2326,89 @@ namespace ortc
         }
       }
 
+      //-----------------------------------------------------------------------
+      bool RUDPChannelStream::handleDeliveredForLossDetection(
+                                                              BufferedPacketPtr packet,
+                                                              Time tick
+                                                              )
+      {
+        if (!packet->mPacket) return false;  // already ACKed by an earlier ACK
+
+        Milliseconds rtt = zsLib::toMilliseconds(tick - packet->mTimeSent);
+
+        if (!packet->mFlaggedAsFailedToReceive) {
+          if ((Milliseconds() == mMinimumObservedRTT) ||
+              (rtt < mMinimumObservedRTT)) {
+            mMinimumObservedRTT = rtt;
+          }
+        } else if (rtt < mMinimumObservedRTT) {
+          // the ACK arrived too quickly to be for the resent copy thus it must
+          // be for an earlier transmission and it cannot tell when the resent
+          // copy was delivered
+          return true;
+        }
+
+        if (packet->mTimeSent >= mMostRecentDeliveredSentTime) {
+          mMostRecentDeliveredSentTime = packet->mTimeSent;
+          mMostRecentDeliveredRTT = rtt;
+        }
+        return true;
+      }
+
+      //-----------------------------------------------------------------------
+      bool RUDPChannelStream::detectLossByTime(Time tick)
+      {
+        if (Time() == mMostRecentDeliveredSentTime) return false;  // nothing was ever ACKed
+
+        // allow packets to be reordered by up to a quarter of the smallest RTT
+        Milliseconds reorderingWindow = mMinimumObservedRTT / 4;
+        if (reorderingWindow < Milliseconds(ORTC_SERVICES_RUDP_MINIMUM_REORDERING_WINDOW_IN_MILLISECONDS)) {
+          reorderingWindow = Milliseconds(ORTC_SERVICES_RUDP_MINIMUM_REORDERING_WINDOW_IN_MILLISECONDS);
+        }
+
+        bool foundLoss = false;
+        Time nextLossAt;
+
+        for (BufferedPacketMap::iterator iter = mSendingPackets.begin(); iter != mSendingPackets.end(); ++iter) {
+          BufferedPacketPtr &packet = (*iter).second;
+
+          if (!packet->mPacket) continue;                                     // already ACKed
+          if (packet->mFlagForResendingInNextBurst) continue;                 // already waiting to be resent
+          if (packet->mTimeSent >= mMostRecentDeliveredSentTime) continue;    // nothing sent after this packet has been ACKed yet
+
+          Time lostAt = packet->mTimeSent + mMostRecentDeliveredRTT + reorderingWindow;
+          if (lostAt <= tick) {
+            ZS_LOG_TRACE(log("packet detected as lost") + ZS_PARAM("sequence number", sequenceToString(packet->mSequenceNumber)) + ZS_PARAM("reordering window (ms)", reorderingWindow))
+            packet->mFlaggedAsFailedToReceive = true;
+            packet->flagForResending(mTotalPacketsToResend);
+            foundLoss = true;
+            continue;
+          }
+
+          if ((Time() == nextLossAt) ||
+              (lostAt < nextLossAt)) {
+            nextLossAt = lostAt;
+          }
+        }
+
+        if (mLossDetectionTimer) {
+          mLossDetectionTimer->cancel();
+          mLossDetectionTimer.reset();
+        }
+
+        if (Time() != nextLossAt) {
+          // check again once the earliest outstanding packet exceeds the reordering window
+          Milliseconds wait = zsLib::toMilliseconds(nextLossAt - tick) + Milliseconds(1);
+          mLossDetectionTimer = ITimer::create(mThisWeak.lock(), wait, false);
+          ZS_LOG_TRACE(log("loss detection timer started") + ZS_PARAM("timer ID", mLossDetectionTimer->getID()) + ZS_PARAM("wait (ms)", wait))
+        }
+
+        if (foundLoss) {
+          mFastRetransmitNow = true;
+        }
+        return foundLoss;
+      }
+
       //-----------------------------------------------------------------------
       void RUDPChannelStream::handleUnfreezing()
       {
@@ -1952,21 +2461,18 @@ namespace ortc
 
           // this is the next packet in the series... process the data from the
           // packet first (but only process the data if the receive is not
-          // shutdown otherwise the data will be ignored and dropped)
+          // shutdown otherwise the data will be ignored and dropped); sub-stream
+          // data was already delivered when the packet arrived
           if ((bufferedPacket->mRUDPPacket->mDataLengthInBytes > 0) &&
-              (0 == (IRUDPChannel::Shutdown_Receive & mShutdownState))) {
+              (!bufferedPacket->mDataDelivered) &&
+              (mTotalSubStreams < 2)) {
 
             const BYTE *pos = bufferedPacket->mRUDPPacket->mData;
             size_t bytes = bufferedPacket->mRUDPPacket->mDataLengthInBytes;
 
             totalDelivered += static_cast<decltype(totalDelivered)>(bytes);
 
-            if (mReceiveStream) {
-              mReceiveStream->write(pos, bytes);
-            } else {
-              ZS_THROW_BAD_STATE_IF(!mPendingReceiveData)
-              mPendingReceiveData->Put(pos, bytes);
-            }
+            writeReceivedData(0, pos, bytes);
           }
 
           // recalculate the GSNFR information
@@ -1982,20 +2488,273 @@ namespace ortc
         }
       }
 
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::deliverSubStreamData(BufferedPacketPtr packet)
+      {
+        size_t length = packet->mRUDPPacket->mDataLengthInBytes;
+        if (length < 1) return;
+
+        if (length < ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE) {
+          ZS_LOG_WARNING(Detail, log("sub stream data is missing its header (thus ignoring)") + ZS_PARAM("sequence number", sequenceToString(packet->mSequenceNumber)) + ZS_PARAM("length", length))
+          return;
+        }
+
+        const BYTE *pos = packet->mRUDPPacket->mData;
+
+        WORD subStreamID = IHelper::getBE16(pos);
+        DWORD subStreamSequenceNumber = IHelper::getBE32(&(pos[sizeof(WORD)]));
+
+        pos += ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE;
+        length -= ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE;
+
+        if (subStreamID >= mSubStreams.size()) {
+          ZS_LOG_WARNING(Detail, log("sub stream data received for unknown sub stream (thus ignoring)") + ZS_PARAM("sub stream", subStreamID))
+          return;
+        }
+
+        SubStream &subStream = mSubStreams[subStreamID];
+
+        if (subStreamSequenceNumber < subStream.mNextReceiveSequenceNumber) {
+          ZS_LOG_TRACE(log("sub stream data already delivered (thus ignoring)") + ZS_PARAM("sub stream", subStreamID) + ZS_PARAM("sequence number", subStreamSequenceNumber))
+          return;
+        }
+
+        if (subStreamSequenceNumber != subStream.mNextReceiveSequenceNumber) {
+          if (subStream.mPendingReceiveData.end() != subStream.mPendingReceiveData.find(subStreamSequenceNumber)) return;
+
+          ITransportStreamWriterPtr receiveStream = (0 == subStreamID ? mReceiveStream : subStream.mReceiveStream);
+          if ((packet->mRUDPPacket->isFlagSet(RUDPPacket::Flag_UO_Unordered)) &&
+              (receiveStream)) {
+            // deliver now and only remember the slot was filled
+            writeReceivedData(subStreamID, pos, length, createUnorderedHeader());
+            subStream.mPendingReceiveData[subStreamSequenceNumber] = SecureByteBlockPtr();
+            return;
+          }
+
+          ZS_LOG_TRACE(log("sub stream data arrived before earlier data on the same sub stream") + ZS_PARAM("sub stream", subStreamID) + ZS_PARAM("sequence number", subStreamSequenceNumber) + ZS_PARAM("expecting", subStream.mNextReceiveSequenceNumber))
+          subStream.mPendingReceiveData[subStreamSequenceNumber] = make_shared<SecureByteBlock>(pos, length);
+          return;
+        }
+
+        writeReceivedData(subStreamID, pos, length);
+        ++(subStream.mNextReceiveSequenceNumber);
+
+        // deliver any data which was waiting for this data to arrive
+        while (subStream.mPendingReceiveData.size() > 0) {
+          SubStreamDataMap::iterator iter = subStream.mPendingReceiveData.begin();
+          if ((*iter).first != subStream.mNextReceiveSequenceNumber) break;
+
+          SecureByteBlockPtr buffer = (*iter).second;
+          if (buffer) {
+            writeReceivedData(subStreamID, buffer->BytePtr(), buffer->SizeInBytes());
+          }
+          ++(subStream.mNextReceiveSequenceNumber);
+
+          subStream.mPendingReceiveData.erase(iter);
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::writeReceivedData(
+                                                WORD subStreamID,
+                                                const BYTE *buffer,
+                                                size_t bufferSizeInBytes,
+                                                StreamHeaderPtr header
+                                                )
+      {
+        if (0 == bufferSizeInBytes) return;
+        if (0 != (IRUDPChannel::Shutdown_Receive & mShutdownState)) return;
+
+        if (0 != subStreamID) {
+          SubStream &subStream = mSubStreams[subStreamID];
+          if (subStream.mReceiveStream) {
+            subStream.mReceiveStream->write(buffer, bufferSizeInBytes, header);
+          } else {
+            ZS_LOG_WARNING(Detail, log("sub stream has no receive stream (thus data is dropped)") + ZS_PARAM("sub stream", subStreamID) + ZS_PARAM("size", bufferSizeInBytes))
+          }
+          return;
+        }
+
+        if (mReceiveStream) {
+          mReceiveStream->write(buffer, bufferSizeInBytes, header);
+        } else {
+          ZS_THROW_BAD_STATE_IF(!mPendingReceiveData)
+          mPendingReceiveData->Put(buffer, bufferSizeInBytes);
+        }
+      }
+
       //-----------------------------------------------------------------------
       size_t RUDPChannelStream::getFromWriteBuffer(
                                                   BYTE *outBuffer,
-                                                  size_t maxFillSize
+                                                  size_t maxFillSize,
+                                                  ReliabilityHeaderPtr &outReliability
                                                   )
       {
         ZS_LOG_TRACE(log("get from write buffer") + ZS_PARAM("max size", maxFillSize))
 
-        if (!mSendStream) return 0;
+        outReliability.reset();
 
-        size_t read = mSendStream->read(outBuffer, maxFillSize);
+        if (mTotalSubStreams < 2) {
+          if (!mSendStream) return 0;
 
-        ZS_LOG_TRACE(log("get from write buffer") + ZS_PARAM("max size", maxFillSize) + ZS_PARAM("read size", read))
-        return read;
+          size_t read = readFromSendStream(mSendStream, mSendStreamPartialHeader, outBuffer, maxFillSize, outReliability);
+
+          ZS_LOG_TRACE(log("get from write buffer") + ZS_PARAM("max size", maxFillSize) + ZS_PARAM("read size", read) + ZS_PARAM("reliable", !outReliability))
+          return read;
+        }
+
+        if (maxFillSize <= ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE) return 0;
+
+        // take turns between the sub-streams which have data to send
+        for (WORD index = 0; index < mTotalSubStreams; ++index) {
+          WORD subStreamID = mNextSubStreamToSend;
+          mNextSubStreamToSend = static_cast<WORD>((mNextSubStreamToSend + 1) % mTotalSubStreams);
+
+          SubStream &subStream = mSubStreams[subStreamID];
+          ITransportStreamReaderPtr sendStream = (0 == subStreamID ? mSendStream : subStream.mSendStream);
+          if (!sendStream) continue;
+          if (sendStream->getTotalReadBuffersAvailable() < 1) continue;
+
+          StreamHeaderPtr &partialHeader = (0 == subStreamID ? mSendStreamPartialHeader : subStream.mSendStreamPartialHeader);
+
+          size_t read = readFromSendStream(sendStream, partialHeader, outBuffer + ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE, maxFillSize - ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE, outReliability);
+          if (0 == read) continue;
+
+          IHelper::setBE16(outBuffer, subStreamID);
+          IHelper::setBE32(&(outBuffer[sizeof(WORD)]), subStream.mNextSendSequenceNumber);
+          ++(subStream.mNextSendSequenceNumber);
+
+          ZS_LOG_TRACE(log("get from write buffer") + ZS_PARAM("max size", maxFillSize) + ZS_PARAM("sub stream", subStreamID) + ZS_PARAM("read size", read))
+          return read + ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE;
+        }
+
+        return 0;
+      }
+
+      //-----------------------------------------------------------------------
+      size_t RUDPChannelStream::readFromSendStream(
+                                                   ITransportStreamReaderPtr stream,
+                                                   StreamHeaderPtr &ioPartiallyReadHeader,
+                                                   BYTE *outBuffer,
+                                                   size_t maxFillSize,
+                                                   ReliabilityHeaderPtr &outReliability
+                                                   )
+      {
+        size_t filled = 0;
+
+        // reads buffer by buffer so a buffer which is not fully reliable
+        // ends up in a packet of its own (thus the remote party can drop or
+        // deliver that packet without corrupting the surrounding data)
+        while ((filled < maxFillSize) &&
+               (stream->getTotalReadBuffersAvailable() > 0)) {
+
+          StreamHeaderPtr header = stream->getNextReadHeader();
+          size_t nextSize = stream->getNextReadSizeInBytes();
+
+          if (0 == nextSize) {
+            stream->read();   // discard the empty buffer
+            continue;
+          }
+
+          ReliabilityHeaderPtr reliability = ReliabilityHeader::convert(header);
+          if ((reliability) &&
+              (!reliability->isReliable()) &&
+              (header != ioPartiallyReadHeader)) {
+
+            if (reliability->hasExpired(0, zsLib::now())) {
+              ZS_LOG_TRACE(log("send buffer expired before it could be sent (thus discarding)") + ZS_PARAM("size", nextSize))
+              stream->read();
+              continue;
+            }
+
+            if (nextSize <= maxFillSize) {
+              if (0 != filled) break;   // must be sent in a packet of its own
+
+              filled = stream->read(outBuffer, nextSize);
+              outReliability = reliability;
+              break;
+            }
+
+            // too large to fit inside a single packet thus must be sent reliably
+          }
+
+          size_t read = stream->read(&(outBuffer[filled]), (nextSize < (maxFillSize - filled) ? nextSize : (maxFillSize - filled)));
+          if (0 == read) break;
+
+          filled += read;
+          ioPartiallyReadHeader = (read < nextSize ? header : StreamHeaderPtr());
+        }
+
+        return filled;
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::abandonPacket(BufferedPacketPtr packet)
+      {
+        // the sequence number must still be delivered so the remote party's
+        // GSNFR can move past it but the expired data is no longer carried
+        size_t keepBytes = (mTotalSubStreams > 1 ? ORTC_SERVICES_RUDP_SUB_STREAM_HEADER_SIZE : 0);
+
+        if (!packet->mPacket) {
+          // already received by the remote party so there is nothing left to abandon
+          packet->mReliability.reset();
+          return;
+        }
+
+        RUDPPacketPtr abandoned = RUDPPacket::parseIfRUDP(packet->mPacket->data(), packet->mPacket->size());
+        if (!abandoned) return;
+
+        if (abandoned->mDataLengthInBytes > keepBytes) {
+          abandoned->mDataLengthInBytes = static_cast<decltype(abandoned->mDataLengthInBytes)>(keepBytes);
+        }
+
+        ZS_LOG_TRACE(log("abandoning expired packet data") + ZS_PARAM("sequence number", sequenceToString(packet->mSequenceNumber)) + ZS_PARAM("retransmits", packet->mTotalRetransmits))
+
+        PacketBufferPtr buffer = abandoned->packetize(ORTC_SERVICES_PACKET_BUFFER_DEFAULT_HEADROOM_IN_BYTES, ORTC_SERVICES_PACKET_BUFFER_DEFAULT_TAILROOM_IN_BYTES);
+        ZS_THROW_BAD_STATE_IF(!buffer)
+
+        // the parsed data pointed into the buffer being replaced (the data is always at the end of the packet)
+        abandoned->mData = (0 != abandoned->mDataLengthInBytes ? (buffer->data() + buffer->size() - abandoned->mDataLengthInBytes) : NULL);
+
+        packet->mRUDPPacket = abandoned;
+        packet->mPacket = buffer;
+        packet->mReliability.reset();
+      }
+
+      //-----------------------------------------------------------------------
+      void RUDPChannelStream::abandonExpiredPackets(Time tick)
+      {
+        if (!mPartiallyReliableDataSent) return;
+
+        bool found = false;
+        for (BufferedPacketMap::iterator iter = mSendingPackets.begin(); iter != mSendingPackets.end(); ++iter) {
+          BufferedPacketPtr &packet = (*iter).second;
+          if (!packet->mReliability) continue;
+          if (!packet->mPacket) {
+            packet->mReliability.reset();
+            continue;
+          }
+
+          found = true;
+          if (!packet->mReliability->hasExpired(packet->mTotalRetransmits, tick)) continue;
+
+          abandonPacket(packet);
+        }
+
+        mPartiallyReliableDataSent = found;
+      }
+
+      //-----------------------------------------------------------------------
+      ULONG RUDPChannelStream::getTotalWriteBuffers() const
+      {
+        ULONG total = static_cast<ULONG>(mSendStream ? mSendStream->getTotalReadBuffersAvailable() : 0);
+
+        for (auto iter = mSubStreams.begin(); iter != mSubStreams.end(); ++iter) {
+          const SubStream &subStream = (*iter);
+          if (!subStream.mSendStream) continue;
+          total += static_cast<ULONG>(subStream.mSendStream->getTotalReadBuffersAvailable());
+        }
+        return total;
       }
 
       //-----------------------------------------------------------------------
@@ -2020,7 +2779,7 @@ namespace ortc
         if (isShutdown()) return;       // already closed?
         if (!isShuttingDown()) return;  // do we want to close if all data is sent?
 
-        ULONG totalWriteBuffers = static_cast<ULONG>(mSendStream ? mSendStream->getTotalReadBuffersAvailable() : 0);
+        ULONG totalWriteBuffers = getTotalWriteBuffers();
 
         if ((0 != totalWriteBuffers) || (0 != mSendingPackets.size())) return;
 
@@ -2044,10 +2803,13 @@ namespace ortc
         BufferedPacketPtr pThis(make_shared<BufferedPacket>());
         pThis->mSequenceNumber = 0;
         pThis->mTimeSentOrReceived = zsLib::now();
+        pThis->mTimeSent = pThis->mTimeSentOrReceived;
         pThis->mXORedParityToNow = false;
         pThis->mHoldsBaton = false;
         pThis->mFlaggedAsFailedToReceive = false;
         pThis->mFlagForResendingInNextBurst = false;
+        pThis->mTotalRetransmits = 0;
+        pThis->mDataDelivered = false;
         return pThis;
       }
 
@@ -2060,6 +2822,7 @@ namespace ortc
         doNotResend(ioTotalPacketsToResend);
         releaseBaton(ioAvailableBatons);
         mPacket.reset();
+        mReliability.reset();   // a received packet can never expire
       }
 
       //-----------------------------------------------------------------------
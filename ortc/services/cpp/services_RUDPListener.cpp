@@ -33,6 +33,7 @@
 #include <ortc/services/internal/services_RUDPChannel.h>
 #include <ortc/services/STUNPacket.h>
 #include <ortc/services/RUDPPacket.h>
+#include <ortc/services/PacketBuffer.h>
 #include <ortc/services/ISTUNRequesterManager.h>
 #include <ortc/services/IICESocket.h>
 #include <ortc/services/IHelper.h>
@@ -545,6 +546,17 @@ namespace ortc
         return sendTo(remoteIP, packet, packetLengthInBytes);
       }
 
+      //-----------------------------------------------------------------------
+      bool RUDPListener::notifyRUDPChannelSendPacket(
+                                                     RUDPChannelPtr channel,
+                                                     const IPAddress &remoteIP,
+                                                     PacketBufferPtr packet
+                                                     )
+      {
+        AutoRecursiveLock lock(mLock);
+        return sendTo(remoteIP, packet->data(), packet->size());
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
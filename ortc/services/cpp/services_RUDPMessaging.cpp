@@ -77,6 +77,7 @@ namespace ortc
         mOuterSendStream(sendStream->getReader()),
         mWireReceiveStream(ITransportStream::create()->getReader()),
         mWireSendStream(ITransportStream::create()->getWriter()),
+        mReceivedData(make_shared<ByteQueue>()),
         mMaxMessageSizeInBytes(maxMessageSizeInBytes)
       {
         ZS_LOG_DETAIL(log("created"))
@@ -269,6 +270,61 @@ namespace ortc
         return channel->getRemoteConnectionInfo();
       }
 
+      //-----------------------------------------------------------------------
+      WORD RUDPMessaging::getTotalStreams()
+      {
+        IRUDPChannelPtr channel = getChannel();
+        if (!channel) return 1;
+        return channel->getTotalStreams();
+      }
+
+      //-----------------------------------------------------------------------
+      IRUDPMessagingPtr RUDPMessaging::openStream(
+                                                  IRUDPMessagingDelegatePtr delegate,
+                                                  WORD streamID,
+                                                  ITransportStreamPtr receiveStream,
+                                                  ITransportStreamPtr sendStream,
+                                                  size_t maxMessageSizeInBytes
+                                                  )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(!delegate)
+        ZS_THROW_INVALID_ARGUMENT_IF(!receiveStream)
+        ZS_THROW_INVALID_ARGUMENT_IF(!sendStream)
+
+        AutoRecursiveLock lock(mLock);
+
+        if ((!mChannel) ||
+            (RUDPMessagingState_Connected != mCurrentState)) {
+          ZS_LOG_WARNING(Detail, log("cannot open stream as messaging is not connected") + ZS_PARAM("stream", streamID))
+          return RUDPMessagingPtr();
+        }
+
+        ITransportStreamPtr wireReceiveStream;
+        ITransportStreamPtr wireSendStream;
+        if (!mChannel->getSubStream(streamID, wireReceiveStream, wireSendStream)) {
+          ZS_LOG_WARNING(Detail, log("channel does not have the requested stream") + ZS_PARAM("stream", streamID) + ZS_PARAM("total streams", mChannel->getTotalStreams()))
+          return RUDPMessagingPtr();
+        }
+
+        RUDPMessagingPtr pStream(make_shared<RUDPMessaging>(make_private {}, getAssociatedMessageQueue(), delegate, receiveStream, sendStream, maxMessageSizeInBytes));
+        pStream->mThisWeak = pStream;
+
+        {
+          AutoRecursiveLock streamLock(pStream->mLock);
+          pStream->mStreamID = streamID;
+          pStream->mChannel = mChannel;
+          pStream->mWireReceiveStream = wireReceiveStream->getReader();
+          pStream->mWireSendStream = wireSendStream->getWriter();
+          pStream->init();
+          pStream->setState(RUDPMessagingState_Connected);
+        }
+
+        mSubStreamMessaging[pStream->getID()] = pStream;
+
+        ZS_LOG_DEBUG(log("stream opened") + ZS_PARAM("stream", streamID) + ZS_PARAM("stream messaging", pStream->getID()))
+        return pStream;
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -315,6 +371,7 @@ namespace ortc
             if (IRUDPChannel::RUDPChannelState_Shutdown == state) {
               mChannel.reset();
             }
+            cancelSubStreams();
             cancel();
             break;
           }
@@ -413,9 +470,13 @@ namespace ortc
         IHelper::debugAppend(resultEl, "informed outer receive ready", mInformedOuterReceiveReady);
         IHelper::debugAppend(resultEl, "informed wire send ready", mInformedWireSendReady);
 
+        IHelper::debugAppend(resultEl, "received data", mReceivedData ? static_cast<size_t>(mReceivedData->CurrentSize()) : 0);
+
         IHelper::debugAppend(resultEl, "graceful shutdown reference", (bool)mGracefulShutdownReference);
 
         IHelper::debugAppend(resultEl, "channel", mChannel ? mChannel->getID() : 0);
+        IHelper::debugAppend(resultEl, "stream", mStreamID);
+        IHelper::debugAppend(resultEl, "sub stream messaging", mSubStreamMessaging.size());
 
         IHelper::debugAppend(resultEl, "max message size (bytes)", mMaxMessageSizeInBytes);
 
@@ -447,7 +508,8 @@ namespace ortc
         }
 
         while (mOuterSendStream->getTotalReadBuffersAvailable() > 0) {
-          SecureByteBlockPtr message = mOuterSendStream->read();
+          StreamHeaderPtr header;
+          SecureByteBlockPtr message = mOuterSendStream->read(&header);
 
           SecureByteBlockPtr buffer(make_shared<SecureByteBlock>(message->SizeInBytes() + sizeof(DWORD)));
 
@@ -456,8 +518,9 @@ namespace ortc
           IHelper::setBE32(&(((DWORD *)dest)[0]), static_cast<DWORD>(message->SizeInBytes()));
           memcpy(&(dest[sizeof(DWORD)]), message->BytePtr(), message->SizeInBytes());
 
-          ZS_LOG_TRACE(log("sending buffer") + ZS_PARAM("message size", message->SizeInBytes()))
-          mWireSendStream->write(buffer);
+          // the channel decides how reliably to send the message based on the header
+          ZS_LOG_TRACE(log("sending buffer") + ZS_PARAM("message size", message->SizeInBytes()) + ZS_PARAM("reliable", !IRUDPChannel::ReliabilityHeader::convert(header)))
+          mWireSendStream->write(buffer, IRUDPChannel::ReliabilityHeader::convert(header));
         }
 
         return true;
@@ -471,43 +534,88 @@ namespace ortc
           return true;
         }
 
-        // read all data available
+        // read all data available (buffer by buffer since an unordered
+        // message can arrive in between the pieces of an ordered message)
 
         while (mWireReceiveStream->getTotalReadBuffersAvailable() > 0) {
 
-          DWORD bufferSize = 0;
+          StreamHeaderPtr header;
+          SecureByteBlockPtr buffer = mWireReceiveStream->read(&header);
+          if (!buffer) continue;
 
-          size_t read = mWireReceiveStream->peekDWORD(bufferSize);
-          if (read != sizeof(bufferSize)) {
-            ZS_LOG_TRACE(log("not enough data available to read"))
-            break;
+          const BYTE *pos = buffer->BytePtr();
+          size_t remaining = buffer->SizeInBytes();
+
+          if (IRUDPChannel::ReliabilityHeader::convert(header)) {
+            // always a complete message by itself
+            DWORD bufferSize = (remaining >= sizeof(DWORD) ? IHelper::getBE32(pos) : 0);
+            if (remaining != sizeof(DWORD) + bufferSize) {
+              ZS_LOG_WARNING(Detail, log("unordered message is malformed (thus ignoring)") + ZS_PARAM("size", remaining))
+              continue;
+            }
+            deliverMessage(&(pos[sizeof(DWORD)]), bufferSize, header);
+            continue;
           }
 
-          size_t available = mWireReceiveStream->getTotalReadSizeAvailableInBytes();
+          if (0 == mReceivedData->CurrentSize()) {
+            // fast path: deliver complete messages straight from the buffer
+            while (remaining >= sizeof(DWORD)) {
+              DWORD bufferSize = IHelper::getBE32(pos);
+              if (remaining < sizeof(DWORD) + bufferSize) break;
 
-          if (available < sizeof(DWORD) + bufferSize) {
-            ZS_LOG_TRACE(log("not enough data available to read") + ZS_PARAM("available", available) + ZS_PARAM("buffer size", bufferSize))
-            break;
+              deliverMessage(&(pos[sizeof(DWORD)]), bufferSize);
+              pos += (sizeof(DWORD) + bufferSize);
+              remaining -= (sizeof(DWORD) + bufferSize);
+            }
+            if (0 == remaining) continue;
           }
 
-          mWireReceiveStream->skip(sizeof(DWORD));
+          mReceivedData->Put(pos, remaining);
 
-          SecureByteBlockPtr message(make_shared<SecureByteBlock>());
-          message->CleanNew(bufferSize);
-          if (bufferSize > 0) {
-            mWireReceiveStream->read(message->BytePtr(), bufferSize);
-          }
+          while (mReceivedData->CurrentSize() >= sizeof(DWORD)) {
+            BYTE sizeBuffer[sizeof(DWORD)] {};
+            mReceivedData->Peek(&(sizeBuffer[0]), sizeof(sizeBuffer));
 
-          ZS_LOG_TRACE(log("message is read") + ZS_PARAM("size", bufferSize))
+            DWORD bufferSize = IHelper::getBE32(&(sizeBuffer[0]));
+
+            size_t available = static_cast<size_t>(mReceivedData->CurrentSize());
+            if (available < sizeof(DWORD) + bufferSize) {
+              ZS_LOG_TRACE(log("not enough data available to read") + ZS_PARAM("available", available) + ZS_PARAM("buffer size", bufferSize))
+              break;
+            }
 
-          if (bufferSize > 0) {
-            mOuterReceiveStream->write(message);
+            mReceivedData->Skip(sizeof(DWORD));
+
+            SecureByteBlockPtr message(make_shared<SecureByteBlock>());
+            message->CleanNew(bufferSize);
+            if (bufferSize > 0) {
+              mReceivedData->Get(message->BytePtr(), bufferSize);
+            }
+
+            ZS_LOG_TRACE(log("message is read") + ZS_PARAM("size", bufferSize))
+
+            if (bufferSize > 0) {
+              mOuterReceiveStream->write(message);
+            }
           }
         }
 
         return true;
       }
 
+      //-----------------------------------------------------------------------
+      void RUDPMessaging::deliverMessage(
+                                         const BYTE *buffer,
+                                         size_t bufferSizeInBytes,
+                                         StreamHeaderPtr header
+                                         )
+      {
+        ZS_LOG_TRACE(log("message is read") + ZS_PARAM("size", bufferSizeInBytes) + ZS_PARAM("unordered", (bool)header))
+
+        if (0 == bufferSizeInBytes) return;
+        mOuterReceiveStream->write(buffer, bufferSizeInBytes, header);
+      }
+
       //-----------------------------------------------------------------------
       void RUDPMessaging::cancel()
       {
@@ -517,6 +625,15 @@ namespace ortc
 
         setState(RUDPMessagingState_ShuttingDown);
 
+        if (0 != mStreamID) {
+          // the channel belongs to the messaging object that opened this stream
+          setState(RUDPMessagingState_Shutdown);
+
+          mDelegate.reset();
+          mChannel.reset();
+          return;
+        }
+
         if (!mGracefulShutdownReference) mGracefulShutdownReference = mThisWeak.lock();
 
         if (mChannel) {
@@ -537,12 +654,30 @@ namespace ortc
 
         setState(RUDPMessagingState_Shutdown);
 
+        cancelSubStreams();
+
         mDelegate.reset();
         mGracefulShutdownReference.reset();
 
         mChannel.reset();
       }
 
+      //-----------------------------------------------------------------------
+      void RUDPMessaging::cancelSubStreams()
+      {
+        SubStreamMessagingMap subStreams;
+        subStreams.swap(mSubStreamMessaging);
+
+        for (auto iter = subStreams.begin(); iter != subStreams.end(); ++iter) {
+          RUDPMessagingPtr subStream = (*iter).second.lock();
+          if (!subStream) continue;
+
+          AutoRecursiveLock lock(subStream->mLock);
+          if (0 != mLastError) subStream->setError(mLastError, mLastErrorReason);
+          subStream->cancel();
+        }
+      }
+
       //-----------------------------------------------------------------------
       void RUDPMessaging::setState(RUDPMessagingStates state)
       {
@@ -30,6 +30,7 @@
  */
 
 #include <ortc/services/RUDPPacket.h>
+#include <ortc/services/PacketBuffer.h>
 #include <ortc/services/IHelper.h>
 
 #include <zsLib/Exception.h>
@@ -221,16 +222,42 @@ namespace ortc
     SecureByteBlockPtr RUDPPacket::packetize() const
     {
       log(Log::Trace, "packetize");
+
+      SecureByteBlockPtr outBuffer(make_shared<SecureByteBlock>(getPacketizedLengthInBytes()));
+      packetizeInto(*outBuffer);
+      return outBuffer;
+    }
+
+    //-------------------------------------------------------------------------
+    PacketBufferPtr RUDPPacket::packetize(
+                                          size_t headroomInBytes,
+                                          size_t tailroomInBytes
+                                          ) const
+    {
+      log(Log::Trace, "packetize");
+
+      PacketBufferPtr outBuffer = PacketBuffer::create(getPacketizedLengthInBytes(), headroomInBytes, tailroomInBytes);
+      packetizeInto(outBuffer->data());
+      return outBuffer;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t RUDPPacket::getPacketizedLengthInBytes() const
+    {
       ZS_THROW_BAD_STATE_IF(mDataLengthInBytes > 0xFFFF)
 
       bool eqFlag = (0 != (mFlags & Flag_EQ_GSNREqualsGSNFR));
       ZS_THROW_BAD_STATE_IF(eqFlag && ((mGSNR & 0xFFFFFF) != (mGSNFR & 0xFFFFFF))) // they must match if the EQ flag is set to true or this is illegal
 
-      size_t length = ORTC_SERVICES_MINIMUM_PACKET_LENGTH_IN_BYTES + ((!eqFlag) ? sizeof(DWORD) : 0) + internal::dwordBoundary(mVectorLengthInBytes) + mDataLengthInBytes;
+      return ORTC_SERVICES_MINIMUM_PACKET_LENGTH_IN_BYTES + ((!eqFlag) ? sizeof(DWORD) : 0) + internal::dwordBoundary(mVectorLengthInBytes) + mDataLengthInBytes;
+    }
 
-      SecureByteBlockPtr outBuffer(make_shared<SecureByteBlock>(length));
+    //-------------------------------------------------------------------------
+    void RUDPPacket::packetizeInto(BYTE *packet) const
+    {
+      bool eqFlag = (0 != (mFlags & Flag_EQ_GSNREqualsGSNFR));
+      size_t length = getPacketizedLengthInBytes();
 
-      BYTE *packet = *outBuffer;
       memset(packet, 0, length);  // make sure to set the entire packet to "0" so all defaults are appropriately set
 
       // put in channel number and length
@@ -258,7 +285,6 @@ namespace ortc
         ZS_THROW_BAD_STATE_IF(NULL == mData)  // cannot have set a length but forgot to specify the pointer
         memcpy(&(packet[ORTC_SERVICES_MINIMUM_PACKET_LENGTH_IN_BYTES + ((!eqFlag) ? sizeof(DWORD) : 0) + internal::dwordBoundary(mVectorLengthInBytes)]), &(mData[0]), mDataLengthInBytes);
       }
-      return outBuffer;
     }
 
     //-------------------------------------------------------------------------
@@ -315,6 +341,20 @@ namespace ortc
       mVectorFlags = (mVectorFlags & (0xFF ^ flag));
     }
 
+    //-------------------------------------------------------------------------
+    void RUDPPacket::setFlag(
+                             BYTE *packetizedBuffer,
+                             size_t packetizedLengthInBytes,
+                             Flags flag
+                             )
+    {
+      ZS_THROW_INVALID_USAGE_IF(!packetizedBuffer)
+      ZS_THROW_INVALID_USAGE_IF(packetizedLengthInBytes < ORTC_SERVICES_MINIMUM_PACKET_LENGTH_IN_BYTES)
+
+      // the flags are located immediately after the channel number and data length
+      packetizedBuffer[sizeof(WORD)+sizeof(WORD)] |= flag;
+    }
+
     //-------------------------------------------------------------------------
     QWORD RUDPPacket::getSequenceNumber(QWORD hintLastSequenceNumber) const
     {
@@ -633,6 +673,11 @@ namespace ortc
         } else {
           flagStr += "(--)";
         }
+        if (isFlagSet(Flag_UO_Unordered)) {
+          flagStr += "(uo)";
+        } else {
+          flagStr += "(--)";
+        }
         if (isFlagSet(Flag_VP_VectorParity)) {
           flagStr += "(vp)";
         } else {
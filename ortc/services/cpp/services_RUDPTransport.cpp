@@ -34,6 +34,7 @@
 #include <ortc/services/internal/services_Helper.h>
 
 #include <ortc/services/RUDPPacket.h>
+#include <ortc/services/PacketBuffer.h>
 
 #include <zsLib/Exception.h>
 #include <zsLib/helpers.h>
@@ -556,6 +557,27 @@ namespace ortc
         return session->sendPacket(packet, packetLengthInBytes);  // no need to call within a lock
       }
 
+      //-----------------------------------------------------------------------
+      bool RUDPTransport::notifyRUDPChannelSendPacket(
+                                                      RUDPChannelPtr channel,
+                                                      const IPAddress &remoteIP,
+                                                      PacketBufferPtr packet
+                                                      )
+      {
+        IICESocketSessionPtr session = getICESession();
+        if (!session) {
+          ZS_LOG_WARNING(Detail, log("send packet failed as ICE session object destroyed"))
+          return false;
+        }
+
+        if (ZS_IS_LOGGING(Insane)) {
+          String base64 = Helper::convertToBase64(packet->data(), packet->size());
+          ZS_LOG_INSANE(log("SEND PACKET ON WIRE") + ZS_PARAM("wire out", base64))
+        }
+
+        return session->sendPacket(packet);  // no need to call within a lock
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
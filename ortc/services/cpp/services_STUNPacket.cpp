@@ -125,6 +125,7 @@ namespace ortc
         STUNPacket::Attribute_GSNFR,
         STUNPacket::Attribute_RUDPFlags,
         STUNPacket::Attribute_ACKVector,
+        STUNPacket::Attribute_RUDPStreams,
 
         // integrity and fingerprint always come last in this order
         STUNPacket::Attribute_MessageIntegrity,
@@ -296,6 +297,7 @@ namespace ortc
           case STUNPacket::Attribute_GSNFR:               return sizeof(QWORD);
           case STUNPacket::Attribute_RUDPFlags:           return sizeof(DWORD);
           case STUNPacket::Attribute_ACKVector:           return stun.mACKVectorLength;
+          case STUNPacket::Attribute_RUDPStreams:         return sizeof(DWORD);
           default:                                        break;
         }
         return 0;
@@ -409,6 +411,7 @@ namespace ortc
           case STUNPacket::Attribute_GSNFR:               rfcBits = STUNPacket::RFC_draft_RUDP; break;
           case STUNPacket::Attribute_RUDPFlags:           rfcBits = STUNPacket::RFC_draft_RUDP; break;
           case STUNPacket::Attribute_ACKVector:           rfcBits = STUNPacket::RFC_draft_RUDP; break;
+          case STUNPacket::Attribute_RUDPStreams:         rfcBits = STUNPacket::RFC_draft_RUDP; break;
 
           case STUNPacket::Attribute_ReservedResponseAddress:
           case STUNPacket::Attribute_ReservedChangeAddress:
@@ -674,7 +677,8 @@ namespace ortc
           case STUNPacket::Attribute_NextSequenceNumber: return true;
           case STUNPacket::Attribute_MinimumRTT:
           case STUNPacket::Attribute_ConnectionInfo:
-          case STUNPacket::Attribute_CongestionControl:   {
+          case STUNPacket::Attribute_CongestionControl:
+          case STUNPacket::Attribute_RUDPStreams:         {
             if (STUNPacket::Method_ReliableChannelOpen != stun.mMethod)
               return false;
             return true;
@@ -938,6 +942,7 @@ namespace ortc
           }
           case STUNPacket::Attribute_MinimumRTT:          return false;         // this is optional during the request/response
           case STUNPacket::Attribute_ConnectionInfo:      return false;         // this is optional during the request/response
+          case STUNPacket::Attribute_RUDPStreams:         return false;         // this is optional during the request/response
           case STUNPacket::Attribute_CongestionControl:   {
             if (STUNPacket::Method_ReliableChannelOpen != stun.mMethod)         // not used unless it is RUDP channel open
               return false;
@@ -1401,6 +1406,7 @@ namespace ortc
           case STUNPacket::Attribute_GSNFR:               packetizeQWORD(pos, stun.mGSNFR); break;
           case STUNPacket::Attribute_RUDPFlags:           packetizeDWORD(pos, 0); *pos = stun.mReliabilityFlags; break;
           case STUNPacket::Attribute_ACKVector:           packetizeBuffer(pos, stun.mACKVector.get(), stun.mACKVectorLength); break;
+          case STUNPacket::Attribute_RUDPStreams:         packetizeDWORD(pos, stun.mRUDPStreams); break;
 
           default:                                        break;
         }
@@ -1490,6 +1496,7 @@ namespace ortc
         case Attribute_GSNFR:                   return "GSNFR";
         case Attribute_RUDPFlags:               return "RUDP flags";
         case Attribute_ACKVector:               return "ACK vector";
+        case Attribute_RUDPStreams:             return "RUDP streams";
 
         case Attribute_ReservedResponseAddress: return "obsolete response address";
         case Attribute_ReservedChangeAddress:   return "obsolete change address";
@@ -1742,6 +1749,7 @@ namespace ortc
       dest->mMinimumRTTIncluded = mMinimumRTTIncluded;
       dest->mMinimumRTT = mMinimumRTT;
       dest->mConnectionInfo = mConnectionInfo;
+      dest->mRUDPStreams = mRUDPStreams;
       dest->mGSNR = mGSNR;
       dest->mGSNFR = mGSNFR;
       dest->mReliabilityFlagsIncluded = mReliabilityFlagsIncluded;
@@ -2117,6 +2125,11 @@ namespace ortc
               stun->mACKVectorLength = attributeLength;
               break;
             }
+            case STUNPacket::Attribute_RUDPStreams:         {
+              if (attributeLength < sizeof(DWORD)) return STUNPacketPtr();
+              stun->mRUDPStreams = static_cast<WORD>(IHelper::getBE32(&(((DWORD *)dataPos)[0])));
+              break;
+            }
 
             // obsolete STUN attributes should be ignored
             case STUNPacket::Attribute_ReservedResponseAddress:
@@ -2606,6 +2619,9 @@ namespace ortc
       if (hasAttribute(STUNPacket::Attribute_ConnectionInfo)) {
         IHelper::debugAppend(resultEl, "connection info", mConnectionInfo);
       }
+      if (hasAttribute(STUNPacket::Attribute_RUDPStreams)) {
+        IHelper::debugAppend(resultEl, "rudp streams", mRUDPStreams);
+      }
       if (hasAttribute(STUNPacket::Attribute_GSNR)) {
         IHelper::debugAppend(resultEl, "gsnr", string(mGSNR) + " (" +  + string(mGSNR & 0xFFFFFF) + ")");
       }
@@ -2772,6 +2788,67 @@ namespace ortc
       return outPacket;
     }
 
+    //-------------------------------------------------------------------------
+    bool STUNPacket::repacketize(SecureByteBlock &packet)
+    {
+      BYTE *buffer = packet.BytePtr();
+      size_t length = packet.SizeInBytes();
+
+      if (length < ORTC_STUN_HEADER_SIZE_IN_BYTES) return false;
+      if (IHelper::getBE32(&(((DWORD *)buffer)[1])) != mMagicCookie) return false;
+
+      BYTE *start = buffer + ORTC_STUN_HEADER_SIZE_IN_BYTES;
+      BYTE *end = buffer + length;
+
+      // validate before the packet is touched; attributes XOR'ed with the
+      // transaction ID cannot be carried over as they would be corrupted
+      // by a new transaction ID
+      BYTE *pos = start;
+      while (pos + sizeof(DWORD) <= end) {
+        WORD attribute = IHelper::getBE16(&(((WORD *)pos)[0]));
+        size_t attributeLength = IHelper::getBE16(&(((WORD *)pos)[1]));
+
+        BYTE *valuePos = pos + sizeof(DWORD);
+        if (valuePos + internal::dwordBoundary(attributeLength) > end) return false;
+
+        switch (attribute) {
+          case Attribute_XORMappedAddress:
+          case Attribute_XORPeerAddress:
+          case Attribute_XORRelayedAddress: return false;
+          default:                          break;
+        }
+
+        pos = valuePos + internal::dwordBoundary(attributeLength);
+      }
+      if (pos != end) return false;
+
+      CryptoPP::AutoSeededRandomPool rng;
+      rng.GenerateBlock(&(mTransactionID[0]), sizeof(mTransactionID));
+      memcpy(&(((DWORD *)buffer)[2]), &(mTransactionID[0]), sizeof(mTransactionID));
+
+      mOriginalPacket = buffer;
+
+      // only recalculate the attributes that depend upon the transaction ID
+      // (everything else remains as is)
+      pos = start;
+      while (pos < end) {
+        WORD attribute = IHelper::getBE16(&(((WORD *)pos)[0]));
+        size_t attributeLength = IHelper::getBE16(&(((WORD *)pos)[1]));
+
+        BYTE *valuePos = pos + sizeof(DWORD);
+
+        switch (attribute) {
+          case Attribute_MessageIntegrity:  internal::packetizeMessageIntegrity(valuePos, *this, pos); break;
+          case Attribute_FingerPrint:       internal::packetizeFingerprint(valuePos, *this, pos); break;
+          default:                          break;
+        }
+
+        pos = valuePos + internal::dwordBoundary(attributeLength);
+      }
+
+      return true;
+    }
+
     //-------------------------------------------------------------------------
     bool STUNPacket::isValidResponseTo(
                                        STUNPacketPtr request,
@@ -2942,6 +3019,7 @@ namespace ortc
         case Attribute_GSNFR:               return (0 != mGSNFR);
         case Attribute_RUDPFlags:           return mReliabilityFlagsIncluded;
         case Attribute_ACKVector:           return (0 != mACKVectorLength);
+        case Attribute_RUDPStreams:         return (0 != mRUDPStreams);
 
         // obsolete attributes
         case Attribute_ReservedResponseAddress:
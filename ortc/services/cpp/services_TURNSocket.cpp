@@ -35,6 +35,7 @@
 #include <ortc/services/internal/services.events.h>
 
 #include <ortc/services/STUNPacket.h>
+#include <ortc/services/PacketBuffer.h>
 #include <ortc/services/ISTUNRequesterManager.h>
 
 #include <zsLib/ISettings.h>
@@ -352,186 +353,21 @@ namespace ortc
                                   bool bindChannelIfPossible
                                   )
       {
-        //ServicesTurnSocketSendPacket(__func__, mID, destination.string(), bufferLengthInBytes, buffer, bindChannelIfPossible);
-        ZS_EVENTING_5(
-                      x, i, Trace, ServicesTurnSocketSendPacket, os, TurnSocket, Send,
-                      puid, id, mID,
-                      string, destination, destination.string(),
-                      buffer, packet, buffer,
-                      size, size, bufferLengthInBytes,
-                      bool, bindChannelIfPossible, bindChannelIfPossible
-                      );
-
-        ORTC_SERVICES_WIRE_LOG_TRACE(log("send packet") + ZS_PARAM("destination", destination.string()) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("bind channel", bindChannelIfPossible))
-
-        if (destination.isAddressEmpty()) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet over TURN as destination is invalid"))
-          return false;
-        }
-        if (destination.isPortEmpty()) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet over TURN as destination port is invalid") + ZS_PARAM("ip", destination.string()))
-          return false;
-        }
-
-        if (!Helper::containsIP(mRestrictedIPs, destination)) {
-          ZS_LOG_WARNING(Trace, log("preventing packet from going via TURN server to destination as destination is not in restricted IP list") + ZS_PARAM("destination", destination.string()))
-          return true;
-        }
+        return sendPacketHelper(destination, buffer, bufferLengthInBytes, bindChannelIfPossible, PacketBufferPtr());
+      }
 
-        if (NULL == buffer) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer is NULL"))
-          return false;
-        }
-        if (0 == bufferLengthInBytes) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer length is empty"))
+      //-----------------------------------------------------------------------
+      bool TURNSocket::sendPacket(
+                                  IPAddress destination,
+                                  PacketBufferPtr packet,
+                                  bool bindChannelIfPossible
+                                  )
+      {
+        if (!packet) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as packet is NULL"))
           return false;
         }
-        if (bufferLengthInBytes > ORTC_SERVICES_TURN_MAX_CHANNEL_DATA_IN_BYTES) {
-          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer length is greater than maximum capacity") + ZS_PARAM("size", bufferLengthInBytes))
-          return false;  // illegal to be so large
-        }
-
-        SecureByteBlockPtr packet;
-        ServerPtr server;
-
-        do
-        {
-          AutoRecursiveLock lock(mLock);
-          if (mActiveServer) {
-            mActiveServer->mInformedWriteReady = false;  // if this method was called in response to a write ready be sure to clear off the write-ready event so it can fire again
-          }
-
-          if (!isReady()) {
-            ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("cannot send packet as TURN is not ready"))
-            return false;
-          }
-
-          ZS_THROW_INVALID_ASSUMPTION_IF(!mActiveServer)
-          server = mActiveServer;
-
-          // scope: first, we check if there is a binded channel to this address
-          {
-            ChannelIPMap::iterator found = mChannelIPMap.find(destination);
-            if (found != mChannelIPMap.end()) {
-              // we found, but is it activated yet?
-              ChannelInfoPtr info = (*found).second;
-              if (info->mBound) {
-                // yes, it is active, so we can packetize this in a special way to send to the remote peer
-                packet = make_shared<SecureByteBlock>(sizeof(DWORD)+dwordBoundary(bufferLengthInBytes));
-
-                IHelper::setBE16(&(((WORD *)(packet->BytePtr()))[0]), info->mChannelNumber);
-                IHelper::setBE16(&(((WORD *)(packet->BytePtr()))[1]), static_cast<WORD>(bufferLengthInBytes));
-
-                info->mLastSentDataAt = zsLib::now();
-
-                // copy the entire buffer into the packet
-                memcpy(&((packet->BytePtr())[sizeof(DWORD)]), buffer, bufferLengthInBytes);
-                //pServicesTurnSocketSendPacketViaChannel(__func__, mID, destination.string(), packet->SizeInBytes(), packet->BytePtr(), info->mChannelNumber);
-                ZS_EVENTING_5(
-                              x, i, Trace, pServicesTurnSocketSendPacketViaChannel, os, TurnSocket, Send,
-                              puid, id, mID,
-                              string, destination, destination.string(),
-                              buffer, packet, packet->BytePtr(),
-                              size, size, packet->SizeInBytes(),
-                              word, channelNumber, info->mChannelNumber
-                              );
-
-                ORTC_SERVICES_WIRE_LOG_TRACE(log("sending packet via bound channel") + ZS_PARAM("channel", info->mChannelNumber) + ZS_PARAM("destination", destination.string()) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("bind channel", bindChannelIfPossible))
-                break;
-              }
-
-              // the binding isn't active yet... will have to wrap the packet in a larger header until the binding request completes
-
-            } else if (bindChannelIfPossible) {
-
-              // there was no channel for this destination - try to bind a new one now...
-              WORD freeChannelNumber = getNextChannelNumber();
-              if ((0 != freeChannelNumber) &&
-                  (mOptions.mUseChannelBinding)) {
-
-                ZS_LOG_DEBUG(log("will attempt to bind channel") + ZS_PARAM("channel", freeChannelNumber) + ZS_PARAM("ip", destination.string()))
-
-                // we have a free channel... create a new binding... (won't happen immediately but hopefully the request will succeed)
-                ChannelInfoPtr info = ChannelInfo::create();
-                info->mChannelNumber = freeChannelNumber;
-                info->mPeerAddress = destination;
-                mChannelIPMap[destination] = info;
-                mChannelNumberMap[freeChannelNumber] = info;
-
-                //ServicesTurnSocketInstallChannelWake(__func__, mID, destination.string(), freeChannelNumber);
-                ZS_EVENTING_3(
-                              x, i, Trace, ServicesTurnSocketInstallChannelWake, os, TurnSocket, Info,
-                              puid, id, mID,
-                              string, destination, destination.string(),
-                              word, freeChannelNumber, freeChannelNumber
-                              );
-
-                IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
-              }
-            }
-          }
-
-          STUNPacketPtr sendData = STUNPacket::createIndication(STUNPacket::Method_Send, NULL); // do not announce software in SEND to maximize data possible
-          fix(sendData);
-          sendData->mPeerAddressList.push_back(destination);
-          sendData->mData = buffer;
-          sendData->mDataLength = bufferLengthInBytes;
-
-          packet = sendData->packetize(STUNPacket::RFC_5766_TURN);
-
-          //ServicesTurnSocketSendPacketViaStun(__func__, mID, destination.string(), packet->SizeInBytes(), packet->BytePtr());
-          ZS_EVENTING_4(
-                        x, i, Trace, ServicesTurnSocketSendPacketViaStun, os, TurnSocket, Send,
-                        puid, id, mID,
-                        string, destination, destination.string(),
-                        buffer, packet, packet->BytePtr(),
-                        size, size, packet->SizeInBytes()
-                        );
-
-          sendData->trace(__func__);
-
-          // scope: we need to check if there is a permission set to be able to even contact this address
-          {
-            PermissionMap::iterator found = mPermissions.find(destination);
-            if (found == mPermissions.end()) {
-              ZS_LOG_DEBUG(log("will attempt to create permision") + ZS_PARAM("ip", destination.string()))
-
-              // we do not have a permission yet to send to this address so we need to create one...
-              PermissionPtr permission = Permission::create();
-
-              permission->mPeerAddress = destination;
-              permission->mPendingData.push_back(packet);
-
-              mPermissions[destination] = permission;
-
-              //ServicesTurnSocketInstallPermissionWake(__func__, mID, destination.string());
-              ZS_EVENTING_2(
-                            x, i, Trace, ServicesTurnSocketInstallPermissionWake, os, TurnSocket, Send,
-                            puid, id, mID,
-                            string, destination, destination.string()
-                            );
-
-
-              // since the permission isn't installed yet we can't send the data just yet... best kick start that permission now...
-              (IWakeDelegateProxy::create(mThisWeak.lock()))->onWake();
-              return true;
-            }
-
-            PermissionPtr permission = (*found).second;
-            permission->mLastSentDataAt = zsLib::now();
-
-            if (!permission->mInstalled) {
-              // the permission hasn't been installed yet so we still can't send the data...
-              permission->mPendingData.push_back(packet);
-              return true;
-            }
-          }
-        } while(false);
-
-        ZS_THROW_BAD_STATE_IF(!packet)  // how is this possible?
-
-        // we are free to send the data now since there is a permission installed...
-        return sendPacketOrDopPacketIfBufferFull(server, *packet, packet->SizeInBytes());
+        return sendPacketHelper(destination, packet->data(), packet->size(), bindChannelIfPossible, packet);
       }
 
       //-----------------------------------------------------------------------
@@ -623,13 +459,10 @@ namespace ortc
         ZS_THROW_INVALID_USAGE_IF(!buffer)
         ZS_THROW_INVALID_USAGE_IF(0 == bufferLengthInBytes)
 
-        {
-          AutoRecursiveLock lock(mLock);
-          if (isShutdown()) return false;
-          if (!mDelegate) return false;
-          if (!mOptions.mUseChannelBinding) return false;                  // can't be bound channels if TURN isn't allowed to use it
-          if (fromIPAddress != mAllocateResponseIP) return false; // must come from the TURN server
-        }
+        // no lock is taken on this path, the published table holds everything needed
+        ChannelTablePtr table = std::atomic_load(&mChannelTable);
+        if (!table) return false;                                         // shutdown or TURN isn't allowed to use channel binding
+        if (fromIPAddress != table->mServerIP) return false;              // must come from the TURN server
 
         if (bufferLengthInBytes < sizeof(DWORD)) return false;
 
@@ -647,25 +480,16 @@ namespace ortc
 
         const BYTE *realBuffer = (const BYTE *)(&(((WORD *)buffer)[2]));
 
-        ITURNSocketDelegatePtr delegate;
-        IPAddress peerAddress;
-
-        // scope: found out which channel this date belongs
-        {
-          AutoRecursiveLock lock(mLock);
+        ITURNSocketDelegatePtr &delegate = table->mDelegate;
 
-          delegate = mDelegate;
-
-          ChannelNumberMap::iterator found = mChannelNumberMap.find(channel);
-          if (mChannelNumberMap.end() == found) {
-            ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("channel packet received for non-existant channel") + ZS_PARAM("ip", fromIPAddress.string()) + ZS_PARAM("channel", channel))
-            return false;                             // this isn't any bound channel we know about...
-          }
-
-          ChannelInfoPtr info = (*found).second;
-          peerAddress = info->mPeerAddress;
+        const IPAddress *foundPeer = table->find(channel);
+        if (NULL == foundPeer) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("channel packet received for non-existant channel") + ZS_PARAM("ip", fromIPAddress.string()) + ZS_PARAM("channel", channel))
+          return false;                             // this isn't any bound channel we know about...
         }
 
+        const IPAddress &peerAddress = *foundPeer;
+
         //ServicesTurnSocketReceivedChannelData(__func__, mID, peerAddress.string(), length, realBuffer);
         ZS_EVENTING_4(
                       x, i, Trace, ServicesTurnSocketReceivedChannelData, os, TurnSocket, Receive,
@@ -1088,6 +912,10 @@ namespace ortc
                     peer = (*iter).second->mPeerAddress;
 
                     // we now have channel data, parse it out by making a copy to the temporary buffer
+                    if (!buffer) {
+                      std::unique_ptr<BYTE[]> newBuffer(new BYTE[ORTC_SERVICES_TURNSOCKET_BUFFER_SIZE]);
+                      buffer = std::move(newBuffer);
+                    }
                     memcpy(buffer.get(), &(((WORD *)&(server->mReadBuffer[0]))[2]), length);
 
                     // now we have a copy it is safe to consume from the original buffer
@@ -1960,6 +1788,7 @@ namespace ortc
         }
         mChannelIPMap.clear();
         mChannelNumberMap.clear();
+        publishChannelTable();
 
         {
           for (auto iter_doNotUse = mActivationTimers.begin(); iter_doNotUse != mActivationTimers.end(); ) {
@@ -2063,6 +1892,7 @@ namespace ortc
 
         mGracefulShutdownReference.reset();
         mDelegate.reset();
+        publishChannelTable();
 
         clearDeallocateRequester();
 
@@ -2247,6 +2077,7 @@ namespace ortc
         }
 
         mAllocateResponseIP = fromIPAddress;
+        publishChannelTable();
         mRelayedIP = response->mRelayedAddress;
         mReflectedIP = response->mMappedAddress;
         mActiveServer = server;
@@ -2647,6 +2478,8 @@ namespace ortc
               if (found2 != mChannelNumberMap.end())
                 mChannelNumberMap.erase(found2);
             }
+
+            if (infoList.size() > 0) publishChannelTable();
           }
         }
 
@@ -2668,6 +2501,223 @@ namespace ortc
         }
       }
 
+      //-----------------------------------------------------------------------
+      bool TURNSocket::sendPacketHelper(
+                                        IPAddress destination,
+                                        const BYTE *buffer,
+                                        size_t bufferLengthInBytes,
+                                        bool bindChannelIfPossible,
+                                        PacketBufferPtr framingPacket
+                                        )
+      {
+        //ServicesTurnSocketSendPacket(__func__, mID, destination.string(), bufferLengthInBytes, buffer, bindChannelIfPossible);
+        ZS_EVENTING_5(
+                      x, i, Trace, ServicesTurnSocketSendPacket, os, TurnSocket, Send,
+                      puid, id, mID,
+                      string, destination, destination.string(),
+                      buffer, packet, buffer,
+                      size, size, bufferLengthInBytes,
+                      bool, bindChannelIfPossible, bindChannelIfPossible
+                      );
+
+        ORTC_SERVICES_WIRE_LOG_TRACE(log("send packet") + ZS_PARAM("destination", destination.string()) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("bind channel", bindChannelIfPossible))
+
+        if (destination.isAddressEmpty()) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet over TURN as destination is invalid"))
+          return false;
+        }
+        if (destination.isPortEmpty()) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet over TURN as destination port is invalid") + ZS_PARAM("ip", destination.string()))
+          return false;
+        }
+
+        if (!Helper::containsIP(mRestrictedIPs, destination)) {
+          ZS_LOG_WARNING(Trace, log("preventing packet from going via TURN server to destination as destination is not in restricted IP list") + ZS_PARAM("destination", destination.string()))
+          return true;
+        }
+
+        if (NULL == buffer) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer is NULL"))
+          return false;
+        }
+        if (0 == bufferLengthInBytes) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer length is empty"))
+          return false;
+        }
+        if (bufferLengthInBytes > ORTC_SERVICES_TURN_MAX_CHANNEL_DATA_IN_BYTES) {
+          ORTC_SERVICES_WIRE_LOG_WARNING(Debug, log("cannot send packet as buffer length is greater than maximum capacity") + ZS_PARAM("size", bufferLengthInBytes))
+          return false;  // illegal to be so large
+        }
+
+        SecureByteBlockPtr packet;
+        const BYTE *sendBuffer = NULL;
+        size_t sendBufferSizeInBytes = 0;
+        ServerPtr server;
+
+        do
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mActiveServer) {
+            mActiveServer->mInformedWriteReady = false;  // if this method was called in response to a write ready be sure to clear off the write-ready event so it can fire again
+          }
+
+          if (!isReady()) {
+            ORTC_SERVICES_WIRE_LOG_WARNING(Detail, log("cannot send packet as TURN is not ready"))
+            return false;
+          }
+
+          ZS_THROW_INVALID_ASSUMPTION_IF(!mActiveServer)
+          server = mActiveServer;
+
+          // scope: first, we check if there is a binded channel to this address
+          {
+            ChannelIPMap::iterator found = mChannelIPMap.find(destination);
+            if (found != mChannelIPMap.end()) {
+              // we found, but is it activated yet?
+              ChannelInfoPtr info = (*found).second;
+              if (info->mBound) {
+                // yes, it is active, so we can packetize this in a special way to send to the remote peer
+                size_t paddingSize = dwordBoundary(bufferLengthInBytes) - bufferLengthInBytes;
+
+                BYTE *header = (framingPacket ? framingPacket->reserveHeadroom(sizeof(DWORD)) : NULL);
+                BYTE *padding = (framingPacket ? framingPacket->reserveTailroom(paddingSize) : NULL);
+
+                if ((NULL != header) &&
+                    (NULL != padding)) {
+                  // the sender reserved room around the data so the channel header and padding can be written in place
+                  IHelper::setBE16(&(((WORD *)header)[0]), info->mChannelNumber);
+                  IHelper::setBE16(&(((WORD *)header)[1]), static_cast<WORD>(bufferLengthInBytes));
+                  if (0 != paddingSize) {
+                    memset(padding, 0, paddingSize);
+                  }
+
+                  sendBuffer = header;
+                  sendBufferSizeInBytes = sizeof(DWORD)+dwordBoundary(bufferLengthInBytes);
+                } else {
+                  packet = make_shared<SecureByteBlock>(sizeof(DWORD)+dwordBoundary(bufferLengthInBytes));
+
+                  IHelper::setBE16(&(((WORD *)(packet->BytePtr()))[0]), info->mChannelNumber);
+                  IHelper::setBE16(&(((WORD *)(packet->BytePtr()))[1]), static_cast<WORD>(bufferLengthInBytes));
+
+                  // copy the entire buffer into the packet
+                  memcpy(&((packet->BytePtr())[sizeof(DWORD)]), buffer, bufferLengthInBytes);
+
+                  sendBuffer = packet->BytePtr();
+                  sendBufferSizeInBytes = packet->SizeInBytes();
+                }
+
+                info->mLastSentDataAt = zsLib::now();
+                //pServicesTurnSocketSendPacketViaChannel(__func__, mID, destination.string(), packet->SizeInBytes(), packet->BytePtr(), info->mChannelNumber);
+                ZS_EVENTING_5(
+                              x, i, Trace, pServicesTurnSocketSendPacketViaChannel, os, TurnSocket, Send,
+                              puid, id, mID,
+                              string, destination, destination.string(),
+                              buffer, packet, sendBuffer,
+                              size, size, sendBufferSizeInBytes,
+                              word, channelNumber, info->mChannelNumber
+                              );
+
+                ORTC_SERVICES_WIRE_LOG_TRACE(log("sending packet via bound channel") + ZS_PARAM("channel", info->mChannelNumber) + ZS_PARAM("destination", destination.string()) + ZS_PARAM("buffer length", bufferLengthInBytes) + ZS_PARAM("bind channel", bindChannelIfPossible))
+                break;
+              }
+
+              // the binding isn't active yet... will have to wrap the packet in a larger header until the binding request completes
+
+            } else if (bindChannelIfPossible) {
+
+              // there was no channel for this destination - try to bind a new one now...
+              WORD freeChannelNumber = getNextChannelNumber();
+              if ((0 != freeChannelNumber) &&
+                  (mOptions.mUseChannelBinding)) {
+
+                ZS_LOG_DEBUG(log("will attempt to bind channel") + ZS_PARAM("channel", freeChannelNumber) + ZS_PARAM("ip", destination.string()))
+
+                // we have a free channel... create a new binding... (won't happen immediately but hopefully the request will succeed)
+                ChannelInfoPtr info = ChannelInfo::create();
+                info->mChannelNumber = freeChannelNumber;
+                info->mPeerAddress = destination;
+                mChannelIPMap[destination] = info;
+                mChannelNumberMap[freeChannelNumber] = info;
+                publishChannelTable();
+
+                //ServicesTurnSocketInstallChannelWake(__func__, mID, destination.string(), freeChannelNumber);
+                ZS_EVENTING_3(
+                              x, i, Trace, ServicesTurnSocketInstallChannelWake, os, TurnSocket, Info,
+                              puid, id, mID,
+                              string, destination, destination.string(),
+                              word, freeChannelNumber, freeChannelNumber
+                              );
+
+                IWakeDelegateProxy::create(mThisWeak.lock())->onWake();
+              }
+            }
+          }
+
+          STUNPacketPtr sendData = STUNPacket::createIndication(STUNPacket::Method_Send, NULL); // do not announce software in SEND to maximize data possible
+          fix(sendData);
+          sendData->mPeerAddressList.push_back(destination);
+          sendData->mData = buffer;
+          sendData->mDataLength = bufferLengthInBytes;
+
+          packet = sendData->packetize(STUNPacket::RFC_5766_TURN);
+          sendBuffer = packet->BytePtr();
+          sendBufferSizeInBytes = packet->SizeInBytes();
+
+          //ServicesTurnSocketSendPacketViaStun(__func__, mID, destination.string(), packet->SizeInBytes(), packet->BytePtr());
+          ZS_EVENTING_4(
+                        x, i, Trace, ServicesTurnSocketSendPacketViaStun, os, TurnSocket, Send,
+                        puid, id, mID,
+                        string, destination, destination.string(),
+                        buffer, packet, packet->BytePtr(),
+                        size, size, packet->SizeInBytes()
+                        );
+
+          sendData->trace(__func__);
+
+          // scope: we need to check if there is a permission set to be able to even contact this address
+          {
+            PermissionMap::iterator found = mPermissions.find(destination);
+            if (found == mPermissions.end()) {
+              ZS_LOG_DEBUG(log("will attempt to create permision") + ZS_PARAM("ip", destination.string()))
+
+              // we do not have a permission yet to send to this address so we need to create one...
+              PermissionPtr permission = Permission::create();
+
+              permission->mPeerAddress = destination;
+              permission->mPendingData.push_back(packet);
+
+              mPermissions[destination] = permission;
+
+              //ServicesTurnSocketInstallPermissionWake(__func__, mID, destination.string());
+              ZS_EVENTING_2(
+                            x, i, Trace, ServicesTurnSocketInstallPermissionWake, os, TurnSocket, Send,
+                            puid, id, mID,
+                            string, destination, destination.string()
+                            );
+
+
+              // since the permission isn't installed yet we can't send the data just yet... best kick start that permission now...
+              (IWakeDelegateProxy::create(mThisWeak.lock()))->onWake();
+              return true;
+            }
+
+            PermissionPtr permission = (*found).second;
+            permission->mLastSentDataAt = zsLib::now();
+
+            if (!permission->mInstalled) {
+              // the permission hasn't been installed yet so we still can't send the data...
+              permission->mPendingData.push_back(packet);
+              return true;
+            }
+          }
+        } while(false);
+
+        ZS_THROW_BAD_STATE_IF(NULL == sendBuffer)  // how is this possible?
+
+        // we are free to send the data now since there is a permission installed...
+        return sendPacketOrDopPacketIfBufferFull(server, sendBuffer, sendBufferSizeInBytes);
+      }
+
       //-----------------------------------------------------------------------
       bool TURNSocket::sendPacketOrDopPacketIfBufferFull(
                                                          ServerPtr server,
@@ -2877,6 +2927,26 @@ namespace ortc
         return channel;
       }
 
+      //-----------------------------------------------------------------------
+      void TURNSocket::publishChannelTable()
+      {
+        ChannelTablePtr table;
+
+        if ((mDelegate) &&
+            (mOptions.mUseChannelBinding)) {
+          table = ChannelTable::create(mOptions.mLimitChannelToRangeStart, mOptions.mLimitChannelToRangeEnd);
+          table->mDelegate = mDelegate;
+          table->mServerIP = mAllocateResponseIP;
+
+          for (ChannelNumberMap::iterator iter = mChannelNumberMap.begin(); iter != mChannelNumberMap.end(); ++iter) {
+            ChannelInfoPtr &info = (*iter).second;
+            table->add(info->mChannelNumber, info->mPeerAddress);
+          }
+        }
+
+        std::atomic_store(&mChannelTable, table);
+      }
+
       //-----------------------------------------------------------------------
       ISTUNRequesterPtr TURNSocket::handleAuthorizationErrors(ISTUNRequesterPtr requester, STUNPacketPtr response)
       {
@@ -3050,6 +3120,66 @@ namespace ortc
         return pThis;
       }
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TURNSocket::ChannelTable
+      #pragma mark
+
+      //-----------------------------------------------------------------------
+      TURNSocket::ChannelTablePtr TURNSocket::ChannelTable::create(
+                                                                   WORD rangeStart,
+                                                                   WORD rangeEnd
+                                                                   )
+      {
+        ChannelTablePtr pThis(make_shared<ChannelTable>());
+        pThis->mRangeStart = rangeStart;
+        pThis->mPages.resize(((rangeEnd - rangeStart) / ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE) + 1);
+        return pThis;
+      }
+
+      //-----------------------------------------------------------------------
+      void TURNSocket::ChannelTable::add(
+                                         WORD channel,
+                                         const IPAddress &peerAddress
+                                         )
+      {
+        ZS_THROW_INVALID_ARGUMENT_IF(channel < mRangeStart)
+
+        size_t index = channel - mRangeStart;
+        size_t pageIndex = index / ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE;
+        ZS_THROW_INVALID_ARGUMENT_IF(pageIndex >= mPages.size())
+
+        PagePtr &page = mPages[pageIndex];
+        if (!page) {
+          page = make_shared<Page>(ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE);
+        }
+
+        Entry &entry = (*page)[index % ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE];
+        entry.mInUse = true;
+        entry.mPeerAddress = peerAddress;
+      }
+
+      //-----------------------------------------------------------------------
+      const IPAddress *TURNSocket::ChannelTable::find(WORD channel) const
+      {
+        if (channel < mRangeStart) return NULL;
+
+        size_t index = channel - mRangeStart;
+        size_t pageIndex = index / ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE;
+        if (pageIndex >= mPages.size()) return NULL;
+
+        const PagePtr &page = mPages[pageIndex];
+        if (!page) return NULL;
+
+        const Entry &entry = (*page)[index % ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE];
+        if (!entry.mInUse) return NULL;
+
+        return &(entry.mPeerAddress);
+      }
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
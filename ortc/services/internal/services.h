@@ -43,14 +43,19 @@
 #include <ortc/services/internal/services_DHPublicKey.h>
 #include <ortc/services/internal/services_DNS.h>
 #include <ortc/services/internal/services_DNSMonitor.h>
+#include <ortc/services/internal/services_Ed25519PrivateKey.h>
+#include <ortc/services/internal/services_Ed25519PublicKey.h>
+#include <ortc/services/internal/services_Encoding.h>
 #include <ortc/services/internal/services_Encryptor.h>
 #include <ortc/services/internal/services_Helper.h>
 #include <ortc/services/internal/services_HTTP.h>
 #include <ortc/services/internal/services_ICESocket.h>
 #include <ortc/services/internal/services_ICESocketSession.h>
+#include <ortc/services/internal/services_KeyGenerationPool.h>
 #include <ortc/services/internal/services_Logger.h>
 #include <ortc/services/internal/services_MessageLayerSecurityChannel.h>
 #include <ortc/services/internal/services_Reachability.h>
+#include <ortc/services/internal/services_RSABatch.h>
 #include <ortc/services/internal/services_RSAPrivateKey.h>
 #include <ortc/services/internal/services_RSAPublicKey.h>
 #include <ortc/services/internal/services_RUDPChannel.h>
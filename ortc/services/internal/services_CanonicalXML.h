@@ -50,8 +50,27 @@ namespace ortc
 
       class CanonicalXML : public ICanonicalXML
       {
+      public:
+        interaction ISink
+        {
+          virtual void write(
+                             const char *value,
+                             size_t length
+                             ) = 0;
+        };
+
       public:
         static String convert(ElementPtr element);
+        static void convert(
+                            ElementPtr element,
+                            std::ostream &output
+                            );
+        static SecureByteBlockPtr hash(ElementPtr element);
+
+        static void write(
+                          ElementPtr element,
+                          ISink &sink
+                          );
       };
     }
   }
@@ -35,6 +35,7 @@
 #include <ortc/services/IDHKeyDomain.h>
 
 #include <cryptopp/dh.h>
+#include <cryptopp/xed25519.h>
 
 namespace ortc
 {
@@ -54,11 +55,11 @@ namespace ortc
       {
         ZS_DECLARE_TYPEDEF_PTR(IDHKeyDomainForDHPrivateKey, ForDHPrivateKey)
 
-        typedef CryptoPP::DH DH;
+        typedef CryptoPP::SimpleKeyAgreementDomain KeyAgreementDomain;
 
         virtual PUID getID() const = 0;
 
-        virtual DH &getDH() const = 0;
+        virtual KeyAgreementDomain &getKeyAgreementDomain() const = 0;
       };
 
       //-----------------------------------------------------------------------
@@ -79,8 +80,10 @@ namespace ortc
       public:
         friend interaction IDHKeyDomainFactory;
         friend interaction IDHKeyDomain;
+        friend class DHKeyDomainPrecompiledCache;
 
         typedef CryptoPP::DH DH;
+        typedef CryptoPP::x25519 X25519;
 
       public:
         DHKeyDomain(const make_private &);
@@ -133,7 +136,7 @@ namespace ortc
 
         // (duplicate) virtual PUID getID() const;
 
-        virtual DH &getDH() const;
+        virtual KeyAgreementDomain &getKeyAgreementDomain() const;
 
       protected:
         //---------------------------------------------------------------------
@@ -146,8 +149,18 @@ namespace ortc
 
         virtual ElementPtr toDebug() const;
 
+        static DHKeyDomainPtr loadNow(
+                                      const CryptoPP::Integer &p,
+                                      const CryptoPP::Integer &q,
+                                      const CryptoPP::Integer &g
+                                      );
+
+        static DHKeyDomainPtr loadPrecompiledNow(KeyDomainPrecompiledTypes precompiledKey);
+
         bool validate() const;
 
+        bool isX25519() const {return KeyDomainPrecompiledType_X25519 == mPrecompiledType;}
+
       private:
         //-------------------------------------------------------------------
         #pragma mark
@@ -156,6 +169,9 @@ namespace ortc
 
         AutoPUID mID;
         mutable DH mDH;
+        mutable std::unique_ptr<X25519> mX25519;   // only allocated for the x25519 curve key domain
+
+        KeyDomainPrecompiledTypes mPrecompiledType {KeyDomainPrecompiledType_Unknown};
       };
 
       //-----------------------------------------------------------------------
@@ -60,6 +60,7 @@ namespace ortc
       public:
         friend interaction IDHPrivateKeyFactory;
         friend interaction IDHPrivateKey;
+        friend class KeyGenerationPool;
 
         ZS_DECLARE_TYPEDEF_PTR(IDHKeyDomainForDHPrivateKey, UseDHKeyDomain)
         ZS_DECLARE_TYPEDEF_PTR(IDHPublicKeyForDHPrivateKey, UseDHPublicKey)
@@ -141,6 +142,18 @@ namespace ortc
         Log::Params debug(const char *message) const;
         virtual ElementPtr toDebug() const;
 
+        static void obtainKeyPair(
+                                  IDHKeyDomainPtr keyDomain,
+                                  SecureByteBlock &outPrivateKey,
+                                  SecureByteBlock &outPublicKey
+                                  );
+
+        static void generateKeyPairNow(
+                                       IDHKeyDomainPtr keyDomain,
+                                       SecureByteBlock &outPrivateKey,
+                                       SecureByteBlock &outPublicKey
+                                       );
+
       private:
         //-------------------------------------------------------------------
         #pragma mark
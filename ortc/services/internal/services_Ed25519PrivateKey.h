@@ -0,0 +1,168 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/internal/types.h>
+#include <ortc/services/IEd25519PrivateKey.h>
+
+#include <cryptopp/xed25519.h>
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      interaction IEd25519PublicKeyForEd25519PrivateKey;
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PrivateKeyForEd25519PublicKey
+      #pragma mark
+
+      interaction IEd25519PrivateKeyForEd25519PublicKey
+      {
+        ZS_DECLARE_TYPEDEF_PTR(IEd25519PrivateKeyForEd25519PublicKey, ForPublicKey)
+
+        static ForPublicKeyPtr generate(Ed25519PublicKeyPtr &outPublicKey);
+
+        virtual ~IEd25519PrivateKeyForEd25519PublicKey() {} // need to make base polymorphic - remove if another virtual method is added
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PrivateKey
+      #pragma mark
+
+      class Ed25519PrivateKey : public Noop,
+                                public IEd25519PrivateKey,
+                                public IEd25519PrivateKeyForEd25519PublicKey
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        friend interaction IEd25519PrivateKey;
+        friend interaction IEd25519PrivateKeyFactory;
+
+        ZS_DECLARE_TYPEDEF_PTR(IEd25519PublicKeyForEd25519PrivateKey, UsePublicKey)
+
+        typedef CryptoPP::ed25519Signer Signer;
+        typedef CryptoPP::ed25519PrivateKey PrivateKey;
+
+      public:
+        Ed25519PrivateKey(const make_private &);
+
+      protected:
+        Ed25519PrivateKey(Noop) : Noop(true) {};
+
+      public:
+        ~Ed25519PrivateKey();
+
+        static Ed25519PrivateKeyPtr convert(IEd25519PrivateKeyPtr privateKey);
+        static Ed25519PrivateKeyPtr convert(ForPublicKeyPtr privateKey);
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PrivateKey => IEd25519PrivateKey
+        #pragma mark
+
+        static ElementPtr toDebug(IEd25519PrivateKeyPtr object);
+
+        static Ed25519PrivateKeyPtr generate(Ed25519PublicKeyPtr &outPublicKey);
+
+        static Ed25519PrivateKeyPtr load(const SecureByteBlock &buffer);
+
+        virtual SecureByteBlockPtr save() const;
+
+        virtual SecureByteBlockPtr sign(const SecureByteBlock &inBufferToSign) const;
+
+        virtual SecureByteBlockPtr sign(const String &stringToSign) const;
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PrivateKey => (internal)
+        #pragma mark
+
+        Log::Params log(const char *message) const;
+        Log::Params debug(const char *message) const;
+
+        virtual ElementPtr toDebug() const;
+
+        const PrivateKey &getPrivateKey() const;
+
+        virtual SecureByteBlockPtr sign(
+                                        const BYTE *inBuffer,
+                                        size_t inBufferSizeInBytes
+                                        ) const;
+
+      private:
+        //-------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PrivateKey => (data)
+        #pragma mark
+
+        AutoPUID mID;
+
+        Signer mSigner;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PrivateKeyFactory
+      #pragma mark
+
+      interaction IEd25519PrivateKeyFactory
+      {
+        static IEd25519PrivateKeyFactory &singleton();
+
+        virtual Ed25519PrivateKeyPtr generate(Ed25519PublicKeyPtr &outPublicKey);
+
+        virtual Ed25519PrivateKeyPtr loadPrivateKey(const SecureByteBlock &buffer);
+      };
+
+      class Ed25519PrivateKeyFactory : public IFactory<IEd25519PrivateKeyFactory> {};
+
+    }
+  }
+}
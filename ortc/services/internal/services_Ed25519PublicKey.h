@@ -0,0 +1,173 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/internal/types.h>
+#include <ortc/services/IEd25519PublicKey.h>
+
+#include <cryptopp/xed25519.h>
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      interaction IEd25519PrivateKeyForEd25519PublicKey;
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PublicKeyForEd25519PrivateKey
+      #pragma mark
+
+      interaction IEd25519PublicKeyForEd25519PrivateKey
+      {
+        ZS_DECLARE_TYPEDEF_PTR(IEd25519PublicKeyForEd25519PrivateKey, ForPrivateKey)
+
+        static ForPrivateKeyPtr load(const SecureByteBlock &buffer);
+
+        virtual ~IEd25519PublicKeyForEd25519PrivateKey() {} // need a virtual function to make this class polymorphic (if another virtual method is added then remove this)
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Ed25519PublicKey
+      #pragma mark
+
+      class Ed25519PublicKey : public Noop,
+                               public IEd25519PublicKey,
+                               public IEd25519PublicKeyForEd25519PrivateKey
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        friend interaction IEd25519PublicKeyFactory;
+        friend interaction IEd25519PublicKey;
+
+        ZS_DECLARE_TYPEDEF_PTR(IEd25519PrivateKeyForEd25519PublicKey, UsePrivateKey)
+
+        typedef CryptoPP::ed25519Verifier Verifier;
+
+      public:
+        Ed25519PublicKey(const make_private &);
+
+      protected:
+        Ed25519PublicKey(Noop) : Noop(true) {};
+
+      public:
+        ~Ed25519PublicKey();
+
+        static Ed25519PublicKeyPtr convert(IEd25519PublicKeyPtr publicKey);
+        static Ed25519PublicKeyPtr convert(ForPrivateKeyPtr publicKey);
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PublicKey => IEd25519PublicKey
+        #pragma mark
+
+        static ElementPtr toDebug(IEd25519PublicKeyPtr object);
+
+        static Ed25519PublicKeyPtr generate(Ed25519PrivateKeyPtr &outPrivatekey);
+
+        static Ed25519PublicKeyPtr load(const SecureByteBlock &buffer);
+
+        virtual SecureByteBlockPtr save() const;
+
+        virtual String getFingerprint() const;
+
+        virtual bool verify(
+                            const SecureByteBlock &inOriginalBufferSigned,
+                            const SecureByteBlock &inSignature
+                            ) const;
+
+        virtual bool verify(
+                            const String &inOriginalStringSigned,
+                            const SecureByteBlock &inSignature
+                            ) const;
+
+        virtual bool verifySignature(ElementPtr signedEl) const;
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PublicKey => (internal)
+        #pragma mark
+
+        Log::Params log(const char *message) const;
+
+        virtual ElementPtr toDebug() const;
+
+        bool verify(
+                    const BYTE *inBuffer,
+                    size_t inBufferLengthInBytes,
+                    const SecureByteBlock &inSignature
+                    ) const;
+
+      private:
+        //-------------------------------------------------------------------
+        #pragma mark
+        #pragma mark Ed25519PublicKey => (data)
+        #pragma mark
+
+        AutoPUID mID;
+        Verifier mVerifier;
+        SecureByteBlock mPublicKey;
+        String mFingerprint;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IEd25519PublicKeyFactory
+      #pragma mark
+
+      interaction IEd25519PublicKeyFactory
+      {
+        static IEd25519PublicKeyFactory &singleton();
+
+        virtual Ed25519PublicKeyPtr loadPublicKey(const SecureByteBlock &buffer);
+      };
+
+      class Ed25519PublicKeyFactory : public IFactory<IEd25519PublicKeyFactory> {};
+    }
+  }
+}
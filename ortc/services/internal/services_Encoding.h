@@ -0,0 +1,90 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/internal/types.h>
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark Encoding
+      #pragma mark
+
+      // Base64 (RFC 4648, padded) and hex codecs that read and write caller
+      // supplied buffers. The widest kernel the CPU supports is selected the
+      // first time a codec is used; every kernel produces identical output.
+      class Encoding
+      {
+      public:
+        struct Kernels
+        {
+          const char *mName;
+
+          // output must hold "base64EncodedLength(length)" characters
+          void (*mEncodeBase64)(const BYTE *input, size_t length, char *output);
+
+          // output must hold "base64DecodedLength(input, length)" bytes,
+          // returns false if the input is not valid base64
+          bool (*mDecodeBase64)(const char *input, size_t length, BYTE *output);
+
+          // output must hold "length * 2" characters
+          void (*mEncodeHex)(const BYTE *input, size_t length, char *output, bool upperCase);
+
+          // output must hold "length / 2" bytes, returns false if the input
+          // is not valid hex
+          bool (*mDecodeHex)(const char *input, size_t length, BYTE *output);
+        };
+
+      public:
+        static const Kernels &scalar();
+        static const Kernels &best();
+
+        static size_t base64EncodedLength(size_t length);
+
+        // RETURNS: the decoded length or 0 if the length or padding of the
+        //          input cannot be valid base64
+        static size_t base64DecodedLength(
+                                          const char *input,
+                                          size_t length
+                                          );
+      };
+    }
+  }
+}
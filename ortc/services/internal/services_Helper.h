@@ -39,6 +39,7 @@
 #define ORTC_SERVICES_SETTING_HELPER_SERVICES_THREAD_POOL_PRIORITY  "ortc/services/services-thread-pool-priority"
 #define ORTC_SERVICES_SETTING_HELPER_SERVICES_THREAD_PRIORITY       "ortc/services/services-thread-priority"
 #define ORTC_SERVICES_SETTING_HELPER_LOGGER_THREAD_PRIORITY         "ortc/services/logger-thread-priority"
+#define ORTC_SERVICES_SETTING_HELPER_IDN_CACHE_SIZE                 "ortc/services/idn-cache-size"
 
 namespace ortc
 {
@@ -58,6 +59,18 @@ namespace ortc
       {
       public:
         static Log::Params slog(const char *message);
+
+        // PURPOSE: Runs the IDN conversions without consulting the
+        //          conversion cache.
+        static String encodeIDN(const String &utf8Str);
+        static String decodeIDN(const String &idnStr);
+
+        // PURPOSE: Checks the labels of an already IDN encoded domain, e.g.
+        //          "www.xn--bcher-kva.de", without allocating.
+        static bool isValidIDNDomain(
+                                     const char *domain,
+                                     size_t length
+                                     );
       };
     }
   }
@@ -62,6 +62,10 @@
 #define ORTC_SERVICES_SETTING_ICE_SOCKET_MAX_REBIND_ATTEMPT_DURATION_IN_SECONDS        "ortc/services/max-ice-socket-rebind-attempt-duration-in-seconds"
 #define ORTC_SERVICES_SETTING_ICE_SOCKET_NO_LOCAL_IPS_CAUSES_SOCKET_FAILURE "ortc/services/ice-socket-fail-when-no-local-ips"
 
+#define ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_BUCKET_IN_MILLISECONDS  "ortc/services/ice-socket-keep-alive-bucket-in-milliseconds"
+#define ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_SPREAD_IN_MILLISECONDS  "ortc/services/ice-socket-keep-alive-spread-in-milliseconds"
+#define ORTC_SERVICES_SETTING_ICE_SOCKET_KEEP_ALIVE_MAX_PER_BUCKET          "ortc/services/ice-socket-keep-alive-max-per-bucket"
+
 namespace ortc
 {
   namespace services
@@ -94,6 +98,13 @@ namespace ortc
                             bool isUserData
                             ) = 0;
 
+        virtual bool sendTo(
+                            const IICESocket::Candidate &viaLocalCandidate,
+                            const IPAddress &destination,
+                            PacketBufferPtr packet,
+                            bool isUserData
+                            ) = 0;
+
         virtual void addRoute(
                               ICESocketSessionPtr session,
                               const IPAddress &viaIP,
@@ -102,6 +113,9 @@ namespace ortc
                               ) = 0;
         virtual void removeRoute(ICESocketSessionPtr session) = 0;
 
+        virtual void monitorKeepAlive(ICESocketSessionPtr session) = 0;
+        virtual void cancelKeepAlive(PUID sessionID) = 0;
+
         virtual void onICESocketSessionClosed(PUID sessionID) = 0;
       };
 
@@ -143,6 +157,12 @@ namespace ortc
         typedef std::list<IPAddress> IPAddressList;
 
         typedef std::map<PUID, UseICESocketSessionPtr> ICESocketSessionMap;
+        typedef String RemoteUsernameFrag;
+        typedef std::map<RemoteUsernameFrag, UseICESocketSessionPtr> ICESocketSessionUsernameMap;
+
+        typedef Time KeepAliveBucket;
+        typedef std::map<KeepAliveBucket, ICESocketSessionMap> KeepAliveBucketMap;
+        typedef std::map<PUID, KeepAliveBucket> KeepAliveScheduleMap;
 
         typedef IPAddress ViaIP;
         typedef IPAddress ViaLocalIP;
@@ -330,6 +350,13 @@ namespace ortc
                             bool isUserData
                             );
 
+        virtual bool sendTo(
+                            const Candidate &viaLocalCandidate,
+                            const IPAddress &destination,
+                            PacketBufferPtr packet,
+                            bool isUserData
+                            );
+
         virtual void addRoute(
                               ICESocketSessionPtr session,
                               const IPAddress &viaIP,
@@ -338,6 +365,9 @@ namespace ortc
                               );
         virtual void removeRoute(ICESocketSessionPtr session);
 
+        virtual void monitorKeepAlive(ICESocketSessionPtr session);
+        virtual void cancelKeepAlive(PUID sessionID);
+
         virtual void onICESocketSessionClosed(PUID sessionID);
         
         //---------------------------------------------------------------------
@@ -495,6 +525,15 @@ namespace ortc
 
         void cancel();
         
+        bool sendToHelper(
+                          const Candidate &viaLocalCandidate,
+                          const IPAddress &destination,
+                          const BYTE *buffer,
+                          size_t bufferLengthInBytes,
+                          bool isUserData,
+                          PacketBufferPtr framingPacket
+                          );
+
         void step();
         bool stepResolveLocalIPs();
         bool stepBind();
@@ -515,6 +554,19 @@ namespace ortc
         void clearTURN(ITURNSocketPtr turn);
         void clearSTUN(ISTUNDiscoveryPtr stun);
 
+        KeepAliveBucket toKeepAliveBucket(Time when) const;
+        void scheduleKeepAlive(
+                               UseICESocketSessionPtr session,
+                               Time when
+                               );
+        void unscheduleKeepAlive(PUID sessionID);
+        void stepKeepAliveTimer();
+
+        //---------------------------------------------------------------------
+        // NOTE:  Do NOT call this method while in a lock because it must
+        //        call into the sessions (which may call back into the socket).
+        void serviceKeepAlives();
+
         //---------------------------------------------------------------------
         // NOTE:  Do NOT call this method while in a lock because it must
         //        deliver data to delegates synchronously.
@@ -570,9 +622,17 @@ namespace ortc
         Milliseconds        mTURNShutdownIfNotUsedBy;         // when will TURN be shutdown if it is not used by this time
 
         ICESocketSessionMap mSessions;
+        ICESocketSessionUsernameMap mSessionsByUsername;  // direct lookup for incoming checks (needed when serving many sessions)
 
         QuickRouteMap       mRoutes;
 
+        ITimerPtr           mKeepAliveTimer;
+        Milliseconds        mKeepAliveBucketDuration {};  // granularity of the shared keep alive timer
+        Milliseconds        mKeepAliveSpreadDuration {};  // newly monitored sessions are phased across this window
+        size_t              mKeepAliveMaxPerBucket {};     // sessions beyond this are pushed to the next bucket (0 = unlimited)
+        KeepAliveBucketMap  mKeepAliveBuckets;
+        KeepAliveScheduleMap mKeepAliveSchedule;
+
         bool                mNotifiedCandidateChanged {};
         DWORD               mLastCandidateCRC;
 
@@ -622,9 +682,11 @@ ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IICESocketForICESocketSession)
 ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::ICESocketSessionPtr, ICESocketSessionPtr)
 ZS_DECLARE_PROXY_TYPEDEF(ortc::services::IICESocketPtr, IICESocketPtr)
 ZS_DECLARE_PROXY_TYPEDEF(ortc::services::IICESocket, IICESocket)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::PacketBufferPtr, PacketBufferPtr)
 ZS_DECLARE_PROXY_METHOD_SYNC_CONST_RETURN_0(getMessageQueue, IMessageQueuePtr)
 ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_1(attach, bool, ICESocketSessionPtr)
 ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_5(sendTo, bool, const IICESocket::Candidate &, const IPAddress &, const BYTE *, size_t, bool)
+ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_4(sendTo, bool, const IICESocket::Candidate &, const IPAddress &, PacketBufferPtr, bool)
 ZS_DECLARE_PROXY_METHOD_1(onICESocketSessionClosed, PUID)
 ZS_DECLARE_PROXY_METHOD_SYNC_4(addRoute, ortc::services::internal::ICESocketSessionPtr, const IPAddress &, const IPAddress &, const IPAddress &)
 ZS_DECLARE_PROXY_METHOD_SYNC_1(removeRoute, ortc::services::internal::ICESocketSessionPtr)
@@ -44,9 +44,12 @@
 #include <zsLib/MessageQueueAssociator.h>
 
 #include <list>
+#include <vector>
 #include <utility>
 
 #define ORTC_SERVICES_SETTING_ICESOCKETSESSION_BACKGROUNDING_PHASE "ortc/services/backgrounding-phase-ice-socket-session"
+#define ORTC_SERVICES_SETTING_ICESOCKETSESSION_CHECK_PACING_IN_MILLISECONDS "ortc/services/ice-socket-session-check-pacing-in-milliseconds"
+#define ORTC_SERVICES_SETTING_ICESOCKETSESSION_MAX_CHECKS_IN_FLIGHT "ortc/services/ice-socket-session-max-checks-in-flight"
 
 namespace ortc
 {
@@ -74,6 +77,8 @@ namespace ortc
         virtual PUID getID() const = 0;
         virtual void close() = 0;
 
+        virtual String getRemoteUsernameFrag() const = 0;
+
         virtual void updateRemoteCandidates(const CandidateList &remoteCandidates) = 0;
 
         virtual bool handleSTUNPacket(
@@ -92,6 +97,8 @@ namespace ortc
 
         virtual void notifyLocalWriteReady(const IICESocket::Candidate &viaLocalCandidate) = 0;
         virtual void notifyRelayWriteReady(const IICESocket::Candidate &viaLocalCandidate) = 0;
+
+        virtual Time notifyKeepAliveDue(Time tick) = 0;  // returns when the session next needs servicing or Time() if no longer needed
       };
 
       //-----------------------------------------------------------------------
@@ -134,22 +141,39 @@ namespace ortc
 
         struct CandidatePair
         {
+          enum CheckStates
+          {
+            CheckState_Frozen,
+            CheckState_Waiting,
+            CheckState_InProgress,
+            CheckState_Succeeded,
+            CheckState_Failed,
+          };
+
+          static const char *toString(CheckStates state);
+
           static CandidatePairPtr create();
           ElementPtr toDebug() const;
 
+          CheckStates getCheckState() const;
+
           AutoPUID mID;
 
           Candidate mLocal;
           Candidate mRemote;
 
+          QWORD mPriority;                        // pair priority for the current role (RFC 8445 section 6.1.2.3)
+          String mPairFoundation;                 // pairs sharing a foundation are unfrozen together (RFC 8445 section 6.1.2.6)
+
           bool mReceivedRequest;
           bool mReceivedResponse;
           bool mFailed;
+          bool mUnfrozen;
 
           ISTUNRequesterPtr mRequester;
         };
 
-        typedef std::list<CandidatePairPtr> CandidatePairList;
+        typedef std::vector<CandidatePairPtr> CandidatePairList;   // always kept ordered from highest to lowest pair priority
 
       public:
         ICESocketSession(
@@ -197,6 +221,13 @@ namespace ortc
                                           IICESocketSessionPtr foundation = IICESocketSessionPtr()
                                           );
 
+        static ICESocketSessionPtr createLite(
+                                              IICESocketSessionDelegatePtr delegate,
+                                              IICESocketPtr socket,
+                                              const char *remoteUsernameFrag,
+                                              const char *remotePassword
+                                              );
+
         virtual PUID getID() const {return mID;}
 
         virtual IICESocketSessionSubscriptionPtr subscribe(IICESocketSessionDelegatePtr delegate);
@@ -217,6 +248,8 @@ namespace ortc
 
         virtual void getLocalCandidates(CandidateList &outCandidates);
         virtual void updateRemoteCandidates(const CandidateList &remoteCandidates);
+        virtual void addRemoteCandidate(const Candidate &remoteCandidate);
+        virtual void setRemoteLite();
         virtual void endOfRemoteCandidates();
 
         virtual void setKeepAliveProperties(
@@ -231,6 +264,8 @@ namespace ortc
                                 size_t packetLengthInBytes
                                 );
 
+        virtual bool sendPacket(PacketBufferPtr packet);
+
         virtual ICEControls getConnectedControlState();
 
         virtual IPAddress getConnectedRemoteIP();
@@ -248,6 +283,8 @@ namespace ortc
         // (duplicate) virtual PUID getID() const;
         // (duplicate) virtual void close();
 
+        // (duplicate) virtual String getRemoteUsernameFrag() const;
+
         // (duplicate) virtual void updateRemoteCandidates(const CandidateList &remoteCandidates);
 
         virtual bool handleSTUNPacket(
@@ -267,6 +304,8 @@ namespace ortc
         virtual void notifyLocalWriteReady(const IICESocket::Candidate &viaLocalCandidate);
         virtual void notifyRelayWriteReady(const IICESocket::Candidate &viaLocalCandidate);
 
+        virtual Time notifyKeepAliveDue(Time tick);
+
         //---------------------------------------------------------------------
         #pragma mark
         #pragma mark ICESocketSession => IWakeDelegate
@@ -347,30 +386,52 @@ namespace ortc
         void setError(WORD errorCode, const char *inReason = NULL);
 
         void step();
+        bool stepLite();
         bool stepSocket();
         bool stepCandidates();
         bool stepActivateTimer();
+        bool activateNextCheck();
+        void unfreezeChecks();
+        void unfreezeFoundation(const String &pairFoundation);
+
+        void addCandidatePair(
+                              const Candidate &local,
+                              const Candidate &remote
+                              );
+        void insertCandidatePair(CandidatePairPtr pairing);
+        void removeCandidatePairs(
+                                  const CandidateList &removedLocalCandidates,
+                                  const CandidateList &removedRemoteCandidates
+                                  );
+        bool isRemovable(const CandidatePairPtr &pairing) const;
         bool stepEndSearch();
         bool stepTimer();
-        bool stepExpectingDataTimer();
-        bool stepKeepAliveTimer();
+        bool stepKeepAlive();
         bool stepCancelLowerPriority();
         bool stepNominate();
         void stepNotifyNominated();
 
         void switchRole(ICEControls newRole);
 
+        bool sendPacketHelper(
+                              const BYTE *packet,
+                              size_t packetLengthInBytes,
+                              PacketBufferPtr framingPacket
+                              );
+
         bool sendTo(
                     const IICESocket::Candidate &viaLocalCandidate,
                     const IPAddress &destination,
                     const BYTE *buffer,
                     size_t bufferLengthInBytes,
-                    bool isUserData
+                    bool isUserData,
+                    PacketBufferPtr framingPacket = PacketBufferPtr()  // if set, "buffer" is the data of this packet
                     );
 
         bool canUnfreeze(CandidatePairPtr derivedPairing);
         void sendKeepAliveNow();
         void sendAliveCheckRequest();
+        void cancelKeepAlive();
 
         void clearBackgroundingNotifierIfPossible();
         void clearAliveCheckRequester()   {if (mAliveCheckRequester) { mAliveCheckRequester->cancel(); mAliveCheckRequester.reset(); mBackgroundingNotifier.reset(); } clearBackgroundingNotifierIfPossible();}
@@ -387,6 +448,8 @@ namespace ortc
         UseICESocketWeakPtr mICESocket;
 
         ICESocketSessionStates mCurrentState;
+        bool mLite {};
+        bool mRemoteLite {};
         WORD mLastError {};
         String mLastErrorReason;
 
@@ -408,8 +471,8 @@ namespace ortc
         String mRemotePassword;
 
         ITimerPtr mActivateTimer;
-        ITimerPtr mKeepAliveTimer;
-        ITimerPtr mExpectingDataTimer;
+        Milliseconds mCheckPacing {};
+        ULONG mMaxChecksInFlight {};
         ITimerPtr mStepTimer;
 
         ICEControls mControl;
@@ -431,6 +494,11 @@ namespace ortc
         Milliseconds mKeepAliveSTUNRequestTimeout {};
         Milliseconds mBackgroundingTimeout {};
 
+        bool mKeepAliveMonitored {};                // keep alives and alive checks are driven by the ICE socket's shared keep alive timer
+        CandidatePairPtr mKeepAliveIndicationPair;
+        STUNPacketPtr mKeepAliveIndication;
+        SecureByteBlockPtr mKeepAliveIndicationPacket;
+
         CandidatePairList mCandidatePairs;
 
         CandidateList mUpdatedLocalCandidates;
@@ -465,6 +533,13 @@ namespace ortc
                                            ICEControls control,
                                            IICESocketSessionPtr foundation = IICESocketSessionPtr()
                                            );
+
+        virtual ICESocketSessionPtr createLite(
+                                               IICESocketSessionDelegatePtr delegate,
+                                               IICESocketPtr socket,
+                                               const char *remoteUsernameFrag,
+                                               const char *remotePassword
+                                               );
       };
 
       class ICESocketSessionFactory : public IFactory<IICESocketSessionFactory> {};
@@ -134,6 +134,26 @@ namespace ortc
                                 ITransportStreamPtr sendStream
                                 ) = 0;
 
+        //-----------------------------------------------------------------------
+        // PURPOSE: Splits the stream into independently ordered sub-streams
+        //          that share the sequence space, ACKs and congestion control
+        //          of the channel. Data on one sub-stream is delivered as soon
+        //          as all earlier data on the same sub-stream has arrived
+        //          regardless of losses on the other sub-streams.
+        // NOTE:    Sub-stream 0 uses the streams passed into setStreams.
+        //          Must be called before any data is sent or received and
+        //          both parties must use the same negotiated total.
+        virtual void setTotalSubStreams(WORD totalSubStreams) = 0;
+
+        //-----------------------------------------------------------------------
+        // PURPOSE: Sets the associated send/receive stream of a sub-stream
+        //          (other than sub-stream 0).
+        virtual void setSubStreamStreams(
+                                         WORD subStreamID,
+                                         ITransportStreamPtr receiveStream,
+                                         ITransportStreamPtr sendStream
+                                         ) = 0;
+
         //-----------------------------------------------------------------------
         // PURPOSE: Close the stream down to prevent further usage.
         // NOTE:    A stream has no capacity to time out the connection. However,
@@ -240,8 +260,7 @@ namespace ortc
         // PURPOSE: Send a packet over the socket interface to the remote party.
         virtual bool notifyRUDPChannelStreamSendPacket(
                                                        IRUDPChannelStreamPtr stream,
-                                                       const BYTE *packet,
-                                                       size_t packetLengthInBytes
+                                                       PacketBufferPtr packet
                                                        ) = 0;
 
         //-----------------------------------------------------------------------
@@ -258,6 +277,6 @@ namespace ortc
 
 ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IRUDPChannelStreamDelegate)
 ZS_DECLARE_PROXY_METHOD_2(onRUDPChannelStreamStateChanged, ortc::services::internal::IRUDPChannelStreamPtr, ortc::services::internal::IRUDPChannelStreamDelegate::RUDPChannelStreamStates)
-ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_3(notifyRUDPChannelStreamSendPacket, bool, ortc::services::internal::IRUDPChannelStreamPtr, const zsLib::BYTE *, size_t)
+ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_2(notifyRUDPChannelStreamSendPacket, bool, ortc::services::internal::IRUDPChannelStreamPtr, ortc::services::PacketBufferPtr)
 ZS_DECLARE_PROXY_METHOD_3(onRUDPChannelStreamSendExternalACKNow, ortc::services::internal::IRUDPChannelStreamPtr, bool, zsLib::PUID)
 ZS_DECLARE_PROXY_END()
@@ -0,0 +1,184 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/internal/types.h>
+#include <ortc/services/IDHKeyDomain.h>
+
+#include <list>
+#include <map>
+
+#define ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_RSA_KEYS "ortc/services/key-generation-pool-rsa-keys"
+#define ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS "ortc/services/key-generation-pool-dh-keys"
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IKeyGenerationPoolAsync
+      #pragma mark
+
+      interaction IKeyGenerationPoolAsync
+      {
+        typedef IDHKeyDomain::KeyDomainPrecompiledTypes KeyDomainPrecompiledTypes;
+
+        virtual void onGenerateRSAKeyPair() = 0;
+        virtual void onGenerateDHKeyPair(KeyDomainPrecompiledTypes precompiledType) = 0;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark KeyGenerationPool
+      #pragma mark
+
+      // Process wide stock of pre-generated RSA key pairs (default key size
+      // only) and DH key pairs (per precompiled key domain). A stock is only
+      // kept for a key type after the first request for it and is topped
+      // back up on the service thread pool whenever a key is taken.
+      class KeyGenerationPool : public IKeyGenerationPoolAsync
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        struct RSAKeyPair
+        {
+          RSAPrivateKeyPtr mPrivateKey;
+          RSAPublicKeyPtr mPublicKey;
+        };
+        typedef std::list<RSAKeyPair> RSAKeyPairList;
+
+        struct DHKeyPair
+        {
+          SecureByteBlockPtr mPrivateKey;
+          SecureByteBlockPtr mPublicKey;
+        };
+        typedef std::list<DHKeyPair> DHKeyPairList;
+
+        struct DHKeyPairPool
+        {
+          IDHKeyDomainPtr mKeyDomain;
+          DHKeyPairList mKeys;
+          size_t mPending {};
+        };
+        typedef std::map<KeyDomainPrecompiledTypes, DHKeyPairPool> DHKeyPairPoolMap;
+
+      public:
+        KeyGenerationPool(const make_private &);
+
+        static KeyGenerationPoolPtr create();
+
+        static KeyGenerationPoolPtr singleton();
+
+        //---------------------------------------------------------------------
+        // PURPOSE: Take a pre-generated RSA key pair of the default key size
+        // RETURNS: Key pair or RSAPrivateKeyPtr() if none is ready (the
+        //          caller must generate one itself)
+        RSAPrivateKeyPtr takeRSAKeyPair(RSAPublicKeyPtr &outPublicKey);
+
+        //---------------------------------------------------------------------
+        // PURPOSE: Take a pre-generated DH key pair for the key domain
+        // RETURNS: true if a key pair was ready (only precompiled key domains
+        //          are pooled)
+        bool takeDHKeyPair(
+                           IDHKeyDomainPtr keyDomain,
+                           SecureByteBlock &outPrivateKey,
+                           SecureByteBlock &outPublicKey
+                           );
+
+        size_t getHits() const;
+        size_t getMisses() const;
+
+        ElementPtr toDebug() const;
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark KeyGenerationPool => IKeyGenerationPoolAsync
+        #pragma mark
+
+        virtual void onGenerateRSAKeyPair();
+        virtual void onGenerateDHKeyPair(KeyDomainPrecompiledTypes precompiledType);
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark KeyGenerationPool => (internal)
+        #pragma mark
+
+        Log::Params log(const char *message) const;
+
+        void refillRSA(size_t total);
+        void refillDH(
+                      KeyDomainPrecompiledTypes precompiledType,
+                      DHKeyPairPool &pool,
+                      size_t total
+                      );
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark KeyGenerationPool => (data)
+        #pragma mark
+
+        AutoPUID mID;
+        KeyGenerationPoolWeakPtr mThisWeak;
+
+        mutable Lock mLock;
+
+        RSAKeyPairList mRSAKeys;
+        size_t mRSAPending {};
+
+        DHKeyPairPoolMap mDHKeys;
+
+        size_t mHits {};
+        size_t mMisses {};
+      };
+    }
+  }
+}
+
+ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IKeyGenerationPoolAsync)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::IKeyGenerationPoolAsync::KeyDomainPrecompiledTypes, KeyDomainPrecompiledTypes)
+ZS_DECLARE_PROXY_METHOD_0(onGenerateRSAKeyPair)
+ZS_DECLARE_PROXY_METHOD_1(onGenerateDHKeyPair, KeyDomainPrecompiledTypes)
+ZS_DECLARE_PROXY_END()
@@ -39,21 +39,47 @@
 #include <zsLib/ITimer.h>
 #include <zsLib/IWakeDelegate.h>
 
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include <cryptopp/hmac.h>
+#include <cryptopp/sha.h>
+
 #include <list>
 #include <map>
 
 #define ORTC_SERVICES_MESSAGE_LAYER_SECURITY_SIGNATURE_ALGORITHM "https://meta.ortclib.org/2012/12/14/jsonsig#rsa-sha1"
+#define ORTC_SERVICES_MESSAGE_LAYER_SECURITY_SIGNATURE_ALGORITHM_ED25519 "https://meta.ortclib.org/2016/jsonsig#ed25519"
 
 #define ORTC_SERVICES_MESSAGE_LAYER_SECURITY_DEFAULT_CRYPTO_ALGORITHM "https://meta.ortclib.org/2012/12/14/jsonmls#aes-cfb-32-16-16-sha1-md5"
 
 #define ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_CHANGE_SENDING_KEY_AFTER "ortc/services/mls-change-sending-key-after-in-seconds"
 
+// when non-zero, outgoing messages are assigned round-robin to this many send
+// key chains and each chain is encrypted on the services thread pool
+#define ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_CHAINS "ortc/services/mls-pipeline-chains"
+#define ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_MAX_PENDING "ortc/services/mls-pipeline-max-pending-messages"
+
 namespace ortc
 {
   namespace services
   {
     namespace internal
     {
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IMessageLayerSecurityChannelAsync
+      #pragma mark
+
+      interaction IMessageLayerSecurityChannelAsync
+      {
+        typedef ULONG AlgorithmIndex;
+
+        virtual void onEncodeChain(AlgorithmIndex index) = 0;
+      };
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -66,6 +92,7 @@ namespace ortc
                                           public zsLib::MessageQueueAssociator,
                                           public SharedRecursiveLock,
                                           public IMessageLayerSecurityChannel,
+                                          public IMessageLayerSecurityChannelAsync,
                                           public IWakeDelegate,
                                           public zsLib::ITimerDelegate,
                                           public ITransportStreamReaderDelegate,
@@ -81,20 +108,50 @@ namespace ortc
         typedef ITransportStream::StreamHeaderPtr StreamHeaderPtr;
         typedef std::list<SecureByteBlockPtr> BufferList;
 
-        typedef ULONG AlgorithmIndex;
+        typedef IMessageLayerSecurityChannelAsync::AlgorithmIndex AlgorithmIndex;
+
+        ZS_DECLARE_CLASS_PTR(KeyContext)
+        ZS_DECLARE_STRUCT_PTR(PendingEncode)
 
         struct KeyInfo
         {
           String mIntegrityPassphrase;
 
           SecureByteBlockPtr mSendKey;
-          SecureByteBlockPtr mNextIV;
+          SecureByteBlockPtr mNextIV;           // initial IV (once a context exists the context holds the running IV)
           SecureByteBlockPtr mLastIntegrity;
 
-          ElementPtr toDebug(AlgorithmIndex index) const;
+          KeyContextPtr mContext;
+
+          KeyContextPtr context();
+          ElementPtr toDebug(
+                             AlgorithmIndex index,
+                             bool encoding = false    // true while a pool thread is advancing the context (its running state is skipped)
+                             ) const;
         };
         
         typedef std::map<AlgorithmIndex, KeyInfo> KeyMap;
+
+        // a message waiting to be encoded by a pipelined key chain
+        struct PendingEncode
+        {
+          AlgorithmIndex mIndex {};
+          KeyContextPtr mContext;
+
+          SecureByteBlockPtr mBuffer;           // decoded data (released once encoded)
+          StreamHeaderPtr mHeader;
+          SecureByteBlockPtr mOutput;           // set once the chain has encoded the message
+        };
+
+        typedef std::list<PendingEncodePtr> PendingEncodeList;
+
+        struct EncodeChain
+        {
+          PendingEncodeList mQueued;
+          bool mBusy {};                        // a pool thread owns the front of the queue
+        };
+
+        typedef std::map<AlgorithmIndex, EncodeChain> EncodeChainMap;
         typedef std::pair<IDHPrivateKeyPtr, IDHPublicKeyPtr> DHPrivatePublicKeyPair;
 
         typedef std::list<DHPrivatePublicKeyPair> DHKeyList;
@@ -124,6 +181,10 @@ namespace ortc
 
         static MessageLayerSecurityChannelPtr convert(IMessageLayerSecurityChannelPtr channel);
 
+        // decodes a base64 keying value; values the fast decoder rejects
+        // (e.g. wrapped across lines) are decoded leniently instead
+        static SecureByteBlockPtr fromBase64(const String &value);
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
@@ -184,6 +245,7 @@ namespace ortc
 
         virtual ElementPtr getSignedReceiveKeying() const;
         virtual void setReceiveKeyingSigningPublicKey(IRSAPublicKeyPtr remotePublicKey);
+        virtual void setReceiveKeyingSigningPublicKey(IEd25519PublicKeyPtr remotePublicKey);
 
         virtual void getSendKeyingNeedingToBeSigned(
                                                     DocumentPtr &outDocumentContainedElementToSign,
@@ -193,6 +255,10 @@ namespace ortc
                                             IRSAPrivateKeyPtr signingKey,
                                             IRSAPublicKeyPtr signingPublicKey
                                             );
+        virtual void notifySendKeyingSigned(
+                                            IEd25519PrivateKeyPtr signingKey,
+                                            IEd25519PublicKeyPtr signingPublicKey
+                                            );
 
         //---------------------------------------------------------------------
         #pragma mark
@@ -208,6 +274,13 @@ namespace ortc
 
         virtual void onTransportStreamWriterReady(ITransportStreamWriterPtr writer);
 
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark MessageLayerSecurityChannel => IMessageLayerSecurityChannelAsync
+        #pragma mark
+
+        virtual void onEncodeChain(AlgorithmIndex index);
+
         //---------------------------------------------------------------------
         #pragma mark
         #pragma mark MessageLayerSecurityChannel => IWakeDelegate
@@ -222,6 +295,78 @@ namespace ortc
 
         virtual void onTimer(ITimerPtr timer);
 
+      public:
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark MessageLayerSecurityChannel::KeyContext
+        #pragma mark
+
+        // Crypto state for one keying index. The AES key schedule and the
+        // HMAC key are prepared once when the key is installed, and every
+        // message is then encoded or decoded without temporary buffers.
+        class KeyContext
+        {
+        public:
+          typedef CryptoPP::CFB_Mode<CryptoPP::AES>::Encryption Encryption;
+          typedef CryptoPP::CFB_Mode<CryptoPP::AES>::Decryption Decryption;
+          typedef CryptoPP::HMAC<CryptoPP::SHA1> IntegrityHMAC;
+          typedef CryptoPP::SHA1 Hasher;
+
+          enum Sizes
+          {
+            IntegritySize = CryptoPP::SHA1::DIGESTSIZE,
+            MinIVSize = CryptoPP::AES::BLOCKSIZE,
+          };
+
+        public:
+          KeyContext(
+                     const SecureByteBlock &key,
+                     const SecureByteBlock &iv,
+                     const String &integrityPassphrase
+                     );
+
+          static size_t headerSize() {return sizeof(DWORD) + IntegritySize;}
+
+          // returns the complete wire buffer (keying index, integrity and the encrypted data)
+          SecureByteBlockPtr encode(
+                                    AlgorithmIndex index,
+                                    const BYTE *buffer,
+                                    size_t bufferSizeInBytes
+                                    );
+
+          // returns SecureByteBlockPtr() if the integrity does not match
+          SecureByteBlockPtr decode(
+                                    const BYTE *integrity,
+                                    const BYTE *buffer,
+                                    size_t bufferSizeInBytes
+                                    );
+
+          String getNextIV() const;
+          String getLastIntegrity() const;
+
+        protected:
+          void calculateIntegrity(
+                                  const BYTE *decrypted,
+                                  size_t decryptedSizeInBytes,
+                                  BYTE *outIntegrity
+                                  );
+          void advanceIV(const BYTE *integrity);
+
+        protected:
+          Encryption mEncryption;
+          Decryption mDecryption;
+          IntegrityHMAC mIntegrity;
+          Hasher mHasher;
+
+          SecureByteBlock mIV;
+          SecureByteBlock mHexIV;               // the hex form of the IV is part of both the integrity and the next IV calculation
+          BYTE mLastIntegrity[IntegritySize] {};
+          bool mHasLastIntegrity {};
+        };
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
@@ -229,6 +374,7 @@ namespace ortc
         #pragma mark
 
         bool isShutdown() const {return SessionState_Shutdown == mCurrentState;}
+        bool hasReceiveSigningPublicKey() const {return ((bool)mReceiveSigningPublicKey) || ((bool)mReceiveSigningEd25519PublicKey);}
 
         Log::Params log(const char *message) const;
         Log::Params debug(const char *message) const;
@@ -242,6 +388,7 @@ namespace ortc
         bool stepReceive();
         bool stepSendKeying();
         bool stepSend();
+        bool stepSendPipelined();
         bool stepCheckConnected();
 
         bool stepProcessReceiveKeying(
@@ -251,6 +398,10 @@ namespace ortc
 
         bool isSendingReady() const;
 
+        bool isPipelining() const {return 0 != mPipelineChains;}
+        bool isEncoding(AlgorithmIndex index) const;
+        void flushPipelinedEncodes();
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
@@ -303,11 +454,14 @@ namespace ortc
 
         // signing
         IRSAPublicKeyPtr mReceiveSigningPublicKey;
+        IEd25519PublicKeyPtr mReceiveSigningEd25519PublicKey;
         DocumentPtr mReceiveKeyingSignedDoc;        // temporary document needed to resolve receive signing public key
         ElementPtr mReceiveKeyingSignedEl;          // temporary eleemnt needed to resolve receive signing public key
 
         IRSAPrivateKeyPtr mSendSigningPrivateKey;
         IRSAPublicKeyPtr mSendSigningPublicKey;
+        IEd25519PrivateKeyPtr mSendSigningEd25519PrivateKey;
+        IEd25519PublicKeyPtr mSendSigningEd25519PublicKey;
         DocumentPtr mSendKeyingNeedingToSignDoc;    // temporary document containing the send keying material needing to be signed
         ElementPtr mSendKeyingNeedToSignEl;         // temporary element containing the send keying material needing to be signed (once notified it is signed, this element get set to EleemntPtr())
 
@@ -334,6 +488,14 @@ namespace ortc
 
         bool mChangeKey {};
         ITimerPtr mChangeSendingKeyTimer;
+
+        // pipelined encoding (disabled when mPipelineChains is 0)
+        ULONG mPipelineChains {};
+        size_t mPipelineMaxPending {};
+        AlgorithmIndex mPipelineLastIndex {};
+
+        PendingEncodeList mPendingEncodes;      // in the order read from the decoded send stream
+        EncodeChainMap mEncodeChains;
       };
 
       //-----------------------------------------------------------------------
@@ -362,3 +524,8 @@ namespace ortc
     }
   }
 }
+
+ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IMessageLayerSecurityChannelAsync)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::IMessageLayerSecurityChannelAsync::AlgorithmIndex, AlgorithmIndex)
+ZS_DECLARE_PROXY_METHOD_1(onEncodeChain, AlgorithmIndex)
+ZS_DECLARE_PROXY_END()
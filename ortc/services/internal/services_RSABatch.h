@@ -0,0 +1,220 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#pragma once
+
+#include <ortc/services/internal/types.h>
+#include <ortc/services/IRSABatch.h>
+
+#include <atomic>
+#include <vector>
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace internal
+    {
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IRSABatchAsync
+      #pragma mark
+
+      interaction IRSABatchAsync
+      {
+        typedef IRSABatch::OperationIndex OperationIndex;
+
+        virtual void onPerformOperation(OperationIndex index) = 0;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSABatch
+      #pragma mark
+
+      class RSABatch : public Noop,
+                       public IRSABatch,
+                       public IRSABatchAsync
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        friend interaction IRSABatchFactory;
+        friend interaction IRSABatch;
+
+        ZS_DECLARE_STRUCT_PTR(Operation)
+
+        typedef std::vector<OperationPtr> OperationList;
+
+        struct Operation
+        {
+          Operations mOperation {Operation_Sign};
+
+          IRSAPrivateKeyPtr mPrivateKey;
+          IRSAPublicKeyPtr mPublicKey;
+
+          SecureByteBlockPtr mInput;
+          SecureByteBlockPtr mSignature;
+
+          std::atomic<bool> mClaimed {false};
+
+          SecureByteBlockPtr mResult;
+          bool mVerified {false};
+        };
+
+      public:
+        RSABatch(const make_private &);
+
+      protected:
+        RSABatch(Noop) : Noop(true) {};
+
+      public:
+        ~RSABatch();
+
+        static RSABatchPtr convert(IRSABatchPtr batch);
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark RSABatch => IRSABatch
+        #pragma mark
+
+        static ElementPtr toDebug(IRSABatchPtr batch);
+
+        static RSABatchPtr create();
+
+        virtual PUID getID() const {return mID;}
+
+        virtual OperationIndex sign(
+                                    IRSAPrivateKeyPtr key,
+                                    const SecureByteBlock &inBufferToSign
+                                    );
+
+        virtual OperationIndex decrypt(
+                                       IRSAPrivateKeyPtr key,
+                                       const SecureByteBlock &buffer
+                                       );
+
+        virtual OperationIndex verify(
+                                      IRSAPublicKeyPtr key,
+                                      const SecureByteBlock &inOriginalBufferSigned,
+                                      const SecureByteBlock &inSignature
+                                      );
+
+        virtual OperationIndex encrypt(
+                                       IRSAPublicKeyPtr key,
+                                       const SecureByteBlock &buffer
+                                       );
+
+        virtual size_t getTotalOperations() const;
+
+        virtual void process(IRSABatchDelegatePtr delegate);
+
+        virtual void wait();
+
+        virtual bool isComplete() const;
+
+        virtual SecureByteBlockPtr getResult(OperationIndex index) const;
+
+        virtual bool getVerified(OperationIndex index) const;
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark RSABatch => IRSABatchAsync
+        #pragma mark
+
+        virtual void onPerformOperation(OperationIndex index);
+
+      protected:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark RSABatch => (internal)
+        #pragma mark
+
+        Log::Params log(const char *message) const;
+
+        virtual ElementPtr toDebug() const;
+
+        OperationIndex add(OperationPtr operation);
+
+        void perform(OperationIndex index);
+
+      private:
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark RSABatch => (data)
+        #pragma mark
+
+        AutoPUID mID;
+        RSABatchWeakPtr mThisWeak;
+
+        mutable Lock mLock;
+
+        OperationList mOperations;
+
+        bool mProcessing {false};
+        size_t mCompleted {};
+
+        IRSABatchDelegatePtr mDelegate;
+        EventPtr mCompletedEvent;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark IRSABatchFactory
+      #pragma mark
+
+      interaction IRSABatchFactory
+      {
+        static IRSABatchFactory &singleton();
+
+        virtual RSABatchPtr create();
+      };
+
+      class RSABatchFactory : public IFactory<IRSABatchFactory> {};
+    }
+  }
+}
+
+ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IRSABatchAsync)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::IRSABatchAsync::OperationIndex, OperationIndex)
+ZS_DECLARE_PROXY_METHOD_1(onPerformOperation, OperationIndex)
+ZS_DECLARE_PROXY_END()
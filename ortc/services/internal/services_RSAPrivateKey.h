@@ -80,6 +80,7 @@ namespace ortc
       public:
         friend interaction IRSAPrivateKey;
         friend interaction IRSAPrivateKeyFactory;
+        friend class KeyGenerationPool;
 
         ZS_DECLARE_TYPEDEF_PTR(IRSAPublicKeyForRSAPrivateKey, UsePublicKey)
 
@@ -131,6 +132,11 @@ namespace ortc
 
         virtual ElementPtr toDebug() const;
 
+        static RSAPrivateKeyPtr generateNow(
+                                            RSAPublicKeyPtr &outPublicKey,
+                                            size_t keySizeInBits
+                                            );
+
         virtual SecureByteBlockPtr sign(
                                         const BYTE *inBuffer,
                                         size_t inBufferSizeInBytes
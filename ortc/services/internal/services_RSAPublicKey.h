@@ -37,6 +37,11 @@
 #include <cryptopp/rsa.h>
 #include <cryptopp/secblock.h>
 
+#include <list>
+#include <map>
+
+#define ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE "ortc/services/rsa-public-key-verify-cache-size"
+
 namespace ortc
 {
   namespace services
@@ -115,15 +120,20 @@ namespace ortc
 
         virtual bool verify(
                             const SecureByteBlock &inOriginalBufferSigned,
-                            const SecureByteBlock &inSignature
+                            const SecureByteBlock &inSignature,
+                            bool useVerifyCache = true
                             ) const;
 
         virtual bool verify(
                             const String &inOriginalStringSigned,
-                            const SecureByteBlock &inSignature
+                            const SecureByteBlock &inSignature,
+                            bool useVerifyCache = true
                             ) const;
 
-        virtual bool verifySignature(ElementPtr signedEl) const;
+        virtual bool verifySignature(
+                                     ElementPtr signedEl,
+                                     bool useVerifyCache = true
+                                     ) const;
 
         virtual SecureByteBlockPtr encrypt(const SecureByteBlock &buffer) const;
 
@@ -140,9 +150,16 @@ namespace ortc
         bool verify(
                     const BYTE *inBuffer,
                     size_t inBufferLengthInBytes,
-                    const SecureByteBlock &inSignature
+                    const SecureByteBlock &inSignature,
+                    bool useVerifyCache
                     ) const;
 
+        bool verifyNow(
+                       const BYTE *inBuffer,
+                       size_t inBufferLengthInBytes,
+                       const SecureByteBlock &inSignature
+                       ) const;
+
       private:
         //-------------------------------------------------------------------
         #pragma mark
@@ -154,6 +171,70 @@ namespace ortc
         String mFingerprint;
       };
 
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark RSAPublicKeyVerifyCache
+      #pragma mark
+
+      // Process wide LRU of prior verification verdicts. The key is a SHA256
+      // over the public key fingerprint, the signed data and the signature
+      // so a hit can only come from the exact same check.
+      class RSAPublicKeyVerifyCache
+      {
+      protected:
+        struct make_private {};
+
+      public:
+        typedef String CacheKey;
+        typedef std::pair<CacheKey, bool> CacheEntry;
+        typedef std::list<CacheEntry> CacheList;
+        typedef std::map<CacheKey, CacheList::iterator> CacheMap;
+
+      public:
+        RSAPublicKeyVerifyCache(const make_private &);
+
+        static RSAPublicKeyVerifyCachePtr singleton();
+
+        static bool isEnabled();    // false when the configured cache size is 0
+
+        static CacheKey toKey(
+                              const String &fingerprint,
+                              const BYTE *inBuffer,
+                              size_t inBufferLengthInBytes,
+                              const SecureByteBlock &inSignature
+                              );
+
+        bool find(
+                  const CacheKey &key,
+                  bool &outVerified
+                  );
+
+        void store(
+                   const CacheKey &key,
+                   bool verified
+                   );
+
+        void clear();
+
+        size_t getHits() const;
+        size_t getMisses() const;
+        size_t getSize() const;
+
+        ElementPtr toDebug() const;
+
+      protected:
+        mutable Lock mLock;
+
+        CacheList mEntries;     // most recently used first
+        CacheMap mLookup;
+
+        size_t mHits {};
+        size_t mMisses {};
+      };
+
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
       //-----------------------------------------------------------------------
@@ -40,6 +40,7 @@
 #include <zsLib/IWakeDelegate.h>
 
 #include <map>
+#include <vector>
 
 namespace ortc
 {
@@ -188,6 +189,14 @@ namespace ortc
         typedef PUID ACKRequestID;
         typedef std::map<ACKRequestID, ISTUNRequesterPtr> ACKRequestMap;
 
+        struct SubStream
+        {
+          ITransportStreamPtr mReceiveStream;
+          ITransportStreamPtr mSendStream;
+        };
+
+        typedef std::vector<SubStream> SubStreamList;
+
       protected:
         RUDPChannel(
                     IMessageQueuePtr queue,
@@ -241,6 +250,14 @@ namespace ortc
 
         virtual String getRemoteConnectionInfo();
 
+        virtual WORD getTotalStreams() const;
+
+        virtual bool getSubStream(
+                                  WORD streamID,
+                                  ITransportStreamPtr &outReceiveStream,
+                                  ITransportStreamPtr &outSendStream
+                                  );
+
         //---------------------------------------------------------------------
         #pragma mark
         #pragma mark RUDPChannel => IRUDPChannelForRUDPTransport
@@ -361,8 +378,7 @@ namespace ortc
 
         virtual bool notifyRUDPChannelStreamSendPacket(
                                                        IRUDPChannelStreamPtr stream,
-                                                       const BYTE *packet,
-                                                       size_t packetLengthInBytes
+                                                       PacketBufferPtr packet
                                                        );
 
         virtual void onRUDPChannelStreamSendExternalACKNow(
@@ -428,6 +444,9 @@ namespace ortc
                               STUNPacketPtr response
                               );
 
+        static WORD getNegotiatedTotalStreams(STUNPacketPtr stun);
+        void setupSubStreams();
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
@@ -486,6 +505,9 @@ namespace ortc
         Time mLastReceivedData;
 
         ACKRequestMap mOutstandingACKs;
+
+        WORD mTotalStreams {1};
+        SubStreamList mSubStreams;                  // index 0 is unused (stream 0 is mReceiveStream/mSendStream)
       };
 
       //-----------------------------------------------------------------------
@@ -510,6 +532,15 @@ namespace ortc
                                                  const BYTE *packet,
                                                  size_t packetLengthInBytes
                                                  ) = 0;
+
+        //---------------------------------------------------------------------
+        // PURPOSE: Send a packet whose reserved headroom/tailroom may be used
+        //          by lower layers to frame the packet without a copy.
+        virtual bool notifyRUDPChannelSendPacket(
+                                                 RUDPChannelPtr channel,
+                                                 const IPAddress &remoteIP,
+                                                 PacketBufferPtr packet
+                                                 ) = 0;
       };
 
       //-----------------------------------------------------------------------
@@ -571,7 +602,9 @@ namespace ortc
 
 ZS_DECLARE_PROXY_BEGIN(ortc::services::internal::IRUDPChannelDelegateForSessionAndListener)
 ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::RUDPChannelPtr, RUDPChannelPtr)
+ZS_DECLARE_PROXY_TYPEDEF(ortc::services::PacketBufferPtr, PacketBufferPtr)
 ZS_DECLARE_PROXY_TYPEDEF(ortc::services::internal::IRUDPChannelDelegateForSessionAndListener::RUDPChannelStates, RUDPChannelStates)
 ZS_DECLARE_PROXY_METHOD_2(onRUDPChannelStateChanged, RUDPChannelPtr, RUDPChannelStates)
 ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_4(notifyRUDPChannelSendPacket, bool, RUDPChannelPtr, const IPAddress &, const BYTE *, size_t)
+ZS_DECLARE_PROXY_METHOD_SYNC_RETURN_3(notifyRUDPChannelSendPacket, bool, RUDPChannelPtr, const IPAddress &, PacketBufferPtr)
 ZS_DECLARE_PROXY_END()
@@ -41,6 +41,10 @@
 
 #include <map>
 #include <list>
+#include <vector>
+
+#define ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING "ortc/services/rudp/pace-sending"
+#define ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_MAX_SUB_STREAMS "ortc/services/rudp/max-sub-streams"
 
 #pragma warning(push)
 #pragma warning(disable:4290)
@@ -88,8 +92,28 @@ namespace ortc
 
         ZS_DECLARE_STRUCT_PTR(BufferedPacket)
 
+        typedef ITransportStream::StreamHeaderPtr StreamHeaderPtr;
+        typedef IRUDPChannel::ReliabilityHeader ReliabilityHeader;
+        typedef IRUDPChannel::ReliabilityHeaderPtr ReliabilityHeaderPtr;
+
         typedef std::map<QWORD, BufferedPacketPtr> BufferedPacketMap;
 
+        typedef std::map<DWORD, SecureByteBlockPtr> SubStreamDataMap;
+
+        struct SubStream
+        {
+          ITransportStreamWriterPtr mReceiveStream;                 // not used for sub-stream 0 (see mReceiveStream)
+          ITransportStreamReaderPtr mSendStream;                    // not used for sub-stream 0 (see mSendStream)
+          ITransportStreamReaderSubscriptionPtr mSendStreamSubscription;
+          StreamHeaderPtr mSendStreamPartialHeader;                 // header of a send buffer only partly read so far (not used for sub-stream 0)
+
+          DWORD mNextSendSequenceNumber {};
+          DWORD mNextReceiveSequenceNumber {};
+          SubStreamDataMap mPendingReceiveData;                     // data which arrived before earlier data on the same sub-stream
+        };
+
+        typedef std::vector<SubStream> SubStreamList;
+
         struct Exceptions
         {
           ZS_DECLARE_CUSTOM_EXCEPTION(IllegalACK)
@@ -148,6 +172,14 @@ namespace ortc
                                 ITransportStreamPtr sendStream
                                 );
 
+        virtual void setTotalSubStreams(WORD totalSubStreams);
+
+        virtual void setSubStreamStreams(
+                                         WORD subStreamID,
+                                         ITransportStreamPtr receiveStream,
+                                         ITransportStreamPtr sendStream
+                                         );
+
         virtual void shutdown(bool shutdownOnlyOnceAllDataSent = false);
 
         virtual void shutdownDirection(Shutdown state);
@@ -233,11 +265,15 @@ namespace ortc
 
         bool sendNowHelper(
                            IRUDPChannelStreamDelegatePtr &delegate,
-                           const BYTE *buffer,
-                           size_t packetLengthInBytes
+                           PacketBufferPtr packet
                            );
         bool sendNow();   // returns true if new packets were sent that weren't sent before
         void sendNowCleanup();
+        Microseconds getPacingInterval() const;
+        ULONG getPacedPacketsToSend(Time tick);
+        void notifyPacedPacketSent(Time tick);
+        void sendTailLossProbe();
+        void resetTailLossProbes();
         void handleAck(
                        QWORD outNextSequenceNumber,
                        QWORD outGreatestSequenceNumberReceived,
@@ -254,13 +290,36 @@ namespace ortc
         void handleECN();
         void handleDuplicate();
         void handlePacketLoss();
+        bool handleDeliveredForLossDetection(
+                                             BufferedPacketPtr packet,
+                                             Time tick
+                                             );
+        bool detectLossByTime(Time tick);
         void handleUnfreezing();
 
         void deliverReadPackets();
+        void deliverSubStreamData(BufferedPacketPtr packet);
+        void writeReceivedData(
+                               WORD subStreamID,
+                               const BYTE *buffer,
+                               size_t bufferSizeInBytes,
+                               StreamHeaderPtr header = StreamHeaderPtr()
+                               );
         size_t getFromWriteBuffer(
                                   BYTE *outBuffer,
-                                  size_t maxFillSize
+                                  size_t maxFillSize,
+                                  ReliabilityHeaderPtr &outReliability
                                   );
+        size_t readFromSendStream(
+                                  ITransportStreamReaderPtr stream,
+                                  StreamHeaderPtr &ioPartiallyReadHeader,
+                                  BYTE *outBuffer,
+                                  size_t maxFillSize,
+                                  ReliabilityHeaderPtr &outReliability
+                                  );
+        void abandonPacket(BufferedPacketPtr packet);
+        void abandonExpiredPackets(Time tick);
+        ULONG getTotalWriteBuffers() const;
 
         bool getRandomFlag();
 
@@ -290,16 +349,24 @@ namespace ortc
           QWORD mSequenceNumber;
 
           Time mTimeSentOrReceived;
+          Time mTimeSent;                       // when this packet was last put on the wire (updated every time the packet is resent)
 
           RUDPPacketPtr mRUDPPacket;
-          SecureByteBlockPtr mPacket;
+          PacketBufferPtr mPacket;              // only used on packets being sent (reset once ACKed)
+          SecureByteBlockPtr mOriginalBuffer;   // only used on received packets (the parsed RUDP packet points into this buffer)
 
           // used for sending packets
           bool mXORedParityToNow;               // only used on buffered packets being sent over the wire to keep track of the current parity state to "this" packet
 
           bool mHoldsBaton;                     // this packet holds a baton
-          bool mFlaggedAsFailedToReceive;       // this packet was flagged that it was never received by the remote party (only flagged once)
+          bool mFlaggedAsFailedToReceive;       // this packet was flagged that it was never received by the remote party and was resent (thus an ACK for it cannot be used to measure the RTT)
           bool mFlagForResendingInNextBurst;    // this packet needs to be resent at the next possible burst window
+
+          ReliabilityHeaderPtr mReliability;    // only set if this packet carries data which may be given up on
+          ULONG mTotalRetransmits;              // how many times this packet was resent
+
+          // used for received packets
+          bool mDataDelivered;                  // the data was already delivered ahead of order (unordered data)
         };
 
       protected:
@@ -326,6 +393,13 @@ namespace ortc
 
         ByteQueuePtr mPendingReceiveData;
 
+        StreamHeaderPtr mSendStreamPartialHeader;               // header of a send buffer only partly read so far
+        bool mPartiallyReliableDataSent {};                     // at least one sent packet may need to be abandoned once expired
+
+        WORD mTotalSubStreams {1};                              // 1 = the stream is not split into sub-streams
+        SubStreamList mSubStreams;                              // only filled if there is more than one sub-stream
+        WORD mNextSubStreamToSend {};                           // sub-streams take turns filling packets so one busy sub-stream cannot starve the others
+
         bool mDidReceiveWriteReady {true};
 
         WORD mSendingChannelNumber;
@@ -366,15 +440,31 @@ namespace ortc
         ITimerPtr mBurstTimer;                                   // this timer will be used to consume the available batons until they are gone (the timer will be cancelled when there is no more available batons or there is no more data to send)
 
         // If there is no burst timer and no "batons" available then when this
-        // timer fires an external ACK must be delivered to ensure that data
-        // has in fact been delivered to the other side.
+        // timer fires a tail loss probe is sent to ensure that data has in
+        // fact been delivered to the other side (only if the probes go
+        // unanswered is an external ACK forced).
         ITimerPtr mEnsureDataHasArrivedWhenNoMoreBurstBatonsAvailableTimer;
+        ULONG mTailLossProbesSent {};                           // how many tail loss probes were sent since the last ACK progress (used to back off the probe timeout)
+        ULONG mTotalTailLossProbes {};                          // how many tail loss probes were ever sent
+
+        // time based loss detection (a packet is lost once a packet sent
+        // sufficiently later than it has been ACKed)
+        Time mMostRecentDeliveredSentTime;                      // when the most recently (re)sent packet that has been ACKed was sent
+        Milliseconds mMostRecentDeliveredRTT {};                // the RTT measured from the most recently (re)sent packet that has been ACKed
+        Milliseconds mMinimumObservedRTT {};                    // smallest RTT ever measured (used to size the reordering window)
+        ITimerPtr mLossDetectionTimer;                          // fires when the earliest outstanding packet will have exceeded the reordering window
+        bool mFastRetransmitNow {};                             // a loss was just detected so one resend may bypass the pacing and baton limits
 
         ITimerPtr mAddToAvailableBurstBatonsTimer;               // add to the batons available when this timer fires (this timer is only active as long as there is data to send)
         Milliseconds mAddToAvailableBurstBatonsDuation {};      // every time there is new congestion this duration is doubled
 
         ULONG mPacketsPerBurst;                                 // how many packets to deliver in a single burst
 
+        bool mPaceSending {};                                   // spread the packets in a burst evenly across the burst window instead of sending them back to back
+        Milliseconds mBurstTimerDuration {};                    // the duration the burst timer was created with (when pacing this is the delay until the next paced send)
+        ULONG mPacedBurstPacketsRemaining {};                   // how many packets remain to be sent in the current paced burst (0 = no burst in progress)
+        Time mNextPacedSendTime;                                // the earliest time the next paced packet is allowed onto the wire
+
         bool mBandwidthIncreaseFrozen {};                       // the bandwidth increase routine is currently frozen because an insufficient time without issues has not occurerd
         Time mStartedSendingAtTime;                             // when did the sending activate again (so when the final ACK comes in the total duration can be calculated)
         Milliseconds mTotalSendingPeriodWithoutIssues {};       // how long has there been a successful period of sending without and sending difficulties
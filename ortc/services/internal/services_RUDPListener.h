@@ -153,6 +153,12 @@ namespace ortc
                                                  size_t packetLengthInBytes
                                                  );
 
+        virtual bool notifyRUDPChannelSendPacket(
+                                                 RUDPChannelPtr channel,
+                                                 const IPAddress &remoteIP,
+                                                 PacketBufferPtr packet
+                                                 );
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
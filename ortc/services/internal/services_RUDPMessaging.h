@@ -37,6 +37,8 @@
 #include <ortc/services/IRUDPChannel.h>
 #include <ortc/services/ITransportStream.h>
 
+#include <map>
+
 namespace ortc
 {
   namespace services
@@ -64,6 +66,10 @@ namespace ortc
       public:
         friend interaction IRUDPMessagingFactory;
         friend interaction IRUDPMessaging;
+
+        typedef std::map<PUID, RUDPMessagingWeakPtr> SubStreamMessagingMap;
+
+        typedef ITransportStream::StreamHeaderPtr StreamHeaderPtr;
         
       public:
         RUDPMessaging(
@@ -138,6 +144,16 @@ namespace ortc
 
         virtual String getRemoteConnectionInfo();
 
+        virtual WORD getTotalStreams();
+
+        virtual IRUDPMessagingPtr openStream(
+                                             IRUDPMessagingDelegatePtr delegate,
+                                             WORD streamID,
+                                             ITransportStreamPtr receiveStream,
+                                             ITransportStreamPtr sendStream,
+                                             size_t maxMessageSizeInBytes
+                                             );
+
         //---------------------------------------------------------------------
         #pragma mark
         #pragma mark RUDPMessaging => IRUDPChannelDelegate
@@ -179,8 +195,14 @@ namespace ortc
         void step();
         bool stepSendData();
         bool stepReceiveData();
+        void deliverMessage(
+                            const BYTE *buffer,
+                            size_t bufferSizeInBytes,
+                            StreamHeaderPtr header = StreamHeaderPtr()
+                            );
 
         void cancel();
+        void cancelSubStreams();
         void setState(RUDPMessagingStates state);
         void setError(WORD errorCode, const char *inReason = NULL);
 
@@ -217,10 +239,15 @@ namespace ortc
         bool mInformedOuterReceiveReady {};
         bool mInformedWireSendReady {};
 
+        ByteQueuePtr mReceivedData;                     // ordered wire data which does not yet form a complete message
+
         RUDPMessagingPtr mGracefulShutdownReference;
 
         IRUDPChannelPtr mChannel;
 
+        WORD mStreamID {};                              // 0 = owns the channel, otherwise a stream opened via openStream
+        SubStreamMessagingMap mSubStreamMessaging;      // streams opened from this messaging object
+
         size_t mMaxMessageSizeInBytes;
       };
 
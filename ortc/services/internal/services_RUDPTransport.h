@@ -181,6 +181,12 @@ namespace ortc
                                                  size_t packetLengthInBytes
                                                  );
 
+        virtual bool notifyRUDPChannelSendPacket(
+                                                 RUDPChannelPtr channel,
+                                                 const IPAddress &remoteIP,
+                                                 PacketBufferPtr packet
+                                                 );
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
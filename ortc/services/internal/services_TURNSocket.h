@@ -45,10 +45,13 @@
 #include <zsLib/IWakeDelegate.h>
 
 #define ORTC_SERVICES_TURN_MAX_CHANNEL_DATA_IN_BYTES ((1 << (sizeof(WORD)*8)) - 1)
+#define ORTC_SERVICES_TURN_CHANNEL_TABLE_PAGE_SIZE (256)
 
 #include <list>
 #include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #define ORTC_SERVICES_SETTING_TURN_SOCKET_BACKGROUNDING_PHASE "ortc/services/backgrounding-phase-turn"
 
@@ -93,6 +96,7 @@ namespace ortc
         ZS_DECLARE_STRUCT_PTR(Server)
         ZS_DECLARE_STRUCT_PTR(Permission)
         ZS_DECLARE_STRUCT_PTR(ChannelInfo)
+        ZS_DECLARE_STRUCT_PTR(ChannelTable)
 
         typedef std::list<ServerPtr> ServerList;
 
@@ -156,6 +160,12 @@ namespace ortc
                                 bool bindChannelIfPossible = false
                                 );
 
+        virtual bool sendPacket(
+                                IPAddress destination,
+                                PacketBufferPtr packet,
+                                bool bindChannelIfPossible = false
+                                );
+
         virtual IPAddress getActiveServerIP() const;
         virtual IPAddress getRelayedIP() const;
         virtual IPAddress getReflectedIP() const;
@@ -303,6 +313,14 @@ namespace ortc
 
         void refreshChannels();
 
+        bool sendPacketHelper(
+                              IPAddress destination,
+                              const BYTE *buffer,
+                              size_t bufferLengthInBytes,
+                              bool bindChannelIfPossible,
+                              PacketBufferPtr framingPacket
+                              );
+
         bool sendPacketOrDopPacketIfBufferFull(
                                                ServerPtr server,
                                                const BYTE *buffer,
@@ -318,6 +336,7 @@ namespace ortc
         void informWriteReady();
 
         WORD getNextChannelNumber();
+        void publishChannelTable();
 
         ISTUNRequesterPtr handleAuthorizationErrors(ISTUNRequesterPtr requester, STUNPacketPtr response);
 
@@ -405,6 +424,42 @@ namespace ortc
           ISTUNRequesterPtr mChannelBindRequester;
         };
 
+        //---------------------------------------------------------------------
+        // An immutable snapshot of what is needed to demultiplex received
+        // channel data. Channel numbers index directly into pages of peer
+        // addresses (pages are only allocated for ranges in use). A new
+        // snapshot is published whenever the channels change so the receive
+        // path never needs to take the lock.
+        struct ChannelTable
+        {
+          struct Entry
+          {
+            bool mInUse {};
+            IPAddress mPeerAddress;
+          };
+
+          ZS_DECLARE_TYPEDEF_PTR(std::vector<Entry>, Page)
+          typedef std::vector<PagePtr> PageList;
+
+          static ChannelTablePtr create(
+                                        WORD rangeStart,
+                                        WORD rangeEnd
+                                        );
+
+          void add(
+                   WORD channel,
+                   const IPAddress &peerAddress
+                   );
+
+          const IPAddress *find(WORD channel) const;
+
+          ITURNSocketDelegatePtr mDelegate;
+          IPAddress mServerIP;
+
+          WORD mRangeStart {};
+          PageList mPages;
+        };
+
       protected:
         //---------------------------------------------------------------------
         #pragma mark
@@ -461,6 +516,7 @@ namespace ortc
 
         ChannelIPMap mChannelIPMap;
         ChannelNumberMap mChannelNumberMap;
+        ChannelTablePtr mChannelTable;      // only accessed via std::atomic_load / std::atomic_store
 
         bool          mForceTURNUseUDP {};
         bool          mForceTURNUseTCP {};
@@ -37,6 +37,15 @@
 
 namespace ortc { namespace services { namespace wire { ZS_DECLARE_FORWARD_SUBSYSTEM(ortc_services_wire) } } }
 
+// Wire logging sits on the path of every packet sent or received. Each
+// statement checks the wire subsystem's level before any of its arguments
+// (address strings, candidate debug elements, base64 dumps) are built, so
+// code that prepares values only for logging must be guarded with
+// ORTC_SERVICES_WIRE_IS_LOGGING. Defining ORTC_SERVICES_DISABLE_WIRE_LOGGING
+// removes the statements, and the code they guard, from the build.
+
+#ifndef ORTC_SERVICES_DISABLE_WIRE_LOGGING
+
 #define ORTC_SERVICES_WIRE_IS_LOGGING(xLevel) ZS_IS_SUBSYSTEM_LOGGING(ZS_GET_OTHER_SUBSYSTEM(::ortc::services::wire, ortc_services_wire), xLevel)
 
 #define ORTC_SERVICES_WIRE_LOG_BASIC(xMsg)    ZS_LOG_SUBSYSTEM_BASIC(ZS_GET_OTHER_SUBSYSTEM(::ortc::services::wire, ortc_services_wire), xMsg)
@@ -47,3 +56,18 @@ namespace ortc { namespace services { namespace wire { ZS_DECLARE_FORWARD_SUBSYS
 
 #define ORTC_SERVICES_WIRE_LOG_WARNING(xLevel, xMsg)  ZS_LOG_SUBSYSTEM_WARNING(ZS_GET_OTHER_SUBSYSTEM(::ortc::services::wire, ortc_services_wire), xLevel, xMsg)
 #define ORTC_SERVICES_WIRE_LOG_ERROR(xLevel, xMsg)    ZS_LOG_SUBSYSTEM_ERROR(ZS_GET_OTHER_SUBSYSTEM(::ortc::services::wire, ortc_services_wire), xLevel, xMsg)
+
+#else //ndef ORTC_SERVICES_DISABLE_WIRE_LOGGING
+
+#define ORTC_SERVICES_WIRE_IS_LOGGING(xLevel) (false)
+
+#define ORTC_SERVICES_WIRE_LOG_BASIC(xMsg)    {}
+#define ORTC_SERVICES_WIRE_LOG_DETAIL(xMsg)   {}
+#define ORTC_SERVICES_WIRE_LOG_DEBUG(xMsg)    {}
+#define ORTC_SERVICES_WIRE_LOG_TRACE(xMsg)    {}
+#define ORTC_SERVICES_WIRE_LOG_INSANE(xMsg)   {}
+
+#define ORTC_SERVICES_WIRE_LOG_WARNING(xLevel, xMsg)  {}
+#define ORTC_SERVICES_WIRE_LOG_ERROR(xLevel, xMsg)    {}
+
+#endif //ndef ORTC_SERVICES_DISABLE_WIRE_LOGGING
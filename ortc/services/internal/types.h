@@ -120,14 +120,19 @@ namespace ortc
       ZS_DECLARE_CLASS_PTR(DHPublicKey);
       ZS_DECLARE_CLASS_PTR(DNSMonitor);
       ZS_DECLARE_CLASS_PTR(DNSQuery);
+      ZS_DECLARE_CLASS_PTR(Ed25519PrivateKey);
+      ZS_DECLARE_CLASS_PTR(Ed25519PublicKey);
       ZS_DECLARE_CLASS_PTR(Encryptor);
       ZS_DECLARE_CLASS_PTR(ICESocket);
       ZS_DECLARE_CLASS_PTR(ICESocketSession);
       ZS_DECLARE_CLASS_PTR(HTTP);
+      ZS_DECLARE_CLASS_PTR(KeyGenerationPool);
       ZS_DECLARE_CLASS_PTR(MessageLayerSecurityChannel);
       ZS_DECLARE_CLASS_PTR(Reachability);
+      ZS_DECLARE_CLASS_PTR(RSABatch);
       ZS_DECLARE_CLASS_PTR(RSAPrivateKey);
       ZS_DECLARE_CLASS_PTR(RSAPublicKey);
+      ZS_DECLARE_CLASS_PTR(RSAPublicKeyVerifyCache);
       ZS_DECLARE_CLASS_PTR(RUDPChannel);
       ZS_DECLARE_CLASS_PTR(RUDPChannelStream);
       ZS_DECLARE_CLASS_PTR(RUDPICESocket);
@@ -145,6 +150,9 @@ namespace ortc
       ZS_DECLARE_INTERACTION_PTR(IRUDPChannelStream);
 
       ZS_DECLARE_INTERACTION_PROXY(IICESocketForICESocketSession);
+      ZS_DECLARE_INTERACTION_PROXY(IKeyGenerationPoolAsync);
+      ZS_DECLARE_INTERACTION_PROXY(IMessageLayerSecurityChannelAsync);
+      ZS_DECLARE_INTERACTION_PROXY(IRSABatchAsync);
       ZS_DECLARE_INTERACTION_PROXY(IRUDPChannelDelegateForSessionAndListener);
       ZS_DECLARE_INTERACTION_PROXY(IRUDPChannelStreamDelegate);
       ZS_DECLARE_INTERACTION_PROXY(IRUDPChannelStreamAsync);
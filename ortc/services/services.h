@@ -42,6 +42,8 @@
 #include <ortc/services/IDHPrivateKey.h>
 #include <ortc/services/IDHPublicKey.h>
 #include <ortc/services/IDNS.h>
+#include <ortc/services/IEd25519PrivateKey.h>
+#include <ortc/services/IEd25519PublicKey.h>
 #include <ortc/services/IEncryptor.h>
 #include <ortc/services/IHelper.h>
 #include <ortc/services/IHTTP.h>
@@ -50,6 +52,7 @@
 #include <ortc/services/ILogger.h>
 #include <ortc/services/IMessageLayerSecurityChannel.h>
 #include <ortc/services/IReachability.h>
+#include <ortc/services/IRSABatch.h>
 #include <ortc/services/IRSAPrivateKey.h>
 #include <ortc/services/IRSAPublicKey.h>
 #include <ortc/services/IRUDPChannel.h>
@@ -62,6 +65,7 @@
 #include <ortc/services/ITCPMessaging.h>
 #include <ortc/services/ITransportStream.h>
 #include <ortc/services/ITURNSocket.h>
+#include <ortc/services/PacketBuffer.h>
 #include <ortc/services/STUNPacket.h>
 #include <ortc/services/RUDPPacket.h>
 #include <ortc/services/RUDPProtocol.h>
@@ -30,15 +30,34 @@
  */
 
 #include <ortc/services/ICanonicalXML.h>
+#include <ortc/services/IHelper.h>
 
+#include <zsLib/eventing/IHasher.h>
 #include <zsLib/XML.h>
 #include <iostream>
+#include <sstream>
 
 #include "config.h"
 #include "testing.h"
 
 using ortc::services::ICanonicalXML;
 
+ZS_DECLARE_TYPEDEF_PTR(ortc::services::IHelper, UseHelper)
+ZS_DECLARE_TYPEDEF_PTR(zsLib::eventing::IHasher, UseHasher)
+
+static void checkCanonicalSinks(
+                                zsLib::XML::ElementPtr element,
+                                const char *finalized
+                                )
+{
+  std::stringstream stream;
+  ICanonicalXML::convert(element, stream);
+  TESTING_EQUAL(zsLib::String(stream.str()), finalized)
+
+  zsLib::String expecting = UseHelper::convertToHex(*UseHasher::hash(finalized, UseHasher::sha1()));
+  TESTING_EQUAL(expecting, UseHelper::convertToHex(*ICanonicalXML::hash(element)))
+}
+
 void doTestCanonicalXML()
 {
   if (!ORTC_SERVICE_TEST_DO_CANONICAL_XML_TEST) return;
@@ -88,6 +107,7 @@ void doTestCanonicalXML()
 
     zsLib::String output = ICanonicalXML::convert(e1);
     TESTING_EQUAL(output, finalized)
+    checkCanonicalSinks(e1, finalized);
   }
 
   {
@@ -132,6 +152,7 @@ void doTestCanonicalXML()
 
     zsLib::String output = ICanonicalXML::convert(elementDoc);
     TESTING_EQUAL(output, finalized)
+    checkCanonicalSinks(elementDoc, finalized);
     TESTING_STDOUT() << output.c_str() << "\n";
   }
 
@@ -33,9 +33,15 @@
 #include <ortc/services/IDHPrivateKey.h>
 #include <ortc/services/IDHPublicKey.h>
 #include <ortc/services/IHelper.h>
+#include <ortc/services/internal/services_KeyGenerationPool.h>
 
+#include <zsLib/ISettings.h>
 #include <zsLib/XML.h>
+
+#include <algorithm>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "config.h"
 #include "testing.h"
@@ -49,6 +55,198 @@ using ortc::services::IDHPublicKey;
 using ortc::services::IDHPublicKeyPtr;
 using ortc::services::SecureByteBlock;
 using ortc::services::SecureByteBlockPtr;
+using zsLib::ISettings;
+using zsLib::Microseconds;
+using zsLib::Milliseconds;
+using zsLib::Time;
+
+typedef std::vector<Microseconds::rep> LatencyList;
+
+//-----------------------------------------------------------------------------
+static LatencyList measureHandshakes(
+                                     IDHPrivateKeyPtr templatePrivateKey,
+                                     IDHPublicKeyPtr templatePublicKey,
+                                     IDHPrivateKeyPtr remotePrivateKey,
+                                     IDHPublicKeyPtr remotePublicKey
+                                     )
+{
+  LatencyList latencies;
+
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_KEY_POOL_HANDSHAKES; ++loop) {
+    // handshakes are spaced apart which gives the pool time to refill
+    std::this_thread::sleep_for(Milliseconds(ORTC_SERVICE_TEST_KEY_POOL_HANDSHAKE_SPACING_MS));
+
+    Time start = zsLib::now();
+
+    IDHPublicKeyPtr publicKey;
+    IDHPrivateKeyPtr privateKey = IDHPrivateKey::loadAndGenerateNewEphemeral(templatePrivateKey, templatePublicKey, publicKey);
+
+    latencies.push_back(std::chrono::duration_cast<Microseconds>(zsLib::now() - start).count());
+
+    TESTING_CHECK((bool)privateKey)
+    TESTING_CHECK((bool)publicKey)
+    if ((!privateKey) || (!publicKey)) continue;
+
+    SecureByteBlockPtr localSecret = privateKey->getSharedSecret(remotePublicKey);
+    SecureByteBlockPtr remoteSecret = remotePrivateKey->getSharedSecret(publicKey);
+
+    TESTING_CHECK(IHelper::hasData(localSecret))
+    TESTING_CHECK(IHelper::hasData(remoteSecret))
+    if ((!localSecret) || (!remoteSecret)) continue;
+
+    TESTING_CHECK(0 == IHelper::compare(*localSecret, *remoteSecret))
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+//-----------------------------------------------------------------------------
+static void reportHandshakes(
+                             const char *title,
+                             const LatencyList &latencies
+                             )
+{
+  if (latencies.size() < 1) return;
+
+  TESTING_STDOUT() << "              " << title << ": handshakes=" << latencies.size()
+                   << " min(us)=" << latencies.front()
+                   << " median(us)=" << latencies[latencies.size() / 2]
+                   << " p90(us)=" << latencies[(latencies.size() * 9) / 10]
+                   << " max(us)=" << latencies.back() << "\n";
+}
+
+//-----------------------------------------------------------------------------
+static void testKeyGenerationPool()
+{
+  IDHKeyDomainPtr keyDomain = IDHKeyDomain::loadPrecompiled(IDHKeyDomain::KeyDomainPrecompiledType_2048);
+  TESTING_CHECK((bool)keyDomain)
+  if (!keyDomain) return;
+
+  ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS, 0);
+
+  IDHPublicKeyPtr localPublicKey;
+  IDHPrivateKeyPtr localPrivateKey = IDHPrivateKey::generate(keyDomain, localPublicKey);
+
+  IDHPublicKeyPtr remotePublicKey;
+  IDHPrivateKeyPtr remotePrivateKey = IDHPrivateKey::generate(keyDomain, remotePublicKey);
+
+  TESTING_CHECK((bool)localPrivateKey)
+  TESTING_CHECK((bool)remotePrivateKey)
+  if ((!localPrivateKey) || (!remotePrivateKey)) return;
+
+  LatencyList without = measureHandshakes(localPrivateKey, localPublicKey, remotePrivateKey, remotePublicKey);
+
+  ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS, 4);
+
+  ortc::services::internal::KeyGenerationPoolPtr pool = ortc::services::internal::KeyGenerationPool::singleton();
+  TESTING_CHECK((bool)pool)
+  if (!pool) return;
+
+  size_t hitsBefore = pool->getHits();
+
+  LatencyList with = measureHandshakes(localPrivateKey, localPublicKey, remotePrivateKey, remotePublicKey);
+
+  // the very first handshake activates the pool and is expected to miss
+  TESTING_CHECK(pool->getHits() > hitsBefore)
+
+  reportHandshakes("without key pool", without);
+  reportHandshakes("with key pool", with);
+
+  if ((without.size() > 0) &&
+      (with.size() > 0)) {
+    TESTING_CHECK(with[with.size() / 2] <= without[without.size() / 2])
+  }
+}
+
+//-----------------------------------------------------------------------------
+static void benchmarkPrecompiledDomains()
+{
+  static IDHKeyDomain::KeyDomainPrecompiledTypes precompiled[] =
+  {
+    IDHKeyDomain::KeyDomainPrecompiledType_1024,
+    IDHKeyDomain::KeyDomainPrecompiledType_1538,
+    IDHKeyDomain::KeyDomainPrecompiledType_2048,
+    IDHKeyDomain::KeyDomainPrecompiledType_3072,
+    IDHKeyDomain::KeyDomainPrecompiledType_4096,
+    IDHKeyDomain::KeyDomainPrecompiledType_6144,
+    IDHKeyDomain::KeyDomainPrecompiledType_8192,
+    IDHKeyDomain::KeyDomainPrecompiledType_X25519,
+    IDHKeyDomain::KeyDomainPrecompiledType_Unknown,
+  };
+
+  // measure the raw cost of a handshake (not the key generation pool)
+  ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS, 0);
+
+  for (int index = 0; precompiled[index] != IDHKeyDomain::KeyDomainPrecompiledType_Unknown; ++index)
+  {
+    Time start = zsLib::now();
+    IDHKeyDomainPtr keyDomain = IDHKeyDomain::loadPrecompiled(precompiled[index], true);
+    Microseconds firstLoad = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+
+    start = zsLib::now();
+    IDHKeyDomainPtr sharedKeyDomain = IDHKeyDomain::loadPrecompiled(precompiled[index], true);
+    Microseconds sharedLoad = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+
+    TESTING_CHECK((bool)keyDomain)
+    TESTING_CHECK((bool)sharedKeyDomain)
+    if ((!keyDomain) || (!sharedKeyDomain)) continue;
+
+    // precompiled domains are validated once and shared
+    TESTING_CHECK(keyDomain->getID() == sharedKeyDomain->getID())
+
+    // loading the same group from its raw values finds the shared domain
+    // (the curve domain has no raw group values)
+    if (IDHKeyDomain::KeyDomainPrecompiledType_X25519 != precompiled[index]) {
+      SecureByteBlock p;
+      SecureByteBlock q;
+      SecureByteBlock g;
+      keyDomain->save(p, q, g);
+
+      IDHKeyDomainPtr loadedKeyDomain = IDHKeyDomain::load(p, q, g, true);
+      TESTING_CHECK((bool)loadedKeyDomain)
+      if (loadedKeyDomain) {
+        TESTING_CHECK(keyDomain->getID() == loadedKeyDomain->getID())
+      }
+    }
+
+    IDHPublicKeyPtr aliceTemplatePublicKey;
+    IDHPrivateKeyPtr aliceTemplatePrivateKey = IDHPrivateKey::generate(keyDomain, aliceTemplatePublicKey);
+
+    IDHPublicKeyPtr bobTemplatePublicKey;
+    IDHPrivateKeyPtr bobTemplatePrivateKey = IDHPrivateKey::generate(keyDomain, bobTemplatePublicKey);
+
+    start = zsLib::now();
+
+    for (int loop = 0; loop < ORTC_SERVICE_TEST_DH_BENCHMARK_HANDSHAKES; ++loop) {
+      IDHPublicKeyPtr alicePublicKey;
+      IDHPrivateKeyPtr alicePrivateKey = IDHPrivateKey::loadAndGenerateNewEphemeral(aliceTemplatePrivateKey, aliceTemplatePublicKey, alicePublicKey);
+
+      IDHPublicKeyPtr bobPublicKey;
+      IDHPrivateKeyPtr bobPrivateKey = IDHPrivateKey::loadAndGenerateNewEphemeral(bobTemplatePrivateKey, bobTemplatePublicKey, bobPublicKey);
+
+      SecureByteBlockPtr aliceSecret = alicePrivateKey->getSharedSecret(bobPublicKey);
+      SecureByteBlockPtr bobSecret = bobPrivateKey->getSharedSecret(alicePublicKey);
+
+      TESTING_CHECK(IHelper::hasData(aliceSecret))
+      TESTING_CHECK(IHelper::hasData(bobSecret))
+      if ((!aliceSecret) || (!bobSecret)) continue;
+
+      TESTING_CHECK(0 == IHelper::compare(*aliceSecret, *bobSecret))
+    }
+
+    Microseconds duration = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+
+    double perSecond = (duration.count() > 0 ? (((double)ORTC_SERVICE_TEST_DH_BENCHMARK_HANDSHAKES) * 1000000.0) / ((double)duration.count()) : 0.0);
+
+    TESTING_STDOUT() << "              " << IDHKeyDomain::toNamespace(precompiled[index])
+                     << ": first load(us)=" << firstLoad.count()
+                     << " shared load(us)=" << sharedLoad.count()
+                     << " handshakes/sec=" << perSecond << "\n";
+  }
+
+  ISettings::setUInt(ORTC_SERVICES_SETTING_KEY_GENERATION_POOL_DH_KEYS, 4);
+}
 
 void doTestDH()
 {
@@ -66,6 +264,7 @@ void doTestDH()
       IDHKeyDomain::KeyDomainPrecompiledType_4096,
       IDHKeyDomain::KeyDomainPrecompiledType_6144,
       IDHKeyDomain::KeyDomainPrecompiledType_8192,
+      IDHKeyDomain::KeyDomainPrecompiledType_X25519,
       IDHKeyDomain::KeyDomainPrecompiledType_Unknown,
     };
 
@@ -265,8 +464,11 @@ void doTestDH()
 
       if (found) {
         TESTING_CHECK(precompiled[index] == keyDomain->getPrecompiledType())
+        TESTING_CHECK(precompiled[index] == IDHKeyDomain::fromNamespace(IDHKeyDomain::toNamespace(precompiled[index])))
       }
     }
   }
 
+  testKeyGenerationPool();
+  benchmarkPrecompiledDomains();
 }
@@ -30,17 +30,36 @@
  */
 
 #include <ortc/services/IHelper.h>
+#include <ortc/services/internal/services_Helper.h>
+#include <ortc/services/internal/services_Encoding.h>
 
+#include <zsLib/eventing/IHasher.h>
 #include <zsLib/String.h>
+#include <zsLib/XML.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <regex>
+#include <vector>
 
 #include "config.h"
 #include "testing.h"
 
 using zsLib::String;
+using zsLib::BYTE;
 
 ZS_DECLARE_TYPEDEF_PTR(ortc::services::IHelper, UseHelper)
+ZS_DECLARE_TYPEDEF_PTR(zsLib::eventing::IHasher, UseHasher)
+ZS_DECLARE_TYPEDEF_PTR(ortc::services::internal::Helper, UseInternalHelper)
+ZS_DECLARE_TYPEDEF_PTR(ortc::services::internal::Encoding, UseEncoding)
+
+using ortc::services::SecureByteBlock;
+using ortc::services::SecureByteBlockPtr;
+ZS_DECLARE_USING_PTR(zsLib::XML, Document)
+ZS_DECLARE_USING_PTR(zsLib::XML, Element)
+ZS_DECLARE_USING_PTR(zsLib::XML, Text)
+ZS_DECLARE_USING_PTR(zsLib::XML, Generator)
 
 static void testI18NIDN()
 {
@@ -144,6 +163,280 @@ static void testDomainValidation()
   
 }
 
+static void testCanonicalJSONDigest()
+{
+  const char *inputs[] = {
+    "{\"keying\":{\"$id\":\"abc\",\"sequence\":1,\"nonce\":\"n\",\"context\":\"ctx\",\"expires\":12345}}",
+    "{\"zeta\":{\"b\":\"2\",\"a\":\"1\",\"$z\":\"last\",\"$a\":\"first\"}}",
+    "{\"keys\":{\"key\":[{\"index\":2,\"algorithm\":\"x\"},{\"index\":1,\"algorithm\":\"y\"}],\"extra\":\"\"}}",
+    "{\"mixed\":{\"item\":\"1\",\"other\":\"o\",\"item\":\"2\",\"empty\":{},\"nested\":{\"deep\":{\"deeper\":[\"a\",\"b\",\"c\"]}}}}",
+    "{\"escaped\":{\"quote\":\"say \\\"hi\\\"\",\"slash\":\"a\\\\b\",\"newline\":\"line1\\nline2\",\"unicode\":\"\\u00e9t\\u00e9\"}}",
+    NULL
+  };
+
+  GeneratorPtr generator = Generator::createJSONGenerator();
+
+  for (size_t loop = 0; NULL != inputs[loop]; ++loop) {
+    DocumentPtr doc = Document::createFromParsedJSON(inputs[loop]);
+    TESTING_CHECK(doc)
+    if (!doc) continue;
+
+    ElementPtr el = doc->getFirstChildElement();
+    TESTING_CHECK(el)
+    if (!el) continue;
+
+    std::unique_ptr<char[]> expectingJSON = generator->write(UseHelper::cloneAsCanonicalJSON(el));
+    String expecting = UseHelper::convertToHex(*UseHasher::hash((const char *)(expectingJSON.get()), UseHasher::sha1()));
+
+    String output = UseHelper::convertToHex(*UseHelper::hashCanonicalJSON(el));
+
+    TESTING_EQUAL(expecting, output)
+    if (expecting != output) {
+      TESTING_EQUAL(String(inputs[loop]), String((const char *)(expectingJSON.get())));
+    }
+  }
+
+  // elements built in code rather than parsed (text stored in other formats)
+  {
+    ElementPtr rootEl = Element::create("bundle");
+    rootEl->setAttribute("id", "1234");
+
+    ElementPtr textEl = Element::create("text");
+    TextPtr text = Text::create();
+    text->setValueAndJSONEncode("a \"quoted\" value\twith a tab");
+    textEl->adoptAsLastChild(text);
+
+    ElementPtr numberEl = Element::create("number");
+    TextPtr number = Text::create();
+    number->setValue("42", Text::Format_JSONNumberEncoded);
+    numberEl->adoptAsLastChild(number);
+
+    ElementPtr entityEl = Element::create("entity");
+    TextPtr entity = Text::create();
+    entity->setValueAndEntityEncode("<less & greater>");
+    entityEl->adoptAsLastChild(entity);
+
+    rootEl->adoptAsLastChild(textEl);
+    rootEl->adoptAsLastChild(numberEl);
+    rootEl->adoptAsLastChild(entityEl);
+    rootEl->adoptAsLastChild(Element::create("alone"));
+
+    std::unique_ptr<char[]> expectingJSON = generator->write(UseHelper::cloneAsCanonicalJSON(rootEl));
+    String expecting = UseHelper::convertToHex(*UseHasher::hash((const char *)(expectingJSON.get()), UseHasher::sha1()));
+
+    TESTING_EQUAL(expecting, UseHelper::convertToHex(*UseHelper::hashCanonicalJSON(rootEl)))
+  }
+}
+
+static bool regexValidDomain(const std::regex &exp, const String &domain)
+{
+  // the expression "isValidDomain" used before the hand written validator
+  return std::regex_match(domain, exp);
+}
+
+static void benchmarkDomainValidation()
+{
+  const char *alphabet = "abcnxyz019-.A_";
+  const size_t alphabetLength = strlen(alphabet);
+
+  unsigned int seed = 20161019;
+  auto nextRandom = [&seed](size_t range) -> size_t {
+    seed = (seed * 1103515245) + 12345;
+    return static_cast<size_t>((seed >> 16) & 0x7FFF) % range;
+  };
+
+  std::vector<String> corpus;
+  corpus.reserve(ORTC_SERVICE_TEST_DOMAIN_BENCHMARK_DOMAINS);
+
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_DOMAIN_BENCHMARK_DOMAINS; ++loop) {
+    std::string domain;
+    size_t totalLabels = 1 + nextRandom(4);
+    for (size_t label = 0; label < totalLabels; ++label) {
+      if (label > 0) domain += ".";
+      if (0 == nextRandom(8)) domain += "xn--";
+
+      // mostly short labels with the odd one around the 63 character limit
+      size_t length = (0 == nextRandom(16) ? 58 + nextRandom(10) : nextRandom(12));
+      bool lettersOnly = ((label + 1 == totalLabels) && (0 != nextRandom(4)));
+      for (size_t pos = 0; pos < length; ++pos) {
+        domain += alphabet[nextRandom(lettersOnly ? 6 : alphabetLength)];
+      }
+    }
+    corpus.push_back(String(domain));
+  }
+
+  std::regex exp("((?=[a-z0-9-]{1,63}\\.)(xn--)?[a-z0-9]+(-[a-z0-9]+)*\\.)+[a-z]{2,63}$");
+
+  std::vector<bool> expected;
+  expected.reserve(corpus.size());
+
+  size_t totalValid = 0;
+
+  zsLib::Time start = zsLib::now();
+  for (auto iter = corpus.begin(); iter != corpus.end(); ++iter) {
+    expected.push_back(regexValidDomain(exp, *iter));
+  }
+  zsLib::Microseconds regexDuration = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  start = zsLib::now();
+  for (size_t index = 0; index < corpus.size(); ++index) {
+    const String &domain = corpus[index];
+    bool validated = UseInternalHelper::isValidIDNDomain(domain.c_str(), domain.length());
+    if (validated) ++totalValid;
+
+    TESTING_EQUAL(validated, expected[index])
+    if (validated != expected[index]) {
+      TESTING_EQUAL(domain, "failed");
+    }
+  }
+  zsLib::Microseconds validatorDuration = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  TESTING_STDOUT() << "              domain regex: domains=" << corpus.size() << " valid=" << totalValid << " total(us)=" << regexDuration.count() << "\n";
+  TESTING_STDOUT() << "              domain validator: domains=" << corpus.size() << " valid=" << totalValid << " total(us)=" << validatorDuration.count() << "\n";
+}
+
+static void benchmarkIDNConversion()
+{
+  const char *idnNames[] = {
+    "www.xn--gwtq9nb2a.jp",
+    "www.xn--vckk7bxa0eza9ezc9d.com",
+    "www.xn--frgbolaget-q5a.nu",
+    "www.xn--bcher-kva.de",
+    "xn--lck1c3crb1723bpq4a.com",
+    "www.xn--mkitorppa-v2a.com",
+    "www.example.com",
+    NULL
+  };
+
+  std::vector<String> utf8Names;
+  for (int loop = 0; NULL != idnNames[loop]; ++loop) {
+    utf8Names.push_back(UseInternalHelper::decodeIDN(idnNames[loop]));
+    TESTING_CHECK(utf8Names.back().hasData())
+  }
+
+  zsLib::Time start = zsLib::now();
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_IDN_BENCHMARK_CONVERSIONS; ++loop) {
+    const String &name = utf8Names[loop % utf8Names.size()];
+    TESTING_EQUAL(UseInternalHelper::encodeIDN(name), String(idnNames[loop % utf8Names.size()]))
+  }
+  zsLib::Microseconds uncachedDuration = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  start = zsLib::now();
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_IDN_BENCHMARK_CONVERSIONS; ++loop) {
+    const String &name = utf8Names[loop % utf8Names.size()];
+    TESTING_EQUAL(UseHelper::convertUTF8ToIDN(name), String(idnNames[loop % utf8Names.size()]))
+    TESTING_EQUAL(UseHelper::convertIDNToUTF8(idnNames[loop % utf8Names.size()]), name)
+  }
+  zsLib::Microseconds cachedDuration = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  TESTING_STDOUT() << "              idn uncached encode: conversions=" << ORTC_SERVICE_TEST_IDN_BENCHMARK_CONVERSIONS << " total(us)=" << uncachedDuration.count() << "\n";
+  TESTING_STDOUT() << "              idn cached encode+decode: conversions=" << ORTC_SERVICE_TEST_IDN_BENCHMARK_CONVERSIONS << " total(us)=" << cachedDuration.count() << "\n";
+}
+
+static void testEncoding()
+{
+  const UseEncoding::Kernels &scalar = UseEncoding::scalar();
+  const UseEncoding::Kernels &best = UseEncoding::best();
+
+  for (size_t length = 1; length < 300; ++length) {
+    SecureByteBlockPtr buffer = UseHelper::random(length);
+
+    // compare against the allocating conversions and the scalar kernels
+    String expectingBase64 = UseHelper::convertToBase64(*buffer);
+    String expectingHex = UseHelper::convertToHex(*buffer);
+
+    std::vector<char> encoded(UseHelper::getBase64EncodedLength(length) + 1);
+    size_t encodedLength = UseHelper::convertToBase64(buffer->BytePtr(), length, &(encoded[0]), encoded.size());
+    TESTING_EQUAL(String(std::string(&(encoded[0]), encodedLength)), expectingBase64)
+
+    std::vector<char> scalarEncoded(encoded.size());
+    scalar.mEncodeBase64(buffer->BytePtr(), length, &(scalarEncoded[0]));
+    TESTING_CHECK(std::equal(encoded.begin(), encoded.begin() + encodedLength, scalarEncoded.begin()))
+
+    std::vector<BYTE> decoded(length + 1);
+    size_t decodedLength = 0;
+    TESTING_CHECK(UseHelper::convertFromBase64(&(encoded[0]), encodedLength, &(decoded[0]), decoded.size(), decodedLength))
+    TESTING_EQUAL(decodedLength, length)
+    TESTING_CHECK(0 == memcmp(&(decoded[0]), buffer->BytePtr(), length))
+
+    std::vector<char> hex((length * 2) + 1);
+    size_t hexLength = UseHelper::convertToHex(buffer->BytePtr(), length, &(hex[0]), hex.size());
+    TESTING_EQUAL(String(std::string(&(hex[0]), hexLength)), expectingHex)
+
+    TESTING_CHECK(UseHelper::convertFromHex(&(hex[0]), hexLength, &(decoded[0]), decoded.size(), decodedLength))
+    TESTING_EQUAL(decodedLength, length)
+    TESTING_CHECK(0 == memcmp(&(decoded[0]), buffer->BytePtr(), length))
+
+    // invalid characters are rejected wherever they appear
+    encoded[(length * 7) % (encodedLength - 2)] = '*';
+    TESTING_CHECK(!UseHelper::convertFromBase64(&(encoded[0]), encodedLength, &(decoded[0]), decoded.size(), decodedLength))
+    TESTING_CHECK(!best.mDecodeBase64(&(encoded[0]), encodedLength, &(decoded[0])))
+  }
+
+  BYTE output[4] {};
+  size_t outputLength = 0;
+  TESTING_CHECK(UseHelper::convertFromBase64("aGk", 3, output, sizeof(output), outputLength))
+  TESTING_EQUAL(outputLength, static_cast<size_t>(2))
+  TESTING_CHECK(!UseHelper::convertFromBase64("aGk=a", 5, output, sizeof(output), outputLength))
+  TESTING_CHECK(!UseHelper::convertFromBase64("aGlhaGlh", 8, output, sizeof(output), outputLength))
+  TESTING_CHECK(!UseHelper::convertFromHex("a", 1, output, sizeof(output), outputLength))
+  TESTING_CHECK(!UseHelper::convertFromHex("zz", 2, output, sizeof(output), outputLength))
+}
+
+static void benchmarkEncoding()
+{
+  const UseEncoding::Kernels &scalar = UseEncoding::scalar();
+  const UseEncoding::Kernels &best = UseEncoding::best();
+
+  size_t sizes[] = {16, 64, 256, 1024, 16*1024, 1024*1024, 0};
+
+  for (int loop = 0; 0 != sizes[loop]; ++loop) {
+    size_t length = sizes[loop];
+    size_t iterations = (ORTC_SERVICE_TEST_ENCODING_BENCHMARK_BYTES / length);
+
+    SecureByteBlockPtr buffer = UseHelper::random(length);
+    std::vector<char> encoded(UseHelper::getBase64EncodedLength(length));
+    std::vector<char> hex(length * 2);
+    std::vector<BYTE> decoded(length);
+
+    const UseEncoding::Kernels *kernels[] = {&scalar, &best};
+    for (size_t index = 0; index < sizeof(kernels) / sizeof(kernels[0]); ++index) {
+      const UseEncoding::Kernels &current = *(kernels[index]);
+
+      zsLib::Time start = zsLib::now();
+      for (size_t count = 0; count < iterations; ++count) {
+        current.mEncodeBase64(buffer->BytePtr(), length, &(encoded[0]));
+      }
+      zsLib::Microseconds encodeBase64 = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+      start = zsLib::now();
+      for (size_t count = 0; count < iterations; ++count) {
+        TESTING_CHECK(current.mDecodeBase64(&(encoded[0]), encoded.size(), &(decoded[0])))
+      }
+      zsLib::Microseconds decodeBase64 = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+      start = zsLib::now();
+      for (size_t count = 0; count < iterations; ++count) {
+        current.mEncodeHex(buffer->BytePtr(), length, &(hex[0]), false);
+      }
+      zsLib::Microseconds encodeHex = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+      TESTING_STDOUT() << "              " << current.mName << " size=" << length << " iterations=" << iterations << " base64 encode(us)=" << encodeBase64.count() << " base64 decode(us)=" << decodeBase64.count() << " hex encode(us)=" << encodeHex.count() << "\n";
+    }
+
+    // the allocating conversions for comparison
+    iterations = std::min<size_t>(iterations, 1000);
+
+    zsLib::Time start = zsLib::now();
+    for (size_t count = 0; count < iterations; ++count) {
+      String result = UseHelper::convertToBase64(*buffer);
+    }
+    zsLib::Microseconds encodeBase64 = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+    TESTING_STDOUT() << "              string size=" << length << " iterations=" << iterations << " base64 encode(us)=" << encodeBase64.count() << "\n";
+  }
+}
+
 void doTestHelper()
 {
   if (!ORTC_SERVICE_TEST_DO_HELPER_TEST) return;
@@ -152,5 +445,10 @@ void doTestHelper()
 
   testI18NIDN();
   testDomainValidation();
+  testCanonicalJSONDigest();
+  benchmarkDomainValidation();
+  benchmarkIDNConversion();
+  testEncoding();
+  benchmarkEncoding();
 
 }
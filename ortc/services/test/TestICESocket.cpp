@@ -36,6 +36,9 @@
 #include <zsLib/ITimer.h>
 #include <ortc/services/IICESocket.h>
 #include <ortc/services/IICESocketSession.h>
+#include <ortc/services/IHelper.h>
+#include <ortc/services/ILogger.h>
+#include <ortc/services/internal/services_wire.h>
 
 #include "config.h"
 #include "testing.h"
@@ -66,6 +69,8 @@ using ortc::services::ITURNSocketDelegate;
 using ortc::services::IICESocket;
 using ortc::services::IICESocketPtr;
 using ortc::services::IICESocketSessionPtr;
+using ortc::services::IHelper;
+using ortc::services::ILogger;
 
 namespace ortc
 {
@@ -442,12 +447,79 @@ namespace ortc
 using ortc::services::test::TestICESocketCallback;
 using ortc::services::test::TestICESocketCallbackPtr;
 
+static zsLib::Log::Params wireLog(const char *message)
+{
+  return zsLib::Log::Params(message, "TestICESocket");
+}
+
+static void benchmarkWireLogging()
+{
+  // the same statements ICESocket issues for every packet sent and received
+  IICESocket::Candidate candidate;
+  candidate.mType = IICESocket::Type_Local;
+  candidate.mIPAddress = IPAddress("192.168.1.10:5000");
+  IPAddress destination("10.0.0.1:6000");
+  BYTE buffer[1200] {};
+  size_t bytesSent = sizeof(buffer);
+  bool wouldBlock = false;
+
+  size_t total = ORTC_SERVICE_TEST_WIRE_LOGGING_BENCHMARK_PACKETS;
+  size_t sent = 0;
+
+  // restored afterwards so the ICE tests keep the level the test logger configured
+  zsLib::Log::Level previousLevel = ZS_GET_SUBSYSTEM_LOG_LEVEL(ZS_GET_OTHER_SUBSYSTEM(::ortc::services::wire, ortc_services_wire));
+
+  ILogger::setLogLevel("ortc_services_wire", zsLib::Log::None);
+  TESTING_CHECK(!ORTC_SERVICES_WIRE_IS_LOGGING(Trace))
+  TESTING_CHECK(!ORTC_SERVICES_WIRE_IS_LOGGING(Insane))
+
+  zsLib::Time start = zsLib::now();
+  for (size_t count = 0; count < total; ++count) {
+    sent += bytesSent;
+  }
+  zsLib::Microseconds bare = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  start = zsLib::now();
+  for (size_t count = 0; count < total; ++count) {
+    ORTC_SERVICES_WIRE_LOG_TRACE(wireLog("packet received") + ZS_PARAM("ip", destination.string()) + ZS_PARAM("handle", count))
+    if (ORTC_SERVICES_WIRE_IS_LOGGING(Insane)) {
+      String base64 = IHelper::convertToBase64(buffer, bytesSent);
+      ORTC_SERVICES_WIRE_LOG_INSANE(wireLog("RECEIVE PACKET ON WIRE") + ZS_PARAM("source", destination.string()) + ZS_PARAM("wire in", base64))
+    }
+
+    sent += bytesSent;
+
+    ORTC_SERVICES_WIRE_LOG_TRACE(wireLog("sending packet") + ZS_PARAM("candidate", candidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer length", sizeof(buffer)) + ZS_PARAM("bytes sent", bytesSent) + ZS_PARAM("would block", wouldBlock))
+    if (ORTC_SERVICES_WIRE_IS_LOGGING(Insane)) {
+      String base64 = IHelper::convertToBase64(buffer, bytesSent);
+      ORTC_SERVICES_WIRE_LOG_INSANE(wireLog("SEND PACKET ON WIRE") + ZS_PARAM("destination", destination.string()) + ZS_PARAM("wire out", base64))
+    }
+  }
+  zsLib::Microseconds disabled = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  // a single statement with its arguments built, as when wire logging is on
+  start = zsLib::now();
+  for (size_t count = 0; count < total; ++count) {
+    zsLib::Log::Params params = wireLog("sending packet") + ZS_PARAM("candidate", candidate.toDebug()) + ZS_PARAM("to ip", destination.string()) + ZS_PARAM("buffer length", sizeof(buffer)) + ZS_PARAM("bytes sent", bytesSent) + ZS_PARAM("would block", wouldBlock);
+    sent += bytesSent;
+  }
+  zsLib::Microseconds built = std::chrono::duration_cast<zsLib::Microseconds>(zsLib::now() - start);
+
+  ILogger::setLogLevel("ortc_services_wire", previousLevel);
+
+  TESTING_EQUAL(sent, total * bytesSent * 3)
+
+  TESTING_STDOUT() << "              wire logging: packets=" << total << " bare(us)=" << bare.count() << " disabled(us)=" << disabled.count() << " arguments built(us)=" << built.count() << "\n";
+}
+
 void doTestICESocket()
 {
   if (!ORTC_SERVICE_TEST_DO_ICE_SOCKET_TEST) return;
 
   TESTING_INSTALL_LOGGER();
 
+  benchmarkWireLogging();
+
   TESTING_SLEEP(1000)
 
   zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
@@ -0,0 +1,403 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+
+#include <zsLib/IMessageQueueThread.h>
+#include <zsLib/Exception.h>
+#include <zsLib/String.h>
+#include <zsLib/Stringize.h>
+#include <zsLib/Log.h>
+
+#include <ortc/services/IICESocket.h>
+#include <ortc/services/IICESocketSession.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <list>
+#include <set>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif //__APPLE__
+
+#ifdef __linux__
+#include <unistd.h>
+#include <fstream>
+#endif //__linux__
+
+namespace ortc { namespace services { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_services_test) } } }
+
+using zsLib::BYTE;
+using zsLib::ULONG;
+using zsLib::PUID;
+using zsLib::String;
+using zsLib::IPAddress;
+using zsLib::IMessageQueue;
+using zsLib::RecursiveLock;
+using zsLib::AutoRecursiveLock;
+using namespace ortc::services;
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace test
+    {
+      ZS_DECLARE_CLASS_PTR(TestICELiteCallback);
+
+      //-----------------------------------------------------------------------
+      // RETURNS: the resident memory of the process or 0 if the platform
+      //          offers no inexpensive way to obtain it
+      static size_t getResidentMemoryInBytes()
+      {
+#ifdef __APPLE__
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (KERN_SUCCESS != task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count)) return 0;
+        return static_cast<size_t>(info.resident_size);
+#elif defined(__linux__)
+        std::ifstream statm("/proc/self/statm");
+        size_t totalPages = 0;
+        size_t residentPages = 0;
+        if (!(statm >> totalPages >> residentPages)) return 0;
+        return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0;
+#endif //__APPLE__
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestICELiteCallback
+      #pragma mark
+
+      // A single callback shared by every socket and session so the density
+      // measurement only counts what the sessions themselves allocate.
+      class TestICELiteCallback : public zsLib::MessageQueueAssociator,
+                                  public IICESocketDelegate,
+                                  public IICESocketSessionDelegate
+      {
+      private:
+        //---------------------------------------------------------------------
+        TestICELiteCallback(zsLib::IMessageQueuePtr queue) :
+          zsLib::MessageQueueAssociator(queue)
+        {
+        }
+
+      public:
+        typedef std::set<PUID> SessionIDSet;
+
+        //---------------------------------------------------------------------
+        static TestICELiteCallbackPtr create(zsLib::IMessageQueuePtr queue)
+        {
+          return TestICELiteCallbackPtr(new TestICELiteCallback(queue));
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketStateChanged(
+                                             IICESocketPtr socket,
+                                             ICESocketStates state
+                                             )
+        {
+          AutoRecursiveLock lock(mLock);
+          switch (state) {
+            case IICESocket::ICESocketState_Ready:    mReadySockets.insert(socket->getID()); break;
+            case IICESocket::ICESocketState_Shutdown: mShutdownSockets.insert(socket->getID()); break;
+            default:                                  break;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketCandidatesChanged(IICESocketPtr socket)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionStateChanged(
+                                                    IICESocketSessionPtr session,
+                                                    ICESocketSessionStates state
+                                                    )
+        {
+          AutoRecursiveLock lock(mLock);
+          switch (state) {
+            case IICESocketSession::ICESocketSessionState_Nominated:
+            case IICESocketSession::ICESocketSessionState_Completed:  mCompletedSessions.insert(session->getID()); break;
+            case IICESocketSession::ICESocketSessionState_Shutdown:   mShutdownSessions.insert(session->getID()); break;
+            default:                                                  break;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionNominationChanged(IICESocketSessionPtr session)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual void handleICESocketSessionReceivedPacket(
+                                                          IICESocketSessionPtr session,
+                                                          const BYTE *buffer,
+                                                          size_t bufferLengthInBytes
+                                                          )
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual bool handleICESocketSessionReceivedSTUNPacket(
+                                                              IICESocketSessionPtr session,
+                                                              STUNPacketPtr stun,
+                                                              const String &localUsernameFrag,
+                                                              const String &remoteUsernameFrag
+                                                              )
+        {
+          return false;
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionWriteReady(IICESocketSessionPtr session)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        bool isReady(IICESocketPtr socket) const {AutoRecursiveLock lock(mLock); return mReadySockets.end() != mReadySockets.find(socket->getID());}
+        bool isShutdown(IICESocketPtr socket) const {AutoRecursiveLock lock(mLock); return mShutdownSockets.end() != mShutdownSockets.find(socket->getID());}
+        bool isCompleted(IICESocketSessionPtr session) const {AutoRecursiveLock lock(mLock); return mCompletedSessions.end() != mCompletedSessions.find(session->getID());}
+        size_t getTotalShutdownSessions() const {AutoRecursiveLock lock(mLock); return mShutdownSessions.size();}
+
+      private:
+        mutable RecursiveLock mLock;
+
+        SessionIDSet mReadySockets;
+        SessionIDSet mShutdownSockets;
+        SessionIDSet mCompletedSessions;
+        SessionIDSet mShutdownSessions;
+      };
+    }
+  }
+}
+
+using ortc::services::test::TestICELiteCallback;
+using ortc::services::test::TestICELiteCallbackPtr;
+
+namespace
+{
+  typedef std::list<IICESocketSessionPtr> SessionList;
+
+  //---------------------------------------------------------------------------
+  static IICESocketPtr createHostOnlySocket(
+                                            zsLib::IMessageQueuePtr queue,
+                                            TestICELiteCallbackPtr callback
+                                            )
+  {
+    IICESocket::TURNServerInfoList turnServers;
+    IICESocket::STUNServerInfoList stunServers;
+
+    IICESocketPtr socket = IICESocket::create(queue, callback, turnServers, stunServers);
+
+    ULONG totalWait = 0;
+    while (!callback->isReady(socket)) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_ICE_LITE_MAX_SECONDS * 10)) break;
+    }
+    TESTING_CHECK(callback->isReady(socket))
+    return socket;
+  }
+
+  //---------------------------------------------------------------------------
+  static void closeSessions(
+                            TestICELiteCallbackPtr callback,
+                            SessionList &sessions
+                            )
+  {
+    size_t expecting = callback->getTotalShutdownSessions() + sessions.size();
+
+    for (SessionList::iterator iter = sessions.begin(); iter != sessions.end(); ++iter) {
+      (*iter)->close();
+    }
+    sessions.clear();
+
+    ULONG totalWait = 0;
+    while (callback->getTotalShutdownSessions() < expecting) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_ICE_LITE_MAX_SECONDS * 10)) break;
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  static void runDensityBenchmark(
+                                  TestICELiteCallbackPtr callback,
+                                  IICESocketPtr socket,
+                                  bool lite,
+                                  size_t totalSessions
+                                  )
+  {
+    // remote candidates for full sessions point at an unroutable test
+    // network address (RFC 5737) so their checks never complete
+    IICESocket::CandidateList remoteCandidates;
+    {
+      IICESocket::Candidate candidate;
+      candidate.mType = IICESocket::Type_Local;
+      candidate.mIPAddress = IPAddress("192.0.2.1:9");
+      candidate.mFoundation = "density";
+      candidate.mPriority = ((1 << 24)*(candidate.mType)) + ((1 << 8)*(candidate.mLocalPreference)) + (256 - 1);
+      remoteCandidates.push_back(candidate);
+    }
+
+    SessionList sessions;
+
+    size_t before = ortc::services::test::getResidentMemoryInBytes();
+
+    for (size_t index = 0; index < totalSessions; ++index) {
+      String remoteUsernameFrag = String("density-") + zsLib::string(static_cast<ULONG>(index));
+      String remotePassword = String("density-password-") + zsLib::string(static_cast<ULONG>(index));
+
+      if (lite) {
+        sessions.push_back(IICESocketSession::createLite(callback, socket, remoteUsernameFrag, remotePassword));
+      } else {
+        sessions.push_back(IICESocketSession::create(callback, socket, remoteUsernameFrag, remotePassword, remoteCandidates, IICESocket::ICEControl_Controlled));
+      }
+    }
+
+    // allow full sessions to start their checks and timers
+    TESTING_SLEEP(1000)
+
+    size_t after = ortc::services::test::getResidentMemoryInBytes();
+
+    TESTING_STDOUT() << "BENCHMARK:    " << (lite ? "ICE-lite" : "full ICE") << " session density\n";
+    if ((0 == before) || (after < before)) {
+      TESTING_STDOUT() << "              sessions=" << totalSessions << " bytes per session=unavailable\n";
+    } else {
+      TESTING_STDOUT() << "              sessions=" << totalSessions
+                       << " resident growth(bytes)=" << (after - before)
+                       << " bytes per session=" << ((after - before) / totalSessions) << "\n";
+    }
+
+    TESTING_EQUAL(sessions.size(), totalSessions)
+
+    closeSessions(callback, sessions);
+  }
+
+  //---------------------------------------------------------------------------
+  static void runLiteNomination(
+                                TestICELiteCallbackPtr callback,
+                                IICESocketPtr server,
+                                IICESocketPtr client
+                                )
+  {
+    IICESocket::CandidateList serverCandidates;
+    server->getLocalCandidates(serverCandidates);
+
+    IICESocketSessionPtr liteSession = IICESocketSession::createLite(callback, server, client->getUsernameFrag(), client->getPassword());
+    IICESocketSessionPtr fullSession = IICESocketSession::create(callback, client, server->getUsernameFrag(), server->getPassword(), serverCandidates, IICESocket::ICEControl_Controlling);
+    fullSession->setRemoteLite();
+    fullSession->endOfRemoteCandidates();
+
+    ULONG totalWait = 0;
+    while ((!callback->isCompleted(liteSession)) ||
+           (!callback->isCompleted(fullSession))) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_ICE_LITE_MAX_SECONDS * 10)) break;
+    }
+
+    TESTING_CHECK(callback->isCompleted(liteSession))
+    TESTING_CHECK(callback->isCompleted(fullSession))
+
+    IICESocket::Candidate local;
+    IICESocket::Candidate remote;
+    TESTING_CHECK(liteSession->getNominatedCandidateInformation(local, remote))
+    TESTING_EQUAL(IICESocket::ICEControl_Controlled, liteSession->getConnectedControlState())
+
+    SessionList sessions;
+    sessions.push_back(liteSession);
+    sessions.push_back(fullSession);
+    closeSessions(callback, sessions);
+  }
+}
+
+void doTestICESocketLite()
+{
+  if (!ORTC_SERVICE_TEST_DO_ICE_SOCKET_LITE_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
+
+  TestICELiteCallbackPtr callback = TestICELiteCallback::create(thread);
+
+  IICESocketPtr server = createHostOnlySocket(thread, callback);
+  IICESocketPtr client = createHostOnlySocket(thread, callback);
+
+  runLiteNomination(callback, server, client);
+
+  runDensityBenchmark(callback, server, true, ORTC_SERVICE_TEST_ICE_LITE_TOTAL_SESSIONS);
+  runDensityBenchmark(callback, server, false, ORTC_SERVICE_TEST_ICE_LITE_TOTAL_FULL_SESSIONS);
+
+  server->shutdown();
+  client->shutdown();
+
+  ULONG totalWait = 0;
+  while ((!callback->isShutdown(server)) ||
+         (!callback->isShutdown(client))) {
+    TESTING_SLEEP(100)
+    ++totalWait;
+    if (totalWait >= (ORTC_SERVICE_TEST_ICE_LITE_MAX_SECONDS * 10)) break;
+  }
+
+  server.reset();
+  client.reset();
+  callback.reset();
+
+  ZS_LOG_BASIC("WAITING:      All ICE-lite tests have finished. Waiting for 'bogus' events to process (10 second wait).");
+
+  TESTING_SLEEP(10000)
+
+  // wait for shutdown
+  {
+    IMessageQueue::size_type count = 0;
+    do
+    {
+      count = thread->getTotalUnprocessedMessages();
+      if (0 != count)
+        std::this_thread::yield();
+    } while (count > 0);
+
+    thread->waitForShutdown();
+  }
+  TESTING_UNINSTALL_LOGGER();
+  zsLib::proxyDump();
+  TESTING_EQUAL(zsLib::proxyGetTotalConstructed(), 0);
+}
@@ -0,0 +1,1018 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+
+#include <ortc/services/internal/services_MessageLayerSecurityChannel.h>
+#include <ortc/services/IDHKeyDomain.h>
+#include <ortc/services/IDHPrivateKey.h>
+#include <ortc/services/IDHPublicKey.h>
+#include <ortc/services/IEd25519PrivateKey.h>
+#include <ortc/services/IEd25519PublicKey.h>
+#include <ortc/services/IHelper.h>
+#include <ortc/services/IRSAPrivateKey.h>
+#include <ortc/services/IRSAPublicKey.h>
+#include <ortc/services/ITransportStream.h>
+
+#include <zsLib/eventing/IHasher.h>
+#include <zsLib/IMessageQueueThread.h>
+#include <zsLib/ISettings.h>
+#include <zsLib/Log.h>
+#include <zsLib/XML.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <list>
+#include <vector>
+
+namespace ortc { namespace services { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_services_test) } } }
+
+using zsLib::BYTE;
+using zsLib::DWORD;
+using zsLib::ULONG;
+using zsLib::String;
+using zsLib::Time;
+using zsLib::Milliseconds;
+using zsLib::AutoPUID;
+using zsLib::AutoRecursiveLock;
+using zsLib::ISettings;
+using namespace ortc::services;
+
+typedef ortc::services::internal::MessageLayerSecurityChannel MessageLayerSecurityChannel;
+typedef MessageLayerSecurityChannel::KeyContext KeyContext;
+typedef MessageLayerSecurityChannel::AlgorithmIndex AlgorithmIndex;
+typedef zsLib::eventing::IHasher IHasher;
+
+// golden wire buffers for keying index 2 with key = 0x00..0x1F,
+// iv = 0xA0..0xAF and the integrity passphrase below (generated
+// independently of this library and of the previous encoder)
+static const char *kGoldenIntegrityPassphrase = "mls-integrity-passphrase";
+
+static const char *kGoldenMessage1 = "hello world";
+static const char *kGoldenMessage3 = "third message";
+
+static const char *kGoldenWire1 =
+  "000000026a95a86c7dc13d0932109887ee329eb13ae3a911b4fa6d9119980b627d278c";
+static const char *kGoldenWire2 =
+  "00000002786a4b5635300101cb93ff77b64c962a2c17e04c118e4e4f08297a520016670e"
+  "0e3454f7bade6e6ad351d85313b11ead06e2c910ec49e0113e054d269b46287d7d72d8be"
+  "00b9e235ab14602352e9c86680302633bf16a2ac069e8126b72c528028e406d8aa035b1e"
+  "618bc0b16d9add6bdf825f4a76af3cf4";
+static const char *kGoldenWire3 =
+  "00000002feefcc8fb6ddeda2ea02f667c235767c7385955ae575eb52784a05149f4471ba7d";
+static const char *kGoldenNextIV = "bcede6afd3026e93f133d0f3c2b6a348b8a0ffdc";
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace test
+    {
+      //-----------------------------------------------------------------------
+      static SecureByteBlockPtr createSequence(
+                                               BYTE start,
+                                               size_t length,
+                                               BYTE step = 1
+                                               )
+      {
+        SecureByteBlockPtr result(std::make_shared<SecureByteBlock>(length));
+        for (size_t index = 0; index < length; ++index) {
+          result->BytePtr()[index] = static_cast<BYTE>(start + (index * step));
+        }
+        return result;
+      }
+
+      //-----------------------------------------------------------------------
+      // the per message encoding as it was done before the key context
+      // existed (kept here as the reference for the wire format)
+      struct LegacyEncoder
+      {
+        SecureByteBlockPtr mKey;
+        SecureByteBlockPtr mNextIV;
+        String mIntegrityPassphrase;
+
+        SecureByteBlockPtr encode(
+                                  AlgorithmIndex index,
+                                  const SecureByteBlock &buffer
+                                  )
+        {
+          SecureByteBlockPtr encrypted = IHelper::encrypt(*mKey, *mNextIV, buffer);
+
+          String hexIV = IHelper::convertToHex(*mNextIV);
+          String hashDecryptedBuffer = IHelper::convertToHex(*IHasher::hash(buffer));
+
+          SecureByteBlockPtr calculatedIntegrity = IHasher::hash(("integrity:" + hashDecryptedBuffer + ":" + hexIV).c_str(), IHasher::hmacSHA1(*(IHelper::convertToBuffer(mIntegrityPassphrase))));
+
+          mNextIV = IHasher::hash(hexIV + ":" + IHelper::convertToHex(*calculatedIntegrity));
+
+          SecureByteBlockPtr output(std::make_shared<SecureByteBlock>(sizeof(DWORD) + calculatedIntegrity->SizeInBytes() + encrypted->SizeInBytes()));
+
+          IHelper::setBE32(output->BytePtr(), static_cast<DWORD>(index));
+
+          BYTE *integrityPos = (output->BytePtr() + sizeof(DWORD));
+          BYTE *outputPos = (integrityPos + calculatedIntegrity->SizeInBytes());
+
+          memcpy(integrityPos, calculatedIntegrity->BytePtr(), calculatedIntegrity->SizeInBytes());
+          memcpy(outputPos, encrypted->BytePtr(), encrypted->SizeInBytes());
+          return output;
+        }
+      };
+
+      //-----------------------------------------------------------------------
+      static SecureByteBlockPtr decodeWire(
+                                           KeyContext &context,
+                                           const SecureByteBlock &wire
+                                           )
+      {
+        if (wire.SizeInBytes() <= KeyContext::headerSize()) return SecureByteBlockPtr();
+
+        const BYTE *integrity = wire.BytePtr() + sizeof(DWORD);
+        const BYTE *encrypted = integrity + KeyContext::IntegritySize;
+        return context.decode(integrity, encrypted, wire.SizeInBytes() - KeyContext::headerSize());
+      }
+
+      //-----------------------------------------------------------------------
+      static void testGolden()
+      {
+        SecureByteBlockPtr key = createSequence(0x00, 32);
+        SecureByteBlockPtr iv = createSequence(0xA0, 16);
+
+        SecureByteBlockPtr message1 = IHelper::convertToBuffer(kGoldenMessage1);
+        SecureByteBlockPtr message2 = createSequence(0x00, 100, 7);
+        SecureByteBlockPtr message3 = IHelper::convertToBuffer(kGoldenMessage3);
+
+        KeyContext encoder(*key, *iv, kGoldenIntegrityPassphrase);
+
+        TESTING_EQUAL(IHelper::convertToHex(*encoder.encode(2, message1->BytePtr(), message1->SizeInBytes())), String(kGoldenWire1))
+        TESTING_EQUAL(IHelper::convertToHex(*encoder.encode(2, message2->BytePtr(), message2->SizeInBytes())), String(kGoldenWire2))
+        TESTING_EQUAL(IHelper::convertToHex(*encoder.encode(2, message3->BytePtr(), message3->SizeInBytes())), String(kGoldenWire3))
+        TESTING_EQUAL(encoder.getNextIV(), String(kGoldenNextIV))
+
+        KeyContext decoder(*key, *iv, kGoldenIntegrityPassphrase);
+
+        SecureByteBlockPtr decoded1 = decodeWire(decoder, *IHelper::convertFromHex(kGoldenWire1));
+        SecureByteBlockPtr decoded2 = decodeWire(decoder, *IHelper::convertFromHex(kGoldenWire2));
+        SecureByteBlockPtr decoded3 = decodeWire(decoder, *IHelper::convertFromHex(kGoldenWire3));
+
+        TESTING_CHECK((bool)decoded1)
+        TESTING_CHECK((bool)decoded2)
+        TESTING_CHECK((bool)decoded3)
+
+        if ((!decoded1) || (!decoded2) || (!decoded3)) return;
+
+        TESTING_EQUAL(0, IHelper::compare(*decoded1, *message1))
+        TESTING_EQUAL(0, IHelper::compare(*decoded2, *message2))
+        TESTING_EQUAL(0, IHelper::compare(*decoded3, *message3))
+        TESTING_EQUAL(decoder.getNextIV(), String(kGoldenNextIV))
+      }
+
+      //-----------------------------------------------------------------------
+      static void testMatchesLegacy()
+      {
+        LegacyEncoder legacy;
+        legacy.mKey = IHelper::random(32);
+        legacy.mNextIV = IHelper::random(16);
+        legacy.mIntegrityPassphrase = IHelper::randomString(32);
+
+        KeyContext encoder(*legacy.mKey, *legacy.mNextIV, legacy.mIntegrityPassphrase);
+        KeyContext decoder(*legacy.mKey, *legacy.mNextIV, legacy.mIntegrityPassphrase);
+
+        for (ULONG loop = 0; loop < ORTC_SERVICE_TEST_MLS_TOTAL_GOLDEN_MESSAGES; ++loop) {
+          SecureByteBlockPtr message = IHelper::random(1 + IHelper::random(0, ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE));
+
+          SecureByteBlockPtr expected = legacy.encode(1, *message);
+          SecureByteBlockPtr actual = encoder.encode(1, message->BytePtr(), message->SizeInBytes());
+
+          TESTING_EQUAL(0, IHelper::compare(*expected, *actual))
+
+          SecureByteBlockPtr decoded = decodeWire(decoder, *actual);
+          TESTING_CHECK((bool)decoded)
+          if (!decoded) return;
+
+          TESTING_EQUAL(0, IHelper::compare(*decoded, *message))
+        }
+
+        TESTING_EQUAL(encoder.getNextIV(), IHelper::convertToHex(*legacy.mNextIV))
+      }
+
+      //-----------------------------------------------------------------------
+      static void testTampered()
+      {
+        SecureByteBlockPtr key = IHelper::random(32);
+        SecureByteBlockPtr iv = IHelper::random(16);
+
+        KeyContext encoder(*key, *iv, "tamper");
+        KeyContext decoder(*key, *iv, "tamper");
+
+        SecureByteBlockPtr message = IHelper::random(64);
+        SecureByteBlockPtr wire = encoder.encode(1, message->BytePtr(), message->SizeInBytes());
+
+        wire->BytePtr()[wire->SizeInBytes() - 1] ^= 0x01;
+
+        TESTING_CHECK(!decodeWire(decoder, *wire))
+      }
+
+      //-----------------------------------------------------------------------
+      static void testWrappedBase64Keying()
+      {
+        SecureByteBlockPtr secret = IHelper::random(64);
+        String strict = IHelper::convertToBase64(*secret);
+
+        // keying values may arrive wrapped across lines and padded with
+        // whitespace (as the previous decoder silently accepted)
+        String wrapped = "  ";
+        for (size_t pos = 0; pos < strict.length(); pos += 16) {
+          wrapped += strict.substr(pos, 16) + "\r\n";
+        }
+        wrapped += "\t ";
+
+        SecureByteBlockPtr strictDecoded = MessageLayerSecurityChannel::fromBase64(strict);
+        SecureByteBlockPtr wrappedDecoded = MessageLayerSecurityChannel::fromBase64(wrapped);
+
+        TESTING_CHECK(0 == IHelper::compare(*secret, *strictDecoded))
+        TESTING_CHECK(0 == IHelper::compare(*secret, *wrappedDecoded))
+      }
+
+      //-----------------------------------------------------------------------
+      static void runBenchmark()
+      {
+        SecureByteBlockPtr key = IHelper::random(32);
+        SecureByteBlockPtr iv = IHelper::random(16);
+        String passphrase = IHelper::randomString(32);
+
+        SecureByteBlockPtr message = IHelper::random(ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE);
+
+        const ULONG total = ORTC_SERVICE_TEST_MLS_BENCHMARK_MESSAGES;
+
+        Milliseconds legacyDuration;
+        Milliseconds contextDuration;
+
+        // scope: previous per message implementation
+        {
+          LegacyEncoder legacy;
+          legacy.mKey = key;
+          legacy.mNextIV = iv;
+          legacy.mIntegrityPassphrase = passphrase;
+
+          Time start = zsLib::now();
+          for (ULONG loop = 0; loop < total; ++loop) {
+            legacy.encode(1, *message);
+          }
+          legacyDuration = zsLib::toMilliseconds(zsLib::now() - start);
+        }
+
+        // scope: key context
+        {
+          KeyContext encoder(*key, *iv, passphrase);
+
+          Time start = zsLib::now();
+          for (ULONG loop = 0; loop < total; ++loop) {
+            encoder.encode(1, message->BytePtr(), message->SizeInBytes());
+          }
+          contextDuration = zsLib::toMilliseconds(zsLib::now() - start);
+        }
+
+        auto perSecond = [total](Milliseconds duration) -> ULONG {
+          if (Milliseconds() == duration) return 0;
+          return static_cast<ULONG>((static_cast<zsLib::QWORD>(total) * 1000) / duration.count());
+        };
+
+        TESTING_STDOUT() << "BENCHMARK:    message layer security encode (" << ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE << " byte messages)\n";
+        TESTING_STDOUT() << "              legacy: messages=" << total << " duration(ms)=" << legacyDuration.count() << " messages/sec=" << perSecond(legacyDuration) << "\n";
+        TESTING_STDOUT() << "              context: messages=" << total << " duration(ms)=" << contextDuration.count() << " messages/sec=" << perSecond(contextDuration) << "\n";
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestMLSPipelineLoopback
+      #pragma mark
+
+      ZS_DECLARE_CLASS_PTR(TestMLSPipelineLoopback)
+
+      // Two channels wired back to back ("a" sends, "b" receives) with the
+      // sender encoding on several pipelined key chains. Every message
+      // carries its sequence number so reordering on the wire is caught.
+      class TestMLSPipelineLoopback : public zsLib::MessageQueueAssociator,
+                                      public IMessageLayerSecurityChannelDelegate,
+                                      public ITransportStreamReaderDelegate,
+                                      public ITransportStreamWriterDelegate
+      {
+      protected:
+        typedef std::list<SecureByteBlockPtr> BufferList;
+
+      private:
+        //---------------------------------------------------------------------
+        TestMLSPipelineLoopback(zsLib::IMessageQueuePtr queue) :
+          zsLib::MessageQueueAssociator(queue)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          mSigningPrivateKey = IRSAPrivateKey::generate(mSigningPublicKey);
+
+          ITransportStreamPtr aToB = ITransportStream::create();
+          ITransportStreamPtr bToA = ITransportStream::create();
+
+          mASendDecoded = ITransportStream::create(mThisWeak.lock(), ITransportStreamReaderDelegatePtr())->getWriter();
+          mAReceiveDecoded = ITransportStream::create(ITransportStreamWriterDelegatePtr(), mThisWeak.lock())->getReader();
+          mBSendDecoded = ITransportStream::create(mThisWeak.lock(), ITransportStreamReaderDelegatePtr())->getWriter();
+          mBReceiveDecoded = ITransportStream::create(ITransportStreamWriterDelegatePtr(), mThisWeak.lock())->getReader();
+
+          mChannelA = IMessageLayerSecurityChannel::create(mThisWeak.lock(), bToA, mAReceiveDecoded->getStream(), mASendDecoded->getStream(), aToB, "a");
+          mChannelB = IMessageLayerSecurityChannel::create(mThisWeak.lock(), aToB, mBReceiveDecoded->getStream(), mBSendDecoded->getStream(), bToA, "b");
+
+          mAReceiveDecoded->notifyReaderReadyToRead();
+          mBReceiveDecoded->notifyReaderReadyToRead();
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static TestMLSPipelineLoopbackPtr create(zsLib::IMessageQueuePtr queue)
+        {
+          TestMLSPipelineLoopbackPtr pThis(new TestMLSPipelineLoopback(queue));
+          pThis->mThisWeak = pThis;
+          pThis->init();
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~TestMLSPipelineLoopback()
+        {
+          mThisWeak.reset();
+          shutdown();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSPipelineLoopback => IMessageLayerSecurityChannelDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onMessageLayerSecurityChannelStateChanged(
+                                                               IMessageLayerSecurityChannelPtr channel,
+                                                               SessionStates state
+                                                               )
+        {
+          AutoRecursiveLock lock(mLock);
+
+          switch (state) {
+            case IMessageLayerSecurityChannel::SessionState_WaitingForNeededInformation: break;
+            case IMessageLayerSecurityChannel::SessionState_Shutdown: {
+              WORD errorCode = 0;
+              String reason;
+              channel->getState(&errorCode, &reason);
+              if (0 != errorCode) {
+                ZS_LOG_ERROR(Basic, log("channel failed") + ZS_PARAM("channel", channel->getID()) + ZS_PARAM("error", errorCode) + ZS_PARAM("reason", reason))
+                mFailed = true;
+              }
+              return;
+            }
+            default: return;
+          }
+
+          if (channel->needsLocalContextID()) {
+            channel->setLocalContextID(channel == mChannelA ? "a" : "b");
+          }
+          if (channel->needsSendKeying()) {
+            channel->setSendKeying(ORTC_SERVICE_TEST_MLS_PIPELINE_PASSPHRASE);
+          }
+          if (channel->needsReceiveKeying()) {
+            channel->setReceiveKeying(ORTC_SERVICE_TEST_MLS_PIPELINE_PASSPHRASE);
+          }
+          if (channel->needsReceiveKeyingSigningPublicKey()) {
+            channel->setReceiveKeyingSigningPublicKey(mSigningPublicKey);
+          }
+          if (channel->needsSendKeyingToeBeSigned()) {
+            signSendKeying(channel);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSPipelineLoopback => ITransportStreamWriterDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamWriterReady(ITransportStreamWriterPtr writer)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (writer != mASendDecoded) return;
+          if (Time() != mStartTime) return;
+
+          mStartTime = zsLib::now();
+
+          for (ULONG sequence = 0; sequence < ORTC_SERVICE_TEST_MLS_PIPELINE_MESSAGES; ++sequence) {
+            SecureByteBlockPtr buffer = IHelper::random(sizeof(DWORD) + IHelper::random(0, ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE));
+            IHelper::setBE32(buffer->BytePtr(), static_cast<DWORD>(sequence));
+
+            mExpected.push_back(buffer);
+            mASendDecoded->write(std::make_shared<SecureByteBlock>(buffer->BytePtr(), buffer->SizeInBytes()));
+          }
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSPipelineLoopback => ITransportStreamReaderDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamReaderReady(ITransportStreamReaderPtr reader)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (reader != mBReceiveDecoded) return;
+
+          while (mBReceiveDecoded->getTotalReadBuffersAvailable() > 0) {
+            SecureByteBlockPtr buffer = mBReceiveDecoded->read();
+
+            TESTING_CHECK(buffer)
+            TESTING_CHECK(mExpected.size() > 0)
+            if ((!buffer) || (mExpected.size() < 1)) {
+              mFailed = true;
+              return;
+            }
+
+            SecureByteBlockPtr expecting = mExpected.front();
+            mExpected.pop_front();
+
+            if (0 != IHelper::compare(*buffer, *expecting)) {
+              ZS_LOG_ERROR(Basic, log("received message out of order or corrupted") + ZS_PARAM("expecting", IHelper::getBE32(expecting->BytePtr())) + ZS_PARAM("received size", buffer->SizeInBytes()))
+              mFailed = true;
+            }
+
+            ++mReceived;
+          }
+
+          if ((ORTC_SERVICE_TEST_MLS_PIPELINE_MESSAGES == mReceived) &&
+              (Time() == mCompleteTime)) {
+            mCompleteTime = zsLib::now();
+          }
+        }
+
+        //---------------------------------------------------------------------
+        bool isComplete() const
+        {
+          AutoRecursiveLock lock(mLock);
+          return (Time() != mCompleteTime) || (mFailed);
+        }
+
+        //---------------------------------------------------------------------
+        void expectationsOkay() const
+        {
+          AutoRecursiveLock lock(mLock);
+          TESTING_CHECK(!mFailed)
+          TESTING_EQUAL(mReceived, ORTC_SERVICE_TEST_MLS_PIPELINE_MESSAGES)
+          TESTING_CHECK(mExpected.size() < 1)
+
+          if (Time() == mCompleteTime) return;
+
+          Milliseconds duration = zsLib::toMilliseconds(mCompleteTime - mStartTime);
+          ULONG perSecond = (Milliseconds() == duration ? 0 : static_cast<ULONG>((static_cast<zsLib::QWORD>(mReceived) * 1000) / duration.count()));
+          TESTING_STDOUT() << "BENCHMARK:    message layer security pipelined loopback (" << ORTC_SERVICE_TEST_MLS_PIPELINE_CHAINS << " chains)\n";
+          TESTING_STDOUT() << "              messages=" << mReceived << " duration(ms)=" << duration.count() << " messages/sec=" << perSecond << "\n";
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mChannelA) {
+            mChannelA->cancel();
+            mChannelA.reset();
+          }
+          if (mChannelB) {
+            mChannelB->cancel();
+            mChannelB.reset();
+          }
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        void signSendKeying(IMessageLayerSecurityChannelPtr channel)
+        {
+          DocumentPtr doc;
+          ElementPtr elementToSign;
+          channel->getSendKeyingNeedingToBeSigned(doc, elementToSign);
+          TESTING_CHECK(elementToSign)
+          if (!elementToSign) return;
+
+          String id = IHelper::convertToHex(*IHelper::random(16));
+          elementToSign->setAttribute("id", id);
+
+          zsLib::XML::GeneratorPtr generator = zsLib::XML::Generator::createJSONGenerator();
+          std::unique_ptr<char[]> elementAsJSON = generator->write(IHelper::cloneAsCanonicalJSON(elementToSign));
+
+          SecureByteBlockPtr elementHash = IHasher::hash(elementAsJSON.get(), IHasher::sha1());
+
+          ElementPtr signatureEl = Element::create("signature");
+          signatureEl->adoptAsLastChild(createElementWithText("reference", "#" + id));
+          signatureEl->adoptAsLastChild(createElementWithText("algorithm", ORTC_SERVICES_JSON_SIGNATURE_ALGORITHM));
+          signatureEl->adoptAsLastChild(createElementWithText("digestValue", IHelper::convertToBase64(*elementHash)));
+          signatureEl->adoptAsLastChild(createElementWithText("digestSigned", IHelper::convertToBase64(*mSigningPrivateKey->sign(*elementHash))));
+
+          elementToSign->adoptAsNextSibling(signatureEl);
+
+          channel->notifySendKeyingSigned(mSigningPrivateKey, mSigningPublicKey);
+        }
+
+        //---------------------------------------------------------------------
+        static ElementPtr createElementWithText(
+                                                const String &elName,
+                                                const String &textVal
+                                                )
+        {
+          ElementPtr tmp = Element::create(elName);
+
+          TextPtr tmpTxt = Text::create();
+          tmpTxt->setValueAndJSONEncode(textVal);
+          tmp->adoptAsFirstChild(tmpTxt);
+          return tmp;
+        }
+
+        //---------------------------------------------------------------------
+        Log::Params log(const char *message) const
+        {
+          ElementPtr objectEl = Element::create("TestMLSPipelineLoopback");
+          IHelper::debugAppend(objectEl, "id", mID);
+          return Log::Params(message, objectEl);
+        }
+
+      private:
+        //---------------------------------------------------------------------
+        mutable zsLib::RecursiveLock mLock;
+        TestMLSPipelineLoopbackWeakPtr mThisWeak;
+
+        AutoPUID mID;
+
+        IRSAPrivateKeyPtr mSigningPrivateKey;
+        IRSAPublicKeyPtr mSigningPublicKey;
+
+        IMessageLayerSecurityChannelPtr mChannelA;
+        IMessageLayerSecurityChannelPtr mChannelB;
+
+        ITransportStreamWriterPtr mASendDecoded;
+        ITransportStreamReaderPtr mAReceiveDecoded;
+        ITransportStreamWriterPtr mBSendDecoded;
+        ITransportStreamReaderPtr mBReceiveDecoded;
+
+        BufferList mExpected;
+        ULONG mReceived {};
+        bool mFailed {};
+
+        Time mStartTime;
+        Time mCompleteTime;
+      };
+
+      //-----------------------------------------------------------------------
+      static void testPipelinedLoopback()
+      {
+        ISettings::setUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_CHAINS, ORTC_SERVICE_TEST_MLS_PIPELINE_CHAINS);
+
+        zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
+
+        TestMLSPipelineLoopbackPtr testObject = TestMLSPipelineLoopback::create(thread);
+
+        ZS_LOG_BASIC("WAITING:      Waiting for pipelined message layer security loopback to complete (max wait is 60 seconds).");
+
+        ULONG totalWait = 0;
+        while (!testObject->isComplete()) {
+          TESTING_SLEEP(1000)
+          ++totalWait;
+          if (totalWait >= 60) break;
+        }
+
+        testObject->expectationsOkay();
+        testObject->shutdown();
+        testObject.reset();
+
+        ISettings::setUInt(ORTC_SERVICES_SETTING_MESSAGE_LAYER_SECURITY_PIPELINE_CHAINS, 0);
+
+        thread->waitForShutdown();
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestMLSAgreementLoopback
+      #pragma mark
+
+      ZS_DECLARE_CLASS_PTR(TestMLSAgreementLoopback)
+
+      // Two channels wired back to back, each sending to the other, keyed
+      // by X25519 key agreement. "a" signs its keying by hand with Ed25519
+      // and hands the key pair over via notifySendKeyingSigned(); "b" has
+      // the Ed25519 pair up front so its keying is auto-signed. Each side
+      // verifies the other with setReceiveKeyingSigningPublicKey().
+      class TestMLSAgreementLoopback : public zsLib::MessageQueueAssociator,
+                                       public IMessageLayerSecurityChannelDelegate,
+                                       public ITransportStreamReaderDelegate,
+                                       public ITransportStreamWriterDelegate
+      {
+      protected:
+        typedef std::list<SecureByteBlockPtr> BufferList;
+
+      private:
+        //---------------------------------------------------------------------
+        TestMLSAgreementLoopback(zsLib::IMessageQueuePtr queue) :
+          zsLib::MessageQueueAssociator(queue)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          mSigningPrivateKeyA = IEd25519PrivateKey::generate(mSigningPublicKeyA);
+          mSigningPrivateKeyB = IEd25519PrivateKey::generate(mSigningPublicKeyB);
+
+          IDHKeyDomainPtr keyDomain = IDHKeyDomain::loadPrecompiled(IDHKeyDomain::KeyDomainPrecompiledType_X25519);
+          TESTING_CHECK(keyDomain)
+
+          mAgreementPrivateKeyA = IDHPrivateKey::generate(keyDomain, mAgreementPublicKeyA);
+          mAgreementPrivateKeyB = IDHPrivateKey::generate(keyDomain, mAgreementPublicKeyB);
+          TESTING_CHECK(mAgreementPrivateKeyA)
+          TESTING_CHECK(mAgreementPrivateKeyB)
+
+          ITransportStreamPtr aToB = ITransportStream::create();
+          ITransportStreamPtr bToA = ITransportStream::create();
+
+          mASendDecoded = ITransportStream::create(mThisWeak.lock(), ITransportStreamReaderDelegatePtr())->getWriter();
+          mAReceiveDecoded = ITransportStream::create(ITransportStreamWriterDelegatePtr(), mThisWeak.lock())->getReader();
+          mBSendDecoded = ITransportStream::create(mThisWeak.lock(), ITransportStreamReaderDelegatePtr())->getWriter();
+          mBReceiveDecoded = ITransportStream::create(ITransportStreamWriterDelegatePtr(), mThisWeak.lock())->getReader();
+
+          mChannelA = IMessageLayerSecurityChannel::create(mThisWeak.lock(), bToA, mAReceiveDecoded->getStream(), mASendDecoded->getStream(), aToB, "a");
+          mChannelB = IMessageLayerSecurityChannel::create(mThisWeak.lock(), aToB, mBReceiveDecoded->getStream(), mBSendDecoded->getStream(), bToA, "b");
+
+          mChannelB->notifySendKeyingSigned(mSigningPrivateKeyB, mSigningPublicKeyB);
+
+          mAReceiveDecoded->notifyReaderReadyToRead();
+          mBReceiveDecoded->notifyReaderReadyToRead();
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static TestMLSAgreementLoopbackPtr create(zsLib::IMessageQueuePtr queue)
+        {
+          TestMLSAgreementLoopbackPtr pThis(new TestMLSAgreementLoopback(queue));
+          pThis->mThisWeak = pThis;
+          pThis->init();
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~TestMLSAgreementLoopback()
+        {
+          mThisWeak.reset();
+          shutdown();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSAgreementLoopback => IMessageLayerSecurityChannelDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onMessageLayerSecurityChannelStateChanged(
+                                                               IMessageLayerSecurityChannelPtr channel,
+                                                               SessionStates state
+                                                               )
+        {
+          AutoRecursiveLock lock(mLock);
+
+          bool isA = (channel == mChannelA);
+
+          switch (state) {
+            case IMessageLayerSecurityChannel::SessionState_WaitingForNeededInformation: break;
+            case IMessageLayerSecurityChannel::SessionState_Connected: {
+              if (isA) mConnectedA = true;
+              else     mConnectedB = true;
+              return;
+            }
+            case IMessageLayerSecurityChannel::SessionState_Shutdown: {
+              WORD errorCode = 0;
+              String reason;
+              channel->getState(&errorCode, &reason);
+              if (0 != errorCode) {
+                ZS_LOG_ERROR(Basic, log("channel failed") + ZS_PARAM("channel", channel->getID()) + ZS_PARAM("error", errorCode) + ZS_PARAM("reason", reason))
+                mFailed = true;
+              }
+              return;
+            }
+            default: return;
+          }
+
+          if (channel->needsLocalContextID()) {
+            channel->setLocalContextID(isA ? "a" : "b");
+          }
+          if ((channel->needsSendKeying()) ||
+              (channel->needsReceiveKeying())) {
+            channel->setLocalKeyAgreement(isA ? mAgreementPrivateKeyA : mAgreementPrivateKeyB, isA ? mAgreementPublicKeyA : mAgreementPublicKeyB, false);
+            channel->setRemoteKeyAgreement(isA ? mAgreementPublicKeyB : mAgreementPublicKeyA);
+          }
+          if (channel->needsReceiveKeyingSigningPublicKey()) {
+            channel->setReceiveKeyingSigningPublicKey(isA ? mSigningPublicKeyB : mSigningPublicKeyA);
+          }
+          if (channel->needsSendKeyingToeBeSigned()) {
+            TESTING_CHECK(isA)
+            signSendKeying(channel);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSAgreementLoopback => ITransportStreamWriterDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamWriterReady(ITransportStreamWriterPtr writer)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          if (writer == mASendDecoded) {
+            if (mSentA) return;
+            mSentA = true;
+            sendMessages(mASendDecoded, mExpectedAtB);
+            return;
+          }
+          if (writer == mBSendDecoded) {
+            if (mSentB) return;
+            mSentB = true;
+            sendMessages(mBSendDecoded, mExpectedAtA);
+            return;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestMLSAgreementLoopback => ITransportStreamReaderDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamReaderReady(ITransportStreamReaderPtr reader)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          if (reader == mAReceiveDecoded) {
+            receiveMessages(mAReceiveDecoded, mExpectedAtA, mReceivedAtA);
+            return;
+          }
+          if (reader == mBReceiveDecoded) {
+            receiveMessages(mBReceiveDecoded, mExpectedAtB, mReceivedAtB);
+            return;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        bool isComplete() const
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mFailed) return true;
+          return (ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES == mReceivedAtA) &&
+                 (ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES == mReceivedAtB);
+        }
+
+        //---------------------------------------------------------------------
+        void expectationsOkay() const
+        {
+          AutoRecursiveLock lock(mLock);
+          TESTING_CHECK(!mFailed)
+          TESTING_CHECK(mConnectedA)
+          TESTING_CHECK(mConnectedB)
+          TESTING_EQUAL(mReceivedAtA, ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES)
+          TESTING_EQUAL(mReceivedAtB, ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES)
+          TESTING_CHECK(mExpectedAtA.size() < 1)
+          TESTING_CHECK(mExpectedAtB.size() < 1)
+
+          IDHKeyDomainPtr keyDomainA = (mChannelA ? mChannelA->getKeyAgreementDomain() : IDHKeyDomainPtr());
+          IDHKeyDomainPtr keyDomainB = (mChannelB ? mChannelB->getKeyAgreementDomain() : IDHKeyDomainPtr());
+          TESTING_CHECK(keyDomainA)
+          TESTING_CHECK(keyDomainB)
+          if ((!keyDomainA) || (!keyDomainB)) return;
+
+          TESTING_EQUAL(String(IDHKeyDomain::toNamespace(keyDomainA->getPrecompiledType())), String("https://meta.ortclib.org/dh/curve/x25519"))
+          TESTING_EQUAL(String(IDHKeyDomain::toNamespace(keyDomainB->getPrecompiledType())), String("https://meta.ortclib.org/dh/curve/x25519"))
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mChannelA) {
+            mChannelA->cancel();
+            mChannelA.reset();
+          }
+          if (mChannelB) {
+            mChannelB->cancel();
+            mChannelB.reset();
+          }
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        void sendMessages(
+                          ITransportStreamWriterPtr writer,
+                          BufferList &outExpected
+                          )
+        {
+          for (ULONG sequence = 0; sequence < ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES; ++sequence) {
+            SecureByteBlockPtr buffer = IHelper::random(sizeof(DWORD) + IHelper::random(0, ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE));
+            IHelper::setBE32(buffer->BytePtr(), static_cast<DWORD>(sequence));
+
+            outExpected.push_back(buffer);
+            writer->write(std::make_shared<SecureByteBlock>(buffer->BytePtr(), buffer->SizeInBytes()));
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void receiveMessages(
+                             ITransportStreamReaderPtr reader,
+                             BufferList &ioExpected,
+                             ULONG &ioReceived
+                             )
+        {
+          while (reader->getTotalReadBuffersAvailable() > 0) {
+            SecureByteBlockPtr buffer = reader->read();
+
+            TESTING_CHECK(buffer)
+            TESTING_CHECK(ioExpected.size() > 0)
+            if ((!buffer) || (ioExpected.size() < 1)) {
+              mFailed = true;
+              return;
+            }
+
+            SecureByteBlockPtr expecting = ioExpected.front();
+            ioExpected.pop_front();
+
+            if (0 != IHelper::compare(*buffer, *expecting)) {
+              ZS_LOG_ERROR(Basic, log("received message out of order or corrupted") + ZS_PARAM("expecting", IHelper::getBE32(expecting->BytePtr())) + ZS_PARAM("received size", buffer->SizeInBytes()))
+              mFailed = true;
+            }
+
+            ++ioReceived;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void signSendKeying(IMessageLayerSecurityChannelPtr channel)
+        {
+          DocumentPtr doc;
+          ElementPtr elementToSign;
+          channel->getSendKeyingNeedingToBeSigned(doc, elementToSign);
+          TESTING_CHECK(elementToSign)
+          if (!elementToSign) return;
+
+          String id = IHelper::convertToHex(*IHelper::random(16));
+          elementToSign->setAttribute("id", id);
+
+          SecureByteBlockPtr elementHash = IHelper::hashCanonicalJSON(elementToSign);
+
+          ElementPtr signatureEl = Element::create("signature");
+          signatureEl->adoptAsLastChild(createElementWithText("reference", "#" + id));
+          signatureEl->adoptAsLastChild(createElementWithText("algorithm", ORTC_SERVICES_JSON_SIGNATURE_ALGORITHM_ED25519));
+          signatureEl->adoptAsLastChild(createElementWithText("digestValue", IHelper::convertToBase64(*elementHash)));
+          signatureEl->adoptAsLastChild(createElementWithText("digestSigned", IHelper::convertToBase64(*mSigningPrivateKeyA->sign(*elementHash))));
+
+          elementToSign->adoptAsNextSibling(signatureEl);
+
+          channel->notifySendKeyingSigned(mSigningPrivateKeyA, mSigningPublicKeyA);
+        }
+
+        //---------------------------------------------------------------------
+        static ElementPtr createElementWithText(
+                                                const String &elName,
+                                                const String &textVal
+                                                )
+        {
+          ElementPtr tmp = Element::create(elName);
+
+          TextPtr tmpTxt = Text::create();
+          tmpTxt->setValueAndJSONEncode(textVal);
+          tmp->adoptAsFirstChild(tmpTxt);
+          return tmp;
+        }
+
+        //---------------------------------------------------------------------
+        Log::Params log(const char *message) const
+        {
+          ElementPtr objectEl = Element::create("TestMLSAgreementLoopback");
+          IHelper::debugAppend(objectEl, "id", mID);
+          return Log::Params(message, objectEl);
+        }
+
+      private:
+        //---------------------------------------------------------------------
+        mutable zsLib::RecursiveLock mLock;
+        TestMLSAgreementLoopbackWeakPtr mThisWeak;
+
+        AutoPUID mID;
+
+        IEd25519PrivateKeyPtr mSigningPrivateKeyA;
+        IEd25519PublicKeyPtr mSigningPublicKeyA;
+        IEd25519PrivateKeyPtr mSigningPrivateKeyB;
+        IEd25519PublicKeyPtr mSigningPublicKeyB;
+
+        IDHPrivateKeyPtr mAgreementPrivateKeyA;
+        IDHPublicKeyPtr mAgreementPublicKeyA;
+        IDHPrivateKeyPtr mAgreementPrivateKeyB;
+        IDHPublicKeyPtr mAgreementPublicKeyB;
+
+        IMessageLayerSecurityChannelPtr mChannelA;
+        IMessageLayerSecurityChannelPtr mChannelB;
+
+        ITransportStreamWriterPtr mASendDecoded;
+        ITransportStreamReaderPtr mAReceiveDecoded;
+        ITransportStreamWriterPtr mBSendDecoded;
+        ITransportStreamReaderPtr mBReceiveDecoded;
+
+        BufferList mExpectedAtA;
+        BufferList mExpectedAtB;
+        ULONG mReceivedAtA {};
+        ULONG mReceivedAtB {};
+
+        bool mSentA {};
+        bool mSentB {};
+        bool mConnectedA {};
+        bool mConnectedB {};
+        bool mFailed {};
+      };
+
+      //-----------------------------------------------------------------------
+      static void testAgreementLoopback()
+      {
+        zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
+
+        TestMLSAgreementLoopbackPtr testObject = TestMLSAgreementLoopback::create(thread);
+
+        ZS_LOG_BASIC("WAITING:      Waiting for ed25519 signed x25519 message layer security loopback to complete (max wait is 60 seconds).");
+
+        ULONG totalWait = 0;
+        while (!testObject->isComplete()) {
+          TESTING_SLEEP(1000)
+          ++totalWait;
+          if (totalWait >= 60) break;
+        }
+
+        testObject->expectationsOkay();
+        testObject->shutdown();
+        testObject.reset();
+
+        thread->waitForShutdown();
+      }
+    }
+  }
+}
+
+void doTestMessageLayerSecurityChannel()
+{
+  if (!ORTC_SERVICE_TEST_DO_MESSAGE_LAYER_SECURITY_CHANNEL_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  ortc::services::test::testGolden();
+  ortc::services::test::testMatchesLegacy();
+  ortc::services::test::testTampered();
+  ortc::services::test::testWrappedBase64Keying();
+  ortc::services::test::runBenchmark();
+  ortc::services::test::testPipelinedLoopback();
+  ortc::services::test::testAgreementLoopback();
+
+  TESTING_STDOUT() << "COMPLETED MESSAGE LAYER SECURITY CHANNEL TESTS...\n";
+}
@@ -0,0 +1,290 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+#include <ortc/services/internal/services_RSAPublicKey.h>
+#include <ortc/services/IEd25519PrivateKey.h>
+#include <ortc/services/IEd25519PublicKey.h>
+#include <ortc/services/IHelper.h>
+#include <ortc/services/IRSABatch.h>
+#include <ortc/services/IRSAPrivateKey.h>
+#include <ortc/services/IRSAPublicKey.h>
+
+#include <zsLib/ISettings.h>
+#include <zsLib/Log.h>
+
+#include "config.h"
+#include "testing.h"
+
+using zsLib::ISettings;
+using ortc::services::IEd25519PrivateKey;
+using ortc::services::IEd25519PrivateKeyPtr;
+using ortc::services::IEd25519PublicKey;
+using ortc::services::IEd25519PublicKeyPtr;
+using ortc::services::IHelper;
+using ortc::services::IRSABatch;
+using ortc::services::IRSABatchPtr;
+using ortc::services::IRSAPrivateKey;
+using ortc::services::IRSAPrivateKeyPtr;
+using ortc::services::IRSAPublicKey;
+using ortc::services::IRSAPublicKeyPtr;
+using ortc::services::SecureByteBlock;
+using ortc::services::SecureByteBlockPtr;
+using zsLib::Microseconds;
+using zsLib::Time;
+
+typedef ortc::services::internal::RSAPublicKeyVerifyCache RSAPublicKeyVerifyCache;
+typedef ortc::services::internal::RSAPublicKeyVerifyCachePtr RSAPublicKeyVerifyCachePtr;
+
+//-----------------------------------------------------------------------------
+static void testVerifyCache()
+{
+  RSAPublicKeyVerifyCachePtr cache = RSAPublicKeyVerifyCache::singleton();
+  TESTING_CHECK(cache)
+  if (!cache) return;
+
+  IRSAPublicKeyPtr publicKey;
+  IRSAPrivateKeyPtr privateKey = IRSAPrivateKey::generate(publicKey);
+
+  TESTING_CHECK(privateKey)
+  TESTING_CHECK(publicKey)
+  if ((!privateKey) || (!publicKey)) return;
+
+  SecureByteBlockPtr message = IHelper::random(64);
+  SecureByteBlockPtr signature = privateKey->sign(*message);
+
+  SecureByteBlockPtr badSignature(std::make_shared<SecureByteBlock>(signature->BytePtr(), signature->SizeInBytes()));
+  badSignature->BytePtr()[0] ^= 0x01;
+
+  cache->clear();
+
+  // first checks miss, repeated checks hit with the same verdict
+  TESTING_CHECK(publicKey->verify(*message, *signature))
+  TESTING_EQUAL(cache->getMisses(), 1)
+  TESTING_EQUAL(cache->getHits(), 0)
+
+  TESTING_CHECK(publicKey->verify(*message, *signature))
+  TESTING_EQUAL(cache->getHits(), 1)
+
+  TESTING_CHECK(!publicKey->verify(*message, *badSignature))
+  TESTING_CHECK(!publicKey->verify(*message, *badSignature))
+  TESTING_EQUAL(cache->getMisses(), 2)
+  TESTING_EQUAL(cache->getHits(), 2)
+
+  // a different message with the same signature is a different entry
+  SecureByteBlockPtr otherMessage = IHelper::random(64);
+  TESTING_CHECK(!publicKey->verify(*otherMessage, *signature))
+  TESTING_EQUAL(cache->getMisses(), 3)
+
+  // opting out neither consults nor records the cache
+  TESTING_CHECK(publicKey->verify(*message, *signature, false))
+  TESTING_CHECK(!publicKey->verify(*message, *badSignature, false))
+  TESTING_EQUAL(cache->getHits(), 2)
+  TESTING_EQUAL(cache->getMisses(), 3)
+  TESTING_EQUAL(cache->getSize(), 3)
+
+  // the cache stays within its configured bound
+  ISettings::setUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE, 2);
+  for (int loop = 0; loop < 5; ++loop) {
+    publicKey->verify(*IHelper::random(64), *signature);
+  }
+  TESTING_EQUAL(cache->getSize(), 2)
+
+  // a disabled cache is bypassed without counting misses
+  ISettings::setUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE, 0);
+  cache->clear();
+  TESTING_CHECK(publicKey->verify(*message, *signature))
+  TESTING_CHECK(!publicKey->verify(*message, *badSignature))
+  TESTING_EQUAL(cache->getHits(), 0)
+  TESTING_EQUAL(cache->getMisses(), 0)
+  TESTING_EQUAL(cache->getSize(), 0)
+
+  ISettings::setUInt(ORTC_SERVICES_SETTING_RSA_PUBLIC_KEY_VERIFY_CACHE_SIZE, 1024);
+  cache->clear();
+}
+
+//-----------------------------------------------------------------------------
+static void testBatch()
+{
+  typedef IRSABatch::OperationIndex OperationIndex;
+
+  IRSAPublicKeyPtr publicKey;
+  IRSAPrivateKeyPtr privateKey = IRSAPrivateKey::generate(publicKey);
+
+  TESTING_CHECK(privateKey)
+  TESTING_CHECK(publicKey)
+  if ((!privateKey) || (!publicKey)) return;
+
+  enum Sizes
+  {
+    Size_Values = 6,
+  };
+
+  SecureByteBlockPtr values[Size_Values];
+  SecureByteBlockPtr encrypted[Size_Values];
+  for (int index = 0; index < Size_Values; ++index) {
+    values[index] = IHelper::random(32);
+    encrypted[index] = publicKey->encrypt(*values[index]);
+  }
+
+  SecureByteBlockPtr message = IHelper::random(64);
+  SecureByteBlockPtr signature = privateKey->sign(*message);
+
+  IRSABatchPtr batch = IRSABatch::create();
+  TESTING_CHECK(batch)
+  if (!batch) return;
+
+  OperationIndex decrypts[Size_Values];
+  for (int index = 0; index < Size_Values; ++index) {
+    decrypts[index] = batch->decrypt(privateKey, *encrypted[index]);
+  }
+  OperationIndex encryptIndex = batch->encrypt(publicKey, *values[0]);
+  OperationIndex signIndex = batch->sign(privateKey, *message);
+  OperationIndex verifyIndex = batch->verify(publicKey, *message, *signature);
+
+  TESTING_EQUAL(batch->getTotalOperations(), Size_Values + 3)
+  TESTING_CHECK(!batch->isComplete())
+
+  batch->wait();
+
+  TESTING_CHECK(batch->isComplete())
+
+  for (int index = 0; index < Size_Values; ++index) {
+    SecureByteBlockPtr result = batch->getResult(decrypts[index]);
+    TESTING_CHECK(result)
+    if (!result) continue;
+    TESTING_CHECK(0 == IHelper::compare(*result, *values[index]))
+  }
+
+  SecureByteBlockPtr reencrypted = batch->getResult(encryptIndex);
+  TESTING_CHECK(reencrypted)
+  if (reencrypted) {
+    SecureByteBlockPtr decrypted = privateKey->decrypt(*reencrypted);
+    TESTING_CHECK(0 == IHelper::compare(*decrypted, *values[0]))
+  }
+
+  SecureByteBlockPtr batchSignature = batch->getResult(signIndex);
+  TESTING_CHECK(batchSignature)
+  if (batchSignature) {
+    TESTING_CHECK(publicKey->verify(*message, *batchSignature, false))
+  }
+
+  TESTING_CHECK(batch->getVerified(verifyIndex))
+
+  // an empty batch completes immediately
+  IRSABatchPtr emptyBatch = IRSABatch::create();
+  emptyBatch->wait();
+  TESTING_CHECK(emptyBatch->isComplete())
+}
+
+//-----------------------------------------------------------------------------
+static void testEd25519()
+{
+  IEd25519PublicKeyPtr publicKey;
+  IEd25519PrivateKeyPtr privateKey = IEd25519PrivateKey::generate(publicKey);
+
+  TESTING_CHECK(privateKey)
+  TESTING_CHECK(publicKey)
+  if ((!privateKey) || (!publicKey)) return;
+
+  SecureByteBlockPtr message = IHelper::random(64);
+  SecureByteBlockPtr signature = privateKey->sign(*message);
+
+  TESTING_CHECK(signature)
+  if (!signature) return;
+
+  TESTING_EQUAL(signature->SizeInBytes(), 64)
+  TESTING_CHECK(publicKey->verify(*message, *signature))
+
+  SecureByteBlockPtr badSignature(std::make_shared<SecureByteBlock>(signature->BytePtr(), signature->SizeInBytes()));
+  badSignature->BytePtr()[0] ^= 0x01;
+  TESTING_CHECK(!publicKey->verify(*message, *badSignature))
+
+  // keys survive a save / load round trip and sign identically
+  IEd25519PrivateKeyPtr loadedPrivateKey = IEd25519PrivateKey::load(*privateKey->save());
+  IEd25519PublicKeyPtr loadedPublicKey = IEd25519PublicKey::load(*publicKey->save());
+
+  TESTING_CHECK(loadedPrivateKey)
+  TESTING_CHECK(loadedPublicKey)
+  if ((!loadedPrivateKey) || (!loadedPublicKey)) return;
+
+  TESTING_CHECK(publicKey->getFingerprint() == loadedPublicKey->getFingerprint())
+  TESTING_CHECK(0 == IHelper::compare(*signature, *loadedPrivateKey->sign(*message)))
+  TESTING_CHECK(loadedPublicKey->verify(*message, *signature))
+
+  TESTING_CHECK(!IEd25519PublicKey::load(*IHelper::random(16)))
+}
+
+//-----------------------------------------------------------------------------
+static void benchmarkSigning()
+{
+  IRSAPublicKeyPtr rsaPublicKey;
+  IRSAPrivateKeyPtr rsaPrivateKey = IRSAPrivateKey::generate(rsaPublicKey);
+
+  IEd25519PublicKeyPtr edPublicKey;
+  IEd25519PrivateKeyPtr edPrivateKey = IEd25519PrivateKey::generate(edPublicKey);
+
+  TESTING_CHECK(rsaPrivateKey)
+  TESTING_CHECK(edPrivateKey)
+  if ((!rsaPrivateKey) || (!edPrivateKey)) return;
+
+  SecureByteBlockPtr message = IHelper::random(32);
+
+  Time start = zsLib::now();
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_SIGNING_BENCHMARK_OPERATIONS; ++loop) {
+    SecureByteBlockPtr signature = rsaPrivateKey->sign(*message);
+    TESTING_CHECK(rsaPublicKey->verify(*message, *signature, false))
+  }
+  Microseconds rsaDuration = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+
+  start = zsLib::now();
+  for (int loop = 0; loop < ORTC_SERVICE_TEST_SIGNING_BENCHMARK_OPERATIONS; ++loop) {
+    SecureByteBlockPtr signature = edPrivateKey->sign(*message);
+    TESTING_CHECK(edPublicKey->verify(*message, *signature))
+  }
+  Microseconds edDuration = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+
+  TESTING_STDOUT() << "              rsa-2048 sign+verify: operations=" << ORTC_SERVICE_TEST_SIGNING_BENCHMARK_OPERATIONS << " total(us)=" << rsaDuration.count() << "\n";
+  TESTING_STDOUT() << "              ed25519 sign+verify: operations=" << ORTC_SERVICE_TEST_SIGNING_BENCHMARK_OPERATIONS << " total(us)=" << edDuration.count() << "\n";
+}
+
+void doTestRSA()
+{
+  if (!ORTC_SERVICE_TEST_DO_RSA_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  testVerifyCache();
+  testBatch();
+  testEd25519();
+  benchmarkSigning();
+
+  TESTING_STDOUT() << "COMPLETED RSA TESTS...\n";
+}
@@ -0,0 +1,1305 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+
+#include <zsLib/IMessageQueueThread.h>
+#include <zsLib/Exception.h>
+#include <zsLib/ITimer.h>
+#include <zsLib/ISettings.h>
+#include <zsLib/Log.h>
+#include <ortc/services/IICESocket.h>
+#include <ortc/services/IICESocketSession.h>
+#include <ortc/services/IRUDPTransport.h>
+#include <ortc/services/IRUDPChannel.h>
+#include <ortc/services/IRUDPMessaging.h>
+#include <ortc/services/ISTUNRequesterManager.h>
+#include <ortc/services/ITransportStream.h>
+#include <ortc/services/PacketBuffer.h>
+#include <ortc/services/RUDPPacket.h>
+#include <ortc/services/STUNPacket.h>
+#include <ortc/services/internal/services_RUDPChannelStream.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+
+namespace ortc { namespace services { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_services_test) } } }
+
+using zsLib::BYTE;
+using zsLib::WORD;
+using zsLib::DWORD;
+using zsLib::QWORD;
+using zsLib::ULONG;
+using zsLib::PUID;
+using zsLib::Time;
+using zsLib::Milliseconds;
+using zsLib::Microseconds;
+using zsLib::IPAddress;
+using zsLib::String;
+using zsLib::string;
+using zsLib::IMessageQueue;
+using zsLib::RecursiveLock;
+using zsLib::AutoRecursiveLock;
+using namespace ortc::services;
+using namespace ortc::services::test;
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace test
+    {
+      ZS_DECLARE_CLASS_PTR(SimulatedLink);
+      ZS_DECLARE_CLASS_PTR(SimulatedICESocketSession);
+      ZS_DECLARE_CLASS_PTR(TestRUDPSimulatedLink);
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark SimulatedLink
+      #pragma mark
+
+      // A two ended link that delivers packets between two simulated ICE
+      // socket sessions. All impairments are computed from a seeded random
+      // generator so the same settings always produce the same drop, jitter,
+      // reorder and duplication decisions.
+      class SimulatedLink : public zsLib::MessageQueueAssociator,
+                            public zsLib::ITimerDelegate
+      {
+      public:
+        struct Impairments
+        {
+          const char *mName {"clean"};
+
+          Milliseconds mDelay {Milliseconds(20)};     // one-way propagation delay
+          Milliseconds mJitter {};                    // maximum extra random one-way delay
+          ULONG mLossPercent {};                      // random loss (percent x 100, i.e. 150 = 1.5%)
+          ULONG mReorderPercent {};                   // chance a packet is held back behind the next (percent x 100)
+          ULONG mDuplicatePercent {};                 // chance a packet is delivered twice (percent x 100)
+          ULONG mBandwidthKbps {};                    // bottleneck bandwidth, 0 = unlimited
+          size_t mQueueLimitInBytes {};               // bottleneck router queue, 0 = unlimited
+          ULONG mDropRUDPPacket {};                   // drop the first transmission of the Nth RUDP packet sent by side 0, 0 = none
+          DWORD mSeed {1};
+        };
+
+        struct Stats
+        {
+          ULONG mPacketsOffered {};
+          ULONG mPacketsLost {};
+          ULONG mPacketsQueueDropped {};
+          ULONG mPacketsReordered {};
+          ULONG mPacketsDuplicated {};
+          ULONG mPacketsDelivered {};
+          QWORD mBytesDelivered {};
+
+          ULONG mRUDPDataPackets {};                  // unique RUDP sequence numbers seen
+          ULONG mRUDPRetransmits {};                  // RUDP sequence numbers seen more than once
+          ULONG mSTUNPackets {};
+        };
+
+      protected:
+        struct PendingPacket
+        {
+          size_t mToSide {};
+          SecureByteBlockPtr mBuffer;
+        };
+        typedef std::multimap<Time, PendingPacket> PendingPacketMap;
+        typedef std::set<QWORD> SeenSequenceSet;
+
+        struct Direction
+        {
+          PendingPacketMap mPending;
+          Time mLinkFreeAt;
+          size_t mQueuedBytes {};
+          Stats mStats;
+          SeenSequenceSet mSeen;
+        };
+
+      private:
+        //---------------------------------------------------------------------
+        SimulatedLink(
+                      zsLib::IMessageQueuePtr queue,
+                      const Impairments &impairments
+                      ) :
+          zsLib::MessageQueueAssociator(queue),
+          mImpairments(impairments),
+          mRandom(impairments.mSeed)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init()
+        {
+          mTimer = zsLib::ITimer::create(mThisWeak.lock(), Milliseconds(1));
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static SimulatedLinkPtr create(
+                                       zsLib::IMessageQueuePtr queue,
+                                       const Impairments &impairments
+                                       )
+        {
+          SimulatedLinkPtr pThis(new SimulatedLink(queue, impairments));
+          pThis->mThisWeak = pThis;
+          pThis->init();
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~SimulatedLink()
+        {
+          cancel();
+        }
+
+        //---------------------------------------------------------------------
+        void attach(
+                    size_t side,
+                    SimulatedICESocketSessionPtr session
+                    )
+        {
+          AutoRecursiveLock lock(mLock);
+          ZS_THROW_INVALID_ARGUMENT_IF(side > 1)
+          mSessions[side] = session;
+        }
+
+        //---------------------------------------------------------------------
+        void cancel()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mTimer) {
+            mTimer->cancel();
+            mTimer.reset();
+          }
+          for (size_t index = 0; index < 2; ++index) {
+            mSessions[index].reset();
+            mDirections[index].mPending.clear();
+            mDirections[index].mQueuedBytes = 0;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void send(
+                  size_t fromSide,
+                  const BYTE *packet,
+                  size_t packetLengthInBytes
+                  )
+        {
+          AutoRecursiveLock lock(mLock);
+
+          Direction &direction = mDirections[fromSide];
+          Stats &stats = direction.mStats;
+
+          ++stats.mPacketsOffered;
+          bool firstTransmission = account(direction, packet, packetLengthInBytes);
+
+          if ((0 != mImpairments.mDropRUDPPacket) &&
+              (0 == fromSide) &&
+              (firstTransmission) &&
+              (stats.mRUDPDataPackets == mImpairments.mDropRUDPPacket)) {
+            ++stats.mPacketsLost;
+            return;
+          }
+
+          Time current = zsLib::now();
+
+          if (decide(mImpairments.mLossPercent)) {
+            ++stats.mPacketsLost;
+            return;
+          }
+
+          // bottleneck serialization with a drop-tail router queue
+          Time departure = current;
+          if (0 != mImpairments.mBandwidthKbps) {
+            if (direction.mLinkFreeAt > departure) departure = direction.mLinkFreeAt;
+
+            if ((0 != mImpairments.mQueueLimitInBytes) &&
+                (direction.mQueuedBytes + packetLengthInBytes > mImpairments.mQueueLimitInBytes)) {
+              ++stats.mPacketsQueueDropped;
+              return;
+            }
+
+            Microseconds serialize(static_cast<Microseconds::rep>((packetLengthInBytes * 8 * 1000) / mImpairments.mBandwidthKbps));
+            departure += serialize;
+            direction.mLinkFreeAt = departure;
+          }
+
+          Time arrival = departure + mImpairments.mDelay;
+          if (Milliseconds() != mImpairments.mJitter) {
+            std::uniform_int_distribution<Microseconds::rep> jitter(0, std::chrono::duration_cast<Microseconds>(mImpairments.mJitter).count());
+            arrival += Microseconds(jitter(mRandom));
+          }
+
+          if (decide(mImpairments.mReorderPercent)) {
+            // hold the packet back long enough that those sent after it will overtake it
+            ++stats.mPacketsReordered;
+            arrival += (mImpairments.mDelay / 2) + Milliseconds(1);
+          }
+
+          size_t toSide = (0 == fromSide ? 1 : 0);
+
+          schedule(direction, toSide, arrival, packet, packetLengthInBytes);
+
+          if (decide(mImpairments.mDuplicatePercent)) {
+            ++stats.mPacketsDuplicated;
+            schedule(direction, toSide, arrival + Milliseconds(1), packet, packetLengthInBytes);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        Stats getStats(size_t fromSide) const
+        {
+          AutoRecursiveLock lock(mLock);
+          return mDirections[fromSide].mStats;
+        }
+
+        //---------------------------------------------------------------------
+        const Impairments &getImpairments() const {return mImpairments;}
+
+        //---------------------------------------------------------------------
+        virtual void onTimer(zsLib::ITimerPtr timer);
+
+      protected:
+        //---------------------------------------------------------------------
+        bool decide(ULONG percentTimes100)
+        {
+          if (0 == percentTimes100) return false;
+          std::uniform_int_distribution<ULONG> chance(0, 9999);
+          return chance(mRandom) < percentTimes100;
+        }
+
+        //---------------------------------------------------------------------
+        bool account(
+                     Direction &direction,
+                     const BYTE *packet,
+                     size_t packetLengthInBytes
+                     )
+        {
+          RUDPPacketPtr rudp = RUDPPacket::parseIfRUDP(packet, packetLengthInBytes);
+          if (!rudp) {
+            ++direction.mStats.mSTUNPackets;
+            return false;
+          }
+
+          QWORD key = (static_cast<QWORD>(rudp->mChannelNumber) << 32) | static_cast<QWORD>(rudp->mSequenceNumber);
+          if (direction.mSeen.end() != direction.mSeen.find(key)) {
+            ++direction.mStats.mRUDPRetransmits;
+            return false;
+          }
+          direction.mSeen.insert(key);
+          ++direction.mStats.mRUDPDataPackets;
+          return true;
+        }
+
+        //---------------------------------------------------------------------
+        void schedule(
+                      Direction &direction,
+                      size_t toSide,
+                      Time arrival,
+                      const BYTE *packet,
+                      size_t packetLengthInBytes
+                      )
+        {
+          PendingPacket pending;
+          pending.mToSide = toSide;
+          pending.mBuffer = make_shared<SecureByteBlock>(packet, packetLengthInBytes);
+
+          direction.mQueuedBytes += packetLengthInBytes;
+          direction.mPending.insert(PendingPacketMap::value_type(arrival, pending));
+        }
+
+      private:
+        SimulatedLinkWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+
+        Impairments mImpairments;
+        std::mt19937 mRandom;
+
+        zsLib::ITimerPtr mTimer;
+
+        SimulatedICESocketSessionPtr mSessions[2];
+        Direction mDirections[2];
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark SimulatedICESocketSession
+      #pragma mark
+
+      // Stands in for an already nominated ICE socket session. Packets sent
+      // on the session travel over the simulated link and packets arriving
+      // from the link are dispatched exactly as ICESocket would dispatch them
+      // (STUN responses to the requester manager, other STUN packets and data
+      // to the session subscribers).
+      class SimulatedICESocketSession : public zsLib::MessageQueueAssociator,
+                                        public IICESocketSession
+      {
+      private:
+        //---------------------------------------------------------------------
+        SimulatedICESocketSession(
+                                  zsLib::IMessageQueuePtr queue,
+                                  SimulatedLinkPtr link,
+                                  size_t side,
+                                  const IPAddress &localIP,
+                                  const IPAddress &remoteIP,
+                                  const char *localUsernameFrag,
+                                  const char *remoteUsernameFrag
+                                  ) :
+          zsLib::MessageQueueAssociator(queue),
+          mLink(link),
+          mSide(side),
+          mLocalIP(localIP),
+          mRemoteIP(remoteIP),
+          mLocalUsernameFrag(localUsernameFrag),
+          mLocalPassword(String(localUsernameFrag) + "-password"),
+          mRemoteUsernameFrag(remoteUsernameFrag),
+          mRemotePassword(String(remoteUsernameFrag) + "-password")
+        {
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static SimulatedICESocketSessionPtr create(
+                                                   zsLib::IMessageQueuePtr queue,
+                                                   SimulatedLinkPtr link,
+                                                   size_t side,
+                                                   const IPAddress &localIP,
+                                                   const IPAddress &remoteIP,
+                                                   const char *localUsernameFrag,
+                                                   const char *remoteUsernameFrag
+                                                   )
+        {
+          SimulatedICESocketSessionPtr pThis(new SimulatedICESocketSession(queue, link, side, localIP, remoteIP, localUsernameFrag, remoteUsernameFrag));
+          pThis->mThisWeak = pThis;
+          link->attach(side, pThis);
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark SimulatedICESocketSession => IICESocketSession
+        #pragma mark
+
+        virtual PUID getID() const {return mID;}
+
+        //---------------------------------------------------------------------
+        virtual IICESocketSessionSubscriptionPtr subscribe(IICESocketSessionDelegatePtr originalDelegate)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (!originalDelegate) return IICESocketSessionSubscriptionPtr();
+
+          IICESocketSessionSubscriptionPtr subscription = mSubscriptions.subscribe(originalDelegate);
+
+          IICESocketSessionDelegatePtr delegate = mSubscriptions.delegate(subscription, true);
+          if (delegate) {
+            delegate->onICESocketSessionStateChanged(mThisWeak.lock(), mCurrentState);
+          }
+          return subscription;
+        }
+
+        virtual IICESocketPtr getSocket() {return IICESocketPtr();}
+
+        //---------------------------------------------------------------------
+        virtual ICESocketSessionStates getState(
+                                                WORD *outLastErrorCode = NULL,
+                                                String *outLastErrorReason = NULL
+                                                ) const
+        {
+          AutoRecursiveLock lock(mLock);
+          if (outLastErrorCode) *outLastErrorCode = 0;
+          if (outLastErrorReason) *outLastErrorReason = String();
+          return mCurrentState;
+        }
+
+        //---------------------------------------------------------------------
+        virtual void close()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (ICESocketSessionState_Shutdown == mCurrentState) return;
+          mCurrentState = ICESocketSessionState_Shutdown;
+          mSubscriptions.delegate()->onICESocketSessionStateChanged(mThisWeak.lock(), mCurrentState);
+          mSubscriptions.clear();
+          mLink.reset();
+        }
+
+        virtual String getLocalUsernameFrag() const {return mLocalUsernameFrag;}
+        virtual String getLocalPassword() const {return mLocalPassword;}
+        virtual String getRemoteUsernameFrag() const {return mRemoteUsernameFrag;}
+        virtual String getRemotePassword() const {return mRemotePassword;}
+
+        //---------------------------------------------------------------------
+        virtual void getLocalCandidates(CandidateList &outCandidates)
+        {
+          Candidate local;
+          getNominatedCandidateInformation(local, local);
+          outCandidates.clear();
+          outCandidates.push_back(local);
+        }
+
+        virtual void updateRemoteCandidates(const CandidateList &remoteCandidates) {}
+        virtual void addRemoteCandidate(const Candidate &remoteCandidate) {}
+        virtual void setRemoteLite() {}
+        virtual void endOfRemoteCandidates() {}
+
+        //---------------------------------------------------------------------
+        virtual void setKeepAliveProperties(
+                                            Milliseconds sendKeepAliveIndications,
+                                            Milliseconds expectSTUNOrDataWithinWithinOrSendAliveCheck = Milliseconds(),
+                                            Milliseconds keepAliveSTUNRequestTimeout = Milliseconds(),
+                                            Milliseconds backgroundingTimeout = Milliseconds()
+                                            )
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual bool sendPacket(
+                                const BYTE *packet,
+                                size_t packetLengthInBytes
+                                )
+        {
+          SimulatedLinkPtr link;
+          {
+            AutoRecursiveLock lock(mLock);
+            link = mLink;
+          }
+          if (!link) return false;
+          link->send(mSide, packet, packetLengthInBytes);
+          return true;
+        }
+
+        //---------------------------------------------------------------------
+        virtual bool sendPacket(PacketBufferPtr packet)
+        {
+          return sendPacket(packet->data(), packet->size());
+        }
+
+        virtual ICEControls getConnectedControlState() {return (0 == mSide ? IICESocket::ICEControl_Controlling : IICESocket::ICEControl_Controlled);}
+
+        virtual IPAddress getConnectedRemoteIP() {return mRemoteIP;}
+
+        //---------------------------------------------------------------------
+        virtual bool getNominatedCandidateInformation(
+                                                      Candidate &outLocal,
+                                                      Candidate &outRemote
+                                                      )
+        {
+          outLocal.mType = IICESocket::Type_Local;
+          outLocal.mComponentID = 1;
+          outLocal.mIPAddress = mLocalIP;
+          outLocal.mPriority = 1;
+
+          outRemote.mType = IICESocket::Type_Local;
+          outRemote.mComponentID = 1;
+          outRemote.mIPAddress = mRemoteIP;
+          outRemote.mPriority = 1;
+          return true;
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark SimulatedICESocketSession => (link)
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        // WARNING: Must not be called from within a lock as the subscribers
+        //          are called synchronously.
+        void handleLinkPacket(
+                              const BYTE *buffer,
+                              size_t bufferLengthInBytes
+                              )
+        {
+          STUNPacketPtr stun = STUNPacket::parseIfSTUN(buffer, bufferLengthInBytes, STUNPacket::ParseOptions(STUNPacket::RFC_AllowAll, false, "SimulatedICESocketSession", mID));
+
+          if (stun) {
+            if (ISTUNRequesterManager::handleSTUNPacket(mRemoteIP, stun)) return;
+
+            size_t pos = stun->mUsername.find(":");
+            if (String::npos == pos) return;
+
+            String localUsernameFrag = stun->mUsername.substr(0, pos);
+            String remoteUsernameFrag = stun->mUsername.substr(pos+1);
+
+            {
+              AutoRecursiveLock lock(mLock);
+              if (mSubscriptions.size() < 1) return;
+            }
+            mSubscriptions.delegate()->handleICESocketSessionReceivedSTUNPacket(mThisWeak.lock(), stun, localUsernameFrag, remoteUsernameFrag);
+            return;
+          }
+
+          {
+            AutoRecursiveLock lock(mLock);
+            if (mSubscriptions.size() < 1) return;
+          }
+          mSubscriptions.delegate()->handleICESocketSessionReceivedPacket(mThisWeak.lock(), buffer, bufferLengthInBytes);
+        }
+
+      private:
+        zsLib::AutoPUID mID;
+        SimulatedICESocketSessionWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+
+        SimulatedLinkPtr mLink;
+        size_t mSide {};
+
+        IPAddress mLocalIP;
+        IPAddress mRemoteIP;
+
+        String mLocalUsernameFrag;
+        String mLocalPassword;
+        String mRemoteUsernameFrag;
+        String mRemotePassword;
+
+        IICESocketSessionDelegateSubscriptions mSubscriptions;
+
+        ICESocketSessionStates mCurrentState {ICESocketSessionState_Completed};
+      };
+
+      //-----------------------------------------------------------------------
+      void SimulatedLink::onTimer(zsLib::ITimerPtr timer)
+      {
+        typedef std::pair<SimulatedICESocketSessionPtr, SecureByteBlockPtr> Delivery;
+        typedef std::list<Delivery> DeliveryList;
+
+        DeliveryList deliveries;
+
+        {
+          AutoRecursiveLock lock(mLock);
+          if (timer != mTimer) return;
+
+          Time current = zsLib::now();
+
+          for (size_t index = 0; index < 2; ++index) {
+            Direction &direction = mDirections[index];
+            while (direction.mPending.size() > 0) {
+              PendingPacketMap::iterator iter = direction.mPending.begin();
+              if ((*iter).first > current) break;
+
+              PendingPacket &pending = (*iter).second;
+              size_t size = pending.mBuffer->SizeInBytes();
+
+              direction.mQueuedBytes -= (size > direction.mQueuedBytes ? direction.mQueuedBytes : size);
+              ++direction.mStats.mPacketsDelivered;
+              direction.mStats.mBytesDelivered += size;
+
+              if (mSessions[pending.mToSide]) {
+                deliveries.push_back(Delivery(mSessions[pending.mToSide], pending.mBuffer));
+              }
+              direction.mPending.erase(iter);
+            }
+          }
+        }
+
+        // the sessions must be called outside of the link lock
+        for (DeliveryList::iterator iter = deliveries.begin(); iter != deliveries.end(); ++iter) {
+          Delivery &delivery = (*iter);
+          delivery.first->handleLinkPacket(delivery.second->BytePtr(), delivery.second->SizeInBytes());
+        }
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestRUDPSimulatedLink
+      #pragma mark
+
+      // Drives a bulk transfer from side "0" to side "1" over either a raw
+      // IRUDPChannel or an IRUDPMessaging channel and measures goodput,
+      // message delivery latency and the retransmit ratio.
+      class TestRUDPSimulatedLink : public zsLib::MessageQueueAssociator,
+                                    public IRUDPTransportDelegate,
+                                    public IRUDPChannelDelegate,
+                                    public IRUDPMessagingDelegate,
+                                    public ITransportStreamReaderDelegate,
+                                    public ITransportStreamWriterDelegate
+      {
+      public:
+        enum Modes
+        {
+          Mode_Channel,
+          Mode_Messaging,
+        };
+
+        struct Result
+        {
+          bool mCompleted {};
+          bool mIntact {true};
+
+          size_t mMessagesReceived {};
+          size_t mMessagesAbandoned {};
+          QWORD mBytesReceived {};
+
+          Milliseconds mDuration {};
+          double mGoodputKbps {};
+
+          Milliseconds mLatencyP50 {};
+          Milliseconds mLatencyP99 {};
+          double mRTTInflation {};
+
+          double mRetransmitRatio {};
+
+          SimulatedLink::Stats mForward;
+          SimulatedLink::Stats mReverse;
+        };
+
+      protected:
+        enum MessageHeaderSizes
+        {
+          MessageHeaderSize = sizeof(DWORD) + sizeof(QWORD),  // message index + send time in microseconds
+        };
+
+        typedef std::vector<Milliseconds> LatencyList;
+
+      private:
+        //---------------------------------------------------------------------
+        TestRUDPSimulatedLink(
+                              zsLib::IMessageQueuePtr queue,
+                              Modes mode,
+                              size_t totalMessages,
+                              size_t messageSizeInBytes,
+                              size_t maxMessagesInFlight,
+                              Milliseconds maxLifetime
+                              ) :
+          zsLib::MessageQueueAssociator(queue),
+          mMode(mode),
+          mTotalMessages(totalMessages),
+          mMessageSize(messageSizeInBytes < MessageHeaderSize ? MessageHeaderSize : messageSizeInBytes),
+          mMaxMessagesInFlight(maxMessagesInFlight),
+          mMaxLifetime(maxLifetime)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init(const SimulatedLink::Impairments &impairments)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          mLink = SimulatedLink::create(getAssociatedMessageQueue(), impairments);
+
+          IPAddress ip1("10.1.1.1", 5000);
+          IPAddress ip2("10.2.2.2", 6000);
+
+          mSessions[0] = SimulatedICESocketSession::create(getAssociatedMessageQueue(), mLink, 0, ip1, ip2, "side1", "side2");
+          mSessions[1] = SimulatedICESocketSession::create(getAssociatedMessageQueue(), mLink, 1, ip2, ip1, "side2", "side1");
+
+          for (size_t index = 0; index < 2; ++index) {
+            mReceiveStreams[index] = ITransportStream::create()->getReader();
+            mSendStreams[index] = ITransportStream::create()->getWriter();
+            mReceiveSubscriptions[index] = mReceiveStreams[index]->subscribe(mThisWeak.lock());
+            mSendSubscriptions[index] = mSendStreams[index]->subscribe(mThisWeak.lock());
+            mReceiveStreams[index]->notifyReaderReadyToRead();
+          }
+
+          mStartTime = zsLib::now();
+
+          mTransports[0] = IRUDPTransport::listen(getAssociatedMessageQueue(), mSessions[0], mThisWeak.lock());
+          mTransports[1] = IRUDPTransport::listen(getAssociatedMessageQueue(), mSessions[1], mThisWeak.lock());
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static TestRUDPSimulatedLinkPtr create(
+                                               zsLib::IMessageQueuePtr queue,
+                                               const SimulatedLink::Impairments &impairments,
+                                               Modes mode,
+                                               size_t totalMessages,
+                                               size_t messageSizeInBytes,
+                                               size_t maxMessagesInFlight,
+                                               Milliseconds maxLifetime = Milliseconds()   // when set every message but the last may expire (messaging mode only)
+                                               )
+        {
+          TestRUDPSimulatedLinkPtr pThis(new TestRUDPSimulatedLink(queue, mode, totalMessages, messageSizeInBytes, maxMessagesInFlight, maxLifetime));
+          pThis->mThisWeak = pThis;
+          pThis->init(impairments);
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~TestRUDPSimulatedLink()
+        {
+          shutdown();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => IRUDPTransportDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onRUDPTransportStateChanged(
+                                                 IRUDPTransportPtr transport,
+                                                 RUDPTransportStates state
+                                                 )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (IRUDPTransport::RUDPTransportState_Ready != state) return;
+          if (transport != mTransports[0]) return;
+          if ((mChannel) || (mMessaging[0])) return;
+
+          // side "0" is always the sending side
+          if (Mode_Messaging == mMode) {
+            mMessaging[0] = IRUDPMessaging::openChannel(getAssociatedMessageQueue(), transport, mThisWeak.lock(), "simulated/benchmark", mReceiveStreams[0]->getStream(), mSendStreams[0]->getStream());
+          } else {
+            mChannel = transport->openChannel(mThisWeak.lock(), "simulated/benchmark", mReceiveStreams[0]->getStream(), mSendStreams[0]->getStream());
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onRUDPTransportChannelWaiting(IRUDPTransportPtr transport)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (transport != mTransports[1]) return;
+
+          if (Mode_Messaging == mMode) {
+            mMessaging[1] = IRUDPMessaging::acceptChannel(getAssociatedMessageQueue(), transport, mThisWeak.lock(), mReceiveStreams[1]->getStream(), mSendStreams[1]->getStream());
+          } else {
+            mAcceptedChannel = transport->acceptChannel(mThisWeak.lock(), mReceiveStreams[1]->getStream(), mSendStreams[1]->getStream());
+          }
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => IRUDPChannelDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onRDUPChannelStateChanged(
+                                               IRUDPChannelPtr channel,
+                                               RUDPChannelStates state
+                                               )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (channel != mChannel) return;
+          if (IRUDPChannel::RUDPChannelState_Connected != state) return;
+          startSending();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => IRUDPMessagingDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onRUDPMessagingStateChanged(
+                                                 IRUDPMessagingPtr messaging,
+                                                 RUDPMessagingStates state
+                                                 )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (messaging != mMessaging[0]) return;
+          if (IRUDPMessaging::RUDPMessagingState_Connected != state) return;
+          startSending();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => ITransportStreamReaderDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamReaderReady(ITransportStreamReaderPtr reader)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (reader != mReceiveStreams[1]) return;
+
+          while (true) {
+            SecureByteBlockPtr buffer = reader->read();
+            if (!buffer) break;
+
+            if (Mode_Messaging == mMode) {
+              handleMessage(buffer->BytePtr(), buffer->SizeInBytes());
+            } else {
+              handleStreamData(buffer->BytePtr(), buffer->SizeInBytes());
+            }
+          }
+
+          if (isTransferComplete()) {
+            if (!mResult.mCompleted) {
+              mResult.mCompleted = true;
+              mResult.mDuration = zsLib::toMilliseconds(zsLib::now() - mSendStartTime);
+            }
+            return;
+          }
+
+          fillSendWindow();
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => ITransportStreamWriterDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTransportStreamWriterReady(ITransportStreamWriterPtr writer)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestRUDPSimulatedLink => (benchmark)
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        bool isComplete() const
+        {
+          AutoRecursiveLock lock(mLock);
+          return mResult.mCompleted;
+        }
+
+        //---------------------------------------------------------------------
+        Result getResult()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          Result result = mResult;
+          if (!result.mCompleted) {
+            result.mDuration = zsLib::toMilliseconds(zsLib::now() - (mSending ? mSendStartTime : mStartTime));
+          }
+
+          if (result.mDuration > Milliseconds()) {
+            result.mGoodputKbps = static_cast<double>(result.mBytesReceived * 8) / static_cast<double>(result.mDuration.count());
+          }
+
+          if (mLatencies.size() > 0) {
+            LatencyList sorted(mLatencies);
+            std::sort(sorted.begin(), sorted.end());
+            result.mLatencyP50 = sorted[(sorted.size() * 50) / 100];
+            result.mLatencyP99 = sorted[((sorted.size() * 99) / 100 < sorted.size() ? (sorted.size() * 99) / 100 : sorted.size() - 1)];
+
+            Milliseconds baseDelay = mLink->getImpairments().mDelay;
+            if (baseDelay > Milliseconds()) {
+              result.mRTTInflation = static_cast<double>(result.mLatencyP50.count()) / static_cast<double>(baseDelay.count());
+            }
+          }
+
+          result.mForward = mLink->getStats(0);
+          result.mReverse = mLink->getStats(1);
+
+          if (0 != result.mForward.mRUDPDataPackets) {
+            result.mRetransmitRatio = static_cast<double>(result.mForward.mRUDPRetransmits) / static_cast<double>(result.mForward.mRUDPDataPackets);
+          }
+          return result;
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          for (size_t index = 0; index < 2; ++index) {
+            if (mMessaging[index]) {
+              mMessaging[index]->shutdown();
+              mMessaging[index].reset();
+            }
+          }
+          if (mChannel) {
+            mChannel->shutdown();
+            mChannel.reset();
+          }
+          if (mAcceptedChannel) {
+            mAcceptedChannel->shutdown();
+            mAcceptedChannel.reset();
+          }
+          for (size_t index = 0; index < 2; ++index) {
+            if (mTransports[index]) {
+              mTransports[index]->shutdown();
+              mTransports[index].reset();
+            }
+            if (mSessions[index]) {
+              mSessions[index]->close();
+              mSessions[index].reset();
+            }
+            if (mReceiveSubscriptions[index]) {
+              mReceiveSubscriptions[index]->cancel();
+              mReceiveSubscriptions[index].reset();
+            }
+            if (mSendSubscriptions[index]) {
+              mSendSubscriptions[index]->cancel();
+              mSendSubscriptions[index].reset();
+            }
+          }
+          if (mLink) {
+            mLink->cancel();
+            mLink.reset();
+          }
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        void startSending()
+        {
+          if (mSending) return;
+          mSending = true;
+          mSendStartTime = zsLib::now();
+          fillSendWindow();
+        }
+
+        //---------------------------------------------------------------------
+        void fillSendWindow()
+        {
+          if (!mSending) return;
+
+          while (mMessagesSent < mTotalMessages) {
+            size_t delivered = mResult.mMessagesReceived + mResult.mMessagesAbandoned;
+            if ((0 != mMaxMessagesInFlight) &&
+                ((mMessagesSent - delivered) >= mMaxMessagesInFlight)) break;
+
+            SecureByteBlockPtr buffer(make_shared<SecureByteBlock>(mMessageSize));
+            BYTE *pos = buffer->BytePtr();
+
+            QWORD sendTime = static_cast<QWORD>(std::chrono::duration_cast<Microseconds>(zsLib::now().time_since_epoch()).count());
+            DWORD index = static_cast<DWORD>(mMessagesSent);
+
+            memcpy(pos, &index, sizeof(index));
+            memcpy(pos + sizeof(index), &sendTime, sizeof(sendTime));
+            for (size_t offset = MessageHeaderSize; offset < mMessageSize; ++offset) {
+              pos[offset] = static_cast<BYTE>((index + offset) & 0xFF);
+            }
+
+            if (Mode_Channel == mMode) {
+              // a raw channel is a byte stream so use a position based pattern instead
+              for (size_t offset = 0; offset < mMessageSize; ++offset) {
+                pos[offset] = static_cast<BYTE>(((mMessagesSent * mMessageSize) + offset) & 0xFF);
+              }
+            }
+
+            IRUDPMessaging::MessageReliabilityHeaderPtr reliability;
+            if ((Milliseconds() != mMaxLifetime) &&
+                (mMessagesSent + 1 < mTotalMessages)) {
+              // the last message stays reliable so the transfer always completes
+              reliability = make_shared<IRUDPMessaging::MessageReliabilityHeader>();
+              reliability->mMaxLifetime = mMaxLifetime;
+            }
+
+            mSendStreams[0]->write(buffer, reliability);
+            ++mMessagesSent;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void handleMessage(
+                           const BYTE *buffer,
+                           size_t bufferSizeInBytes
+                           )
+        {
+          if (bufferSizeInBytes != mMessageSize) {
+            mResult.mIntact = false;
+            return;
+          }
+
+          DWORD index = 0;
+          QWORD sendTime = 0;
+          memcpy(&index, buffer, sizeof(index));
+          memcpy(&sendTime, buffer + sizeof(index), sizeof(sendTime));
+
+          size_t expecting = mResult.mMessagesReceived + mResult.mMessagesAbandoned;
+          if (index != static_cast<DWORD>(expecting)) {
+            // messaging is ordered and only expired messages may be skipped
+            if ((Milliseconds() == mMaxLifetime) ||
+                (index < static_cast<DWORD>(expecting))) {
+              mResult.mIntact = false;
+            } else {
+              mResult.mMessagesAbandoned += (index - expecting);
+            }
+          }
+
+          for (size_t offset = MessageHeaderSize; offset < mMessageSize; ++offset) {
+            if (buffer[offset] != static_cast<BYTE>((index + offset) & 0xFF)) {
+              mResult.mIntact = false;
+              break;
+            }
+          }
+
+          QWORD current = static_cast<QWORD>(std::chrono::duration_cast<Microseconds>(zsLib::now().time_since_epoch()).count());
+          mLatencies.push_back(std::chrono::duration_cast<Milliseconds>(Microseconds(static_cast<Microseconds::rep>(current - sendTime))));
+
+          ++mResult.mMessagesReceived;
+          mResult.mBytesReceived += bufferSizeInBytes;
+        }
+
+        //---------------------------------------------------------------------
+        void handleStreamData(
+                              const BYTE *buffer,
+                              size_t bufferSizeInBytes
+                              )
+        {
+          for (size_t offset = 0; offset < bufferSizeInBytes; ++offset) {
+            if (buffer[offset] != static_cast<BYTE>((mResult.mBytesReceived + offset) & 0xFF)) {
+              mResult.mIntact = false;
+              break;
+            }
+          }
+          mResult.mBytesReceived += bufferSizeInBytes;
+          mResult.mMessagesReceived = static_cast<size_t>(mResult.mBytesReceived / mMessageSize);
+        }
+
+        //---------------------------------------------------------------------
+        bool isTransferComplete() const
+        {
+          if (Milliseconds() != mMaxLifetime) {
+            return (mResult.mMessagesReceived + mResult.mMessagesAbandoned) >= mTotalMessages;
+          }
+          return mResult.mBytesReceived >= (static_cast<QWORD>(mTotalMessages) * mMessageSize);
+        }
+
+      private:
+        TestRUDPSimulatedLinkWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+
+        Modes mMode;
+        size_t mTotalMessages {};
+        size_t mMessageSize {};
+        size_t mMaxMessagesInFlight {};
+        Milliseconds mMaxLifetime {};
+
+        SimulatedLinkPtr mLink;
+        SimulatedICESocketSessionPtr mSessions[2];
+        IRUDPTransportPtr mTransports[2];
+
+        IRUDPChannelPtr mChannel;
+        IRUDPChannelPtr mAcceptedChannel;
+        IRUDPMessagingPtr mMessaging[2];
+
+        ITransportStreamReaderPtr mReceiveStreams[2];
+        ITransportStreamWriterPtr mSendStreams[2];
+        ITransportStreamReaderSubscriptionPtr mReceiveSubscriptions[2];
+        ITransportStreamWriterSubscriptionPtr mSendSubscriptions[2];
+
+        Time mStartTime;
+        Time mSendStartTime;
+        bool mSending {};
+        size_t mMessagesSent {};
+
+        LatencyList mLatencies;
+        Result mResult;
+      };
+    }
+  }
+}
+
+using ortc::services::test::SimulatedLink;
+using ortc::services::test::TestRUDPSimulatedLink;
+using ortc::services::test::TestRUDPSimulatedLinkPtr;
+
+namespace
+{
+  //---------------------------------------------------------------------------
+  static SimulatedLink::Impairments makeImpairments(
+                                                    const char *name,
+                                                    ULONG delayMs,
+                                                    ULONG jitterMs,
+                                                    ULONG lossPercentTimes100,
+                                                    ULONG reorderPercentTimes100,
+                                                    ULONG duplicatePercentTimes100,
+                                                    ULONG bandwidthKbps,
+                                                    size_t queueLimitInBytes,
+                                                    ULONG dropRUDPPacket = 0
+                                                    )
+  {
+    SimulatedLink::Impairments result;
+    result.mName = name;
+    result.mDelay = Milliseconds(delayMs);
+    result.mJitter = Milliseconds(jitterMs);
+    result.mLossPercent = lossPercentTimes100;
+    result.mReorderPercent = reorderPercentTimes100;
+    result.mDuplicatePercent = duplicatePercentTimes100;
+    result.mBandwidthKbps = bandwidthKbps;
+    result.mQueueLimitInBytes = queueLimitInBytes;
+    result.mDropRUDPPacket = dropRUDPPacket;
+    result.mSeed = ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_SEED;
+    return result;
+  }
+
+  //---------------------------------------------------------------------------
+  static void runSimulatedLinkBenchmark(
+                                        zsLib::IMessageQueuePtr queue,
+                                        const SimulatedLink::Impairments &impairments,
+                                        TestRUDPSimulatedLink::Modes mode,
+                                        bool paceSending
+                                        )
+  {
+    const char *modeName = (TestRUDPSimulatedLink::Mode_Messaging == mode ? "messaging" : "channel");
+
+    zsLib::ISettings::setBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING, paceSending);
+
+    TestRUDPSimulatedLinkPtr benchmark = TestRUDPSimulatedLink::create(
+                                                                       queue,
+                                                                       impairments,
+                                                                       mode,
+                                                                       ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_TOTAL_MESSAGES,
+                                                                       ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MESSAGE_SIZE,
+                                                                       ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MESSAGES_IN_FLIGHT
+                                                                       );
+
+    ULONG totalWait = 0;
+    while (!benchmark->isComplete()) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MAX_SECONDS * 10)) break;
+    }
+
+    TestRUDPSimulatedLink::Result result = benchmark->getResult();
+
+    TESTING_STDOUT() << "BENCHMARK:    RUDP " << modeName << " over \"" << impairments.mName << "\" link (" << (paceSending ? "paced" : "bursting") << ")\n";
+    TESTING_STDOUT() << "              completed=" << (result.mCompleted ? "yes" : "no")
+                     << " bytes=" << result.mBytesReceived
+                     << " duration(ms)=" << result.mDuration.count()
+                     << " goodput(kbps)=" << result.mGoodputKbps << "\n";
+    TESTING_STDOUT() << "              latency p50(ms)=" << result.mLatencyP50.count()
+                     << " p99(ms)=" << result.mLatencyP99.count()
+                     << " rtt inflation=" << result.mRTTInflation << "\n";
+    TESTING_STDOUT() << "              data packets=" << result.mForward.mRUDPDataPackets
+                     << " retransmits=" << result.mForward.mRUDPRetransmits
+                     << " retransmit ratio=" << result.mRetransmitRatio
+                     << " lost=" << result.mForward.mPacketsLost
+                     << " queue dropped=" << result.mForward.mPacketsQueueDropped
+                     << " reordered=" << result.mForward.mPacketsReordered
+                     << " duplicated=" << result.mForward.mPacketsDuplicated
+                     << " stun(fwd/rev)=" << result.mForward.mSTUNPackets << "/" << result.mReverse.mSTUNPackets << "\n";
+
+    TESTING_CHECK(result.mCompleted)
+    TESTING_CHECK(result.mIntact)
+
+    benchmark->shutdown();
+    benchmark.reset();
+  }
+
+  //---------------------------------------------------------------------------
+  // A partially reliable message that the remote party acknowledged through
+  // an ACK vector (while an earlier packet was lost) stays in the sending
+  // list until the GSNFR moves past it. Its lifetime then runs out and it
+  // must not be abandoned again as its packet is already gone.
+  static void testExpiredAfterVectorACK(zsLib::IMessageQueuePtr queue)
+  {
+    zsLib::ISettings::setBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING, false);
+
+    SimulatedLink::Impairments impairments = makeImpairments("drop-one", 20, 0, 0, 0, 0, 0, 0, ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_DROP_PACKET);
+
+    TestRUDPSimulatedLinkPtr test = TestRUDPSimulatedLink::create(
+                                                                  queue,
+                                                                  impairments,
+                                                                  TestRUDPSimulatedLink::Mode_Messaging,
+                                                                  ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_MESSAGES,
+                                                                  ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_MESSAGE_SIZE,
+                                                                  ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MESSAGES_IN_FLIGHT,
+                                                                  Milliseconds(ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_LIFETIME_MS)
+                                                                  );
+
+    ULONG totalWait = 0;
+    while (!test->isComplete()) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MAX_SECONDS * 10)) break;
+    }
+
+    TestRUDPSimulatedLink::Result result = test->getResult();
+
+    TESTING_STDOUT() << "TEST:         RUDP partially reliable messages expiring after a vector ACK\n";
+    TESTING_STDOUT() << "              completed=" << (result.mCompleted ? "yes" : "no")
+                     << " received=" << result.mMessagesReceived
+                     << " abandoned=" << result.mMessagesAbandoned
+                     << " lost=" << result.mForward.mPacketsLost
+                     << " retransmits=" << result.mForward.mRUDPRetransmits << "\n";
+
+    TESTING_CHECK(result.mCompleted)
+    TESTING_CHECK(result.mIntact)
+    TESTING_EQUAL(result.mForward.mPacketsLost, 1)
+
+    test->shutdown();
+    test.reset();
+
+    zsLib::ISettings::setBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING, true);
+  }
+}
+
+void doTestRUDPSimulatedLink()
+{
+  if (!ORTC_SERVICE_TEST_DO_RUDP_SIMULATED_LINK_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
+
+  SimulatedLink::Impairments scenarios[] = {
+    //              name                 delay jitter loss  reorder dup  kbps  queue
+    makeImpairments("clean",             20,   0,     0,    0,      0,   0,    0),
+    makeImpairments("lossy-1%",          20,   0,     100,  0,      0,   0,    0),
+    makeImpairments("lossy-5%-jitter",   40,   10,    500,  0,      0,   0,    0),
+    makeImpairments("reorder-duplicate", 30,   5,     0,    300,    200, 0,    0),
+    makeImpairments("bottleneck-2mbps",  25,   0,     0,    0,      0,   2000, 16*1024),
+  };
+
+  for (size_t index = 0; index < (sizeof(scenarios) / sizeof(scenarios[0])); ++index) {
+    // compare bursting against paced sending on the same link
+    for (int paced = 0; paced < 2; ++paced) {
+      runSimulatedLinkBenchmark(thread, scenarios[index], TestRUDPSimulatedLink::Mode_Channel, 0 != paced);
+      runSimulatedLinkBenchmark(thread, scenarios[index], TestRUDPSimulatedLink::Mode_Messaging, 0 != paced);
+    }
+  }
+
+  zsLib::ISettings::setBool(ORTC_SERVICES_SETTING_RUDP_CHANNEL_STREAM_PACE_SENDING, true);
+
+  testExpiredAfterVectorACK(thread);
+
+  ZS_LOG_BASIC("WAITING:      All simulated links have finished. Waiting for 'bogus' events to process (10 second wait).");
+
+  TESTING_SLEEP(10000)
+
+  // wait for shutdown
+  {
+    IMessageQueue::size_type count = 0;
+    do
+    {
+      count = thread->getTotalUnprocessedMessages();
+      if (0 != count)
+        std::this_thread::yield();
+    } while (count > 0);
+
+    thread->waitForShutdown();
+  }
+  TESTING_UNINSTALL_LOGGER();
+  zsLib::proxyDump();
+  TESTING_EQUAL(zsLib::proxyGetTotalConstructed(), 0);
+}
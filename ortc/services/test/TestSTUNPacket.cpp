@@ -140,6 +140,8 @@ namespace ortc
           test1();
           test2();
           test3();
+          test4();
+          test5();
         }
 
         void test1()
@@ -177,6 +179,54 @@ namespace ortc
           bool valid = packet->isValidMessageIntegrity(kRfc5769SampleMsgPassword);
           TESTING_CHECK(valid)
         }
+
+        void test4()
+        {
+          STUNPacketPtr indication = STUNPacket::createIndication(STUNPacket::Method_Binding);
+          indication->mUsername = "evtj:h6vY";
+          indication->mPassword = kRfc5769SampleMsgPassword;
+          indication->mCredentialMechanism = STUNPacket::CredentialMechanisms_ShortTerm;
+          indication->mFingerprintIncluded = true;
+
+          SecureByteBlockPtr buffer = indication->packetize(STUNPacket::RFC_5245_ICE);
+          TESTING_CHECK((bool)buffer)
+
+          BYTE originalTransactionID[sizeof(indication->mTransactionID)] {};
+          memcpy(&(originalTransactionID[0]), &(indication->mTransactionID[0]), sizeof(originalTransactionID));
+
+          // the template is stamped in place with a new transaction ID
+          bool repacketized = indication->repacketize(*buffer);
+          TESTING_CHECK(repacketized)
+          TESTING_CHECK(0 != memcmp(&(originalTransactionID[0]), &(indication->mTransactionID[0]), sizeof(originalTransactionID)))
+
+          SecureByteBlockPtr copy = IHelper::convertToBuffer(buffer->BytePtr(), buffer->SizeInBytes());
+          STUNPacketPtr packet = STUNPacket::parseIfSTUN(copy->BytePtr(), copy->SizeInBytes(), STUNPacket::RFC_5245_ICE);
+
+          TESTING_CHECK((bool)packet)
+          if (!packet) return;
+
+          TESTING_CHECK(0 == memcmp(&(packet->mTransactionID[0]), &(indication->mTransactionID[0]), sizeof(packet->mTransactionID)))
+
+          bool valid = packet->isValidMessageIntegrity(kRfc5769SampleMsgPassword);
+          TESTING_CHECK(valid)
+        }
+
+        void test5()
+        {
+          // XOR-MAPPED-ADDRESS is XOR'ed with the transaction ID so the
+          // packet cannot be stamped with a new one
+          SecureByteBlockPtr buffer = IHelper::convertToBuffer(kRfc5769SampleResponseIPv6, sizeof(kRfc5769SampleResponseIPv6));
+          STUNPacketPtr packet = STUNPacket::parseIfSTUN(buffer->BytePtr(), buffer->SizeInBytes(), STUNPacket::RFC_5245_ICE);
+
+          TESTING_CHECK((bool)packet)
+          if (!packet) return;
+
+          TESTING_CHECK(packet->hasAttribute(STUNPacket::Attribute_XORMappedAddress))
+
+          bool repacketized = packet->repacketize(*buffer);
+          TESTING_CHECK(!repacketized)
+          TESTING_CHECK(0 == memcmp(buffer->BytePtr(), kRfc5769SampleResponseIPv6, sizeof(kRfc5769SampleResponseIPv6)))
+        }
       };
     }
   }
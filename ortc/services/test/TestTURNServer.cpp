@@ -0,0 +1,2122 @@
+/*
+
+ Copyright (c) 2016, Hookflash Inc.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ The views and conclusions contained in the software and documentation are those
+ of the authors and should not be interpreted as representing official policies,
+ either expressed or implied, of the FreeBSD Project.
+
+ */
+
+
+#include <zsLib/IMessageQueueThread.h>
+#include <zsLib/Exception.h>
+#include <zsLib/Socket.h>
+#include <zsLib/ITimer.h>
+#include <zsLib/ISettings.h>
+#include <zsLib/String.h>
+#include <zsLib/Log.h>
+
+#include <ortc/services/IICESocket.h>
+#include <ortc/services/IICESocketSession.h>
+#include <ortc/services/ITURNSocket.h>
+#include <ortc/services/STUNPacket.h>
+#include <ortc/services/IHelper.h>
+#include <ortc/services/internal/services_ICESocketSession.h>
+
+#include "config.h"
+#include "testing.h"
+
+#include <list>
+#include <map>
+#include <vector>
+#include <random>
+#include <cstring>
+
+#define ORTC_SERVICE_TEST_TURN_SERVER_DEFAULT_LIFETIME_IN_SECONDS   (600)
+#define ORTC_SERVICE_TEST_TURN_SERVER_MAX_LIFETIME_IN_SECONDS       (3600)
+#define ORTC_SERVICE_TEST_TURN_SERVER_PERMISSION_LIFETIME_IN_SECONDS (300)
+#define ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_LIFETIME_IN_SECONDS   (600)
+
+#define ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MIN                   (0x4000)
+#define ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MAX                   (0x7FFF)
+
+#define ORTC_SERVICE_TEST_TURN_SERVER_READ_BUFFER_SIZE              (1 << (sizeof(WORD)*8))
+
+namespace ortc { namespace services { namespace test { ZS_DECLARE_SUBSYSTEM(ortc_services_test) } } }
+
+using zsLib::BYTE;
+using zsLib::WORD;
+using zsLib::DWORD;
+using zsLib::QWORD;
+using zsLib::ULONG;
+using zsLib::PUID;
+using zsLib::Time;
+using zsLib::Seconds;
+using zsLib::Milliseconds;
+using zsLib::Microseconds;
+using zsLib::IPAddress;
+using zsLib::String;
+using zsLib::Socket;
+using zsLib::SocketPtr;
+using zsLib::IMessageQueue;
+using zsLib::RecursiveLock;
+using zsLib::AutoRecursiveLock;
+using namespace ortc::services;
+using namespace ortc::services::test;
+
+namespace ortc
+{
+  namespace services
+  {
+    namespace test
+    {
+      ZS_DECLARE_CLASS_PTR(LocalTURNServer);
+      ZS_DECLARE_CLASS_PTR(TestTURNServerClient);
+      ZS_DECLARE_CLASS_PTR(TestTURNServerICEClient);
+
+      //-----------------------------------------------------------------------
+      static size_t dwordBoundary(size_t length)
+      {
+        if (0 == (length % sizeof(DWORD)))
+          return length;
+        return length + (sizeof(DWORD) - (length % sizeof(DWORD)));
+      }
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark LocalTURNServer
+      #pragma mark
+
+      // A minimal in-process RFC 5766 TURN server so TURN behaviour can be
+      // exercised without any external infrastructure. Clients connect over
+      // UDP or TCP and use long term credentials (a 401 challenge is always
+      // issued first). Allocations relay over UDP only. Every packet the
+      // server emits (to clients or to peers) can be delayed and, on UDP legs,
+      // randomly dropped.
+      class LocalTURNServer : public zsLib::MessageQueueAssociator,
+                              public zsLib::ISocketDelegate,
+                              public zsLib::ITimerDelegate
+      {
+      public:
+        struct Impairments
+        {
+          const char *mName {"clean"};
+
+          Milliseconds mLatency {};                   // added to every packet the server sends
+          ULONG mLossPercent {};                      // random loss on UDP legs (percent x 100, i.e. 150 = 1.5%)
+          DWORD mSeed {1};
+        };
+
+        struct Stats
+        {
+          ULONG mRequests {};
+          ULONG mChallenges {};
+          ULONG mAllocations {};
+          ULONG mPermissions {};
+          ULONG mChannelBinds {};
+          ULONG mPacketsToPeers {};
+          ULONG mPacketsToClients {};
+          ULONG mPacketsDenied {};
+          ULONG mPacketsLost {};
+          QWORD mBytesRelayed {};
+        };
+
+      protected:
+        ZS_DECLARE_STRUCT_PTR(Connection);
+        ZS_DECLARE_STRUCT_PTR(Allocation);
+
+        struct Connection
+        {
+          SocketPtr mSocket;
+          IPAddress mRemoteIP;
+          std::vector<BYTE> mReadBuffer;              // received but not yet framed
+          std::vector<BYTE> mWriteBuffer;             // waiting for the socket to become writable
+        };
+
+        struct Channel
+        {
+          IPAddress mPeerIP;
+          Time mExpires;
+        };
+
+        typedef std::map<String, Time> PermissionMap; // peer address (without port) -> expiry
+        typedef std::map<WORD, Channel> ChannelMap;
+        typedef std::map<String, WORD> PeerChannelMap;// peer address (with port) -> channel
+
+        struct Allocation
+        {
+          String mKey;
+          IPAddress mClientIP;
+          ConnectionWeakPtr mConnection;              // empty when the client uses UDP
+
+          SocketPtr mRelaySocket;
+          IPAddress mRelayedIP;
+          Time mExpires;
+
+          PermissionMap mPermissions;
+          ChannelMap mChannels;
+          PeerChannelMap mPeerChannels;
+        };
+
+        struct PendingPacket
+        {
+          SocketPtr mUDPSocket;
+          IPAddress mDestination;
+          ConnectionPtr mConnection;
+          SecureByteBlockPtr mBuffer;
+        };
+
+        typedef std::map<SocketPtr, ConnectionPtr> ConnectionMap;
+        typedef std::map<String, AllocationPtr> AllocationMap;
+        typedef std::map<SocketPtr, AllocationPtr> RelayMap;
+        typedef std::multimap<Time, PendingPacket> PendingPacketMap;
+
+      private:
+        //---------------------------------------------------------------------
+        LocalTURNServer(
+                        zsLib::IMessageQueuePtr queue,
+                        const char *username,
+                        const char *password,
+                        const char *realm,
+                        const IPAddress &bindIP
+                        ) :
+          zsLib::MessageQueueAssociator(queue),
+          mUsername(username),
+          mPassword(password),
+          mRealm(realm),
+          mNonce(IHelper::randomString(16)),
+          mBindIP(bindIP),
+          mRandom(1)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          IPAddress bindIP(mBindIP);
+          bindIP.setPort(0);
+
+          mUDPSocket = Socket::createUDP();
+          mUDPSocket->bind(bindIP);
+          mUDPSocket->setBlocking(false);
+          mUDPSocket->setDelegate(mThisWeak.lock());
+          mUDPAddress = mUDPSocket->getLocalAddress();
+
+          mTCPListenSocket = Socket::createTCP();
+          mTCPListenSocket->setOptionFlag(Socket::SetOptionFlag::NonBlocking, true);
+          mTCPListenSocket->bind(bindIP);
+          mTCPListenSocket->listen();
+          mTCPListenSocket->setDelegate(mThisWeak.lock()); // set delegate must happen after the listen
+          mTCPAddress = mTCPListenSocket->getLocalAddress();
+
+          mLastHousekeeping = zsLib::now();
+          mTimer = zsLib::ITimer::create(mThisWeak.lock(), Milliseconds(1));
+
+          ZS_LOG_BASIC(log("local TURN server listening") + ZS_PARAM("udp", mUDPAddress.string()) + ZS_PARAM("tcp", mTCPAddress.string()))
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static LocalTURNServerPtr create(
+                                         zsLib::IMessageQueuePtr queue,
+                                         const char *username,
+                                         const char *password,
+                                         const char *realm,
+                                         const IPAddress &bindIP = IPAddress::loopbackV4()
+                                         )
+        {
+          LocalTURNServerPtr pThis(new LocalTURNServer(queue, username, password, realm, bindIP));
+          pThis->mThisWeak = pThis;
+          pThis->init();
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~LocalTURNServer()
+        {
+          shutdown();
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+
+          if (mTimer) {
+            mTimer->cancel();
+            mTimer.reset();
+          }
+
+          for (RelayMap::iterator iter = mRelays.begin(); iter != mRelays.end(); ++iter) {
+            (*iter).first->close();
+          }
+          for (ConnectionMap::iterator iter = mConnections.begin(); iter != mConnections.end(); ++iter) {
+            (*iter).first->close();
+          }
+
+          mRelays.clear();
+          mAllocations.clear();
+          mConnections.clear();
+          mPending.clear();
+
+          if (mUDPSocket) {
+            mUDPSocket->close();
+            mUDPSocket.reset();
+          }
+          if (mTCPListenSocket) {
+            mTCPListenSocket->close();
+            mTCPListenSocket.reset();
+          }
+        }
+
+        //---------------------------------------------------------------------
+        IPAddress getUDPAddress() const {AutoRecursiveLock lock(mLock); return mUDPAddress;}
+        IPAddress getTCPAddress() const {AutoRecursiveLock lock(mLock); return mTCPAddress;}
+
+        //---------------------------------------------------------------------
+        void setImpairments(const Impairments &impairments)
+        {
+          AutoRecursiveLock lock(mLock);
+          mImpairments = impairments;
+          mRandom.seed(impairments.mSeed);
+        }
+
+        //---------------------------------------------------------------------
+        Stats getStats() const
+        {
+          AutoRecursiveLock lock(mLock);
+          return mStats;
+        }
+
+        //---------------------------------------------------------------------
+        size_t getTotalAllocations() const
+        {
+          AutoRecursiveLock lock(mLock);
+          return mAllocations.size();
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark LocalTURNServer => ISocketDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onReadReady(SocketPtr socket)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          if (socket == mUDPSocket) {
+            readUDP();
+            return;
+          }
+
+          if (socket == mTCPListenSocket) {
+            accept();
+            return;
+          }
+
+          {
+            ConnectionMap::iterator found = mConnections.find(socket);
+            if (found != mConnections.end()) {
+              readTCP((*found).second);
+              return;
+            }
+          }
+
+          {
+            RelayMap::iterator found = mRelays.find(socket);
+            if (found != mRelays.end()) {
+              readRelay((*found).second);
+              return;
+            }
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onWriteReady(SocketPtr socket)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          ConnectionMap::iterator found = mConnections.find(socket);
+          if (found == mConnections.end()) return;
+
+          flush((*found).second);
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onException(SocketPtr socket)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          ConnectionMap::iterator found = mConnections.find(socket);
+          if (found == mConnections.end()) {
+            ZS_LOG_WARNING(Detail, log("socket exception") + ZS_PARAM("socket", socket->getSocket()))
+            return;
+          }
+
+          close((*found).second);
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark LocalTURNServer => ITimerDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTimer(zsLib::ITimerPtr timer)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (timer != mTimer) return;
+
+          Time current = zsLib::now();
+
+          while (mPending.size() > 0) {
+            PendingPacketMap::iterator iter = mPending.begin();
+            if ((*iter).first > current) break;
+
+            PendingPacket pending = (*iter).second;
+            mPending.erase(iter);
+
+            transmit(pending.mUDPSocket, pending.mDestination, pending.mConnection, pending.mBuffer);
+          }
+
+          if (mLastHousekeeping + Seconds(1) > current) return;
+          mLastHousekeeping = current;
+
+          expire(current);
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark LocalTURNServer => (internal)
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        Log::Params log(const char *message) const
+        {
+          ElementPtr objectEl = Element::create("LocalTURNServer");
+          IHelper::debugAppend(objectEl, "id", mID);
+          return Log::Params(message, objectEl);
+        }
+
+        //---------------------------------------------------------------------
+        static String toKey(
+                            bool isUDP,
+                            const IPAddress &clientIP
+                            )
+        {
+          return String(isUDP ? "udp:" : "tcp:") + clientIP.string();
+        }
+
+        //---------------------------------------------------------------------
+        bool decide(ULONG percentTimes100)
+        {
+          if (0 == percentTimes100) return false;
+          std::uniform_int_distribution<ULONG> chance(0, 9999);
+          return chance(mRandom) < percentTimes100;
+        }
+
+        //---------------------------------------------------------------------
+        void readUDP()
+        {
+          while (true) {
+            IPAddress source;
+            BYTE buffer[ORTC_SERVICE_TEST_TURN_SERVER_READ_BUFFER_SIZE];
+            bool wouldBlock = false;
+            size_t bytesRead = 0;
+
+            try {
+              bytesRead = mUDPSocket->receiveFrom(source, &(buffer[0]), sizeof(buffer), &wouldBlock);
+            } catch (Socket::Exceptions::Unspecified &) {
+              return;
+            }
+            if (0 == bytesRead) return;
+
+            handleClientPacket(source, ConnectionPtr(), &(buffer[0]), bytesRead);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void readRelay(AllocationPtr allocation)
+        {
+          while (true) {
+            IPAddress peer;
+            BYTE buffer[ORTC_SERVICE_TEST_TURN_SERVER_READ_BUFFER_SIZE];
+            bool wouldBlock = false;
+            size_t bytesRead = 0;
+
+            try {
+              bytesRead = allocation->mRelaySocket->receiveFrom(peer, &(buffer[0]), sizeof(buffer), &wouldBlock);
+            } catch (Socket::Exceptions::Unspecified &) {
+              return;
+            }
+            if (0 == bytesRead) return;
+
+            handlePeerPacket(allocation, peer, &(buffer[0]), bytesRead);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void accept()
+        {
+          IPAddress remoteIP;
+          int noThrowError = 0;
+          SocketPtr socket = mTCPListenSocket->accept(remoteIP, NULL, &noThrowError);
+          if (!socket) return;
+
+          try {
+#ifndef __QNX__
+            socket->setOptionFlag(Socket::SetOptionFlag::IgnoreSigPipe, true);
+#endif //ndef __QNX__
+          } catch(Socket::Exceptions::UnsupportedSocketOption &) {
+          }
+          socket->setOptionFlag(Socket::SetOptionFlag::NonBlocking, true);
+          socket->setDelegate(mThisWeak.lock());
+
+          ConnectionPtr connection(make_shared<Connection>());
+          connection->mSocket = socket;
+          connection->mRemoteIP = remoteIP;
+          mConnections[socket] = connection;
+
+          ZS_LOG_DEBUG(log("accepted TCP client") + ZS_PARAM("client", remoteIP.string()))
+        }
+
+        //---------------------------------------------------------------------
+        void readTCP(ConnectionPtr connection)
+        {
+          while (true) {
+            BYTE buffer[ORTC_SERVICE_TEST_TURN_SERVER_READ_BUFFER_SIZE];
+            bool wouldBlock = false;
+            size_t bytesRead = 0;
+
+            try {
+              bytesRead = connection->mSocket->receive(&(buffer[0]), sizeof(buffer), &wouldBlock);
+            } catch (Socket::Exceptions::Unspecified &) {
+              close(connection);
+              return;
+            }
+
+            if (0 == bytesRead) {
+              if (!wouldBlock) {
+                close(connection);
+                return;
+              }
+              break;
+            }
+
+            connection->mReadBuffer.insert(connection->mReadBuffer.end(), &(buffer[0]), &(buffer[bytesRead]));
+          }
+
+          // TCP frames are either whole STUN messages or padded ChannelData
+          while (connection->mReadBuffer.size() >= sizeof(DWORD)) {
+            STUNPacketPtr stun;
+            size_t consumedBytes = 0;
+            STUNPacket::ParseLookAheadStates ahead = STUNPacket::parseStreamIfSTUN(stun, consumedBytes, &(connection->mReadBuffer[0]), connection->mReadBuffer.size(), STUNPacket::ParseStreamOptions(STUNPacket::RFC_5766_TURN, false, "LocalTURNServer", mID));
+
+            switch (ahead) {
+              case STUNPacket::ParseLookAheadState_STUNPacket:  {
+                if ((!stun) || (0 == consumedBytes)) {
+                  close(connection);
+                  return;
+                }
+                // the parsed packet points into the read buffer so handle it before consuming
+                handleClientSTUN(connection->mRemoteIP, connection, stun);
+                if (mConnections.end() == mConnections.find(connection->mSocket)) return;
+                connection->mReadBuffer.erase(connection->mReadBuffer.begin(), connection->mReadBuffer.begin() + consumedBytes);
+                continue;
+              }
+              case STUNPacket::ParseLookAheadState_NotSTUN:     {
+                size_t length = IHelper::getBE16(&(((WORD *)&(connection->mReadBuffer[0]))[1]));
+                size_t frameSize = sizeof(DWORD) + dwordBoundary(length);
+                if (connection->mReadBuffer.size() < frameSize) return;
+
+                handleClientChannelData(connection->mRemoteIP, connection, &(connection->mReadBuffer[0]), sizeof(DWORD) + length);
+                if (mConnections.end() == mConnections.find(connection->mSocket)) return;
+                connection->mReadBuffer.erase(connection->mReadBuffer.begin(), connection->mReadBuffer.begin() + frameSize);
+                continue;
+              }
+              default:                                          return;
+            }
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void close(ConnectionPtr connection)
+        {
+          ZS_LOG_DEBUG(log("TCP client closed") + ZS_PARAM("client", connection->mRemoteIP.string()))
+
+          // allocations made over a TCP connection end with the connection
+          for (AllocationMap::iterator iter = mAllocations.begin(); iter != mAllocations.end(); ) {
+            AllocationMap::iterator current = iter; ++iter;
+            if (connection != (*current).second->mConnection.lock()) continue;
+            remove((*current).second);
+          }
+
+          for (PendingPacketMap::iterator iter = mPending.begin(); iter != mPending.end(); ) {
+            PendingPacketMap::iterator current = iter; ++iter;
+            if (connection == (*current).second.mConnection) mPending.erase(current);
+          }
+
+          mConnections.erase(connection->mSocket);
+          connection->mSocket->close();
+        }
+
+        //---------------------------------------------------------------------
+        void flush(ConnectionPtr connection)
+        {
+          while (connection->mWriteBuffer.size() > 0) {
+            bool wouldBlock = false;
+            size_t sent = 0;
+            try {
+              sent = connection->mSocket->send(&(connection->mWriteBuffer[0]), connection->mWriteBuffer.size(), &wouldBlock);
+            } catch (Socket::Exceptions::Unspecified &) {
+              close(connection);
+              return;
+            }
+            if (0 == sent) return;
+            connection->mWriteBuffer.erase(connection->mWriteBuffer.begin(), connection->mWriteBuffer.begin() + sent);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void deliver(
+                     SocketPtr udpSocket,
+                     const IPAddress &destination,
+                     ConnectionPtr connection,
+                     SecureByteBlockPtr buffer
+                     )
+        {
+          if (!buffer) return;
+
+          if ((!connection) &&
+              (decide(mImpairments.mLossPercent))) {
+            ++mStats.mPacketsLost;
+            return;
+          }
+
+          if (Milliseconds() == mImpairments.mLatency) {
+            transmit(udpSocket, destination, connection, buffer);
+            return;
+          }
+
+          PendingPacket pending;
+          pending.mUDPSocket = udpSocket;
+          pending.mDestination = destination;
+          pending.mConnection = connection;
+          pending.mBuffer = buffer;
+
+          // equal times keep their insertion order so TCP streams are never reordered
+          mPending.insert(PendingPacketMap::value_type(zsLib::now() + mImpairments.mLatency, pending));
+        }
+
+        //---------------------------------------------------------------------
+        void transmit(
+                      SocketPtr udpSocket,
+                      const IPAddress &destination,
+                      ConnectionPtr connection,
+                      SecureByteBlockPtr buffer
+                      )
+        {
+          if (connection) {
+            if (mConnections.end() == mConnections.find(connection->mSocket)) return;
+            connection->mWriteBuffer.insert(connection->mWriteBuffer.end(), buffer->BytePtr(), buffer->BytePtr() + buffer->SizeInBytes());
+            flush(connection);
+            return;
+          }
+
+          if (!udpSocket) return;
+
+          try {
+            bool wouldBlock = false;
+            udpSocket->sendTo(destination, buffer->BytePtr(), buffer->SizeInBytes(), &wouldBlock);
+          } catch (Socket::Exceptions::Unspecified &) {
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void sendToClient(
+                          const IPAddress &clientIP,
+                          ConnectionPtr connection,
+                          SecureByteBlockPtr buffer
+                          )
+        {
+          deliver(connection ? SocketPtr() : mUDPSocket, clientIP, connection, buffer);
+        }
+
+        //---------------------------------------------------------------------
+        void sendResponse(
+                          const IPAddress &clientIP,
+                          ConnectionPtr connection,
+                          STUNPacketPtr response
+                          )
+        {
+          response->mUsername = mUsername;
+          response->mPassword = mPassword;
+          response->mRealm = mRealm;
+          response->mCredentialMechanism = STUNPacket::CredentialMechanisms_LongTerm;
+
+          sendToClient(clientIP, connection, response->packetize(STUNPacket::RFC_5766_TURN));
+        }
+
+        //---------------------------------------------------------------------
+        void sendError(
+                       const IPAddress &clientIP,
+                       ConnectionPtr connection,
+                       STUNPacketPtr request,
+                       STUNPacket::ErrorCodes errorCode
+                       )
+        {
+          request->mErrorCode = errorCode;
+          STUNPacketPtr response = STUNPacket::createErrorResponse(request);
+
+          if ((STUNPacket::ErrorCode_Unauthorized == errorCode) ||
+              (STUNPacket::ErrorCode_StaleNonce == errorCode)) {
+            response->mRealm = mRealm;
+            response->mNonce = mNonce;
+          }
+
+          sendToClient(clientIP, connection, response->packetize(STUNPacket::RFC_5766_TURN));
+        }
+
+        //---------------------------------------------------------------------
+        AllocationPtr find(
+                           const IPAddress &clientIP,
+                           ConnectionPtr connection
+                           )
+        {
+          AllocationMap::iterator found = mAllocations.find(toKey(!connection, clientIP));
+          if (found == mAllocations.end()) return AllocationPtr();
+          return (*found).second;
+        }
+
+        //---------------------------------------------------------------------
+        void remove(AllocationPtr allocation)
+        {
+          ZS_LOG_DEBUG(log("removing allocation") + ZS_PARAM("client", allocation->mClientIP.string()) + ZS_PARAM("relayed", allocation->mRelayedIP.string()))
+
+          mAllocations.erase(allocation->mKey);
+          mRelays.erase(allocation->mRelaySocket);
+          allocation->mRelaySocket->close();
+        }
+
+        //---------------------------------------------------------------------
+        void expire(Time current)
+        {
+          for (AllocationMap::iterator iter = mAllocations.begin(); iter != mAllocations.end(); ) {
+            AllocationMap::iterator currentIter = iter; ++iter;
+            AllocationPtr allocation = (*currentIter).second;
+
+            if (allocation->mExpires < current) {
+              remove(allocation);
+              continue;
+            }
+
+            for (PermissionMap::iterator permIter = allocation->mPermissions.begin(); permIter != allocation->mPermissions.end(); ) {
+              PermissionMap::iterator currentPerm = permIter; ++permIter;
+              if ((*currentPerm).second < current) allocation->mPermissions.erase(currentPerm);
+            }
+
+            for (ChannelMap::iterator chanIter = allocation->mChannels.begin(); chanIter != allocation->mChannels.end(); ) {
+              ChannelMap::iterator currentChan = chanIter; ++chanIter;
+              if ((*currentChan).second.mExpires >= current) continue;
+              allocation->mPeerChannels.erase((*currentChan).second.mPeerIP.string());
+              allocation->mChannels.erase(currentChan);
+            }
+          }
+        }
+
+        //---------------------------------------------------------------------
+        bool hasPermission(
+                           AllocationPtr allocation,
+                           const IPAddress &peerIP
+                           )
+        {
+          return allocation->mPermissions.end() != allocation->mPermissions.find(peerIP.string(false));
+        }
+
+        //---------------------------------------------------------------------
+        void handleClientPacket(
+                                const IPAddress &source,
+                                ConnectionPtr connection,
+                                const BYTE *buffer,
+                                size_t bufferLengthInBytes
+                                )
+        {
+          if (bufferLengthInBytes < sizeof(DWORD)) return;
+
+          // ChannelData always starts with 0b01 (STUN always starts with 0b00)
+          if (0x40 == (buffer[0] & 0xC0)) {
+            handleClientChannelData(source, connection, buffer, bufferLengthInBytes);
+            return;
+          }
+
+          STUNPacketPtr stun = STUNPacket::parseIfSTUN(buffer, bufferLengthInBytes, STUNPacket::ParseOptions(static_cast<STUNPacket::RFCs>(STUNPacket::RFC_5766_TURN | STUNPacket::RFC_5389_STUN), false, "LocalTURNServer", mID));
+          if (!stun) return;
+
+          handleClientSTUN(source, connection, stun);
+        }
+
+        //---------------------------------------------------------------------
+        void handleClientChannelData(
+                                     const IPAddress &source,
+                                     ConnectionPtr connection,
+                                     const BYTE *buffer,
+                                     size_t bufferLengthInBytes
+                                     )
+        {
+          AllocationPtr allocation = find(source, connection);
+          if (!allocation) return;
+
+          WORD channel = IHelper::getBE16(&(((WORD *)buffer)[0]));
+          size_t length = IHelper::getBE16(&(((WORD *)buffer)[1]));
+          if (bufferLengthInBytes < sizeof(DWORD) + length) return;
+
+          ChannelMap::iterator found = allocation->mChannels.find(channel);
+          if (found == allocation->mChannels.end()) return;
+
+          relayToPeer(allocation, (*found).second.mPeerIP, buffer + sizeof(DWORD), length);
+        }
+
+        //---------------------------------------------------------------------
+        void handleClientSTUN(
+                              const IPAddress &source,
+                              ConnectionPtr connection,
+                              STUNPacketPtr stun
+                              )
+        {
+          if (STUNPacket::Class_Indication == stun->mClass) {
+            if (STUNPacket::Method_Send != stun->mMethod) return;
+
+            AllocationPtr allocation = find(source, connection);
+            if (!allocation) return;
+            if (stun->mPeerAddressList.size() < 1) return;
+            if (!stun->mData) return;
+
+            relayToPeer(allocation, stun->mPeerAddressList.front(), stun->mData, stun->mDataLength);
+            return;
+          }
+
+          if (STUNPacket::Class_Request != stun->mClass) return;
+
+          ++mStats.mRequests;
+
+          if (STUNPacket::Method_Binding == stun->mMethod) {
+            // plain STUN binding so the same server can stand in for a STUN server
+            STUNPacketPtr response = STUNPacket::createResponse(stun);
+            response->mMappedAddress = source;
+            sendToClient(source, connection, response->packetize(STUNPacket::RFC_5389_STUN));
+            return;
+          }
+
+          if (!stun->hasAttribute(STUNPacket::Attribute_MessageIntegrity)) {
+            ++mStats.mChallenges;
+            sendError(source, connection, stun, STUNPacket::ErrorCode_Unauthorized);
+            return;
+          }
+
+          if ((stun->mUsername != mUsername) ||
+              (stun->mRealm != mRealm) ||
+              (!stun->isValidMessageIntegrity(mPassword, mUsername, mRealm))) {
+            ZS_LOG_WARNING(Detail, log("request failed authentication") + ZS_PARAM("client", source.string()) + ZS_PARAM("username", stun->mUsername))
+            sendError(source, connection, stun, STUNPacket::ErrorCode_Unauthorized);
+            return;
+          }
+
+          if (stun->mNonce != mNonce) {
+            sendError(source, connection, stun, STUNPacket::ErrorCode_StaleNonce);
+            return;
+          }
+
+          switch (stun->mMethod) {
+            case STUNPacket::Method_Allocate:         handleAllocate(source, connection, stun); break;
+            case STUNPacket::Method_Refresh:          handleRefresh(source, connection, stun); break;
+            case STUNPacket::Method_CreatePermission: handleCreatePermission(source, connection, stun); break;
+            case STUNPacket::Method_ChannelBind:      handleChannelBind(source, connection, stun); break;
+            default:                                  sendError(source, connection, stun, STUNPacket::ErrorCode_BadRequest); break;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void handleAllocate(
+                            const IPAddress &source,
+                            ConnectionPtr connection,
+                            STUNPacketPtr request
+                            )
+        {
+          AllocationPtr allocation = find(source, connection);
+
+          // DONT-FRAGMENT, EVEN-PORT and MOBILITY-TICKET are silently ignored
+          if (!allocation) {
+            if (STUNPacket::Protocol_UDP != request->mRequestedTransport) {
+              sendError(source, connection, request, STUNPacket::ErrorCode_UnsupportedTransportProtocol);
+              return;
+            }
+
+            IPAddress bindIP(mBindIP);
+            bindIP.setPort(0);
+
+            allocation = make_shared<Allocation>();
+            allocation->mKey = toKey(!connection, source);
+            allocation->mClientIP = source;
+            allocation->mConnection = connection;
+            allocation->mRelaySocket = Socket::createUDP();
+            allocation->mRelaySocket->bind(bindIP);
+            allocation->mRelaySocket->setBlocking(false);
+            allocation->mRelaySocket->setDelegate(mThisWeak.lock());
+            allocation->mRelayedIP = allocation->mRelaySocket->getLocalAddress();
+
+            mAllocations[allocation->mKey] = allocation;
+            mRelays[allocation->mRelaySocket] = allocation;
+            ++mStats.mAllocations;
+
+            ZS_LOG_DEBUG(log("allocated") + ZS_PARAM("client", source.string()) + ZS_PARAM("relayed", allocation->mRelayedIP.string()))
+          }
+          // else - a retransmitted allocate on the same 5-tuple gets the same answer
+
+          DWORD lifetime = (request->mLifetimeIncluded ? request->mLifetime : ORTC_SERVICE_TEST_TURN_SERVER_DEFAULT_LIFETIME_IN_SECONDS);
+          if (lifetime > ORTC_SERVICE_TEST_TURN_SERVER_MAX_LIFETIME_IN_SECONDS) lifetime = ORTC_SERVICE_TEST_TURN_SERVER_MAX_LIFETIME_IN_SECONDS;
+          allocation->mExpires = zsLib::now() + Seconds(lifetime);
+
+          STUNPacketPtr response = STUNPacket::createResponse(request);
+          response->mRelayedAddress = allocation->mRelayedIP;
+          response->mMappedAddress = source;
+          response->mLifetimeIncluded = true;
+          response->mLifetime = lifetime;
+          sendResponse(source, connection, response);
+        }
+
+        //---------------------------------------------------------------------
+        void handleRefresh(
+                           const IPAddress &source,
+                           ConnectionPtr connection,
+                           STUNPacketPtr request
+                           )
+        {
+          AllocationPtr allocation = find(source, connection);
+          if (!allocation) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_AllocationMismatch);
+            return;
+          }
+
+          DWORD lifetime = (request->mLifetimeIncluded ? request->mLifetime : ORTC_SERVICE_TEST_TURN_SERVER_DEFAULT_LIFETIME_IN_SECONDS);
+          if (lifetime > ORTC_SERVICE_TEST_TURN_SERVER_MAX_LIFETIME_IN_SECONDS) lifetime = ORTC_SERVICE_TEST_TURN_SERVER_MAX_LIFETIME_IN_SECONDS;
+
+          if (0 == lifetime) {
+            remove(allocation);
+          } else {
+            allocation->mExpires = zsLib::now() + Seconds(lifetime);
+          }
+
+          STUNPacketPtr response = STUNPacket::createResponse(request);
+          response->mLifetimeIncluded = true;
+          response->mLifetime = lifetime;
+          sendResponse(source, connection, response);
+        }
+
+        //---------------------------------------------------------------------
+        void handleCreatePermission(
+                                    const IPAddress &source,
+                                    ConnectionPtr connection,
+                                    STUNPacketPtr request
+                                    )
+        {
+          AllocationPtr allocation = find(source, connection);
+          if (!allocation) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_AllocationMismatch);
+            return;
+          }
+
+          if (request->mPeerAddressList.size() < 1) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_BadRequest);
+            return;
+          }
+
+          Time expires = zsLib::now() + Seconds(ORTC_SERVICE_TEST_TURN_SERVER_PERMISSION_LIFETIME_IN_SECONDS);
+          for (STUNPacket::PeerAddressList::iterator iter = request->mPeerAddressList.begin(); iter != request->mPeerAddressList.end(); ++iter) {
+            allocation->mPermissions[(*iter).string(false)] = expires;
+            ++mStats.mPermissions;
+          }
+
+          sendResponse(source, connection, STUNPacket::createResponse(request));
+        }
+
+        //---------------------------------------------------------------------
+        void handleChannelBind(
+                               const IPAddress &source,
+                               ConnectionPtr connection,
+                               STUNPacketPtr request
+                               )
+        {
+          AllocationPtr allocation = find(source, connection);
+          if (!allocation) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_AllocationMismatch);
+            return;
+          }
+
+          WORD channel = request->mChannelNumber;
+          if ((channel < ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MIN) ||
+              (channel > ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MAX) ||
+              (1 != request->mPeerAddressList.size())) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_BadRequest);
+            return;
+          }
+
+          const IPAddress &peerIP = request->mPeerAddressList.front();
+
+          // a channel can only ever be bound to one peer and a peer to one channel
+          ChannelMap::iterator foundChannel = allocation->mChannels.find(channel);
+          if ((foundChannel != allocation->mChannels.end()) &&
+              ((*foundChannel).second.mPeerIP != peerIP)) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_BadRequest);
+            return;
+          }
+          PeerChannelMap::iterator foundPeer = allocation->mPeerChannels.find(peerIP.string());
+          if ((foundPeer != allocation->mPeerChannels.end()) &&
+              ((*foundPeer).second != channel)) {
+            sendError(source, connection, request, STUNPacket::ErrorCode_BadRequest);
+            return;
+          }
+
+          Time current = zsLib::now();
+
+          Channel &info = allocation->mChannels[channel];
+          info.mPeerIP = peerIP;
+          info.mExpires = current + Seconds(ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_LIFETIME_IN_SECONDS);
+          allocation->mPeerChannels[peerIP.string()] = channel;
+
+          // binding a channel installs or refreshes the permission too
+          allocation->mPermissions[peerIP.string(false)] = current + Seconds(ORTC_SERVICE_TEST_TURN_SERVER_PERMISSION_LIFETIME_IN_SECONDS);
+          ++mStats.mChannelBinds;
+
+          sendResponse(source, connection, STUNPacket::createResponse(request));
+        }
+
+        //---------------------------------------------------------------------
+        void relayToPeer(
+                         AllocationPtr allocation,
+                         const IPAddress &peerIP,
+                         const BYTE *buffer,
+                         size_t bufferLengthInBytes
+                         )
+        {
+          if (!hasPermission(allocation, peerIP)) {
+            ++mStats.mPacketsDenied;
+            return;
+          }
+
+          ++mStats.mPacketsToPeers;
+          mStats.mBytesRelayed += bufferLengthInBytes;
+
+          deliver(allocation->mRelaySocket, peerIP, ConnectionPtr(), make_shared<SecureByteBlock>(buffer, bufferLengthInBytes));
+        }
+
+        //---------------------------------------------------------------------
+        void handlePeerPacket(
+                              AllocationPtr allocation,
+                              const IPAddress &peerIP,
+                              const BYTE *buffer,
+                              size_t bufferLengthInBytes
+                              )
+        {
+          if (!hasPermission(allocation, peerIP)) {
+            ++mStats.mPacketsDenied;
+            return;
+          }
+
+          ConnectionPtr connection = allocation->mConnection.lock();
+          bool isUDP = (String("udp:") == allocation->mKey.substr(0, strlen("udp:")));
+          if ((!isUDP) && (!connection)) return;
+
+          SecureByteBlockPtr packet;
+
+          PeerChannelMap::iterator found = allocation->mPeerChannels.find(peerIP.string());
+          if (found != allocation->mPeerChannels.end()) {
+            // ChannelData is padded to a DWORD boundary over TCP only
+            size_t padded = (isUDP ? bufferLengthInBytes : dwordBoundary(bufferLengthInBytes));
+            packet = make_shared<SecureByteBlock>(sizeof(DWORD) + padded);
+
+            BYTE *pos = packet->BytePtr();
+            IHelper::setBE16(&(((WORD *)pos)[0]), (*found).second);
+            IHelper::setBE16(&(((WORD *)pos)[1]), static_cast<WORD>(bufferLengthInBytes));
+            memcpy(pos + sizeof(DWORD), buffer, bufferLengthInBytes);
+            if (padded > bufferLengthInBytes) {
+              memset(pos + sizeof(DWORD) + bufferLengthInBytes, 0, padded - bufferLengthInBytes);
+            }
+          } else {
+            STUNPacketPtr indication = STUNPacket::createIndication(STUNPacket::Method_Data);
+            indication->mPeerAddressList.push_back(peerIP);
+            indication->mData = buffer;
+            indication->mDataLength = bufferLengthInBytes;
+            packet = indication->packetize(STUNPacket::RFC_5766_TURN);
+          }
+
+          ++mStats.mPacketsToClients;
+          mStats.mBytesRelayed += bufferLengthInBytes;
+
+          sendToClient(allocation->mClientIP, connection, packet);
+        }
+
+      private:
+        LocalTURNServerWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+        zsLib::AutoPUID mID;
+
+        String mUsername;
+        String mPassword;
+        String mRealm;
+        String mNonce;
+
+        IPAddress mBindIP;
+        IPAddress mUDPAddress;
+        IPAddress mTCPAddress;
+
+        SocketPtr mUDPSocket;
+        SocketPtr mTCPListenSocket;
+
+        Impairments mImpairments;
+        std::mt19937 mRandom;
+        Stats mStats;
+
+        zsLib::ITimerPtr mTimer;
+        Time mLastHousekeeping;
+
+        ConnectionMap mConnections;
+        AllocationMap mAllocations;
+        RelayMap mRelays;
+        PendingPacketMap mPending;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark LegacyChannelDemux
+      #pragma mark
+
+      // A copy of how TURNSocket::handleChannelData used to demultiplex
+      // channel data: the socket lock is taken once to validate the source
+      // and again to look the channel up in a std::map. Only used to replay
+      // a captured channel data stream for the before/after comparison.
+      class LegacyChannelDemux
+      {
+      protected:
+        ZS_DECLARE_STRUCT_PTR(ChannelInfo)
+
+        struct ChannelInfo
+        {
+          WORD mChannelNumber {};
+          IPAddress mPeerAddress;
+        };
+
+        typedef std::map<WORD, ChannelInfoPtr> ChannelNumberMap;
+
+      public:
+        //---------------------------------------------------------------------
+        LegacyChannelDemux(
+                           ITURNSocketDelegatePtr delegate,
+                           const IPAddress &serverIP
+                           ) :
+          mDelegate(delegate),
+          mServerIP(serverIP)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void addChannel(
+                        WORD channel,
+                        const IPAddress &peerAddress
+                        )
+        {
+          AutoRecursiveLock lock(mLock);
+          ChannelInfoPtr info(std::make_shared<ChannelInfo>());
+          info->mChannelNumber = channel;
+          info->mPeerAddress = peerAddress;
+          mChannelNumberMap[channel] = info;
+        }
+
+        //---------------------------------------------------------------------
+        bool handleChannelData(
+                               IPAddress fromIPAddress,
+                               const BYTE *buffer,
+                               size_t bufferLengthInBytes
+                               )
+        {
+          {
+            AutoRecursiveLock lock(mLock);
+            if (!mDelegate) return false;
+            if (fromIPAddress != mServerIP) return false;
+          }
+
+          if (bufferLengthInBytes < sizeof(DWORD)) return false;
+
+          WORD channel = IHelper::getBE16(&(((WORD *)buffer)[0]));
+          WORD length = IHelper::getBE16(&(((WORD *)buffer)[1]));
+
+          if ((channel < ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MIN) ||
+              (channel > ORTC_SERVICE_TEST_TURN_SERVER_CHANNEL_MAX)) return false;
+
+          if (length > (bufferLengthInBytes-sizeof(DWORD))) return false;
+
+          const BYTE *realBuffer = (const BYTE *)(&(((WORD *)buffer)[2]));
+
+          ITURNSocketDelegatePtr delegate;
+          IPAddress peerAddress;
+
+          {
+            AutoRecursiveLock lock(mLock);
+
+            delegate = mDelegate;
+
+            ChannelNumberMap::iterator found = mChannelNumberMap.find(channel);
+            if (mChannelNumberMap.end() == found) return false;
+
+            ChannelInfoPtr info = (*found).second;
+            peerAddress = info->mPeerAddress;
+          }
+
+          delegate->handleTURNSocketReceivedPacket(ITURNSocketPtr(), peerAddress, realBuffer, length);
+          return true;
+        }
+
+      private:
+        mutable RecursiveLock mLock;
+
+        ITURNSocketDelegatePtr mDelegate;
+        IPAddress mServerIP;
+
+        ChannelNumberMap mChannelNumberMap;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestTURNServerClient
+      #pragma mark
+
+      // Drives a TURNSocket against the local server. Once allocated, data is
+      // sent through the relay to a local peer socket which echoes every
+      // packet back through the relay so both relay directions are measured.
+      // When channels are used the echoed channel data is also captured and
+      // replayed through the old and the current demultiplexer.
+      class TestTURNServerClient : public zsLib::MessageQueueAssociator,
+                                   public ITURNSocketDelegate,
+                                   public zsLib::ISocketDelegate,
+                                   public zsLib::ITimerDelegate
+      {
+      public:
+        struct Result
+        {
+          bool mAllocated {};
+          bool mCompleted {};
+          Milliseconds mAllocationTime {};
+
+          ULONG mPacketsSent {};
+          ULONG mPacketsAtPeer {};
+          ULONG mPacketsEchoed {};
+          QWORD mBytesEchoed {};
+          Milliseconds mDuration {};
+          ULONG mThroughputKbps {};
+
+          ULONG mDemuxPackets {};
+          Microseconds mLegacyDemuxDuration {};
+          Microseconds mTableDemuxDuration {};
+          ULONG mLegacyDemuxDelivered {};
+          ULONG mTableDemuxDelivered {};
+        };
+
+      private:
+        //---------------------------------------------------------------------
+        TestTURNServerClient(
+                             zsLib::IMessageQueuePtr queue,
+                             bool useChannelBinding,
+                             size_t packetSize,
+                             ULONG packetsPerTick
+                             ) :
+          zsLib::MessageQueueAssociator(queue),
+          mUseChannelBinding(useChannelBinding),
+          mPacketSize(packetSize),
+          mPacketsPerTick(packetsPerTick)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init(
+                  const IPAddress &serverIP,
+                  bool useUDP
+                  )
+        {
+          AutoRecursiveLock lock(mLock);
+
+          IPAddress bindIP(IPAddress::loopbackV4());
+
+          mSocket = Socket::createUDP();
+          mSocket->bind(bindIP);
+          mSocket->setBlocking(false);
+          mSocket->setDelegate(mThisWeak.lock());
+
+          mPeerSocket = Socket::createUDP();
+          mPeerSocket->bind(bindIP);
+          mPeerSocket->setBlocking(false);
+          mPeerSocket->setDelegate(mThisWeak.lock());
+          mPeerIP = mPeerSocket->getLocalAddress();
+
+          ITURNSocket::CreationOptions options;
+          options.mServers.push_back(String("turn:") + serverIP.string() + (useUDP ? "?transport=udp" : "?transport=tcp"));
+          options.mUsername = ORTC_SERVICE_TEST_TURN_SERVER_USERNAME;
+          options.mPassword = ORTC_SERVICE_TEST_TURN_SERVER_PASSWORD;
+          options.mUseChannelBinding = mUseChannelBinding;
+
+          mStarted = zsLib::now();
+          mTURNSocket = ITURNSocket::create(getAssociatedMessageQueue(), mThisWeak.lock(), options);
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static TestTURNServerClientPtr create(
+                                              zsLib::IMessageQueuePtr queue,
+                                              const IPAddress &serverIP,
+                                              bool useUDP,
+                                              bool useChannelBinding,
+                                              size_t packetSize,
+                                              ULONG packetsPerTick
+                                              )
+        {
+          TestTURNServerClientPtr pThis(new TestTURNServerClient(queue, useChannelBinding, packetSize, packetsPerTick));
+          pThis->mThisWeak = pThis;
+          pThis->init(serverIP, useUDP);
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~TestTURNServerClient()
+        {
+          cancel();
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mTimer) {
+            mTimer->cancel();
+            mTimer.reset();
+          }
+          if (mTURNSocket) {
+            mTURNSocket->shutdown();
+          }
+        }
+
+        //---------------------------------------------------------------------
+        void cancel()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (mTimer) {
+            mTimer->cancel();
+            mTimer.reset();
+          }
+          mTURNSocket.reset();
+          if (mSocket) {
+            mSocket->close();
+            mSocket.reset();
+          }
+          if (mPeerSocket) {
+            mPeerSocket->close();
+            mPeerSocket.reset();
+          }
+        }
+
+        //---------------------------------------------------------------------
+        bool isComplete() const {AutoRecursiveLock lock(mLock); return mResult.mCompleted;}
+        bool isShutdown() const {AutoRecursiveLock lock(mLock); return !mTURNSocket;}
+
+        //---------------------------------------------------------------------
+        Result getResult() const
+        {
+          AutoRecursiveLock lock(mLock);
+          Result result = mResult;
+          if ((Time() != mFirstSent) &&
+              (Time() != mLastEchoed) &&
+              (mLastEchoed > mFirstSent)) {
+            result.mDuration = zsLib::toMilliseconds(mLastEchoed - mFirstSent);
+            if (Milliseconds() != result.mDuration) {
+              result.mThroughputKbps = static_cast<ULONG>((result.mBytesEchoed * 8) / result.mDuration.count());
+            }
+          }
+          return result;
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestTURNServerClient => ITURNSocketDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTURNSocketStateChanged(
+                                              ITURNSocketPtr socket,
+                                              TURNSocketStates state
+                                              )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (socket != mTURNSocket) return;
+
+          switch (state) {
+            case ITURNSocket::TURNSocketState_Ready: {
+              mResult.mAllocated = true;
+              mResult.mAllocationTime = zsLib::toMilliseconds(zsLib::now() - mStarted);
+              mTimer = zsLib::ITimer::create(mThisWeak.lock(), Milliseconds(ORTC_SERVICE_TEST_TURN_SERVER_TICK_IN_MILLISECONDS));
+              break;
+            }
+            case ITURNSocket::TURNSocketState_Shutdown: {
+              mResult.mCompleted = true;
+              mTURNSocket.reset();
+              break;
+            }
+            default: break;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void handleTURNSocketReceivedPacket(
+                                                    ITURNSocketPtr socket,
+                                                    IPAddress source,
+                                                    const BYTE *packet,
+                                                    size_t packetLengthInBytes
+                                                    )
+        {
+          AutoRecursiveLock lock(mLock);
+          TESTING_CHECK(source == mPeerIP)
+
+          if (mReplaying) {
+            ++mReplayDelivered;
+            return;
+          }
+
+          ++mResult.mPacketsEchoed;
+          mResult.mBytesEchoed += packetLengthInBytes;
+          mLastEchoed = zsLib::now();
+        }
+
+        //---------------------------------------------------------------------
+        virtual bool notifyTURNSocketSendPacket(
+                                                ITURNSocketPtr socket,
+                                                IPAddress destination,
+                                                const BYTE *packet,
+                                                size_t packetLengthInBytes
+                                                )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (!mSocket) return false;
+          return 0 != mSocket->sendTo(destination, packet, packetLengthInBytes);
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onTURNSocketWriteReady(ITURNSocketPtr socket)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestTURNServerClient => ISocketDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onReadReady(SocketPtr socket)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          while (true) {
+            IPAddress source;
+            BYTE buffer[ORTC_SERVICE_TEST_TURN_SERVER_READ_BUFFER_SIZE];
+            bool wouldBlock = false;
+            size_t bytesRead = 0;
+
+            try {
+              if (socket == mSocket) {
+                bytesRead = mSocket->receiveFrom(source, &(buffer[0]), sizeof(buffer), &wouldBlock);
+              } else if (socket == mPeerSocket) {
+                bytesRead = mPeerSocket->receiveFrom(source, &(buffer[0]), sizeof(buffer), &wouldBlock);
+              }
+            } catch (Socket::Exceptions::Unspecified &) {
+              return;
+            }
+            if (0 == bytesRead) return;
+
+            if (socket == mPeerSocket) {
+              // the peer echoes everything straight back to the relayed address
+              ++mResult.mPacketsAtPeer;
+              mPeerSocket->sendTo(source, &(buffer[0]), bytesRead);
+              continue;
+            }
+
+            if (!mTURNSocket) return;
+            if (mTURNSocket->handleChannelData(source, &(buffer[0]), bytesRead)) {
+              if (mCaptured.size() < ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_CAPTURE_PACKETS) {
+                mServerIP = source;
+                mCaptured.push_back(CapturedPacket(&(buffer[0]), &(buffer[bytesRead])));
+              }
+              continue;
+            }
+
+            STUNPacketPtr stun = STUNPacket::parseIfSTUN(&(buffer[0]), bytesRead, static_cast<STUNPacket::RFCs>(STUNPacket::RFC_5766_TURN | STUNPacket::RFC_5389_STUN));
+            if (!stun) continue;
+            mTURNSocket->handleSTUNPacket(source, stun);
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onWriteReady(SocketPtr socket)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onException(SocketPtr socket)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        #pragma mark
+        #pragma mark TestTURNServerClient => ITimerDelegate
+        #pragma mark
+
+        //---------------------------------------------------------------------
+        virtual void onTimer(zsLib::ITimerPtr timer)
+        {
+          AutoRecursiveLock lock(mLock);
+          if (timer != mTimer) return;
+          if (!mTURNSocket) return;
+
+          Time current = zsLib::now();
+
+          if (Time() == mFirstSent) mFirstSent = current;
+
+          if (mFirstSent + Seconds(ORTC_SERVICE_TEST_TURN_SERVER_RUN_SECONDS) < current) {
+            // allow the last packets to drain before declaring the run over
+            if (mFirstSent + Seconds(ORTC_SERVICE_TEST_TURN_SERVER_RUN_SECONDS + 1) < current) {
+              replayDemux();
+              shutdown();
+            }
+            return;
+          }
+
+          std::unique_ptr<BYTE[]> buffer(new BYTE[mPacketSize]);
+          for (ULONG loop = 0; loop < mPacketsPerTick; ++loop) {
+            memset(buffer.get(), static_cast<BYTE>(mResult.mPacketsSent), mPacketSize);
+            mTURNSocket->sendPacket(mPeerIP, buffer.get(), mPacketSize, mUseChannelBinding);
+            ++mResult.mPacketsSent;
+          }
+        }
+
+      protected:
+        //---------------------------------------------------------------------
+        // Replays the captured channel data (while the allocation and its
+        // channel are still live) through the old std::map and double lock
+        // demultiplexer and then through TURNSocket::handleChannelData, which
+        // reads the published channel table.
+        void replayDemux()
+        {
+          if (mCaptured.size() < 1) return;
+
+          LegacyChannelDemux legacy(mThisWeak.lock(), mServerIP);
+          for (auto iter = mCaptured.begin(); iter != mCaptured.end(); ++iter) {
+            const CapturedPacket &packet = (*iter);
+            legacy.addChannel(IHelper::getBE16(&(packet[0])), mPeerIP);
+          }
+
+          mResult.mDemuxPackets = static_cast<ULONG>(mCaptured.size() * ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_REPLAYS);
+          mReplaying = true;
+
+          mReplayDelivered = 0;
+          Time start = zsLib::now();
+          for (ULONG replay = 0; replay < ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_REPLAYS; ++replay) {
+            for (auto iter = mCaptured.begin(); iter != mCaptured.end(); ++iter) {
+              const CapturedPacket &packet = (*iter);
+              legacy.handleChannelData(mServerIP, &(packet[0]), packet.size());
+            }
+          }
+          mResult.mLegacyDemuxDuration = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+          mResult.mLegacyDemuxDelivered = mReplayDelivered;
+
+          mReplayDelivered = 0;
+          start = zsLib::now();
+          for (ULONG replay = 0; replay < ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_REPLAYS; ++replay) {
+            for (auto iter = mCaptured.begin(); iter != mCaptured.end(); ++iter) {
+              const CapturedPacket &packet = (*iter);
+              mTURNSocket->handleChannelData(mServerIP, &(packet[0]), packet.size());
+            }
+          }
+          mResult.mTableDemuxDuration = std::chrono::duration_cast<Microseconds>(zsLib::now() - start);
+          mResult.mTableDemuxDelivered = mReplayDelivered;
+
+          mReplaying = false;
+        }
+
+      private:
+        typedef std::vector<BYTE> CapturedPacket;
+        typedef std::list<CapturedPacket> CapturedPacketList;
+
+        TestTURNServerClientWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+
+        bool mUseChannelBinding {};
+        size_t mPacketSize {};
+        ULONG mPacketsPerTick {};
+
+        SocketPtr mSocket;
+        SocketPtr mPeerSocket;
+        IPAddress mPeerIP;
+
+        ITURNSocketPtr mTURNSocket;
+        zsLib::ITimerPtr mTimer;
+
+        Time mStarted;
+        Time mFirstSent;
+        Time mLastEchoed;
+
+        IPAddress mServerIP;
+        CapturedPacketList mCaptured;
+        bool mReplaying {};
+        ULONG mReplayDelivered {};
+
+        Result mResult;
+      };
+
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      //-----------------------------------------------------------------------
+      #pragma mark
+      #pragma mark TestTURNServerICEClient
+      #pragma mark
+
+      // Measures how long an ICE socket takes to offer a relayed candidate
+      // when its only TURN and STUN server is the local server, and how long
+      // a session between two such sockets takes to nominate a pair.
+      class TestTURNServerICEClient : public zsLib::MessageQueueAssociator,
+                                      public IICESocketDelegate,
+                                      public IICESocketSessionDelegate
+      {
+      private:
+        //---------------------------------------------------------------------
+        TestTURNServerICEClient(zsLib::IMessageQueuePtr queue) :
+          zsLib::MessageQueueAssociator(queue)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void init(const IPAddress &serverIP)
+        {
+          AutoRecursiveLock lock(mLock);
+
+          IICESocket::TURNServerInfoList turnServers;
+          IICESocket::STUNServerInfoList stunServers;
+
+          IICESocket::TURNServerInfoPtr turnInfo = IICESocket::TURNServerInfo::create();
+          turnInfo->mTURNServer = String("turn:") + serverIP.string() + "?transport=udp";
+          turnInfo->mTURNServerUsername = ORTC_SERVICE_TEST_TURN_SERVER_USERNAME;
+          turnInfo->mTURNServerPassword = ORTC_SERVICE_TEST_TURN_SERVER_PASSWORD;
+
+          IICESocket::STUNServerInfoPtr stunInfo = IICESocket::STUNServerInfo::create();
+          stunInfo->mSTUNServer = serverIP.string();
+
+          turnServers.push_back(turnInfo);
+          stunServers.push_back(stunInfo);
+
+          mStarted = zsLib::now();
+          mICESocket = IICESocket::create(getAssociatedMessageQueue(), mThisWeak.lock(), turnServers, stunServers);
+        }
+
+      public:
+        //---------------------------------------------------------------------
+        static TestTURNServerICEClientPtr create(
+                                                 zsLib::IMessageQueuePtr queue,
+                                                 const IPAddress &serverIP
+                                                 )
+        {
+          TestTURNServerICEClientPtr pThis(new TestTURNServerICEClient(queue));
+          pThis->mThisWeak = pThis;
+          pThis->init(serverIP);
+          return pThis;
+        }
+
+        //---------------------------------------------------------------------
+        ~TestTURNServerICEClient()
+        {
+          mSession.reset();
+          mICESocket.reset();
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketStateChanged(
+                                             IICESocketPtr socket,
+                                             ICESocketStates state
+                                             )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (IICESocket::ICESocketState_Shutdown == state) {
+            mICESocket.reset();
+            return;
+          }
+          mReady = (IICESocket::ICESocketState_Ready == state);
+          checkCandidates(socket);
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketCandidatesChanged(IICESocketPtr socket)
+        {
+          AutoRecursiveLock lock(mLock);
+          checkCandidates(socket);
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionStateChanged(
+                                                    IICESocketSessionPtr session,
+                                                    ICESocketSessionStates state
+                                                    )
+        {
+          AutoRecursiveLock lock(mLock);
+          if (session != mSession) return;
+          if (mNominated) return;
+
+          switch (state) {
+            case IICESocketSession::ICESocketSessionState_Nominated:
+            case IICESocketSession::ICESocketSessionState_Completed:  {
+              mNominated = true;
+              mNominationTime = zsLib::toMilliseconds(zsLib::now() - mSessionStarted);
+              break;
+            }
+            default:  break;
+          }
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionNominationChanged(IICESocketSessionPtr session)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual void handleICESocketSessionReceivedPacket(
+                                                          IICESocketSessionPtr session,
+                                                          const BYTE *buffer,
+                                                          size_t bufferLengthInBytes
+                                                          )
+        {
+        }
+
+        //---------------------------------------------------------------------
+        virtual bool handleICESocketSessionReceivedSTUNPacket(
+                                                              IICESocketSessionPtr session,
+                                                              STUNPacketPtr stun,
+                                                              const String &localUsernameFrag,
+                                                              const String &remoteUsernameFrag
+                                                              )
+        {
+          return false;
+        }
+
+        //---------------------------------------------------------------------
+        virtual void onICESocketSessionWriteReady(IICESocketSessionPtr session)
+        {
+        }
+
+        //---------------------------------------------------------------------
+        void connect(
+                     TestTURNServerICEClientPtr remote,
+                     bool controlling
+                     )
+        {
+          IICESocket::CandidateList remoteCandidates;
+          String remoteUsernameFrag;
+          String remotePassword;
+          remote->getCandidateInfo(remoteCandidates, remoteUsernameFrag, remotePassword);
+
+          AutoRecursiveLock lock(mLock);
+          if (!mICESocket) return;
+
+          mNominated = false;
+          mSessionStarted = zsLib::now();
+          mSession = IICESocketSession::create(
+                                               mThisWeak.lock(),
+                                               mICESocket,
+                                               remoteUsernameFrag,
+                                               remotePassword,
+                                               IICESocket::CandidateList(),
+                                               controlling ? IICESocket::ICEControl_Controlling : IICESocket::ICEControl_Controlled
+                                               );
+
+          // remote candidates are trickled into the live session one at a time
+          for (IICESocket::CandidateList::iterator iter = remoteCandidates.begin(); iter != remoteCandidates.end(); ++iter) {
+            mSession->addRemoteCandidate(*iter);
+          }
+          mSession->endOfRemoteCandidates();
+        }
+
+        //---------------------------------------------------------------------
+        void getCandidateInfo(
+                              IICESocket::CandidateList &outCandidates,
+                              String &outUsernameFrag,
+                              String &outPassword
+                              ) const
+        {
+          AutoRecursiveLock lock(mLock);
+          if (!mICESocket) return;
+          mICESocket->getLocalCandidates(outCandidates);
+          outUsernameFrag = mICESocket->getUsernameFrag();
+          outPassword = mICESocket->getPassword();
+        }
+
+        //---------------------------------------------------------------------
+        void closeSession()
+        {
+          AutoRecursiveLock lock(mLock);
+          if (!mSession) return;
+          mSession->close();
+          mSession.reset();
+        }
+
+        //---------------------------------------------------------------------
+        void shutdown()
+        {
+          AutoRecursiveLock lock(mLock);
+          closeSession();
+          if (!mICESocket) return;
+          mICESocket->shutdown();
+        }
+
+        //---------------------------------------------------------------------
+        bool isReady() const {AutoRecursiveLock lock(mLock); return mReady && mRelayed;}
+        bool isNominated() const {AutoRecursiveLock lock(mLock); return mNominated;}
+        Milliseconds getNominationTime() const {AutoRecursiveLock lock(mLock); return mNominationTime;}
+        bool hasRelayedCandidate() const {AutoRecursiveLock lock(mLock); return mRelayed;}
+        bool isShutdown() const {AutoRecursiveLock lock(mLock); return !mICESocket;}
+        Milliseconds getRelayedCandidateTime() const {AutoRecursiveLock lock(mLock); return mRelayedTime;}
+        size_t getTotalCandidates() const {AutoRecursiveLock lock(mLock); return mTotalCandidates;}
+
+      protected:
+        //---------------------------------------------------------------------
+        void checkCandidates(IICESocketPtr socket)
+        {
+          if (mRelayed) return;
+
+          IICESocket::CandidateList candidates;
+          socket->getLocalCandidates(candidates);
+          mTotalCandidates = candidates.size();
+
+          for (IICESocket::CandidateList::iterator iter = candidates.begin(); iter != candidates.end(); ++iter) {
+            if (IICESocket::Type_Relayed != (*iter).mType) continue;
+            mRelayed = true;
+            mRelayedTime = zsLib::toMilliseconds(zsLib::now() - mStarted);
+            return;
+          }
+        }
+
+      private:
+        TestTURNServerICEClientWeakPtr mThisWeak;
+        mutable RecursiveLock mLock;
+
+        IICESocketPtr mICESocket;
+        IICESocketSessionPtr mSession;
+
+        Time mStarted;
+        bool mReady {};
+        bool mRelayed {};
+        Milliseconds mRelayedTime {};
+        size_t mTotalCandidates {};
+
+        Time mSessionStarted;
+        bool mNominated {};
+        Milliseconds mNominationTime {};
+      };
+    }
+  }
+}
+
+using ortc::services::test::LocalTURNServer;
+using ortc::services::test::LocalTURNServerPtr;
+using ortc::services::test::TestTURNServerClient;
+using ortc::services::test::TestTURNServerClientPtr;
+using ortc::services::test::TestTURNServerICEClient;
+using ortc::services::test::TestTURNServerICEClientPtr;
+
+namespace
+{
+  //---------------------------------------------------------------------------
+  static LocalTURNServer::Impairments makeImpairments(
+                                                      const char *name,
+                                                      ULONG latencyMs,
+                                                      ULONG lossPercentTimes100
+                                                      )
+  {
+    LocalTURNServer::Impairments result;
+    result.mName = name;
+    result.mLatency = Milliseconds(latencyMs);
+    result.mLossPercent = lossPercentTimes100;
+    result.mSeed = ORTC_SERVICE_TEST_TURN_SERVER_SEED;
+    return result;
+  }
+
+  //---------------------------------------------------------------------------
+  static void runTURNServerBenchmark(
+                                     zsLib::IMessageQueuePtr queue,
+                                     LocalTURNServerPtr server,
+                                     const LocalTURNServer::Impairments &impairments,
+                                     bool useUDP,
+                                     bool useChannelBinding
+                                     )
+  {
+    server->setImpairments(impairments);
+    LocalTURNServer::Stats before = server->getStats();
+
+    TestTURNServerClientPtr client = TestTURNServerClient::create(
+                                                                  queue,
+                                                                  useUDP ? server->getUDPAddress() : server->getTCPAddress(),
+                                                                  useUDP,
+                                                                  useChannelBinding,
+                                                                  ORTC_SERVICE_TEST_TURN_SERVER_PACKET_SIZE,
+                                                                  ORTC_SERVICE_TEST_TURN_SERVER_PACKETS_PER_TICK
+                                                                  );
+
+    ULONG totalWait = 0;
+    while (!client->isComplete()) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 10)) break;
+    }
+
+    TestTURNServerClient::Result result = client->getResult();
+    LocalTURNServer::Stats after = server->getStats();
+
+    TESTING_STDOUT() << "BENCHMARK:    TURN over " << (useUDP ? "UDP" : "TCP") << " with " << (useChannelBinding ? "channels" : "send indications") << " through \"" << impairments.mName << "\" server\n";
+    TESTING_STDOUT() << "              allocated=" << (result.mAllocated ? "yes" : "no")
+                     << " allocation(ms)=" << result.mAllocationTime.count()
+                     << " requests=" << (after.mRequests - before.mRequests)
+                     << " challenges=" << (after.mChallenges - before.mChallenges) << "\n";
+    TESTING_STDOUT() << "              sent=" << result.mPacketsSent
+                     << " at peer=" << result.mPacketsAtPeer
+                     << " echoed=" << result.mPacketsEchoed
+                     << " duration(ms)=" << result.mDuration.count()
+                     << " relayed throughput(kbps)=" << result.mThroughputKbps
+                     << " server lost=" << (after.mPacketsLost - before.mPacketsLost)
+                     << " denied=" << (after.mPacketsDenied - before.mPacketsDenied) << "\n";
+
+    if (result.mDemuxPackets > 0) {
+      auto perSecond = [](ULONG packets, Microseconds duration) -> QWORD {
+        if (Microseconds() == duration) return 0;
+        return (static_cast<QWORD>(packets) * 1000000) / duration.count();
+      };
+
+      TESTING_STDOUT() << "              demux replay: packets=" << result.mDemuxPackets << "\n";
+      TESTING_STDOUT() << "              map+lock: duration(us)=" << result.mLegacyDemuxDuration.count() << " packets/sec=" << perSecond(result.mDemuxPackets, result.mLegacyDemuxDuration) << "\n";
+      TESTING_STDOUT() << "              channel table: duration(us)=" << result.mTableDemuxDuration.count() << " packets/sec=" << perSecond(result.mDemuxPackets, result.mTableDemuxDuration) << "\n";
+
+      TESTING_EQUAL(result.mLegacyDemuxDelivered, result.mDemuxPackets)
+      TESTING_EQUAL(result.mTableDemuxDelivered, result.mDemuxPackets)
+    }
+
+    TESTING_CHECK(result.mAllocated)
+    TESTING_CHECK(result.mCompleted)
+    TESTING_CHECK(result.mPacketsEchoed > 0)
+
+    client->cancel();
+    client.reset();
+
+    // the client deallocates on shutdown
+    TESTING_EQUAL(server->getTotalAllocations(), 0)
+  }
+
+  //---------------------------------------------------------------------------
+  static void runICERelayedCandidateBenchmark(
+                                              zsLib::IMessageQueuePtr queue,
+                                              LocalTURNServerPtr server,
+                                              const LocalTURNServer::Impairments &impairments
+                                              )
+  {
+    server->setImpairments(impairments);
+
+    TestTURNServerICEClientPtr client = TestTURNServerICEClient::create(queue, server->getUDPAddress());
+
+    ULONG totalWait = 0;
+    while (!client->hasRelayedCandidate()) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 10)) break;
+    }
+
+    TESTING_STDOUT() << "BENCHMARK:    ICE relayed candidate through \"" << impairments.mName << "\" server\n";
+    TESTING_STDOUT() << "              relayed=" << (client->hasRelayedCandidate() ? "yes" : "no")
+                     << " gathered(ms)=" << client->getRelayedCandidateTime().count()
+                     << " candidates=" << client->getTotalCandidates() << "\n";
+
+    TESTING_CHECK(client->hasRelayedCandidate())
+
+    client->shutdown();
+
+    totalWait = 0;
+    while (!client->isShutdown()) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 10)) break;
+    }
+    client.reset();
+  }
+
+  //---------------------------------------------------------------------------
+  static void runICENominationBenchmark(
+                                        zsLib::IMessageQueuePtr queue,
+                                        LocalTURNServerPtr server,
+                                        const LocalTURNServer::Impairments &impairments,
+                                        ULONG checkPacingInMilliseconds
+                                        )
+  {
+    server->setImpairments(impairments);
+    zsLib::ISettings::setUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_CHECK_PACING_IN_MILLISECONDS, checkPacingInMilliseconds);
+
+    TestTURNServerICEClientPtr controlling = TestTURNServerICEClient::create(queue, server->getUDPAddress());
+    TestTURNServerICEClientPtr controlled = TestTURNServerICEClient::create(queue, server->getUDPAddress());
+
+    ULONG totalWait = 0;
+    while ((!controlling->isReady()) ||
+           (!controlled->isReady())) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 10)) break;
+    }
+
+    controlling->connect(controlled, true);
+    controlled->connect(controlling, false);
+
+    totalWait = 0;
+    while ((!controlling->isNominated()) ||
+           (!controlled->isNominated())) {
+      TESTING_SLEEP(10)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 100)) break;
+    }
+
+    TESTING_STDOUT() << "BENCHMARK:    ICE nomination with Ta=" << checkPacingInMilliseconds << "ms through \"" << impairments.mName << "\" server\n";
+    TESTING_STDOUT() << "              nominated=" << ((controlling->isNominated()) && (controlled->isNominated()) ? "yes" : "no")
+                     << " controlling(ms)=" << controlling->getNominationTime().count()
+                     << " controlled(ms)=" << controlled->getNominationTime().count()
+                     << " candidates=" << controlling->getTotalCandidates() << "x" << controlled->getTotalCandidates() << "\n";
+
+    TESTING_CHECK(controlling->isNominated())
+    TESTING_CHECK(controlled->isNominated())
+
+    controlling->shutdown();
+    controlled->shutdown();
+
+    totalWait = 0;
+    while ((!controlling->isShutdown()) ||
+           (!controlled->isShutdown())) {
+      TESTING_SLEEP(100)
+      ++totalWait;
+      if (totalWait >= (ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS * 10)) break;
+    }
+    controlling.reset();
+    controlled.reset();
+
+    zsLib::ISettings::setUInt(ORTC_SERVICES_SETTING_ICESOCKETSESSION_CHECK_PACING_IN_MILLISECONDS, ORTC_SERVICE_TEST_TURN_SERVER_CHECK_PACING_IN_MILLISECONDS);
+  }
+}
+
+void doTestTURNServer()
+{
+  if (!ORTC_SERVICE_TEST_DO_TURN_SERVER_TEST) return;
+
+  TESTING_INSTALL_LOGGER();
+
+  // the server runs on its own thread as if it were a separate host
+  zsLib::IMessageQueueThreadPtr serverThread(zsLib::IMessageQueueThread::createBasic());
+  zsLib::IMessageQueueThreadPtr thread(zsLib::IMessageQueueThread::createBasic());
+
+  LocalTURNServerPtr server = LocalTURNServer::create(serverThread, ORTC_SERVICE_TEST_TURN_SERVER_USERNAME, ORTC_SERVICE_TEST_TURN_SERVER_PASSWORD, ORTC_SERVICE_TEST_TURN_SERVER_REALM);
+
+  LocalTURNServer::Impairments scenarios[] = {
+    //              name              latency loss
+    makeImpairments("clean",          0,      0),
+    makeImpairments("latency-25ms",   25,     0),
+    makeImpairments("lossy-2%",       0,      200),
+  };
+
+  for (size_t index = 0; index < (sizeof(scenarios) / sizeof(scenarios[0])); ++index) {
+    runTURNServerBenchmark(thread, server, scenarios[index], true, false);
+    runTURNServerBenchmark(thread, server, scenarios[index], true, true);
+    runTURNServerBenchmark(thread, server, scenarios[index], false, true);
+    runICERelayedCandidateBenchmark(thread, server, scenarios[index]);
+    runICENominationBenchmark(thread, server, scenarios[index], ORTC_SERVICE_TEST_TURN_SERVER_CHECK_PACING_IN_MILLISECONDS);
+    runICENominationBenchmark(thread, server, scenarios[index], ORTC_SERVICE_TEST_TURN_SERVER_FAST_CHECK_PACING_IN_MILLISECONDS);
+  }
+
+  server->shutdown();
+  server.reset();
+
+  ZS_LOG_BASIC("WAITING:      All TURN server benchmarks have finished. Waiting for 'bogus' events to process (10 second wait).");
+
+  TESTING_SLEEP(10000)
+
+  // wait for shutdown
+  {
+    IMessageQueue::size_type count = 0;
+    do
+    {
+      count = thread->getTotalUnprocessedMessages();
+      count += serverThread->getTotalUnprocessedMessages();
+      if (0 != count)
+        std::this_thread::yield();
+    } while (count > 0);
+
+    thread->waitForShutdown();
+    serverThread->waitForShutdown();
+  }
+  TESTING_UNINSTALL_LOGGER();
+  zsLib::proxyDump();
+  TESTING_EQUAL(zsLib::proxyGetTotalConstructed(), 0);
+}
@@ -56,6 +56,11 @@
 #define ORTC_SERVICE_TEST_DO_RUDPICESOCKET_CLIENT_TO_SERVER_TEST   (true)
 #define ORTC_SERVICE_TEST_DO_TCP_MESSAGING_TEST                    (true)
 #define ORTC_SERVICE_TEST_DO_STUN_PACKET_TEST                      (true)
+#define ORTC_SERVICE_TEST_DO_RUDP_SIMULATED_LINK_TEST              (true)
+#define ORTC_SERVICE_TEST_DO_TURN_SERVER_TEST                      (true)
+#define ORTC_SERVICE_TEST_DO_ICE_SOCKET_LITE_TEST                  (true)
+#define ORTC_SERVICE_TEST_DO_MESSAGE_LAYER_SECURITY_CHANNEL_TEST   (true)
+#define ORTC_SERVICE_TEST_DO_RSA_TEST                              (true)
 
 #define ORTC_SERVICE_TEST_DNS_ZONE "test-dns.ortclib.org"
 
@@ -69,6 +74,66 @@
 #define ORTC_SERVICE_TEST_RUDP_SERVER_IP                           "127.0.0.1"  // if running remotely choose alternative IP
 #define ORTC_SERVICE_TEST_RUDP_SERVER_PORT                         50000
 
+// simulated link benchmark (impairment decisions are reproducible for a given seed)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_SEED                 (1234)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_TOTAL_MESSAGES       (500)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MESSAGE_SIZE         (1024)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MESSAGES_IN_FLIGHT   (32)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_MAX_SECONDS          (60)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_MESSAGES     (200)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_MESSAGE_SIZE  (200)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_LIFETIME_MS   (60)
+#define ORTC_SERVICE_TEST_RUDP_SIMULATED_LINK_EXPIRE_DROP_PACKET   (20)
+
+// local TURN server stand-in benchmark (no external TURN server required)
+#define ORTC_SERVICE_TEST_TURN_SERVER_USERNAME                     "local-turn-user"
+#define ORTC_SERVICE_TEST_TURN_SERVER_PASSWORD                     "local-turn-password"
+#define ORTC_SERVICE_TEST_TURN_SERVER_REALM                        "localhost"
+#define ORTC_SERVICE_TEST_TURN_SERVER_SEED                         (1234)
+#define ORTC_SERVICE_TEST_TURN_SERVER_PACKET_SIZE                  (1000)
+#define ORTC_SERVICE_TEST_TURN_SERVER_PACKETS_PER_TICK             (10)
+#define ORTC_SERVICE_TEST_TURN_SERVER_TICK_IN_MILLISECONDS         (10)
+#define ORTC_SERVICE_TEST_TURN_SERVER_RUN_SECONDS                  (5)
+#define ORTC_SERVICE_TEST_TURN_SERVER_MAX_SECONDS                  (30)
+#define ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_CAPTURE_PACKETS        (1000)
+#define ORTC_SERVICE_TEST_TURN_SERVER_DEMUX_REPLAYS                (200)
+#define ORTC_SERVICE_TEST_TURN_SERVER_CHECK_PACING_IN_MILLISECONDS (20)
+#define ORTC_SERVICE_TEST_TURN_SERVER_FAST_CHECK_PACING_IN_MILLISECONDS (5)
+
+// ICE-lite density benchmark
+#define ORTC_SERVICE_TEST_ICE_LITE_TOTAL_SESSIONS                  (5000)
+#define ORTC_SERVICE_TEST_ICE_LITE_TOTAL_FULL_SESSIONS             (500)
+#define ORTC_SERVICE_TEST_ICE_LITE_MAX_SECONDS                     (30)
+
+// message layer security encode/decode
+#define ORTC_SERVICE_TEST_MLS_TOTAL_GOLDEN_MESSAGES                (50)
+#define ORTC_SERVICE_TEST_MLS_MESSAGE_SIZE                         (1024)
+#define ORTC_SERVICE_TEST_MLS_BENCHMARK_MESSAGES                   (20000)
+#define ORTC_SERVICE_TEST_MLS_PIPELINE_CHAINS                      (4)
+#define ORTC_SERVICE_TEST_MLS_PIPELINE_MESSAGES                    (2000)
+#define ORTC_SERVICE_TEST_MLS_PIPELINE_PASSPHRASE                  "mls-pipeline-passphrase"
+#define ORTC_SERVICE_TEST_MLS_AGREEMENT_MESSAGES                   (50)
+
+// key generation pool handshake latency
+#define ORTC_SERVICE_TEST_KEY_POOL_HANDSHAKES                      (20)
+#define ORTC_SERVICE_TEST_KEY_POOL_HANDSHAKE_SPACING_MS            (200)
+
+// DH precompiled key domain handshake benchmark
+#define ORTC_SERVICE_TEST_DH_BENCHMARK_HANDSHAKES                  (10)
+
+// RSA versus Ed25519 signing benchmark
+#define ORTC_SERVICE_TEST_SIGNING_BENCHMARK_OPERATIONS             (50)
+
+// domain validation and IDN conversion benchmark
+#define ORTC_SERVICE_TEST_DOMAIN_BENCHMARK_DOMAINS                 (20000)
+#define ORTC_SERVICE_TEST_IDN_BENCHMARK_CONVERSIONS                (2000)
+
+// base64/hex codec throughput benchmark (bytes converted per input size)
+#define ORTC_SERVICE_TEST_ENCODING_BENCHMARK_BYTES                 (16*1024*1024)
+
+// per-packet cost of wire log statements while wire logging is disabled
+#define ORTC_SERVICE_TEST_WIRE_LOGGING_BENCHMARK_PACKETS           (1000000)
+
 #define ORTC_SERVICE_TEST_DNS_PROVIDER_RESOLVES_BOGUS_DNS_A_RECORDS    (false)
 #define ORTC_SERVICE_TEST_DNS_PROVIDER_RESOLVES_BOGUS_DNS_AAAA_RECORDS (false)
 
@@ -62,12 +62,17 @@ void doTestDH();
 void doTestDNS();
 void doTestHelper();
 void doTestICESocket();
+void doTestICESocketLite();
+void doTestMessageLayerSecurityChannel();
+void doTestRSA();
 void doTestSTUNDiscovery();
 void doTestSTUNPacket();
 void doTestTURNSocket();
+void doTestTURNServer();
 void doTestRUDPListener();
 void doTestRUDPICESocket();
 void doTestRUDPICESocketLoopback();
+void doTestRUDPSimulatedLink();
 void doTestTCPMessagingLoopback();
 
 namespace Testing
@@ -201,12 +206,17 @@ namespace Testing
     TESTING_RUN_TEST_FUNC(doTestDNS)
     TESTING_RUN_TEST_FUNC(doTestHelper)
     TESTING_RUN_TEST_FUNC(doTestICESocket)
+    TESTING_RUN_TEST_FUNC(doTestICESocketLite)
+    TESTING_RUN_TEST_FUNC(doTestMessageLayerSecurityChannel)
+    TESTING_RUN_TEST_FUNC(doTestRSA)
     TESTING_RUN_TEST_FUNC(doTestSTUNDiscovery)
     TESTING_RUN_TEST_FUNC(doTestSTUNPacket)
     TESTING_RUN_TEST_FUNC(doTestTURNSocket)
+    TESTING_RUN_TEST_FUNC(doTestTURNServer)
     TESTING_RUN_TEST_FUNC(doTestRUDPICESocketLoopback)
     TESTING_RUN_TEST_FUNC(doTestRUDPListener)
     TESTING_RUN_TEST_FUNC(doTestRUDPICESocket)
+    TESTING_RUN_TEST_FUNC(doTestRUDPSimulatedLink)
     TESTING_RUN_TEST_FUNC(doTestTCPMessagingLoopback)
 
     TESTING_UNINSTALL_LOGGER()
@@ -154,6 +154,8 @@ namespace ortc
     ZS_DECLARE_INTERACTION_PTR(IDecryptor);
     ZS_DECLARE_INTERACTION_PTR(IDNS);
     ZS_DECLARE_INTERACTION_PTR(IDNSQuery);
+    ZS_DECLARE_INTERACTION_PTR(IEd25519PrivateKey);
+    ZS_DECLARE_INTERACTION_PTR(IEd25519PublicKey);
     ZS_DECLARE_INTERACTION_PTR(IEncryptor);
     ZS_DECLARE_INTERACTION_PTR(IHelper);
     ZS_DECLARE_INTERACTION_PTR(IICESocket);
@@ -162,6 +164,7 @@ namespace ortc
     ZS_DECLARE_INTERACTION_PTR(IHTTPQuery);
     ZS_DECLARE_INTERACTION_PTR(IMessageLayerSecurityChannel);
     ZS_DECLARE_INTERACTION_PTR(IReachability);
+    ZS_DECLARE_INTERACTION_PTR(IRSABatch);
     ZS_DECLARE_INTERACTION_PTR(IRSAPrivateKey);
     ZS_DECLARE_INTERACTION_PTR(IRSAPublicKey);
     ZS_DECLARE_INTERACTION_PTR(IRUDPListener);
@@ -186,6 +189,7 @@ namespace ortc
     ZS_DECLARE_INTERACTION_PROXY(IHTTPQueryDelegate);
     ZS_DECLARE_INTERACTION_PROXY(IMessageLayerSecurityChannelDelegate);
     ZS_DECLARE_INTERACTION_PROXY(IReachabilityDelegate);
+    ZS_DECLARE_INTERACTION_PROXY(IRSABatchDelegate);
     ZS_DECLARE_INTERACTION_PROXY(IRUDPListenerDelegate);
     ZS_DECLARE_INTERACTION_PROXY(IRUDPMessagingDelegate);
     ZS_DECLARE_INTERACTION_PROXY(IRUDPChannelDelegate);
@@ -208,6 +212,7 @@ namespace ortc
     ZS_DECLARE_INTERACTION_PROXY_SUBSCRIPTION(ITransportStreamReaderSubscription, ITransportStreamReaderDelegate);
     ZS_DECLARE_INTERACTION_PROXY_SUBSCRIPTION(ITransportStreamWriterSubscription, ITransportStreamWriterDelegate);
 
+    ZS_DECLARE_STRUCT_PTR(PacketBuffer);
     ZS_DECLARE_STRUCT_PTR(RUDPPacket);
     ZS_DECLARE_STRUCT_PTR(STUNPacket);
 
@@ -13,6 +13,11 @@ void doTestHelper();
 void doTestICESocket();
 void doTestSTUNDiscovery();
 void doTestSTUNPacket();
+void doTestRUDPSimulatedLink();
+void doTestTURNServer();
+void doTestICESocketLite();
+void doTestMessageLayerSecurityChannel();
+void doTestRSA();
 void doTestTURNSocket();
 void doTestRUDPListener();
 void doTestRUDPICESocket();
@@ -28,6 +33,11 @@ TESTING_RUN_TEST_FUNC(doTestHelper)
 TESTING_RUN_TEST_FUNC(doTestICESocket)
 TESTING_RUN_TEST_FUNC(doTestSTUNDiscovery)
 TESTING_RUN_TEST_FUNC(doTestSTUNPacket)
+TESTING_RUN_TEST_FUNC(doTestRUDPSimulatedLink)
+TESTING_RUN_TEST_FUNC(doTestTURNServer)
+TESTING_RUN_TEST_FUNC(doTestICESocketLite)
+TESTING_RUN_TEST_FUNC(doTestMessageLayerSecurityChannel)
+TESTING_RUN_TEST_FUNC(doTestRSA)
 TESTING_RUN_TEST_FUNC(doTestTURNSocket)
 TESTING_RUN_TEST_FUNC(doTestRUDPICESocketLoopback)
 TESTING_RUN_TEST_FUNC(doTestRUDPListener)
@@ -139,6 +149,66 @@ namespace ortclib_services_Test
           }
         }
 
+        TEST_METHOD(Test_RUDPSimulatedLink)
+        {
+          Testing::setup();
+          unsigned int totalFailures = Testing::getGlobalFailedVar();
+
+          doTestRUDPSimulatedLink();
+
+          if (totalFailures != Testing::getGlobalFailedVar()) {
+            Assert::Fail(L"RUDPSimulatedLink retry tests have failed", LINE_INFO());
+          }
+        }
+
+        TEST_METHOD(Test_TURNServer)
+        {
+          Testing::setup();
+          unsigned int totalFailures = Testing::getGlobalFailedVar();
+
+          doTestTURNServer();
+
+          if (totalFailures != Testing::getGlobalFailedVar()) {
+            Assert::Fail(L"TURNServer retry tests have failed", LINE_INFO());
+          }
+        }
+
+        TEST_METHOD(Test_ICESocketLite)
+        {
+          Testing::setup();
+          unsigned int totalFailures = Testing::getGlobalFailedVar();
+
+          doTestICESocketLite();
+
+          if (totalFailures != Testing::getGlobalFailedVar()) {
+            Assert::Fail(L"ICESocketLite retry tests have failed", LINE_INFO());
+          }
+        }
+
+        TEST_METHOD(Test_MessageLayerSecurityChannel)
+        {
+          Testing::setup();
+          unsigned int totalFailures = Testing::getGlobalFailedVar();
+
+          doTestMessageLayerSecurityChannel();
+
+          if (totalFailures != Testing::getGlobalFailedVar()) {
+            Assert::Fail(L"MessageLayerSecurityChannel retry tests have failed", LINE_INFO());
+          }
+        }
+
+        TEST_METHOD(Test_RSA)
+        {
+          Testing::setup();
+          unsigned int totalFailures = Testing::getGlobalFailedVar();
+
+          doTestRSA();
+
+          if (totalFailures != Testing::getGlobalFailedVar()) {
+            Assert::Fail(L"RSA retry tests have failed", LINE_INFO());
+          }
+        }
+
         TEST_METHOD(Test_TURNSocket)
         {
           Testing::setup();
@@ -18,6 +18,11 @@ void doTestHelper();
 void doTestICESocket();
 void doTestSTUNDiscovery();
 void doTestSTUNPacket();
+void doTestRUDPSimulatedLink();
+void doTestTURNServer();
+void doTestICESocketLite();
+void doTestMessageLayerSecurityChannel();
+void doTestRSA();
 void doTestTURNSocket();
 void doTestRUDPListener();
 void doTestRUDPICESocket();
@@ -33,6 +38,11 @@ TESTING_RUN_TEST_FUNC(doTestHelper)
 TESTING_RUN_TEST_FUNC(doTestICESocket)
 TESTING_RUN_TEST_FUNC(doTestSTUNDiscovery)
 TESTING_RUN_TEST_FUNC(doTestSTUNPacket)
+TESTING_RUN_TEST_FUNC(doTestRUDPSimulatedLink)
+TESTING_RUN_TEST_FUNC(doTestTURNServer)
+TESTING_RUN_TEST_FUNC(doTestICESocketLite)
+TESTING_RUN_TEST_FUNC(doTestMessageLayerSecurityChannel)
+TESTING_RUN_TEST_FUNC(doTestRSA)
 TESTING_RUN_TEST_FUNC(doTestTURNSocket)
 TESTING_RUN_TEST_FUNC(doTestRUDPICESocketLoopback)
 TESTING_RUN_TEST_FUNC(doTestRUDPListener)
@@ -152,6 +162,66 @@ TESTING_RUN_TEST_FUNC(doTestTCPMessagingLoopback)
   XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
 }
 
+- (void)test_doTestRUDPSimulatedLink {
+  // This is an example of a functional test case.
+  // Use XCTAssert and related functions to verify your tests produce the correct results.
+  unsigned int total = Testing::getGlobalFailedVar();
+
+  Testing::setup();
+
+  doTestRUDPSimulatedLink();
+
+  XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
+}
+
+- (void)test_doTestTURNServer {
+  // This is an example of a functional test case.
+  // Use XCTAssert and related functions to verify your tests produce the correct results.
+  unsigned int total = Testing::getGlobalFailedVar();
+
+  Testing::setup();
+
+  doTestTURNServer();
+
+  XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
+}
+
+- (void)test_doTestICESocketLite {
+  // This is an example of a functional test case.
+  // Use XCTAssert and related functions to verify your tests produce the correct results.
+  unsigned int total = Testing::getGlobalFailedVar();
+
+  Testing::setup();
+
+  doTestICESocketLite();
+
+  XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
+}
+
+- (void)test_doTestMessageLayerSecurityChannel {
+  // This is an example of a functional test case.
+  // Use XCTAssert and related functions to verify your tests produce the correct results.
+  unsigned int total = Testing::getGlobalFailedVar();
+
+  Testing::setup();
+
+  doTestMessageLayerSecurityChannel();
+
+  XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
+}
+
+- (void)test_doTestRSA {
+  // This is an example of a functional test case.
+  // Use XCTAssert and related functions to verify your tests produce the correct results.
+  unsigned int total = Testing::getGlobalFailedVar();
+
+  Testing::setup();
+
+  doTestRSA();
+
+  XCTAssertEqual(total, (unsigned int)Testing::getGlobalFailedVar());
+}
+
 - (void)test_doTestTURNSocket {
   // This is an example of a functional test case.
   // Use XCTAssert and related functions to verify your tests produce the correct results.